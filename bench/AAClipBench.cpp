@@ -242,6 +242,70 @@ private:
     typedef Benchmark INHERITED;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// This bench intersects two overlapping anti-aliased round-rect clips, as happens
+// when round-rect clips nest in a view hierarchy.
+class AAClipOpBench : public Benchmark {
+public:
+    AAClipOpBench() {
+        SkPath outer, inner;
+        outer.addRoundRect(SkRect::MakeLTRB(0.5f, 0.5f, 639.5f, 479.5f), 20, 20);
+        inner.addRoundRect(SkRect::MakeLTRB(40.25f, 30.25f, 600.75f, 450.75f), 12, 12);
+        fOuter.setPath(outer, NULL, true);
+        fInner.setPath(inner, NULL, true);
+    }
+
+protected:
+    const char* onGetName() override { return "aaclip_op_rrect"; }
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkAAClip clip;
+            clip.op(fOuter, fInner, SkRegion::kIntersect_Op);
+        }
+    }
+
+private:
+    SkAAClip fOuter;
+    SkAAClip fInner;
+    typedef Benchmark INHERITED;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// This bench draws an A8 mask through an anti-aliased round-rect clip, which
+// goes through SkAAClipBlitter::blitMask.
+class AAClipBlitMaskBench : public Benchmark {
+public:
+    AAClipBlitMaskBench() {
+        fMask.allocPixels(SkImageInfo::MakeA8(400, 400));
+        SkRandom rand;
+        for (int y = 0; y < fMask.height(); ++y) {
+            for (int x = 0; x < fMask.width(); ++x) {
+                *fMask.getAddr8(x, y) = rand.nextU() & 0xFF;
+            }
+        }
+        fClipPath.addRoundRect(SkRect::MakeLTRB(10.5f, 10.5f, 390.5f, 390.5f), 16, 16);
+    }
+
+protected:
+    const char* onGetName() override { return "aaclip_blitmask"; }
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        this->setupPaint(&paint);
+
+        canvas->save();
+        canvas->clipPath(fClipPath, SkRegion::kIntersect_Op, true);
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawBitmap(fMask, 0, 0, &paint);
+        }
+        canvas->restore();
+    }
+
+private:
+    SkBitmap fMask;
+    SkPath   fClipPath;
+    typedef Benchmark INHERITED;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return SkNEW_ARGS(AAClipBuilderBench, (false, false)); )
@@ -255,3 +319,5 @@ DEF_BENCH( return SkNEW_ARGS(AAClipBench, (true, false)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBench, (true, true)); )
 DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (false)); )
 DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (true)); )
+DEF_BENCH( return SkNEW_ARGS(AAClipOpBench, ()); )
+DEF_BENCH( return SkNEW_ARGS(AAClipBlitMaskBench, ()); )
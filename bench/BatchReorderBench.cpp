@@ -0,0 +1,124 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkCanvas.h"
+#include "SkColorFilter.h"
+#include "SkPaint.h"
+
+/**
+ * Interleaves small rects and text over a grid of disjoint cells. None of the draws overlap, so a
+ * reordering GPU backend can merge all the rects into one batch and all the text into another no
+ * matter how far apart they were recorded. Best run under the gpunull config.
+ */
+class BatchReorderBench : public Benchmark {
+public:
+    BatchReorderBench(bool aa) : fAA(aa) {
+        fName.printf("batch_reorder_interleaved%s", aa ? "_aa" : "");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kGPU_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint rectPaint;
+        rectPaint.setAntiAlias(fAA);
+        rectPaint.setColor(0xFF3366CC);
+
+        SkPaint textPaint;
+        textPaint.setAntiAlias(fAA);
+        textPaint.setTextSize(SkIntToScalar(kCell - 4));
+
+        for (int i = 0; i < loops; ++i) {
+            for (int y = 0; y < H; y += kCell) {
+                for (int x = 0; x < W; x += 2 * kCell) {
+                    SkRect r = SkRect::MakeXYWH(SkIntToScalar(x) + 0.5f,
+                                                SkIntToScalar(y) + 0.5f,
+                                                SkIntToScalar(kCell - 2),
+                                                SkIntToScalar(kCell - 2));
+                    canvas->drawRect(r, rectPaint);
+                    canvas->drawText("g", 1, SkIntToScalar(x + kCell),
+                                     SkIntToScalar(y + kCell - 4), textPaint);
+                }
+            }
+        }
+    }
+
+private:
+    enum {
+        W = 640,
+        H = 480,
+        kCell = 16,
+    };
+    SkString fName;
+    bool     fAA;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return SkNEW_ARGS(BatchReorderBench, (false)); )
+DEF_BENCH( return SkNEW_ARGS(BatchReorderBench, (true)); )
+
+/**
+ * Thousands of small disjoint rects, each with its own color filter so that no two of them share
+ * a pipeline and none can merge. A reordering GPU backend searches back through earlier draws for
+ * a merge, so this measures what that search costs when it never succeeds. Best run under the
+ * gpunull config.
+ */
+class BatchReorderUnmergeableBench : public Benchmark {
+public:
+    BatchReorderUnmergeableBench() {}
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kGPU_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return "batch_reorder_disjoint_unmergeable"; }
+
+    void onPreDraw() override {
+        for (int i = 0; i < kCount; ++i) {
+            SkColor color = SkColorSetARGB(0xFF, i & 0xFF, (i >> 8) & 0xFF, 0x80);
+            fFilters[i].reset(SkColorFilter::CreateModeFilter(color, SkXfermode::kScreen_Mode));
+        }
+    }
+
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setColor(0xFF3366CC);
+
+        for (int i = 0; i < loops; ++i) {
+            int index = 0;
+            for (int y = 0; y < H; y += kCell) {
+                for (int x = 0; x < W; x += kCell) {
+                    paint.setColorFilter(fFilters[index++]);
+                    SkRect r = SkRect::MakeXYWH(SkIntToScalar(x), SkIntToScalar(y),
+                                                SkIntToScalar(kCell - 2),
+                                                SkIntToScalar(kCell - 2));
+                    canvas->drawRect(r, paint);
+                }
+            }
+        }
+    }
+
+private:
+    enum {
+        W = 640,
+        H = 480,
+        kCell = 8,
+        kCount = (W / kCell) * (H / kCell),
+    };
+    SkAutoTUnref<SkColorFilter> fFilters[kCount];
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return SkNEW(BatchReorderUnmergeableBench); )
@@ -12,6 +12,7 @@
 #include "SkMallocPixelRef.h"
 #include "SkOSFile.h"
 #include "SkStream.h"
+#include "SkStreamPriv.h"
 
 /*
  *
@@ -19,8 +20,10 @@
  * It is invoked from the nanobench.cpp file.
  *
  */
-DecodingBench::DecodingBench(SkString path, SkColorType colorType)
-    : fColorType(colorType)
+DecodingBench::DecodingBench(SkString path, SkColorType colorType, Source source)
+    : fPath(path)
+    , fColorType(colorType)
+    , fSource(source)
     , fData(SkData::NewFromFileName(path.c_str()))
 {
     // Parse filename and the color type to give the benchmark a useful name
@@ -40,7 +43,10 @@ DecodingBench::DecodingBench(SkString path, SkColorType colorType)
             colorName = "Unknown";
     }
     fName.printf("Decode_%s_%s", baseName.c_str(), colorName);
-    
+    if (kFile_Source == source) {
+        fName.append("_file");
+    }
+
 #ifdef SK_DEBUG
     // Ensure that we can create a decoder.
     SkAutoTDelete<SkStreamRewindable> stream(new SkMemoryStream(fData));
@@ -49,6 +55,16 @@ DecodingBench::DecodingBench(SkString path, SkColorType colorType)
 #endif
 }
 
+SkStreamRewindable* DecodingBench::newStream() const {
+    if (kFile_Source == fSource) {
+        // SkStream::NewFromFile() would map a regular file into an SkMemoryStream, so open the
+        // file directly to time reading through SkBufferedFILEStream.
+        return SkNEW_ARGS(SkBufferedFILEStream, (sk_fopen(fPath.c_str(), kRead_SkFILE_Flag),
+                                                 fPath.c_str()));
+    }
+    return new SkMemoryStream(fData);
+}
+
 const char* DecodingBench::onGetName() {
     return fName.c_str();
 }
@@ -101,7 +117,7 @@ void DecodingBench::onDraw(const int n, SkCanvas* canvas) {
     for (int i = 0; i < n; i++) {
         // create a new stream and a new decoder to mimic the behavior of
         // CodecBench.
-        stream.reset(new SkMemoryStream(fData));
+        stream.reset(this->newStream());
         decoder.reset(SkImageDecoder::Factory(stream));
         decoder->setAllocator(&allocator);
         decoder->decode(stream, &bitmap, fColorType,
@@ -22,7 +22,12 @@
  */
 class DecodingBench : public Benchmark {
 public:
-    DecodingBench(SkString path, SkColorType colorType);
+    enum Source {
+        kMemory_Source,     // decode from an SkMemoryStream over the encoded data
+        kFile_Source,       // decode from an SkBufferedFILEStream over the file
+    };
+
+    DecodingBench(SkString path, SkColorType colorType, Source source = kMemory_Source);
 
 protected:
     const char* onGetName() override;
@@ -31,8 +36,12 @@ protected:
     void onPreDraw() override;
 
 private:
+    SkStreamRewindable* newStream() const;
+
+    SkString                fPath;
     SkString                fName;
     SkColorType             fColorType;
+    Source                  fSource;
     SkAutoTUnref<SkData>    fData;
     SkAutoMalloc            fPixelStorage;
     typedef Benchmark INHERITED;
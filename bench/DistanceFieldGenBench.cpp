@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkDistanceFieldGen.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkTemplates.h"
+
+// Generates distance fields for a set of glyph-sized A8 masks.
+class DistanceFieldGenBench : public Benchmark {
+    enum {
+        kGlyphCount = 64,
+        kWidth      = 40,
+        kHeight     = 48,
+    };
+
+public:
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return "distance_field_gen";
+    }
+
+    void onPreDraw() override {
+        SkRandom rand;
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setStyle(SkPaint::kStroke_Style);
+
+        fMasks.setInfo(SkImageInfo::MakeA8(kWidth, kHeight*kGlyphCount));
+        fMasks.allocPixels();
+        fMasks.eraseColor(0);
+        SkCanvas canvas(fMasks);
+        for (int i = 0; i < kGlyphCount; ++i) {
+            // a few overlapping strokes, roughly the complexity of a glyph
+            for (int j = 0; j < 3; ++j) {
+                paint.setStrokeWidth(rand.nextRangeF(2, 6));
+                canvas.drawOval(SkRect::MakeXYWH(rand.nextRangeF(0, kWidth/2),
+                                                 kHeight*i + rand.nextRangeF(0, kHeight/2),
+                                                 rand.nextRangeF(8, kWidth/2),
+                                                 rand.nextRangeF(8, kHeight/2)), paint);
+            }
+        }
+
+        fFields.reset(SkComputeDistanceFieldSize(kWidth, kHeight)*kGlyphCount);
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        const size_t fieldSize = SkComputeDistanceFieldSize(kWidth, kHeight);
+        for (int loop = 0; loop < loops; ++loop) {
+            for (int i = 0; i < kGlyphCount; ++i) {
+                SkGenerateDistanceFieldFromA8Image(fFields.get() + fieldSize*i,
+                                                  fMasks.getAddr8(0, kHeight*i),
+                                                  kWidth, kHeight, fMasks.rowBytes());
+            }
+        }
+    }
+
+private:
+    SkBitmap                      fMasks;
+    SkAutoTMalloc<unsigned char>  fFields;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return SkNEW(DistanceFieldGenBench); )
@@ -8,28 +8,45 @@
 #include "Benchmark.h"
 #include "SkBitmap.h"
 #include "SkMipMap.h"
+#include "SkString.h"
 
 class MipMapBench: public Benchmark {
-    SkBitmap fBitmap;
+    SkBitmap    fBitmap;
+    SkString    fName;
+    SkColorType fColorType;
+    int         fLevelCount;
 
 public:
-    MipMapBench() {}
+    MipMapBench(SkColorType ct, int levelCount) : fColorType(ct), fLevelCount(levelCount) {
+        fName.set("mipmap_build");
+        switch (ct) {
+            case kN32_SkColorType:      break;
+            case kRGB_565_SkColorType:  fName.append("_565"); break;
+            case kAlpha_8_SkColorType:  fName.append("_a8"); break;
+            default:                    SkASSERT(false); break;
+        }
+        if (levelCount != SK_MaxS32) {
+            fName.appendf("_%dlevel", levelCount);
+        }
+    }
 
 protected:
     bool isSuitableFor(Backend backend) override {
         return kNonRendering_Backend == backend;
     }
 
-    const char* onGetName() override { return "mipmap_build"; }
+    const char* onGetName() override { return fName.c_str(); }
 
     void onPreDraw() override {
-        fBitmap.allocN32Pixels(1000, 1000, true);
+        SkAlphaType at = kRGB_565_SkColorType == fColorType ? kOpaque_SkAlphaType
+                                                            : kPremul_SkAlphaType;
+        fBitmap.allocPixels(SkImageInfo::Make(1000, 1000, fColorType, at));
         fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
     }
 
     void onDraw(const int loops, SkCanvas*) override {
         for (int i = 0; i < loops; i++) {
-            SkMipMap::Build(fBitmap, NULL)->unref();
+            SkMipMap::Build(fBitmap, NULL, fLevelCount)->unref();
         }
     }
 
@@ -37,4 +54,9 @@ private:
     typedef Benchmark INHERITED;
 };
 
-DEF_BENCH( return new MipMapBench; )
+DEF_BENCH( return new MipMapBench(kN32_SkColorType, SK_MaxS32); )
+DEF_BENCH( return new MipMapBench(kRGB_565_SkColorType, SK_MaxS32); )
+DEF_BENCH( return new MipMapBench(kAlpha_8_SkColorType, SK_MaxS32); )
+
+// What a draw at scale 1/2 pays now that levels are only built on demand.
+DEF_BENCH( return new MipMapBench(kN32_SkColorType, 1); )
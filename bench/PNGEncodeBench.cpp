@@ -0,0 +1,87 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkGradientShader.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+#if !defined(SK_BUILD_FOR_MAC) && !defined(SK_BUILD_FOR_IOS) && !defined(SK_BUILD_FOR_WIN)
+
+/*
+ *  Encodes a screenshot sized bitmap, a gradient with some shapes over it, as PNG with one of
+ *  SkPNGEncoderOptions' presets, serially or in parallel bands.
+ */
+class PNGEncodeBench : public Benchmark {
+public:
+    PNGEncodeBench(SkPNGEncoderOptions::Preset preset, bool parallel)
+        : fOptions(preset) {
+        fOptions.fParallel = parallel;
+        static const char* gPresetNames[] = { "fastest", "fast", "default", "smallest" };
+        SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gPresetNames) == SkPNGEncoderOptions::kSmallest_Preset + 1,
+                          preset_names_mismatch);
+        fName.printf("encode_png_%s%s", gPresetNames[preset], parallel ? "_parallel" : "");
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return kNonRendering_Backend == backend;
+    }
+
+    void onPreDraw() override {
+        fBitmap.allocN32Pixels(1920, 1080, true);
+        SkCanvas canvas(fBitmap);
+        const SkPoint pts[] = { { 0, 0 }, { 1920, 1080 } };
+        const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+        SkPaint paint;
+        paint.setShader(SkGradientShader::CreateLinear(pts, colors, NULL, SK_ARRAY_COUNT(colors),
+                                                       SkShader::kClamp_TileMode))->unref();
+        canvas.drawPaint(paint);
+        paint.setShader(NULL);
+        paint.setAntiAlias(true);
+        SkRandom rand;
+        for (int i = 0; i < 200; ++i) {
+            paint.setColor(rand.nextU() | 0xFF000000);
+            canvas.drawCircle(rand.nextRangeScalar(0, 1920), rand.nextRangeScalar(0, 1080),
+                              rand.nextRangeScalar(2, 40), paint);
+        }
+        fEncoder.reset(CreatePNGImageEncoder(fOptions));
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkAutoTUnref<SkData> data(fEncoder->encodeData(fBitmap,
+                                                           SkImageEncoder::kDefaultQuality));
+            SkASSERT(data);
+        }
+    }
+
+private:
+    SkPNGEncoderOptions             fOptions;
+    SkString                        fName;
+    SkBitmap                        fBitmap;
+    SkAutoTDelete<SkImageEncoder>   fEncoder;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kFastest_Preset, false); )
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kFastest_Preset, true); )
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kFast_Preset, false); )
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kDefault_Preset, false); )
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kDefault_Preset, true); )
+DEF_BENCH( return new PNGEncodeBench(SkPNGEncoderOptions::kSmallest_Preset, false); )
+
+#endif
@@ -984,6 +984,158 @@ private:
     typedef ConicBench INHERITED;
 };
 
+// Draws the same complex, concave, non-AA path every frame. On the GPU this goes through
+// GrTessellatingPathRenderer, which can reuse its triangulation unless the path is volatile.
+class ConcavePathBench : public Benchmark {
+public:
+    ConcavePathBench(bool isVolatile) : fVolatile(isVolatile) {
+        SkRandom rand;
+        const int kPoints = 1000;
+        for (int i = 0; i < kPoints; ++i) {
+            SkScalar angle = 2 * SK_ScalarPI * i / kPoints;
+            SkScalar radius = (i & 1) ? 240 : rand.nextRangeF(40, 200);
+            SkPoint pt = SkPoint::Make(250 + radius * SkScalarCos(angle),
+                                       250 + radius * SkScalarSin(angle));
+            if (0 == i) {
+                fPath.moveTo(pt);
+            } else {
+                fPath.lineTo(pt);
+            }
+        }
+        fPath.close();
+        fPath.setIsVolatile(isVolatile);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fVolatile ? "path_fill_concave_volatile" : "path_fill_concave_static";
+    }
+
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        this->setupPaint(&paint);
+        paint.setAntiAlias(false);
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawPath(fPath, paint);
+        }
+    }
+
+private:
+    SkPath fPath;
+    bool   fVolatile;
+
+    typedef Benchmark INHERITED;
+};
+
+// Many differently colored anti-aliased convex polygons, so each becomes its own GPU batch with
+// CPU-heavy geometry to compute at flush time.
+class ConvexPathsBench : public Benchmark {
+public:
+    ConvexPathsBench(bool curves) : fCurves(curves) {
+        SkRandom rand;
+        const int kSides = 64;
+        for (int i = 0; i < kPathCount; ++i) {
+            SkScalar cx = rand.nextRangeF(50, 590);
+            SkScalar cy = rand.nextRangeF(50, 430);
+            SkScalar r = rand.nextRangeF(10, 50);
+            for (int j = 0; j < kSides; ++j) {
+                SkScalar angle = 2 * SK_ScalarPI * j / kSides;
+                SkPoint pt = SkPoint::Make(cx + r * SkScalarCos(angle),
+                                           cy + r * SkScalarSin(angle));
+                if (0 == j) {
+                    fPaths[i].moveTo(pt);
+                } else if (curves) {
+                    SkScalar midAngle = 2 * SK_ScalarPI * (j - 0.5f) / kSides;
+                    SkScalar midR = r / SkScalarCos(SK_ScalarPI / kSides);
+                    fPaths[i].quadTo(cx + midR * SkScalarCos(midAngle),
+                                     cy + midR * SkScalarSin(midAngle), pt.fX, pt.fY);
+                } else {
+                    fPaths[i].lineTo(pt);
+                }
+            }
+            fPaths[i].close();
+            fColors[i] = rand.nextU() | 0xFF000000;
+        }
+    }
+
+protected:
+    const char* onGetName() override {
+        return fCurves ? "path_fill_convex_aa_curves" : "path_fill_convex_aa_lines";
+    }
+
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < loops; ++i) {
+            paint.setColor(fColors[i % kPathCount]);
+            canvas->drawPath(fPaths[i % kPathCount], paint);
+        }
+    }
+
+private:
+    enum {
+        kPathCount = 100,
+    };
+    SkPath  fPaths[kPathCount];
+    SkColor fColors[kPathCount];
+    bool    fCurves;
+
+    typedef Benchmark INHERITED;
+};
+
+// Lots of small, self-intersecting anti-aliased paths. On the GPU these have no analytic path
+// renderer and fall back to software masks.
+class SmallComplexPathsBench : public Benchmark {
+public:
+    SmallComplexPathsBench() {
+        SkRandom rand;
+        const int kPoints = 7;
+        for (int i = 0; i < kPathCount; ++i) {
+            SkScalar cx = rand.nextRangeF(20, 620);
+            SkScalar cy = rand.nextRangeF(20, 460);
+            SkScalar r = rand.nextRangeF(8, 20);
+            // A seven pointed star drawn as a single self-intersecting contour.
+            for (int j = 0; j < kPoints; ++j) {
+                SkScalar angle = 2 * SK_ScalarPI * ((3 * j) % kPoints) / kPoints;
+                SkPoint pt = SkPoint::Make(cx + r * SkScalarCos(angle),
+                                           cy + r * SkScalarSin(angle));
+                if (0 == j) {
+                    fPaths[i].moveTo(pt);
+                } else {
+                    fPaths[i].lineTo(pt);
+                }
+            }
+            fPaths[i].close();
+            // Keep the distance field path renderer from caching these.
+            fPaths[i].setIsVolatile(true);
+            fColors[i] = rand.nextU() | 0xFF000000;
+        }
+    }
+
+protected:
+    const char* onGetName() override {
+        return "path_fill_small_complex_aa";
+    }
+
+    void onDraw(const int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < loops; ++i) {
+            paint.setColor(fColors[i % kPathCount]);
+            canvas->drawPath(fPaths[i % kPathCount], paint);
+        }
+    }
+
+private:
+    enum {
+        kPathCount = 200,
+    };
+    SkPath  fPaths[kPathCount];
+    SkColor fColors[kPathCount];
+
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 const SkRect ConservativelyContainsBench::kBounds = SkRect::MakeWH(SkIntToScalar(100), SkIntToScalar(100));
@@ -1020,6 +1172,12 @@ DEF_BENCH( return new LongCurvedPathBench(FLAGS01); )
 DEF_BENCH( return new LongLinePathBench(FLAGS00); )
 DEF_BENCH( return new LongLinePathBench(FLAGS01); )
 
+DEF_BENCH( return new ConcavePathBench(false); )
+DEF_BENCH( return new ConcavePathBench(true); )
+DEF_BENCH( return new ConvexPathsBench(false); )
+DEF_BENCH( return new ConvexPathsBench(true); )
+DEF_BENCH( return new SmallComplexPathsBench(); )
+
 DEF_BENCH( return new PathCreateBench(); )
 DEF_BENCH( return new PathCopyBench(); )
 DEF_BENCH( return new PathTransformBench(true); )
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+
+static void make_big_path(SkPath& path) {
+    #include "BigPathBench.inc"
+}
+
+// A chart or map like polyline: many short line segments.
+static void make_polyline(SkPath& path) {
+    SkRandom rand;
+    SkScalar x = 100, y = 100;
+    path.moveTo(x, y);
+    for (int i = 0; i < 2000; ++i) {
+        x += rand.nextRangeF(-2, 2);
+        y += rand.nextRangeF(-2, 2);
+        path.lineTo(x, y);
+    }
+}
+
+enum Encoding {
+    kRaw_Encoding,      // SkPath::writeToMemory()
+    kExact_Encoding,    // SkPath::writeCompactToMemory(), lossless
+    kGrid_Encoding,     // SkPath::writeCompactToMemory(), within 1/64
+};
+
+static const char* gEncodingName[] = { "raw", "exact", "grid" };
+
+static const SkScalar kGridTolerance = 1.0f / 64;
+
+static size_t write_path(const SkPath& path, Encoding encoding, void* storage) {
+    switch (encoding) {
+        case kRaw_Encoding:
+            return path.writeToMemory(storage);
+        case kExact_Encoding:
+            return path.writeCompactToMemory(storage);
+        case kGrid_Encoding:
+            return path.writeCompactToMemory(storage, kGridTolerance);
+    }
+    return 0;
+}
+
+/*
+ *  Times writing or reading a path in each encoding. The name ends with the encoded size.
+ */
+class PathSerializeBench : public Benchmark {
+public:
+    PathSerializeBench(bool big, Encoding encoding, bool read)
+        : fBig(big)
+        , fEncoding(encoding)
+        , fRead(read) {
+        if (fBig) {
+            make_big_path(fPath);
+        } else {
+            make_polyline(fPath);
+        }
+        fSize = write_path(fPath, fEncoding, NULL);
+        // The encoded size goes in the name so each run reports it once, next to its timing.
+        fName.printf("path_serialize_%s_%s_%s_%dbytes", big ? "big" : "polyline",
+                     gEncodingName[encoding], read ? "read" : "write", (int)fSize);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onPreDraw() override {
+        fStorage.reset(fSize);
+        write_path(fPath, fEncoding, fStorage.get());
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            if (fRead) {
+                SkPath path;
+                path.readFromMemory(fStorage.get(), fSize);
+            } else {
+                write_path(fPath, fEncoding, fStorage.get());
+            }
+        }
+    }
+
+private:
+    bool                fBig;
+    Encoding            fEncoding;
+    bool                fRead;
+    SkString            fName;
+    SkPath              fPath;
+    size_t              fSize;
+    SkAutoTMalloc<char> fStorage;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new PathSerializeBench(true, kRaw_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(true, kExact_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(true, kGrid_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(true, kRaw_Encoding, true); )
+DEF_BENCH( return new PathSerializeBench(true, kExact_Encoding, true); )
+DEF_BENCH( return new PathSerializeBench(true, kGrid_Encoding, true); )
+
+DEF_BENCH( return new PathSerializeBench(false, kRaw_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(false, kExact_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(false, kGrid_Encoding, false); )
+DEF_BENCH( return new PathSerializeBench(false, kRaw_Encoding, true); )
+DEF_BENCH( return new PathSerializeBench(false, kExact_Encoding, true); )
+DEF_BENCH( return new PathSerializeBench(false, kGrid_Encoding, true); )
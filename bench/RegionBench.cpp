@@ -9,6 +9,7 @@
 #include "SkRandom.h"
 #include "SkRegion.h"
 #include "SkString.h"
+#include "SkTDArray.h"
 
 static bool union_proc(SkRegion& a, SkRegion& b) {
     SkRegion result;
@@ -117,9 +118,54 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Builds a region from many small "damage" rects, either in one setRects() call or by unioning
+// them one at a time.
+class RegionFromRectsBench : public Benchmark {
+public:
+    RegionFromRectsBench(int count, bool bulk) : fBulk(bulk) {
+        fName.printf("region_%s_%d", bulk ? "setrects" : "unionrects", count);
+
+        SkRandom rand;
+        for (int i = 0; i < count; i++) {
+            int x = rand.nextU() % 1024;
+            int y = rand.nextU() % 768;
+            *fRects.append() = SkIRect::MakeXYWH(x, y, 1 + rand.nextU() % 64,
+                                                 1 + rand.nextU() % 64);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkRegion rgn;
+            if (fBulk) {
+                rgn.setRects(fRects.begin(), fRects.count());
+            } else {
+                for (int j = 0; j < fRects.count(); ++j) {
+                    rgn.op(fRects[j], SkRegion::kUnion_Op);
+                }
+            }
+        }
+    }
+
+private:
+    SkTDArray<SkIRect>  fRects;
+    SkString            fName;
+    bool                fBulk;
+
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define SMALL   16
+#define LARGE   1000
 
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, union_proc, "union")); )
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, sect_proc, "intersect")); )
@@ -130,3 +176,10 @@ DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, containsrect_proc, "containsre
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, sectsrgn_proc, "intersectsrgn")); )
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, sectsrect_proc, "intersectsrect")); )
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, containsxy_proc, "containsxy")); )
+
+DEF_BENCH( return SkNEW_ARGS(RegionBench, (LARGE, containsxy_proc, "containsxy")); )
+DEF_BENCH( return SkNEW_ARGS(RegionBench, (LARGE, sectsrect_proc, "intersectsrect")); )
+DEF_BENCH( return SkNEW_ARGS(RegionBench, (LARGE, containsrect_proc, "containsrect")); )
+
+DEF_BENCH( return SkNEW_ARGS(RegionFromRectsBench, (LARGE, true)); )
+DEF_BENCH( return SkNEW_ARGS(RegionFromRectsBench, (LARGE, false)); )
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkTypes.h"
+
+#if !defined(SK_BUILD_FOR_WIN32)
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkSharedMemoryPipe.h"
+#include "SkString.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ *  Sends commands through an SkGPipe in shared memory to a reader in a child process, which
+ *  draws them into a raster canvas.
+ *
+ *  kThroughput_Mode draws a rect per loop, and waits for the reader once at the end, so it
+ *  measures the time per command when the two processes run in parallel (the inverse of
+ *  commands per second). kLatency_Mode waits for the reader after each rect, so it measures the
+ *  round trip of a command. The bitmap modes draw a 256x256 bitmap whose pixels change every
+ *  loop, either allocated in the shared memory, so only a reference is sent, or not, so its
+ *  pixels are copied through the pipe.
+ */
+class SharedMemoryPipeBench : public Benchmark {
+public:
+    enum Mode {
+        kThroughput_Mode,
+        kLatency_Mode,
+        kSharedBitmap_Mode,
+        kCopiedBitmap_Mode,
+    };
+
+    SharedMemoryPipeBench(Mode mode) : fMode(mode), fChild(-1) {
+        static const char* gNames[] = { "throughput", "latency", "bitmap_shared", "bitmap_copied" };
+        fName.printf("pipe_shm_%s", gNames[mode]);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        fMemory.reset(SkSharedPipeMemory::Create(2 * kSize * kSize * 4, kSize * kSize * 4));
+        if (NULL == fMemory) {
+            return;
+        }
+        fBitmap.setInfo(SkImageInfo::MakeN32Premul(kSize, kSize));
+        if (kSharedBitmap_Mode == fMode) {
+            fMemory->allocPixels(&fBitmap);
+        } else {
+            fBitmap.allocPixels();
+        }
+        fBitmap.eraseColor(SK_ColorBLUE);
+
+        fChild = fork();
+        if (0 == fChild) {
+            SkBitmap dst;
+            dst.allocN32Pixels(kSize, kSize);
+            SkCanvas canvas(dst);
+            SkSharedMemoryPipeReader reader(fMemory, &canvas);
+            while (SkGPipeReader::kDone_Status == reader.playback()) {}
+            _exit(0);
+        }
+        fController.reset(SkNEW_ARGS(SkSharedMemoryPipeController, (fMemory)));
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        // Closes the pipe, so the reader exits.
+        fController.free();
+        if (fChild > 0) {
+            waitpid(fChild, NULL, 0);
+            fChild = -1;
+        }
+        fBitmap.reset();
+        fMemory.reset(NULL);
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        if (NULL == fController.get() || fChild < 0) {
+            return;
+        }
+        SkGPipeWriter writer;
+        SkCanvas* canvas = writer.startRecording(fController, SkGPipeWriter::kCrossProcess_Flag,
+                                                 kSize, kSize);
+        SkPaint paint;
+        for (int i = 0; i < loops; ++i) {
+            switch (fMode) {
+                case kThroughput_Mode:
+                case kLatency_Mode:
+                    paint.setColor(SkColorSetARGB(0xFF, i & 0xFF, 0, 0));
+                    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(kSize / 2),
+                                                    SkIntToScalar(kSize / 2)), paint);
+                    if (kLatency_Mode == fMode) {
+                        fController->waitForReader();
+                    }
+                    break;
+                case kSharedBitmap_Mode:
+                case kCopiedBitmap_Mode:
+                    // The reader must be done with the pixels before they change.
+                    fController->waitForReader();
+                    *fBitmap.getAddr32(0, 0) = SkPackARGB32(0xFF, i & 0xFF, 0, 0);
+                    fBitmap.notifyPixelsChanged();
+                    canvas->drawBitmap(fBitmap, 0, 0);
+                    break;
+            }
+        }
+        writer.endRecording();
+        fController->waitForReader();
+    }
+
+private:
+    enum {
+        kSize = 256,
+    };
+
+    Mode                                        fMode;
+    SkString                                    fName;
+    SkAutoTUnref<SkSharedPipeMemory>            fMemory;
+    SkAutoTDelete<SkSharedMemoryPipeController> fController;
+    SkBitmap                                    fBitmap;
+    pid_t                                       fChild;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new SharedMemoryPipeBench(SharedMemoryPipeBench::kThroughput_Mode); )
+DEF_BENCH( return new SharedMemoryPipeBench(SharedMemoryPipeBench::kLatency_Mode); )
+DEF_BENCH( return new SharedMemoryPipeBench(SharedMemoryPipeBench::kSharedBitmap_Mode); )
+DEF_BENCH( return new SharedMemoryPipeBench(SharedMemoryPipeBench::kCopiedBitmap_Mode); )
+
+#endif
@@ -13,6 +13,7 @@
 #include "SkRandom.h"
 #include "SkStream.h"
 #include "SkString.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkTypeface.h"
 
@@ -170,3 +171,64 @@ DEF_BENCH( return new TextBench(STR, 16, 0x88FF0000, kBW, true); )
 
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kBW, true, true); )
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kAA, false, true); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Measures a paragraph's worth of words, the way layout does, either one measureText() call
+// per word or one measureTexts() call for all of them.
+class TextMeasureBench : public Benchmark {
+    SkPaint                 fPaint;
+    SkString                fName;
+    bool                    fBatch;
+    SkTDArray<const char*>  fWords;
+    SkTDArray<size_t>       fLengths;
+    SkTDArray<SkScalar>     fWidths;
+public:
+    TextMeasureBench(bool batch) : fBatch(batch) {
+        fPaint.setAntiAlias(true);
+        fPaint.setTextSize(SkIntToScalar(16));
+        fName.printf("text_measure_%s", batch ? "batch" : "single");
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onPreDraw() override {
+        static const char* gWords[] = {
+            "Hamburgefons", "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+            "Sphinx", "of", "black", "quartz", "judge", "my", "vow",
+        };
+        SkRandom rand;
+        for (int i = 0; i < 256; ++i) {
+            const char* word = gWords[rand.nextULessThan(SK_ARRAY_COUNT(gWords))];
+            *fWords.append() = word;
+            *fLengths.append() = strlen(word);
+        }
+        fWidths.setCount(fWords.count());
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            if (fBatch) {
+                fPaint.measureTexts(fWords.count(), (const void* const*)fWords.begin(),
+                                    fLengths.begin(), fWidths.begin());
+            } else {
+                for (int j = 0; j < fWords.count(); ++j) {
+                    fWidths[j] = fPaint.measureText(fWords[j], fLengths[j]);
+                }
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new TextMeasureBench(false); )
+DEF_BENCH( return new TextMeasureBench(true); )
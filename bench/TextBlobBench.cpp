@@ -9,6 +9,7 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkCanvas.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkRandom.h"
 #include "SkStream.h"
@@ -21,11 +22,15 @@
 
 /*
  * A trivial test which benchmarks the performance of a textblob with a single run.
+ *
+ * The cold variant draws a long run of distinct, larger glyphs and purges the font cache
+ * before every draw, so each iteration has to scale all of the glyph images again.
  */
 class TextBlobBench : public Benchmark {
 public:
-    TextBlobBench()
-        : fTypeface(NULL) {
+    TextBlobBench(bool cold = false)
+        : fTypeface(NULL)
+        , fCold(cold) {
     }
 
 protected:
@@ -35,6 +40,11 @@ protected:
         SkPaint paint;
         paint.setTypeface(fTypeface);
         const char* text = "Hello blob!";
+        if (fCold) {
+            paint.setTextSize(48);
+            text = "The quick brown fox jumps over the lazy dog. "
+                   "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG! 0123456789 ?@#$%&*()[]{}";
+        }
         SkTDArray<uint16_t> glyphs;
         size_t len = strlen(text);
         glyphs.append(paint.textToGlyphs(text, len, NULL));
@@ -51,7 +61,7 @@ protected:
     }
 
     const char* onGetName() {
-        return "TextBlobBench";
+        return fCold ? "TextBlobBench_cold" : "TextBlobBench";
     }
 
     void onDraw(const int loops, SkCanvas* canvas) {
@@ -59,6 +69,9 @@ protected:
 
         // To ensure maximum caching, we just redraw the blob at the same place everytime
         for (int i = 0; i < loops; i++) {
+            if (fCold) {
+                SkGraphics::PurgeFontCache();
+            }
             canvas->drawTextBlob(fBlob, 0, 0, paint);
         }
     }
@@ -68,8 +81,10 @@ private:
     SkAutoTUnref<const SkTextBlob> fBlob;
     SkTDArray<uint16_t>      fGlyphs;
     SkAutoTUnref<SkTypeface> fTypeface;
+    bool                     fCold;
 
     typedef Benchmark INHERITED;
 };
 
 DEF_BENCH( return new TextBlobBench(); )
+DEF_BENCH( return new TextBlobBench(true); )
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkRandom.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+#include "SkTextureCompressor.h"
+
+// Measures compressing a coverage-mask-like A8 image into each of the alpha formats,
+// with and without the platform specific encoders.
+class TextureCompressionBench : public Benchmark {
+    enum {
+        kSize = 1024,
+    };
+
+public:
+    TextureCompressionBench(SkTextureCompressor::Format format, const char* name, bool opt)
+        : fFormat(format)
+        , fOpt(opt) {
+        fName.printf("compress_a8_%s%s", name, opt ? "" : "_portable");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onPreDraw() override {
+        // Mostly empty or full, with anti-aliased edges in between.
+        SkRandom rand;
+        fPixels.reset(kSize*kSize);
+        for (int y = 0; y < kSize; ++y) {
+            for (int x = 0; x < kSize; ++x) {
+                const int cell = ((x >> 5) ^ (y >> 5)) & 3;
+                uint8_t alpha = 0;
+                if (1 == cell) {
+                    alpha = 0xFF;
+                } else if (2 == cell) {
+                    alpha = rand.nextU() & 0xFF;
+                }
+                fPixels[y*kSize + x] = alpha;
+            }
+        }
+        fCompressed.reset(SkTextureCompressor::GetCompressedDataSize(fFormat, kSize, kSize));
+    }
+
+    void onDraw(const int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkTextureCompressor::CompressBufferToFormat(fCompressed.get(), fPixels.get(),
+                                                        kAlpha_8_SkColorType, kSize, kSize,
+                                                        kSize, fFormat, fOpt);
+        }
+    }
+
+private:
+    SkTextureCompressor::Format fFormat;
+    bool                        fOpt;
+    SkString                    fName;
+    SkAutoTMalloc<uint8_t>      fPixels;
+    SkAutoTMalloc<uint8_t>      fCompressed;
+
+    typedef Benchmark INHERITED;
+};
+
+// 1024 isn't a multiple of every ASTC block size, so only the power of two ones are here.
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kLATC_Format, "latc", true)); )
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kLATC_Format, "latc", false)); )
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kR11_EAC_Format, "r11eac", true)); )
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kR11_EAC_Format, "r11eac", false)); )
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kASTC_4x4_Format, "astc_4x4", true)); )
+DEF_BENCH( return SkNEW_ARGS(TextureCompressionBench,
+                             (SkTextureCompressor::kASTC_8x8_Format, "astc_8x8", true)); )
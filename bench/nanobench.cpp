@@ -550,6 +550,7 @@ public:
                       , fCurrentImage(0)
                       , fCurrentSubsetImage(0)
                       , fCurrentColorType(0)
+                      , fDecodeFromFile(false)
                       , fCurrentSubsetType(0)
                       , fUseCodec(0)
                       , fCurrentAnimSKP(0) {
@@ -783,15 +784,22 @@ public:
             while (fCurrentColorType < fColorTypes.count()) {
                 const SkString& path = fImages[fCurrentImage];
                 SkColorType colorType = fColorTypes[fCurrentColorType];
-                fCurrentColorType++;
+                if (fDecodeFromFile) {
+                    // The bench decoding from memory was returned last time.
+                    fDecodeFromFile = false;
+                    fCurrentColorType++;
+                    return new DecodingBench(path, colorType, DecodingBench::kFile_Source);
+                }
                 // Check if the image decodes to the right color type
                 // before creating the benchmark
                 SkBitmap bitmap;
                 if (SkImageDecoder::DecodeFile(path.c_str(), &bitmap,
                         colorType, SkImageDecoder::kDecodePixels_Mode)
                         && bitmap.colorType() == colorType) {
+                    fDecodeFromFile = true;
                     return new DecodingBench(path, colorType);
                 }
+                fCurrentColorType++;
             }
             fCurrentColorType = 0;
             fCurrentImage++;
@@ -906,6 +914,7 @@ private:
     int fCurrentImage;
     int fCurrentSubsetImage;
     int fCurrentColorType;
+    bool fDecodeFromFile;
     int fCurrentSubsetType;
     int fUseCodec;
     int fCurrentAnimSKP;
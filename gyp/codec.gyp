@@ -38,6 +38,10 @@
         '../src/codec/SkCodec_libpng.cpp',
         '../src/codec/SkCodec_wbmp.cpp',
         '../src/codec/SkGifInterlaceIter.cpp',
+        '../src/codec/SkIncrementalCodec.cpp',
+        '../src/codec/SkIncrementalCodec_gif.cpp',
+        '../src/codec/SkIncrementalCodec_jpeg.cpp',
+        '../src/codec/SkIncrementalCodec_png.cpp',
         '../src/codec/SkJpegCodec.cpp',
         '../src/codec/SkJpegDecoderMgr.cpp',
         '../src/codec/SkJpegUtility.cpp',
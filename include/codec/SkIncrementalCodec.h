@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkIncrementalCodec_DEFINED
+#define SkIncrementalCodec_DEFINED
+
+#include "SkBitmap.h"
+#include "SkEncodedFormat.h"
+#include "SkImageInfo.h"
+#include "SkTypes.h"
+
+class SkROBuffer;
+
+/**
+ *  Decodes an image while its encoded data is still arriving, e.g. from the network into an
+ *  SkRWBuffer. Each call to update() is given a newer snapshot of the buffer, and decodes only
+ *  the bytes that are new since the last call; the decoder keeps its state in between rather
+ *  than starting over.
+ *
+ *  PNG (including interlaced), GIF (the first frame) and JPEG (including progressive) are
+ *  supported. Pixels are always decoded to kN32.
+ */
+class SkIncrementalCodec : SkNoncopyable {
+public:
+    /**
+     *  Return a codec for the image in buffer, or NULL if it is not a supported format. Only
+     *  the first few bytes need to have arrived; if too few have to tell the format, this
+     *  returns NULL and can be called again once there are more.
+     */
+    static SkIncrementalCodec* NewFromBuffer(const SkROBuffer*);
+
+    virtual ~SkIncrementalCodec() {}
+
+    enum Result {
+        kIncomplete_Result,     //!< all of the data so far is decoded, more is needed
+        kComplete_Result,       //!< the whole image is decoded
+        kError_Result,          //!< the data is invalid, and no more will be decoded
+    };
+
+    /**
+     *  Decode what can be decoded of buffer's data. buffer must be a snapshot of the same
+     *  SkRWBuffer as the previous calls (and as NewFromBuffer()), so that it starts with every
+     *  byte they saw. Once the result is complete or an error, later calls return it again.
+     */
+    Result update(const SkROBuffer* buffer);
+
+    SkEncodedFormat getEncodedFormat() const { return this->onGetEncodedFormat(); }
+
+    /** Returns true once the header is decoded, and the bitmap has its size and pixels. */
+    bool hasInfo() const { return !fBitmap.isNull(); }
+
+    /**
+     *  The pixels decoded so far, initially transparent (or black for opaque images). update()
+     *  notifies the bitmap's pixelref when it changes its pixels.
+     */
+    const SkBitmap& bitmap() const { return fBitmap; }
+
+    /**
+     *  Rows [0, rowsDecoded()) have been decoded, at least in part: interlaced and progressive
+     *  images fill every row in more detail with each pass.
+     */
+    int rowsDecoded() const { return fRowsDecoded; }
+
+protected:
+    SkIncrementalCodec()
+        : fBytesDecoded(0)
+        , fRowsDecoded(0)
+        , fPixelsChanged(false)
+        , fResult(kIncomplete_Result) {}
+
+    virtual SkEncodedFormat onGetEncodedFormat() const = 0;
+
+    /**
+     *  Decode what can be decoded of the next length bytes of the image, holding on to any
+     *  that can't be used until more arrive.
+     */
+    virtual Result onAppend(const void* data, size_t length) = 0;
+
+    /** Allocate the bitmap's pixels, once the size is known. Returns false on failure. */
+    bool allocPixels(int width, int height, SkAlphaType);
+
+    SkPMColor* getAddr(int y) { return fBitmap.getAddr32(0, y); }
+
+    /** Call after writing pixels, with the bottom row they reached plus one. */
+    void setRowsDecoded(int rows) {
+        fRowsDecoded = SkTMax(fRowsDecoded, rows);
+        fPixelsChanged = true;
+    }
+
+private:
+    SkBitmap    fBitmap;
+    size_t      fBytesDecoded;
+    int         fRowsDecoded;
+    bool        fPixelsChanged;
+    Result      fResult;
+};
+
+#endif  // SkIncrementalCodec_DEFINED
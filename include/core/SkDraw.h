@@ -128,6 +128,12 @@ private:
                      bool pathIsMutable, bool drawCoverage,
                      SkBlitter* customBlitter = NULL) const;
 
+    /**
+     *  If the path is worth caching, draw it by blitting its cached coverage mask (rasterizing
+     *  and caching the mask first if needed) and return true. Otherwise return false.
+     */
+    bool    drawPathWithMaskCache(const SkPath&, const SkMatrix&, const SkPaint&) const;
+
     /**
      *  Return the current clip bounds, in local coordinates, with slop to account
      *  for antialiasing or hairlines (i.e. device-bounds outset by 1, and then
@@ -100,6 +100,10 @@ public:
     static const char* FactoryToName(Factory);
     static bool NameToType(const char name[], Type* type);
 
+    /** Adds a name/factory/type entry to the global registry. This may be called from any
+        thread, even while other threads look entries up. Entries are never removed, and a
+        later entry replaces an earlier one of the same name or factory.
+      */
     static void Register(const char name[], Factory, Type);
 
     class Registrar {
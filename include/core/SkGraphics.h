@@ -77,6 +77,23 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  Back the font cache with a file, so that glyph metrics, images and paths generated by
+     *  one process can be reused by the next. The file is memory mapped right away; glyphs
+     *  generated afterwards are written out by FlushFontDiskCache() (and Term()), which drops
+     *  the least recently used glyphs to keep the file under byteLimit.
+     *
+     *  This purges the font cache, and should be called before text is drawn on other threads.
+     *  Pass NULL to stop using the file.
+     */
+    static void SetFontDiskCache(const char path[], size_t byteLimit);
+
+    /**
+     *  Write the glyphs generated since the font disk cache was set or last flushed to its file.
+     *  Returns false if the file could not be written.
+     */
+    static bool FlushFontDiskCache();
+
     /**
      *  Scaling bitmaps with the kHigh_SkFilterQuality setting is
      *  expensive, so the result is saved in the global Scaled Image
@@ -111,6 +128,28 @@ public:
     static size_t GetResourceCacheSingleAllocationByteLimit();
     static size_t SetResourceCacheSingleAllocationByteLimit(size_t newLimit);
 
+    /**
+     *  Counters for the global discardable memory pool, which holds decoded images (e.g. for
+     *  SkDiscardablePixelRef) when the platform does not provide its own discardable memory.
+     */
+    struct DiscardableMemoryStats {
+        int     fHits;           //!< locks that found their memory still resident
+        int     fMisses;         //!< locks that found their memory purged
+        int     fPurges;         //!< blocks purged to stay within the byte limit
+        int     fRecycles;       //!< allocations that reused the memory of a purged block
+        size_t  fBytesUsed;      //!< bytes held by resident blocks
+        size_t  fBytesRecycled;  //!< bytes of purged blocks held for reuse
+    };
+    static void GetDiscardableMemoryStats(DiscardableMemoryStats*);
+    static void ResetDiscardableMemoryStats();
+
+    /**
+     *  These functions get/set the memory budget for the global discardable memory pool. Unlocked
+     *  blocks are purged when the pool exceeds this limit. Set returns the previous limit.
+     */
+    static size_t GetDiscardableMemoryByteLimit();
+    static size_t SetDiscardableMemoryByteLimit(size_t newLimit);
+
     /**
      *  Applications with command line options may pass optional state, such
      *  as cache sizes, here, for instance:
@@ -60,6 +60,37 @@ public:
      */
     bool encodeStream(SkWStream* stream, const SkBitmap& bm, int quality);
 
+    /**
+     *  Encodes an image whose pixels arrive a band of rows at a time, e.g. from a tiled
+     *  renderer, so that only the band being written and the encoder's own state need to be
+     *  in memory.
+     */
+    class RowWriter : SkNoncopyable {
+    public:
+        virtual ~RowWriter() {}
+
+        /**
+         *  Encode the next rowCount rows, laid out as the SkImageInfo given to beginRows()
+         *  says, rowBytes apart. Returns false on failure, after which every call fails.
+         */
+        virtual bool writeRows(const void* pixels, size_t rowBytes, int rowCount) = 0;
+
+        /**
+         *  Write out the end of the image, once all of its rows have been written. Returns
+         *  false on failure, or if rows are missing.
+         */
+        virtual bool finish() = 0;
+    };
+
+    /**
+     *  Start encoding an image described by 'info' to 'stream', at quality level 'quality'
+     *  (which can be in range 0-100). Returns NULL if this encoder can't encode incrementally
+     *  or can't encode this kind of image (kIndex_8 images have no color table to write).
+     *  On success the caller must delete the returned writer, and keep the stream alive until
+     *  then.
+     */
+    RowWriter* beginRows(SkWStream* stream, const SkImageInfo& info, int quality);
+
     static SkData* EncodeData(const SkImageInfo&, const void* pixels, size_t rowBytes,
                               Type, int quality);
     static SkData* EncodeData(const SkBitmap&, Type, int quality);
@@ -78,6 +109,14 @@ protected:
      * This must be overridden by each SkImageEncoder implementation.
      */
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) = 0;
+
+    /**
+     *  Implement to support beginRows(). 'info' has a non-empty size, and 'quality' is in
+     *  range 0-100. The default returns NULL.
+     */
+    virtual RowWriter* onBeginRows(SkWStream*, const SkImageInfo&, int /*quality*/) {
+        return NULL;
+    }
 };
 
 // This macro declares a global (i.e., non-class owned) creation entry point
@@ -104,6 +143,46 @@ DECLARE_ENCODER_CREATOR(PNGImageEncoder);
 DECLARE_ENCODER_CREATOR(KTXImageEncoder);
 DECLARE_ENCODER_CREATOR(WEBPImageEncoder);
 
+/**
+ *  Tuning for the libpng based PNG encoder. PNG is lossless, so these trade encoding time
+ *  against file size only.
+ */
+struct SkPNGEncoderOptions {
+    enum Preset {
+        kFastest_Preset,    //!< zlib level 1 with the Sub filter
+        kFast_Preset,       //!< zlib level 3 with the None, Sub and Up filters
+        kDefault_Preset,    //!< libpng's filtering and zlib level (6)
+        kSmallest_Preset,   //!< zlib level 9 with adaptive filtering
+    };
+
+    /**
+     *  Filters the encoder may choose from for each row, adaptively if more than one is set.
+     *  kAll_Filters leaves the choice to libpng, which uses only None for palette images.
+     */
+    enum Filters {
+        kNone_Filter    = 0x08,
+        kSub_Filter     = 0x10,
+        kUp_Filter      = 0x20,
+        kAvg_Filter     = 0x40,
+        kPaeth_Filter   = 0x80,
+        kAll_Filters    = 0xF8,
+    };
+
+    SkPNGEncoderOptions(Preset = kDefault_Preset);
+
+    int         fZLibLevel;     //!< 0..9; the quality passed to the encoder is ignored
+    unsigned    fFilters;       //!< mask of Filters
+    /**
+     *  If true, large images are cut into bands of rows that are filtered and deflated on
+     *  SkTaskGroup's threads, and stitched back into one IDAT stream. The file is a little
+     *  bigger than a serial encode's.
+     */
+    bool        fParallel;
+};
+
+/** Like CreatePNGImageEncoder(), but with these options rather than the default ones. */
+SkImageEncoder* CreatePNGImageEncoder(const SkPNGEncoderOptions&);
+
 #ifdef SK_BUILD_FOR_IOS
 DECLARE_ENCODER_CREATOR(PNGImageEncoder_IOS);
 #endif
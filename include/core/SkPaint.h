@@ -890,6 +890,17 @@ public:
         return this->measureText(text, length, NULL);
     }
 
+    /** Measure each of count runs of text, as measureText(texts[i], lengths[i])
+     *  would, but with one lookup of the font cache for the whole batch.
+     *
+     *  @param count    Number of runs of text
+     *  @param texts    Address of each run of text
+     *  @param lengths  Number of bytes in each run of text
+     *  @param widths   Returns the advance width of each run of text
+     */
+    void measureTexts(int count, const void* const texts[], const size_t lengths[],
+                      SkScalar widths[]) const;
+
     /** Return the number of bytes of text that were measured. If
      *  isVerticalText() is true, then the vertical advances are used for
      *  the measurement.
@@ -1137,6 +1148,7 @@ private:
     friend class GrTextContext;
     friend class GrGLPathRendering;
     friend class SkScalerContext;
+    friend class SkTextMeasureCache;
     friend class SkTextToPathIter;
     friend class SkCanonicalizePaint;
 };
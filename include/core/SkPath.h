@@ -893,6 +893,12 @@ public:
      *  If buffer is NULL, it still returns the number of bytes.
      */
     size_t writeToMemory(void* buffer) const;
+    /**
+     *  Like writeToMemory(), but delta encodes the points and run length encodes the verbs, which
+     *  is usually much smaller. If tolerance is 0, the path is read back exactly. Otherwise each
+     *  coordinate may move by up to tolerance. readFromMemory() reads either encoding.
+     */
+    size_t writeCompactToMemory(void* buffer, SkScalar tolerance = 0) const;
     /**
      * Initializes the path from the buffer
      *
@@ -921,7 +927,7 @@ public:
 private:
     enum SerializationOffsets {
         // 1 free bit at 29
-        kUnused1_SerializationShift = 28,    // 1 free bit
+        kCompact_SerializationShift = 28,   // requires 1 bit
         kDirection_SerializationShift = 26, // requires 2 bits
         kIsVolatile_SerializationShift = 25, // requires 1 bit
         // 1 free bit at 24
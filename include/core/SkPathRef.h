@@ -17,6 +17,7 @@
 #include <stddef.h> // ptrdiff_t
 
 class SkRBuffer;
+class SkRBufferWithSizeCheck;
 class SkWBuffer;
 
 /**
@@ -175,6 +176,12 @@ public:
 
     static SkPathRef* CreateFromBuffer(SkRBuffer* buffer);
 
+    /**
+     * Reads a path ref written by writeToCompactBuffer(). Returns NULL if the buffer is too short
+     * or its contents are not a valid path.
+     */
+    static SkPathRef* CreateFromCompactBuffer(SkRBufferWithSizeCheck* buffer);
+
     /**
      * Rollsback a path ref to zero verbs and points with the assumption that the path ref will be
      * repopulated with approximately the same number of verbs and points. A new path ref is created
@@ -246,6 +253,14 @@ public:
      */
     uint32_t writeSize() const;
 
+    /**
+     * Writes the verbs as runs, and the points as deltas from the previous point, in variable
+     * length integers, padded to a multiple of 4 bytes. If tolerance is 0 the points are read back
+     * exactly. Otherwise they may be rounded to a grid whose spacing is at most 2 * tolerance.
+     * The bounds are not written. If buffer has no storage, this only counts the bytes.
+     */
+    void writeToCompactBuffer(SkWBuffer* buffer, SkScalar tolerance) const;
+
     /**
      * Gets an ID that uniquely identifies the contents of the path ref. If two path refs have the
      * same ID then they have the same verbs and points. However, two path refs may have the same
@@ -56,6 +56,17 @@ public:
     static SkPicture* CreateFromStream(SkStream*,
                                        InstallPixelRefProc proc = &SkImageDecoder::DecodeMemory);
 
+    /**
+     *  Like CreateFromStream(), but if the stream has an op index (see serializeWithOpIndex()), the
+     *  returned picture keeps the serialized ops and reads them as it plays them back, skipping
+     *  blocks outside the clip, instead of recording them all up front. Such a picture is not
+     *  an SkBigPicture, so GPU layer hoisting does not apply to it. Returns NULL if the index
+     *  does not match the ops.
+     */
+    static SkPicture* CreateIndexedFromStream(SkStream*,
+                                              InstallPixelRefProc proc =
+                                                      &SkImageDecoder::DecodeMemory);
+
     /**
      *  Recreate a picture that was serialized into a buffer. If the creation requires bitmap
      *  decoding, the decoder must be set on the SkReadBuffer parameter by calling
@@ -108,6 +119,13 @@ public:
      */
     void serialize(SkWStream*, SkPixelSerializer* = NULL) const;
 
+    /**
+     *  Like serialize(), but also writes an index of the bounds of the drawing ops, which
+     *  CreateIndexedFromStream() uses to skip ops outside the clip. Building the index replays
+     *  the picture once more to bound its ops.
+     */
+    void serializeWithOpIndex(SkWStream*, SkPixelSerializer* = NULL) const;
+
     /**
      *  Serialize to a buffer.
      */
@@ -158,6 +176,7 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkIndexedPicture;
     template <typename> friend class SkMiniPicture;
 
     virtual int numSlowPaths() const = 0;
@@ -171,10 +190,12 @@ private:
     // V40: Remove UniqueID serialization from SkImageFilter.
     // V41: Added serialization of SkBitmapSource's filterQuality parameter
     // V42: Added a bool to SkPictureShader serialization to indicate did-we-serialize-a-picture?
+    // V43: Added an index of op blocks and their bounds to streamed SkPictureData
+    // V44: Streamed SkPictureData writes its paths with SkPath::writeCompactToMemory()
 
     // Only SKPs within the min/current picture version range (inclusive) can be read.
     static const uint32_t     MIN_PICTURE_VERSION = 35;     // Produced by Chrome M39.
-    static const uint32_t CURRENT_PICTURE_VERSION = 42;
+    static const uint32_t CURRENT_PICTURE_VERSION = 44;
 
     static_assert(MIN_PICTURE_VERSION <= 41,
                   "Remove kFontFileName and related code from SkFontDescriptor.cpp.");
@@ -187,6 +208,7 @@ private:
 
     SkPictInfo createHeader() const;
     SkPictureData* backport() const;
+    void serialize(SkWStream*, SkPixelSerializer*, bool writeOpIndex) const;
 
     mutable uint32_t fUniqueID;
 };
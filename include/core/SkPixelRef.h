@@ -195,6 +195,14 @@ public:
         return this->onRefEncodedData();
     }
 
+    /**
+     *  Returns true if the pixels are generated (e.g. decoded) when this is locked, so the first
+     *  lock may be expensive, rather than already being in memory.
+     */
+    bool isLazyGenerated() const {
+        return this->onIsLazyGenerated();
+    }
+
     struct LockRequest {
         SkISize         fSize;
         SkFilterQuality fQuality;
@@ -316,6 +324,9 @@ protected:
     // default impl does nothing.
     virtual void onNotifyPixelsChanged();
 
+    // default impl returns false.
+    virtual bool onIsLazyGenerated() const;
+
     // default impl returns false.
     virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3],
                                  SkYUVColorSpace* colorSpace);
@@ -28,6 +28,8 @@ public:
     enum Flags {
         kCrossProcess_Flag  = 1 << 0,
         kValidation_Flag    = 1 << 1,
+        // Write paths with SkPath::writeCompactToMemory(). Any reader can read them.
+        kCompactPaths_Flag  = 1 << 2,
     };
 
     SkWriteBuffer(uint32_t flags = 0);
@@ -107,6 +109,12 @@ public:
      */
     void setPixelSerializer(SkPixelSerializer*);
 
+    /**
+     * With kCompactPaths_Flag, allow each path coordinate to move by up to tolerance. Defaults
+     * to 0, which writes paths exactly.
+     */
+    void setPathTolerance(SkScalar tolerance) { fPathTolerance = tolerance; }
+
 private:
     bool isValidating() const { return SkToBool(fFlags & kValidation_Flag); }
 
@@ -119,6 +127,7 @@ private:
     SkRefCntSet* fTFSet;
 
     SkAutoTUnref<SkPixelSerializer> fPixelSerializer;
+    SkScalar fPathTolerance;
 };
 
 #endif // SkWriteBuffer_DEFINED
@@ -43,6 +43,7 @@ class GrTextureParams;
 class GrVertexBuffer;
 class GrStrokeInfo;
 class GrSoftwarePathRenderer;
+class SkData;
 class SkGpuDevice;
 
 class SK_API GrContext : public SkRefCnt {
@@ -149,6 +150,14 @@ public:
      */
     void freeGpuResources();
 
+    /**
+     * Loads and links the programs stored under the given keys in
+     * GrContextOptions::fPersistentCache ahead of the draws that need them, so that those draws
+     * wait on neither the persistent cache nor the driver. The keys are the ones the context
+     * previously passed to PersistentCache::store(). Returns the number of programs linked.
+     */
+    int warmUpProgramCache(const SkData* const keys[], int count);
+
     /**
      * Purge all the unlocked resources from the cache.
      * This entry point is mainly meant for timing texture uploads
@@ -10,14 +10,37 @@
 
 #include "SkTypes.h"
 
+class SkData;
+
 struct GrContextOptions {
+    /**
+     * Abstract interface to a cache that outlives the GrContext, e.g. one backed by files on
+     * disk. The GPU backend uses it to save compiled programs so later processes can skip
+     * compiling them again. Both methods may be called at any time from the thread using the
+     * GrContext.
+     */
+    class PersistentCache {
+    public:
+        virtual ~PersistentCache() {}
+
+        /**
+         * Returns the data stored under key, or NULL if there is none. The caller takes a ref
+         * on the returned data.
+         */
+        virtual SkData* load(const SkData& key) = 0;
+
+        /** Stores data under key, replacing anything already stored there. */
+        virtual void store(const SkData& key, const SkData& data) = 0;
+    };
+
     GrContextOptions()
         : fDrawPathToCompressedTexture(false)
         , fSuppressPrints(false)
         , fMaxTextureSizeOverride(SK_MaxS32)
         , fMinTextureSizeOverride(0)
         , fSuppressDualSourceBlending(false)
-        , fGeometryBufferMapThreshold(-1) {}
+        , fGeometryBufferMapThreshold(-1)
+        , fPersistentCache(NULL) {}
 
     // EXPERIMENTAL
     // May be removed in the future, or may become standard depending
@@ -39,6 +62,10 @@ struct GrContextOptions {
         buffers to CPU memory in order to update them.  A value of -1 means the GrContext should
         deduce the optimal value for this platform. */
     int  fGeometryBufferMapThreshold;
+
+    /** If non-NULL, compiled programs are saved to and loaded from this cache. It is not owned by
+        the GrContext and must outlive it. */
+    PersistentCache* fPersistentCache;
 };
 
 #endif
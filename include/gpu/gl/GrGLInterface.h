@@ -217,6 +217,7 @@ public:
         GLPtr<GrGLGetQueryObjectui64vProc> fGetQueryObjectui64v;
         GLPtr<GrGLGetQueryObjectuivProc> fGetQueryObjectuiv;
         GLPtr<GrGLGetQueryivProc> fGetQueryiv;
+        GLPtr<GrGLGetProgramBinaryProc> fGetProgramBinary;
         GLPtr<GrGLGetProgramInfoLogProc> fGetProgramInfoLog;
         GLPtr<GrGLGetProgramivProc> fGetProgramiv;
         GLPtr<GrGLGetRenderbufferParameterivProc> fGetRenderbufferParameteriv;
@@ -240,6 +241,10 @@ public:
         GLPtr<GrGLMapBufferRangeProc> fMapBufferRange;
         GLPtr<GrGLMapBufferSubDataProc> fMapBufferSubData;
         GLPtr<GrGLMapTexSubImage2DProc> fMapTexSubImage2D;
+        // Optional, from GL 4.1, ARB_get_program_binary, ES 3.0 or OES_get_program_binary. Used to
+        // save and restore linked programs through GrContextOptions::fPersistentCache.
+        GLPtr<GrGLProgramBinaryProc> fProgramBinary;
+        GLPtr<GrGLProgramParameteriProc> fProgramParameteri;
         GLPtr<GrGLPixelStoreiProc> fPixelStorei;
         GLPtr<GrGLPopGroupMarkerProc> fPopGroupMarker;
         GLPtr<GrGLPushGroupMarkerProc> fPushGroupMarker;
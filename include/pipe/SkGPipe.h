@@ -15,6 +15,7 @@
 #include "SkWriter32.h"
 
 class SkCanvas;
+class SkPixelSerializer;
 
 // XLib.h might have defined Status already (ugh)
 #ifdef Status
@@ -87,6 +88,16 @@ public:
     virtual void notifyWritten(size_t bytes) = 0;
     virtual int numberOfReaders() const { return 1; }
 
+    /**
+     *  Only used when the writer flattens bitmaps (kCrossProcess_Flag without
+     *  kSharedAddressSpace_Flag). If this returns non-NULL, the serializer is
+     *  offered each bitmap's pixels before they are copied into the stream, so
+     *  the controller can send something smaller instead (e.g. a reference to
+     *  pixels the reader can already see). The reader's bitmap decoder must
+     *  understand whatever it sends.
+     */
+    virtual SkPixelSerializer* getPixelSerializer() { return NULL; }
+
     /**
      *  Release resource references that are held in internal caches.
      *  This must only be called after the pipe has been completely flushed.
@@ -23,6 +23,15 @@ public:
     static size_t ApproximateBytesUsed(const SkPicture* pict) {
         return pict->approximateBytesUsed();
     }
+
+    /**
+     *  Decodes the lazily generated bitmaps (e.g. those from an SkImageGenerator) that the
+     *  picture draws inside clip, which is in the picture's coordinates, concurrently on
+     *  SkTaskGroup's threads.  Their pixels are left in the discardable memory or cache backing
+     *  them, so drawing the picture with that clip soon after does not have to decode them on
+     *  the drawing thread.  Blocks until they are all decoded, and returns how many there were.
+     */
+    static int PrerollBitmaps(const SkPicture* pict, const SkRect& clip);
 };
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkIncrementalCodec.h"
+#include "SkIncrementalCodecPriv.h"
+#include "SkRWBuffer.h"
+
+// Enough for the longest signature, "GIF89a".
+#define kSignatureBytes 6
+
+SkIncrementalCodec* SkIncrementalCodec::NewFromBuffer(const SkROBuffer* buffer) {
+    uint8_t sig[kSignatureBytes];
+    size_t count = 0;
+    SkROBuffer::Iter iter(buffer);
+    do {
+        const size_t n = SkTMin(iter.size(), sizeof(sig) - count);
+        if (n > 0) {
+            memcpy(sig + count, iter.data(), n);
+        }
+        count += n;
+    } while (count < sizeof(sig) && iter.next());
+    if (count < sizeof(sig)) {
+        return NULL;
+    }
+
+    static const uint8_t kPngSig[] = { 0x89, 'P', 'N', 'G' };
+    static const uint8_t kJpegSig[] = { 0xFF, 0xD8, 0xFF };
+    if (!memcmp(sig, kPngSig, sizeof(kPngSig))) {
+        return SkNewIncrementalPngCodec();
+    }
+    if (!memcmp(sig, kJpegSig, sizeof(kJpegSig))) {
+        return SkNewIncrementalJpegCodec();
+    }
+    if (!memcmp(sig, "GIF87a", 6) || !memcmp(sig, "GIF89a", 6)) {
+        return SkNewIncrementalGifCodec();
+    }
+    return NULL;
+}
+
+SkIncrementalCodec::Result SkIncrementalCodec::update(const SkROBuffer* buffer) {
+    if (kIncomplete_Result != fResult) {
+        return fResult;
+    }
+    if (buffer->size() < fBytesDecoded) {
+        // Not a newer snapshot of the same buffer.
+        return fResult = kError_Result;
+    }
+
+    size_t skip = fBytesDecoded;
+    SkROBuffer::Iter iter(buffer);
+    do {
+        size_t size = iter.size();
+        if (skip >= size) {
+            skip -= size;
+            continue;
+        }
+        const char* data = (const char*)iter.data() + skip;
+        size -= skip;
+        skip = 0;
+        fBytesDecoded += size;
+        fResult = this->onAppend(data, size);
+    } while (kIncomplete_Result == fResult && iter.next());
+
+    if (fPixelsChanged) {
+        fBitmap.notifyPixelsChanged();
+        fPixelsChanged = false;
+    }
+    return fResult;
+}
+
+bool SkIncrementalCodec::allocPixels(int width, int height, SkAlphaType alphaType) {
+    SkASSERT(fBitmap.isNull());
+    if (width <= 0 || height <= 0 ||
+            !fBitmap.tryAllocPixels(SkImageInfo::MakeN32(width, height, alphaType))) {
+        fBitmap.reset();
+        return false;
+    }
+    fBitmap.eraseColor(kOpaque_SkAlphaType == alphaType ? SK_ColorBLACK : SK_ColorTRANSPARENT);
+    return true;
+}
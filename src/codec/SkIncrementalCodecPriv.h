@@ -0,0 +1,19 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkIncrementalCodecPriv_DEFINED
+#define SkIncrementalCodecPriv_DEFINED
+
+class SkIncrementalCodec;
+
+// The format specific codecs, for SkIncrementalCodec::NewFromBuffer() to pick from. Each
+// returns NULL if its library can't be set up.
+SkIncrementalCodec* SkNewIncrementalPngCodec();
+SkIncrementalCodec* SkNewIncrementalJpegCodec();
+SkIncrementalCodec* SkNewIncrementalGifCodec();
+
+#endif  // SkIncrementalCodecPriv_DEFINED
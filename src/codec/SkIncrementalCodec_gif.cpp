@@ -0,0 +1,367 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCodecPriv.h"
+#include "SkColorPriv.h"
+#include "SkGifInterlaceIter.h"
+#include "SkIncrementalCodec.h"
+#include "SkIncrementalCodecPriv.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+// The largest code in GIF's LZW.
+#define kMaxCodes           4096
+#define kNoTransparentIndex -1
+
+/*
+ *  giflib can only pull its data from a reader that must supply it, so this parses the GIF
+ *  itself: it keeps the bytes it can't use yet, and a state machine for where it is in the
+ *  file, so that it can stop at the end of any chunk and resume with the next. The LZW decoder
+ *  likewise keeps its bit buffer and code table between chunks.
+ *
+ *  Only the first frame is decoded.
+ */
+class SkIncrementalGifCodec : public SkIncrementalCodec {
+public:
+    SkIncrementalGifCodec()
+        : fState(kHeader_State)
+        , fNeeded(13)
+        , fExtensionLabel(0)
+        , fTransparentIndex(kNoTransparentIndex)
+        , fScreenWidth(0)
+        , fScreenHeight(0)
+        , fFrameLeft(0)
+        , fFrameTop(0)
+        , fFrameWidth(0)
+        , fFrameHeight(0)
+        , fRowsOut(0)
+        , fX(0) {
+        sk_bzero(fGlobalColors, sizeof(fGlobalColors));
+        sk_bzero(fColors, sizeof(fColors));
+    }
+
+protected:
+    SkEncodedFormat onGetEncodedFormat() const override { return kGIF_SkEncodedFormat; }
+
+    Result onAppend(const void* data, size_t length) override {
+        fPending.append(SkToInt(length), (const uint8_t*)data);
+
+        const uint8_t* p = fPending.begin();
+        const uint8_t* stop = fPending.end();
+        Result result = kIncomplete_Result;
+        while (kIncomplete_Result == result) {
+            if (kImageSubBlock_State == fState) {
+                // LZW data is used as it arrives, rather than a sub-block at a time.
+                const size_t n = SkTMin(fNeeded, (size_t)(stop - p));
+                if (0 == n) {
+                    break;
+                }
+                result = this->decodeLZW(p, n);
+                p += n;
+                fNeeded -= n;
+                if (0 == fNeeded) {
+                    fState = kImageSubBlockSize_State;
+                    fNeeded = 1;
+                }
+                continue;
+            }
+            if ((size_t)(stop - p) < fNeeded) {
+                break;
+            }
+            const size_t used = fNeeded;
+            result = this->parse(p);
+            p += used;
+        }
+
+        fPending.remove(0, SkToInt(p - fPending.begin()));
+        return result;
+    }
+
+private:
+    enum State {
+        kHeader_State,
+        kGlobalColors_State,
+        kBlockStart_State,
+        kExtensionLabel_State,
+        kExtensionSubBlockSize_State,
+        kExtensionSubBlock_State,
+        kImageDescriptor_State,
+        kLocalColors_State,
+        kLZWCodeSize_State,
+        kImageSubBlockSize_State,
+        kImageSubBlock_State,
+    };
+
+    static uint16_t Get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+    static void ReadColors(const uint8_t* p, int count, SkPMColor colors[256]) {
+        for (int i = 0; i < count; ++i) {
+            colors[i] = SkPackARGB32NoCheck(0xFF, p[0], p[1], p[2]);
+            p += 3;
+        }
+    }
+
+    // Handle the fNeeded bytes at p, and set fState and fNeeded to what comes next.
+    Result parse(const uint8_t* p) {
+        switch (fState) {
+            case kHeader_State:
+                fScreenWidth = Get16(p + 6);
+                fScreenHeight = Get16(p + 8);
+                if (p[10] & 0x80) {
+                    fState = kGlobalColors_State;
+                    fNeeded = 3 * (2 << (p[10] & 7));
+                } else {
+                    fState = kBlockStart_State;
+                    fNeeded = 1;
+                }
+                break;
+            case kGlobalColors_State:
+                ReadColors(p, SkToInt(fNeeded / 3), fGlobalColors);
+                fState = kBlockStart_State;
+                fNeeded = 1;
+                break;
+            case kBlockStart_State:
+                switch (p[0]) {
+                    case 0x21:
+                        fState = kExtensionLabel_State;
+                        fNeeded = 1;
+                        break;
+                    case 0x2C:
+                        fState = kImageDescriptor_State;
+                        fNeeded = 9;
+                        break;
+                    default:
+                        // A trailer (0x3B) with no frame, or garbage.
+                        SkCodecPrintf("Error: no image in gif\n");
+                        return kError_Result;
+                }
+                break;
+            case kExtensionLabel_State:
+                fExtensionLabel = p[0];
+                fState = kExtensionSubBlockSize_State;
+                fNeeded = 1;
+                break;
+            case kExtensionSubBlockSize_State:
+                if (0 == p[0]) {
+                    fState = kBlockStart_State;
+                    fNeeded = 1;
+                } else {
+                    fState = kExtensionSubBlock_State;
+                    fNeeded = p[0];
+                }
+                break;
+            case kExtensionSubBlock_State:
+                // Of the extensions, only the graphics control extension matters to us.
+                if (0xF9 == fExtensionLabel && fNeeded >= 4) {
+                    fTransparentIndex = (p[0] & 1) ? p[3] : kNoTransparentIndex;
+                }
+                fState = kExtensionSubBlockSize_State;
+                fNeeded = 1;
+                break;
+            case kImageDescriptor_State: {
+                fFrameLeft = Get16(p);
+                fFrameTop = Get16(p + 2);
+                fFrameWidth = Get16(p + 4);
+                fFrameHeight = Get16(p + 6);
+                if (0 == fScreenWidth || 0 == fScreenHeight) {
+                    fScreenWidth = fFrameLeft + fFrameWidth;
+                    fScreenHeight = fFrameTop + fFrameHeight;
+                }
+                if (0 == fFrameWidth || 0 == fFrameHeight ||
+                        !this->allocPixels(fScreenWidth, fScreenHeight, kPremul_SkAlphaType)) {
+                    return kError_Result;
+                }
+                fRow.reset(fFrameWidth);
+                if (p[8] & 0x40) {
+                    fInterlaceIter.reset(SkNEW_ARGS(SkGifInterlaceIter, (fFrameHeight)));
+                }
+                memcpy(fColors, fGlobalColors, sizeof(fColors));
+                if (p[8] & 0x80) {
+                    fState = kLocalColors_State;
+                    fNeeded = 3 * (2 << (p[8] & 7));
+                } else {
+                    fState = kLZWCodeSize_State;
+                    fNeeded = 1;
+                }
+                break;
+            }
+            case kLocalColors_State:
+                sk_bzero(fColors, sizeof(fColors));
+                ReadColors(p, SkToInt(fNeeded / 3), fColors);
+                fState = kLZWCodeSize_State;
+                fNeeded = 1;
+                break;
+            case kLZWCodeSize_State:
+                // Codes below the clear code are palette indices, so they have to fit in a byte.
+                if (p[0] < 1 || p[0] > 8) {
+                    SkCodecPrintf("Error: invalid LZW code size in gif\n");
+                    return kError_Result;
+                }
+                fLZW.init(p[0]);
+                fState = kImageSubBlockSize_State;
+                fNeeded = 1;
+                break;
+            case kImageSubBlockSize_State:
+                if (0 == p[0]) {
+                    // The frame's data ended early; what was decoded is all there is.
+                    return kComplete_Result;
+                }
+                fState = kImageSubBlock_State;
+                fNeeded = p[0];
+                break;
+            case kImageSubBlock_State:
+                SkASSERT(false);
+                break;
+        }
+        return kIncomplete_Result;
+    }
+
+    Result decodeLZW(const uint8_t* p, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            fLZW.fBits |= p[i] << fLZW.fBitCount;
+            fLZW.fBitCount += 8;
+            while (fLZW.fBitCount >= fLZW.fCodeSize) {
+                int code = fLZW.fBits & fLZW.fCodeMask;
+                fLZW.fBits >>= fLZW.fCodeSize;
+                fLZW.fBitCount -= fLZW.fCodeSize;
+
+                if (code == fLZW.fClearCode) {
+                    fLZW.clear();
+                    continue;
+                }
+                if (code == fLZW.fClearCode + 1) {
+                    // The end code.
+                    return kComplete_Result;
+                }
+                if (fLZW.fOldCode < 0) {
+                    if (code > fLZW.fClearCode) {
+                        return kError_Result;
+                    }
+                    fLZW.fFirstChar = SkToU8(code);
+                    fLZW.fOldCode = code;
+                    if (this->writeIndex(SkToU8(code))) {
+                        return kComplete_Result;
+                    }
+                    continue;
+                }
+
+                const int inCode = code;
+                uint8_t* sp = fLZW.fStack;
+                if (code >= fLZW.fNextCode) {
+                    if (code > fLZW.fNextCode) {
+                        return kError_Result;
+                    }
+                    *sp++ = fLZW.fFirstChar;
+                    code = fLZW.fOldCode;
+                }
+                while (code > fLZW.fClearCode) {
+                    *sp++ = fLZW.fSuffix[code];
+                    code = fLZW.fPrefix[code];
+                }
+                fLZW.fFirstChar = SkToU8(code);
+                *sp++ = fLZW.fFirstChar;
+
+                if (fLZW.fNextCode < kMaxCodes) {
+                    fLZW.fPrefix[fLZW.fNextCode] = SkToU16(fLZW.fOldCode);
+                    fLZW.fSuffix[fLZW.fNextCode] = fLZW.fFirstChar;
+                    ++fLZW.fNextCode;
+                    if (fLZW.fNextCode > fLZW.fCodeMask && fLZW.fCodeSize < 12) {
+                        ++fLZW.fCodeSize;
+                        fLZW.fCodeMask = (1 << fLZW.fCodeSize) - 1;
+                    }
+                }
+                fLZW.fOldCode = inCode;
+
+                while (sp > fLZW.fStack) {
+                    if (this->writeIndex(*--sp)) {
+                        return kComplete_Result;
+                    }
+                }
+            }
+        }
+        return kIncomplete_Result;
+    }
+
+    // Returns true once the last row of the frame is written.
+    bool writeIndex(uint8_t index) {
+        fRow[fX++] = index;
+        if (fX < fFrameWidth) {
+            return false;
+        }
+        fX = 0;
+
+        const int y = fFrameTop + (fInterlaceIter.get() ? fInterlaceIter->nextY() : fRowsOut);
+        if (y < fScreenHeight) {
+            SkPMColor* dst = this->getAddr(y);
+            const int width = SkTMin(fFrameWidth, fScreenWidth - fFrameLeft);
+            for (int x = 0; x < width; ++x) {
+                if (fRow[x] != fTransparentIndex) {
+                    dst[fFrameLeft + x] = fColors[fRow[x]];
+                }
+            }
+            this->setRowsDecoded(y + 1);
+        }
+        return ++fRowsOut == fFrameHeight;
+    }
+
+    struct LZW {
+        void init(int minCodeSize) {
+            fMinCodeSize = minCodeSize;
+            fClearCode = 1 << minCodeSize;
+            fBits = 0;
+            fBitCount = 0;
+            for (int i = 0; i < fClearCode; ++i) {
+                fPrefix[i] = 0;
+                fSuffix[i] = SkToU8(i);
+            }
+            this->clear();
+        }
+
+        void clear() {
+            fCodeSize = fMinCodeSize + 1;
+            fCodeMask = (1 << fCodeSize) - 1;
+            fNextCode = fClearCode + 2;
+            fOldCode = -1;
+        }
+
+        int         fMinCodeSize;
+        int         fClearCode;
+        int         fCodeSize;
+        int         fCodeMask;
+        int         fNextCode;
+        int         fOldCode;
+        uint8_t     fFirstChar;
+        uint32_t    fBits;
+        int         fBitCount;
+        uint16_t    fPrefix[kMaxCodes];
+        uint8_t     fSuffix[kMaxCodes];
+        uint8_t     fStack[kMaxCodes + 1];
+    };
+
+    SkTDArray<uint8_t>                  fPending;   // bytes received but not yet used
+    State                               fState;
+    size_t                              fNeeded;    // bytes needed for the current state
+    uint8_t                             fExtensionLabel;
+    int                                 fTransparentIndex;
+    int                                 fScreenWidth;
+    int                                 fScreenHeight;
+    int                                 fFrameLeft;
+    int                                 fFrameTop;
+    int                                 fFrameWidth;
+    int                                 fFrameHeight;
+    int                                 fRowsOut;
+    int                                 fX;
+    SkAutoTDelete<SkGifInterlaceIter>   fInterlaceIter;
+    SkAutoTMalloc<uint8_t>              fRow;
+    SkPMColor                           fGlobalColors[256];
+    SkPMColor                           fColors[256];
+    LZW                                 fLZW;
+};
+
+SkIncrementalCodec* SkNewIncrementalGifCodec() {
+    return SkNEW(SkIncrementalGifCodec);
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCodecPriv.h"
+#include "SkColorPriv.h"
+#include "SkIncrementalCodec.h"
+#include "SkIncrementalCodecPriv.h"
+#include "SkJpegUtility.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+static void sk_inc_jpeg_output_message(j_common_ptr info) {
+    char buffer[JMSG_LENGTH_MAX];
+    info->err->format_message(info, buffer);
+    SkCodecPrintf("libjpeg error %d <%s>\n", info->err->msg_code, buffer);
+}
+
+static void sk_inc_jpeg_emit_message(j_common_ptr, int) {}
+
+/*
+ *  A source manager for libjpeg's suspending mode: it holds the bytes libjpeg has not used
+ *  yet, and when libjpeg wants more than that, reports that none are available, which makes
+ *  the libjpeg call return early. libjpeg backs up to where it can start again, so the same
+ *  call is made again once more data has been appended.
+ */
+struct sk_inc_jpeg_source_mgr : jpeg_source_mgr {
+    sk_inc_jpeg_source_mgr() : fSkip(0) {
+        init_source = sk_init_source;
+        fill_input_buffer = sk_fill_input_buffer;
+        skip_input_data = sk_skip_input_data;
+        resync_to_restart = jpeg_resync_to_restart;
+        term_source = sk_term_source;
+        next_input_byte = NULL;
+        bytes_in_buffer = 0;
+    }
+
+    void append(const void* data, size_t length) {
+        // Drop what libjpeg is done with.
+        fData.remove(0, fData.count() - SkToInt(bytes_in_buffer));
+
+        const size_t skip = SkTMin(fSkip, length);
+        fSkip -= skip;
+        fData.append(SkToInt(length - skip), (const uint8_t*)data + skip);
+
+        next_input_byte = fData.begin();
+        bytes_in_buffer = fData.count();
+    }
+
+    static void sk_init_source(j_decompress_ptr) {}
+    static void sk_term_source(j_decompress_ptr) {}
+
+    static boolean sk_fill_input_buffer(j_decompress_ptr) {
+        return FALSE;
+    }
+
+    static void sk_skip_input_data(j_decompress_ptr dinfo, long numBytes) {
+        if (numBytes <= 0) {
+            return;
+        }
+        sk_inc_jpeg_source_mgr* src = (sk_inc_jpeg_source_mgr*)dinfo->src;
+        if ((size_t)numBytes > src->bytes_in_buffer) {
+            // Skip the rest when it arrives.
+            src->fSkip += numBytes - src->bytes_in_buffer;
+            numBytes = src->bytes_in_buffer;
+        }
+        src->next_input_byte += numBytes;
+        src->bytes_in_buffer -= numBytes;
+    }
+
+    SkTDArray<uint8_t>  fData;
+    size_t              fSkip;
+};
+
+/*
+ *  Baseline images are decoded a row at a time, as the data for each row arrives. Progressive
+ *  images use libjpeg's buffered image mode: the coefficients of every scan are accumulated as
+ *  they arrive, and each time another scan is complete, the whole image is output again in
+ *  more detail.
+ */
+class SkIncrementalJpegCodec : public SkIncrementalCodec {
+public:
+    SkIncrementalJpegCodec()
+        : fState(kHeader_State)
+        , fOutputScan(0)
+        , fLastCompletedScan(0) {
+        fDInfo.err = jpeg_std_error(&fErrorMgr);
+        fErrorMgr.error_exit = skjpeg_err_exit;
+        fErrorMgr.output_message = sk_inc_jpeg_output_message;
+        fErrorMgr.emit_message = sk_inc_jpeg_emit_message;
+        jpeg_create_decompress(&fDInfo);
+        fDInfo.src = &fSrcMgr;
+    }
+
+    ~SkIncrementalJpegCodec() override {
+        jpeg_destroy_decompress(&fDInfo);
+    }
+
+protected:
+    SkEncodedFormat onGetEncodedFormat() const override { return kJPEG_SkEncodedFormat; }
+
+    Result onAppend(const void* data, size_t length) override {
+        if (setjmp(fErrorMgr.fJmpBuf)) {
+            return kError_Result;
+        }
+        fSrcMgr.append(data, length);
+        return this->decode();
+    }
+
+private:
+    enum State {
+        kHeader_State,
+        kStart_State,
+        kScanlines_State,       // baseline: reading the rows
+        kConsume_State,         // progressive: accumulating scans
+        kOutput_State,          // progressive: outputting the rows for fOutputScan
+        kFinishOutput_State,    // progressive: done outputting fOutputScan
+        kFinish_State,
+        kDone_State,
+    };
+
+    Result decode() {
+        for (;;) {
+            switch (fState) {
+                case kHeader_State:
+                    if (JPEG_SUSPENDED == jpeg_read_header(&fDInfo, TRUE)) {
+                        return kIncomplete_Result;
+                    }
+                    if (!this->onHeader()) {
+                        return kError_Result;
+                    }
+                    fState = kStart_State;
+                    break;
+                case kStart_State:
+                    if (!jpeg_start_decompress(&fDInfo)) {
+                        return kIncomplete_Result;
+                    }
+                    fRow.reset(fDInfo.output_width * fDInfo.output_components);
+                    fState = fDInfo.buffered_image ? kConsume_State : kScanlines_State;
+                    break;
+                case kScanlines_State:
+                    if (!this->readScanlines()) {
+                        return kIncomplete_Result;
+                    }
+                    fState = kFinish_State;
+                    break;
+                case kConsume_State:
+                    while (!jpeg_input_complete(&fDInfo)) {
+                        const int status = jpeg_consume_input(&fDInfo);
+                        if (JPEG_SUSPENDED == status) {
+                            break;
+                        }
+                        if (JPEG_SCAN_COMPLETED == status) {
+                            fLastCompletedScan = fDInfo.input_scan_number;
+                        }
+                    }
+                    if (jpeg_input_complete(&fDInfo)) {
+                        fLastCompletedScan = fDInfo.input_scan_number;
+                    }
+                    if (fLastCompletedScan > fOutputScan) {
+                        // Only output complete scans, so that outputting never waits on input.
+                        fOutputScan = fLastCompletedScan;
+                        jpeg_start_output(&fDInfo, fOutputScan);
+                        fState = kOutput_State;
+                    } else if (jpeg_input_complete(&fDInfo)) {
+                        fState = kFinish_State;
+                    } else {
+                        return kIncomplete_Result;
+                    }
+                    break;
+                case kOutput_State:
+                    if (!this->readScanlines()) {
+                        return kIncomplete_Result;
+                    }
+                    fState = kFinishOutput_State;
+                    break;
+                case kFinishOutput_State:
+                    // This reads ahead to the next scan's header.
+                    if (!jpeg_finish_output(&fDInfo)) {
+                        return kIncomplete_Result;
+                    }
+                    fState = kConsume_State;
+                    break;
+                case kFinish_State:
+                    if (!jpeg_finish_decompress(&fDInfo)) {
+                        return kIncomplete_Result;
+                    }
+                    fState = kDone_State;
+                    break;
+                case kDone_State:
+                    return kComplete_Result;
+            }
+        }
+    }
+
+    bool onHeader() {
+        switch (fDInfo.jpeg_color_space) {
+            case JCS_CMYK:
+            case JCS_YCCK:
+                // libjpeg cannot convert from CMYK or YCCK to RGB.
+                fDInfo.out_color_space = JCS_CMYK;
+                break;
+            case JCS_GRAYSCALE:
+                fDInfo.out_color_space = JCS_GRAYSCALE;
+                break;
+            default:
+                fDInfo.out_color_space = JCS_RGB;
+                break;
+        }
+        fDInfo.buffered_image = jpeg_has_multiple_scans(&fDInfo);
+        jpeg_calc_output_dimensions(&fDInfo);
+        return this->allocPixels(fDInfo.output_width, fDInfo.output_height,
+                                 kOpaque_SkAlphaType);
+    }
+
+    // Returns false if it ran out of data before the last row.
+    bool readScanlines() {
+        while (fDInfo.output_scanline < fDInfo.output_height) {
+            const int y = fDInfo.output_scanline;
+            JSAMPLE* rowPtr = fRow.get();
+            if (1 != jpeg_read_scanlines(&fDInfo, &rowPtr, 1)) {
+                return false;
+            }
+            this->convertRow(this->getAddr(y));
+            this->setRowsDecoded(y + 1);
+        }
+        return true;
+    }
+
+    void convertRow(SkPMColor* dst) const {
+        const uint8_t* src = fRow.get();
+        const int width = fDInfo.output_width;
+        switch (fDInfo.out_color_space) {
+            case JCS_GRAYSCALE:
+                for (int x = 0; x < width; ++x) {
+                    dst[x] = SkPackARGB32NoCheck(0xFF, src[x], src[x], src[x]);
+                }
+                break;
+            case JCS_CMYK:
+                // libjpeg gives us inverted CMYK, so R = C * K, and so on.
+                for (int x = 0; x < width; ++x) {
+                    const uint8_t k = src[3];
+                    dst[x] = SkPackARGB32NoCheck(0xFF, SkMulDiv255Round(src[0], k),
+                                                       SkMulDiv255Round(src[1], k),
+                                                       SkMulDiv255Round(src[2], k));
+                    src += 4;
+                }
+                break;
+            default:
+                for (int x = 0; x < width; ++x) {
+                    dst[x] = SkPackARGB32NoCheck(0xFF, src[0], src[1], src[2]);
+                    src += 3;
+                }
+                break;
+        }
+    }
+
+    jpeg_decompress_struct      fDInfo;
+    skjpeg_error_mgr            fErrorMgr;
+    sk_inc_jpeg_source_mgr      fSrcMgr;
+    SkAutoTMalloc<JSAMPLE>      fRow;
+    State                       fState;
+    int                         fOutputScan;
+    int                         fLastCompletedScan;
+};
+
+SkIncrementalCodec* SkNewIncrementalJpegCodec() {
+    return SkNEW(SkIncrementalJpegCodec);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCodecPriv.h"
+#include "SkColorPriv.h"
+#include "SkIncrementalCodec.h"
+#include "SkIncrementalCodecPriv.h"
+#include "SkTemplates.h"
+
+#ifdef SKIA_PNG_PREFIXED
+    // this must proceed png.h
+    #include "pngprefix.h"
+#endif
+#include "png.h"
+
+#ifndef png_jmpbuf
+#  define png_jmpbuf(png_ptr) ((png_ptr)->jmpbuf)
+#endif
+
+#ifndef png_infopp_NULL
+    #define png_infopp_NULL NULL
+#endif
+
+#ifndef int_p_NULL
+    #define int_p_NULL NULL
+#endif
+
+static void sk_inc_png_error_fn(png_structp png_ptr, png_const_charp msg) {
+    SkCodecPrintf("------ png error %s\n", msg);
+    longjmp(png_jmpbuf(png_ptr), 1);
+}
+
+static void sk_inc_png_warning_fn(png_structp, png_const_charp msg) {
+    SkCodecPrintf("----- png warning %s\n", msg);
+}
+
+/*
+ *  Pushes the data through libpng's progressive reader, which calls back with each row as it
+ *  is decoded. libpng expands every format to 8 bit RGBA for us. Interlaced images keep the
+ *  whole RGBA image, which libpng combines each pass's pixels into.
+ */
+class SkIncrementalPngCodec : public SkIncrementalCodec {
+public:
+    SkIncrementalPngCodec(png_structp png_ptr, png_infop info_ptr)
+        : fPng(png_ptr)
+        , fInfo(info_ptr)
+        , fInterlaced(false)
+        , fDone(false) {
+        png_set_progressive_read_fn(fPng, this, InfoCallback, RowCallback, EndCallback);
+    }
+
+    ~SkIncrementalPngCodec() override {
+        png_destroy_read_struct(&fPng, &fInfo, png_infopp_NULL);
+    }
+
+protected:
+    SkEncodedFormat onGetEncodedFormat() const override { return kPNG_SkEncodedFormat; }
+
+    Result onAppend(const void* data, size_t length) override {
+        if (setjmp(png_jmpbuf(fPng))) {
+            return kError_Result;
+        }
+        png_process_data(fPng, fInfo, (png_bytep)data, length);
+        return fDone ? kComplete_Result : kIncomplete_Result;
+    }
+
+private:
+    static SkIncrementalPngCodec* Get(png_structp png_ptr) {
+        return (SkIncrementalPngCodec*)png_get_progressive_ptr(png_ptr);
+    }
+
+    static void InfoCallback(png_structp png_ptr, png_infop info_ptr) {
+        SkIncrementalPngCodec* codec = Get(png_ptr);
+
+        png_uint_32 width, height;
+        int bitDepth, colorType, interlaceType;
+        png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &colorType, &interlaceType,
+                     int_p_NULL, int_p_NULL);
+
+        const bool hasAlpha = SkToBool(colorType & PNG_COLOR_MASK_ALPHA) ||
+                              png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+        png_set_expand(png_ptr);
+        if (16 == bitDepth) {
+            png_set_strip_16(png_ptr);
+        }
+        if (!(colorType & PNG_COLOR_MASK_COLOR)) {
+            png_set_gray_to_rgb(png_ptr);
+        }
+        if (!hasAlpha) {
+            png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+        }
+        codec->fInterlaced = png_set_interlace_handling(png_ptr) > 1;
+        png_read_update_info(png_ptr, info_ptr);
+
+        if (width > 0x7FFFFFFF / 4 || height > 0x7FFFFFFF ||
+                !codec->allocPixels(width, height,
+                                    hasAlpha ? kPremul_SkAlphaType : kOpaque_SkAlphaType)) {
+            png_error(png_ptr, "could not allocate pixels");
+        }
+        if (codec->fInterlaced) {
+            codec->fRGBA.reset(width * height * 4);
+            sk_bzero(codec->fRGBA.get(), width * height * 4);
+        }
+    }
+
+    static void RowCallback(png_structp png_ptr, png_bytep newRow, png_uint_32 rowNum, int) {
+        SkIncrementalPngCodec* codec = Get(png_ptr);
+        const SkBitmap& bm = codec->bitmap();
+        if (NULL == newRow || rowNum >= (png_uint_32)bm.height()) {
+            // No new pixels for this row in this pass.
+            return;
+        }
+
+        const uint8_t* src = newRow;
+        if (codec->fInterlaced) {
+            png_bytep row = codec->fRGBA.get() + rowNum * bm.width() * 4;
+            png_progressive_combine_row(png_ptr, row, newRow);
+            src = row;
+        }
+        SkPMColor* dst = codec->getAddr(rowNum);
+        for (int x = 0; x < bm.width(); ++x) {
+            dst[x] = SkPreMultiplyARGB(src[3], src[0], src[1], src[2]);
+            src += 4;
+        }
+        codec->setRowsDecoded(rowNum + 1);
+    }
+
+    static void EndCallback(png_structp png_ptr, png_infop) {
+        Get(png_ptr)->fDone = true;
+    }
+
+    png_structp             fPng;
+    png_infop               fInfo;
+    SkAutoTMalloc<uint8_t>  fRGBA;      // the whole image, for interlaced images only
+    bool                    fInterlaced;
+    bool                    fDone;
+};
+
+SkIncrementalCodec* SkNewIncrementalPngCodec() {
+    png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL,
+                                                 sk_inc_png_error_fn, sk_inc_png_warning_fn);
+    if (NULL == png_ptr) {
+        return NULL;
+    }
+    png_infop info_ptr = png_create_info_struct(png_ptr);
+    if (NULL == info_ptr) {
+        png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
+        return NULL;
+    }
+    return SkNEW_ARGS(SkIncrementalPngCodec, (png_ptr, info_ptr));
+}
@@ -10,6 +10,7 @@
 #include "SkBlitter.h"
 #include "SkColorPriv.h"
 #include "SkPath.h"
+#include "Sk4px.h"
 #include "SkScan.h"
 #include "SkThread.h"
 #include "SkUtils.h"
@@ -1583,6 +1584,65 @@ static void operatorX(SkAAClip::Builder& builder, int lastY,
     }
 }
 
+/*
+ *  Returns true if row (laid out across rowBounds) has a single alpha value over
+ *  [bounds.fLeft, bounds.fRight), returning it in *alpha. Columns outside of rowBounds, and a
+ *  NULL row, count as 0. This is the common case for the interior rows of rect-ish clips.
+ */
+static bool row_is_uniform(const uint8_t* row, const SkIRect& rowBounds, const SkIRect& bounds,
+                           U8CPU* alpha) {
+    if (NULL == row) {
+        *alpha = 0;
+        return true;
+    }
+
+    bool found = bounds.fLeft < rowBounds.fLeft || bounds.fRight > rowBounds.fRight;
+    U8CPU a = 0;
+    int x = rowBounds.fLeft;
+    while (x < rowBounds.fRight && x < bounds.fRight) {
+        x += row[0];
+        if (x > bounds.fLeft) {
+            if (!found) {
+                a = row[1];
+                found = true;
+            } else if (row[1] != a) {
+                return false;
+            }
+        }
+        row += 2;
+    }
+    *alpha = a;
+    return true;
+}
+
+/*
+ *  operatorX() for when one of the rows is uniform: only the other row needs to be walked.
+ */
+static void operatorUniformX(SkAAClip::Builder& builder, int lastY, U8CPU uniformAlpha,
+                             bool uniformIsA, RowIter& iter, AlphaProc proc,
+                             const SkIRect& bounds) {
+    int prevRite = bounds.fLeft;
+    for (; !iter.done() && iter.left() < bounds.fRight; iter.next()) {
+        int rite = SkMin32(iter.right(), bounds.fRight);
+        if (rite <= bounds.fLeft) {
+            continue;
+        }
+        int left = SkMax32(iter.left(), bounds.fLeft);
+        if (left > prevRite) {
+            U8CPU alpha = uniformIsA ? proc(uniformAlpha, 0) : proc(0, uniformAlpha);
+            builder.addRun(prevRite, lastY, alpha, left - prevRite);
+        }
+        U8CPU alpha = uniformIsA ? proc(uniformAlpha, iter.alpha())
+                                 : proc(iter.alpha(), uniformAlpha);
+        builder.addRun(left, lastY, alpha, rite - left);
+        prevRite = rite;
+    }
+    if (prevRite < bounds.fRight) {
+        U8CPU alpha = uniformIsA ? proc(uniformAlpha, 0) : proc(0, uniformAlpha);
+        builder.addRun(prevRite, lastY, alpha, bounds.fRight - prevRite);
+    }
+}
+
 static void adjust_iter(SkAAClip::Iter& iter, int& topA, int& botA, int bot) {
     if (bot == botA) {
         iter.next();
@@ -1649,9 +1709,22 @@ static void operateY(SkAAClip::Builder& builder, const SkAAClip& A,
             builder.addRun(bounds.fLeft, bot - 1, 0, bounds.width());
         } else if (top >= bounds.fTop) {
             SkASSERT(bot <= bounds.fBottom);
-            RowIter rowIterA(rowA, rowA ? A.getBounds() : bounds);
-            RowIter rowIterB(rowB, rowB ? B.getBounds() : bounds);
-            operatorX(builder, bot - 1, rowIterA, rowIterB, proc, bounds);
+            U8CPU alphaA, alphaB;
+            bool uniformA = row_is_uniform(rowA, A.getBounds(), bounds, &alphaA);
+            bool uniformB = row_is_uniform(rowB, B.getBounds(), bounds, &alphaB);
+            if (uniformA && uniformB) {
+                builder.addRun(bounds.fLeft, bot - 1, proc(alphaA, alphaB), bounds.width());
+            } else if (uniformA) {
+                RowIter rowIterB(rowB, B.getBounds());
+                operatorUniformX(builder, bot - 1, alphaA, true, rowIterB, proc, bounds);
+            } else if (uniformB) {
+                RowIter rowIterA(rowA, A.getBounds());
+                operatorUniformX(builder, bot - 1, alphaB, false, rowIterA, proc, bounds);
+            } else {
+                RowIter rowIterA(rowA, A.getBounds());
+                RowIter rowIterB(rowB, B.getBounds());
+                operatorX(builder, bot - 1, rowIterA, rowIterB, proc, bounds);
+            }
         }
 
         adjust_iter(iterA, topA, botA, bot);
@@ -2035,6 +2108,10 @@ void SkAAClipBlitter::blitRect(int x, int y, int width, int height) {
 typedef void (*MergeAAProc)(const void* src, int width, const uint8_t* row,
                             int initialRowCount, void* dst);
 
+// Opaque or empty clip runs at least this wide are blitted (or skipped) for a whole band of rows
+// in blitMask(), rather than merged into the mask one row at a time.
+static const int kMinSolidSpanWidth = 16;
+
 static void small_memcpy(void* dst, const void* src, size_t n) {
     memcpy(dst, src, n);
 }
@@ -2056,6 +2133,30 @@ static inline uint16_t mergeOne(uint16_t value, unsigned alpha) {
                        SkMulDiv255Round(b, alpha));
 }
 
+static inline void mergeSpan(const uint16_t* SK_RESTRICT src, int n, unsigned alpha,
+                             uint16_t* SK_RESTRICT dst) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = mergeOne(src[i], alpha);
+    }
+}
+
+// A8 coverage is scaled 16 pixels at a time. mulWiden().div255RoundNarrow() rounds exactly like
+// SkMulDiv255Round, so this matches the scalar mergeOne() bit for bit.
+static inline void mergeSpan(const uint8_t* SK_RESTRICT src, int n, unsigned alpha,
+                             uint8_t* SK_RESTRICT dst) {
+    const Sk16b scale((uint8_t)alpha);
+    while (n >= 16) {
+        Sk4px::Load4((const SkPMColor*)src).mulWiden(scale).div255RoundNarrow()
+                                           .store4((SkPMColor*)dst);
+        src += 16;
+        dst += 16;
+        n -= 16;
+    }
+    for (int i = 0; i < n; ++i) {
+        dst[i] = mergeOne(src[i], alpha);
+    }
+}
+
 template <typename T> void mergeT(const T* SK_RESTRICT src, int srcN,
                                  const uint8_t* SK_RESTRICT row, int rowN,
                                  T* SK_RESTRICT dst) {
@@ -2070,9 +2171,7 @@ template <typename T> void mergeT(const T* SK_RESTRICT src, int srcN,
         } else if (0 == rowA) {
             small_bzero(dst, n * sizeof(T));
         } else {
-            for (int i = 0; i < n; ++i) {
-                dst[i] = mergeOne(src[i], rowA);
-            }
+            mergeSpan(src, n, rowA, dst);
         }
 
         if (0 == (srcN -= n)) {
@@ -2108,6 +2207,27 @@ static MergeAAProc find_merge_aa_proc(SkMask::Format format) {
     }
 }
 
+// Merges columns [left, right) of rows [top, bottom) of mask with the (shared) clip row, and
+// blits them one row at a time.
+static void merge_mask_band(SkBlitter* blitter, const SkMask& mask, MergeAAProc mergeProc,
+                            int left, int right, int top, int bottom,
+                            const uint8_t* row, int initialCount, SkMask* rowMask) {
+    if (left >= right) {
+        return;
+    }
+    rowMask->fBounds.fLeft = left;
+    rowMask->fBounds.fRight = right;
+
+    const void* src = mask.getAddr(left, top);
+    for (int y = top; y < bottom; ++y) {
+        mergeProc(src, right - left, row, initialCount, rowMask->fImage);
+        rowMask->fBounds.fTop = y;
+        rowMask->fBounds.fBottom = y + 1;
+        blitter->blitMask(*rowMask, rowMask->fBounds);
+        src = (const void*)((const char*)src + mask.fRowBytes);
+    }
+}
+
 static U8CPU bit2byte(int bitInAByte) {
     SkASSERT(bitInAByte <= 0xFF);
     // negation turns any non-zero into 0xFFFFFF??, so we just shift down
@@ -2186,15 +2306,10 @@ void SkAAClipBlitter::blitMask(const SkMask& origMask, const SkIRect& clip) {
     // HACK -- we are devolving 3D into A8, need to copy the rest of the 3D
     // data into a temp block to support it better (ugh)
 
-    const void* src = mask->getAddr(clip.fLeft, clip.fTop);
-    const size_t srcRB = mask->fRowBytes;
-    const int width = clip.width();
     MergeAAProc mergeProc = find_merge_aa_proc(mask->fFormat);
 
     SkMask rowMask;
     rowMask.fFormat = SkMask::k3D_Format == mask->fFormat ? SkMask::kA8_Format : mask->fFormat;
-    rowMask.fBounds.fLeft = clip.fLeft;
-    rowMask.fBounds.fRight = clip.fRight;
     rowMask.fRowBytes = mask->fRowBytes; // doesn't matter, since our height==1
     rowMask.fImage = (uint8_t*)fScanlineScratch;
 
@@ -2209,13 +2324,45 @@ void SkAAClipBlitter::blitMask(const SkMask& origMask, const SkIRect& clip) {
 
         int initialCount;
         row = fAAClip->findX(row, clip.fLeft, &initialCount);
-        do {
-            mergeProc(src, width, row, initialCount, rowMask.fImage);
-            rowMask.fBounds.fTop = y;
-            rowMask.fBounds.fBottom = y + 1;
-            fBlitter->blitMask(rowMask, rowMask.fBounds);
-            src = (const void*)((const char*)src + srcRB);
-        } while (++y < localStopY);
+
+        // Every row in [y, localStopY) shares the same runs. Long opaque or transparent runs
+        // (the interior of rect and round-rect clips) are handed to fBlitter for the whole band
+        // at once, or skipped; only the columns in between are merged row by row. Merging drops
+        // the extra planes of a 3D mask, so those are always merged, to look the same throughout.
+        int mixedLeft = clip.fLeft;
+        const uint8_t* mixedRow = row;
+        int mixedCount = initialCount;
+
+        int x = clip.fLeft;
+        int n = initialCount;
+        for (;;) {
+            const int runRight = SkMin32(x + n, clip.fRight);
+            const unsigned alpha = row[1];
+            const bool solid = (0xFF == alpha || 0 == alpha) &&
+                               runRight - x >= kMinSolidSpanWidth &&
+                               SkMask::k3D_Format != mask->fFormat;
+            if (solid) {
+                merge_mask_band(fBlitter, *mask, mergeProc, mixedLeft, x, y, localStopY,
+                                mixedRow, mixedCount, &rowMask);
+                if (alpha) {
+                    fBlitter->blitMask(*mask, SkIRect::MakeLTRB(x, y, runRight, localStopY));
+                }
+                mixedLeft = runRight;
+            }
+            if (runRight == clip.fRight) {
+                break;
+            }
+            x = runRight;
+            row += 2;
+            n = row[0];
+            if (solid) {
+                mixedRow = row;
+                mixedCount = n;
+            }
+        }
+        merge_mask_band(fBlitter, *mask, mergeProc, mixedLeft, clip.fRight, y, localStopY,
+                        mixedRow, mixedCount, &rowMask);
+        y = localStopY;
     } while (y < stopY);
 }
 
@@ -59,6 +59,9 @@ public:
     const SkBBoxHierarchy* bbh() const { return fBBH; }
     const SkRecord*     record() const { return fRecord; }
     const AccelData* accelData() const { return fAccelData; }
+// Used by SkRecordCollectBitmaps
+    int drawableCount() const;
+    SkPicture const* const* drawablePicts() const;
 
 private:
     struct Analysis {
@@ -73,8 +76,6 @@ private:
 
     int numSlowPaths() const override;
     const Analysis& analysis() const;
-    int drawableCount() const;
-    SkPicture const* const* drawablePicts() const;
 
     const SkRect                          fCullRect;
     const size_t                          fApproxBytesUsedBySubPictures;
@@ -174,8 +174,17 @@ struct MipMapRec : public SkResourceCache::Rec {
     const Key& getKey() const override { return fKey; }
     size_t bytesUsed() const override { return sizeof(fKey) + fMipMap->size(); }
 
-    static bool Finder(const SkResourceCache::Rec& baseRec, void* contextMip) {
+    struct FindContext {
+        int             fMinLevelCount;
+        const SkMipMap* fResult;
+    };
+
+    static bool Finder(const SkResourceCache::Rec& baseRec, void* contextPtr) {
         const MipMapRec& rec = static_cast<const MipMapRec&>(baseRec);
+        FindContext* context = static_cast<FindContext*>(contextPtr);
+        if (!rec.fMipMap->hasLevels(context->fMinLevelCount)) {
+            return false;   // too shallow: have the cache purge it so it can be rebuilt deeper
+        }
         const SkMipMap* mm = SkRef(rec.fMipMap);
         // the call to ref() above triggers a "lock" in the case of discardable memory,
         // which means we can now check for null (in case the lock failed).
@@ -184,7 +193,7 @@ struct MipMapRec : public SkResourceCache::Rec {
             return false;
         }
         // the call must call unref() when they are done.
-        *(const SkMipMap**)contextMip = mm;
+        context->fResult = mm;
         return true;
     }
 
@@ -194,14 +203,15 @@ private:
 };
 }
 
-const SkMipMap* SkMipMapCache::FindAndRef(const SkBitmap& src, SkResourceCache* localCache) {
+const SkMipMap* SkMipMapCache::FindAndRef(const SkBitmap& src, SkResourceCache* localCache,
+                                          int minLevelCount) {
     MipMapKey key(src.getGenerationID(), get_bounds_from_bitmap(src));
-    const SkMipMap* result;
+    MipMapRec::FindContext context = { minLevelCount, NULL };
 
-    if (!CHECK_LOCAL(localCache, find, Find, key, MipMapRec::Finder, &result)) {
-        result = NULL;
+    if (!CHECK_LOCAL(localCache, find, Find, key, MipMapRec::Finder, &context)) {
+        return NULL;
     }
-    return result;
+    return context.fResult;
 }
 
 static SkResourceCache::DiscardableFactory get_fact(SkResourceCache* localCache) {
@@ -209,8 +219,9 @@ static SkResourceCache::DiscardableFactory get_fact(SkResourceCache* localCache)
                       : SkResourceCache::GetDiscardableFactory();
 }
 
-const SkMipMap* SkMipMapCache::AddAndRef(const SkBitmap& src, SkResourceCache* localCache) {
-    SkMipMap* mipmap = SkMipMap::Build(src, get_fact(localCache));
+const SkMipMap* SkMipMapCache::AddAndRef(const SkBitmap& src, SkResourceCache* localCache,
+                                         int levelCount) {
+    SkMipMap* mipmap = SkMipMap::Build(src, get_fact(localCache), levelCount);
     if (mipmap) {
         MipMapRec* rec = SkNEW_ARGS(MipMapRec, (src, mipmap));
         CHECK_LOCAL(localCache, add, Add, rec);
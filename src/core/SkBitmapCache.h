@@ -56,8 +56,19 @@ public:
 
 class SkMipMapCache {
 public:
-    static const SkMipMap* FindAndRef(const SkBitmap& src, SkResourceCache* localCache = NULL);
-    static const SkMipMap* AddAndRef(const SkBitmap& src, SkResourceCache* localCache = NULL);
+    /**
+     *  Search the cache for a mipmap of src with at least minLevelCount levels (or every level
+     *  src supports). A cached mipmap that is too shallow is purged, so that a following
+     *  AddAndRef() can replace it with a deeper one.
+     */
+    static const SkMipMap* FindAndRef(const SkBitmap& src, SkResourceCache* localCache = NULL,
+                                      int minLevelCount = 0);
+
+    /**
+     *  Build a mipmap of src with up to levelCount levels and add it to the cache.
+     */
+    static const SkMipMap* AddAndRef(const SkBitmap& src, SkResourceCache* localCache = NULL,
+                                     int levelCount = SK_MaxS32);
 };
 
 #endif
@@ -166,9 +166,13 @@ bool SkDefaultBitmapControllerState::processMediumRequest(const SkBitmap& origBi
     SkScalar invScale = SkScalarSqrt(invScaleSize.width() * invScaleSize.height());
     
     if (invScale > SK_Scalar1) {
-        fCurrMip.reset(SkMipMapCache::FindAndRef(origBitmap));
+        SkScalar levelScale = SkScalarInvert(invScale);
+        // Only ask for the levels this draw needs; deeper ones are built if a later draw
+        // asks for them.
+        const int levelCount = SkMipMap::ComputeLevel(levelScale);
+        fCurrMip.reset(SkMipMapCache::FindAndRef(origBitmap, NULL, levelCount));
         if (NULL == fCurrMip.get()) {
-            fCurrMip.reset(SkMipMapCache::AddAndRef(origBitmap));
+            fCurrMip.reset(SkMipMapCache::AddAndRef(origBitmap, NULL, levelCount));
             if (NULL == fCurrMip.get()) {
                 return false;
             }
@@ -178,7 +182,6 @@ bool SkDefaultBitmapControllerState::processMediumRequest(const SkBitmap& origBi
             sk_throw();
         }
         
-        SkScalar levelScale = SkScalarInvert(invScale);
         SkMipMap::Level level;
         if (fCurrMip->extractLevel(levelScale, &level)) {
             SkScalar invScaleFixup = level.fScale;
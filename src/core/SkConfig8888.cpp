@@ -8,6 +8,7 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkConfig8888.h"
+#include "SkConfig8888_opts.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
 #include "SkMathPriv.h"
@@ -74,6 +75,13 @@ static void memcpy32_row(uint32_t* dst, const uint32_t* src, int count) {
     memcpy(dst, src, count * 4);
 }
 
+// Prefer the SIMD version of a row proc, where there is one.
+static SkConfig8888RowProc platform_proc_or(SkConfig8888ProcType type,
+                                            SkConfig8888RowProc portableProc) {
+    SkConfig8888RowProc proc = SkConfig8888GetPlatformProc(type);
+    return proc ? proc : portableProc;
+}
+
 bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height) const {
     if (width <= 0 || height <= 0) {
         return false;
@@ -83,14 +91,15 @@ bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height)
         return false;
     }
 
-    void (*proc)(uint32_t* dst, const uint32_t* src, int count);
+    SkConfig8888RowProc proc;
     AlphaVerb doAlpha = compute_AlphaVerb(fAlphaType, dst->fAlphaType);
     bool doSwapRB = fColorType != dst->fColorType;
 
     switch (doAlpha) {
         case kNothing_AlphaVerb:
             if (doSwapRB) {
-                proc = convert32_row<true, kNothing_AlphaVerb>;
+                proc = platform_proc_or(kSwapRB_SkConfig8888ProcType,
+                                        convert32_row<true, kNothing_AlphaVerb>);
             } else {
                 if (fPixels == dst->fPixels) {
                     return true;
@@ -100,16 +109,20 @@ bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height)
             break;
         case kPremul_AlphaVerb:
             if (doSwapRB) {
-                proc = convert32_row<true, kPremul_AlphaVerb>;
+                proc = platform_proc_or(kSwapRBPremul_SkConfig8888ProcType,
+                                        convert32_row<true, kPremul_AlphaVerb>);
             } else {
-                proc = convert32_row<false, kPremul_AlphaVerb>;
+                proc = platform_proc_or(kPremul_SkConfig8888ProcType,
+                                        convert32_row<false, kPremul_AlphaVerb>);
             }
             break;
         case kUnpremul_AlphaVerb:
             if (doSwapRB) {
-                proc = convert32_row<true, kUnpremul_AlphaVerb>;
+                proc = platform_proc_or(kSwapRBUnpremul_SkConfig8888ProcType,
+                                        convert32_row<true, kUnpremul_AlphaVerb>);
             } else {
-                proc = convert32_row<false, kUnpremul_AlphaVerb>;
+                proc = platform_proc_or(kUnpremul_SkConfig8888ProcType,
+                                        convert32_row<false, kUnpremul_AlphaVerb>);
             }
             break;
     }
@@ -6,100 +6,77 @@
  */
 
 #include "SkDistanceFieldGen.h"
+#include "SkNx.h"
 #include "SkPoint.h"
 
+// The working data is kept in separate planes, one float per texel each, so that the passes can
+// work on several texels at once.
 struct DFData {
-    float   fAlpha;      // alpha value of source texel
-    float   fDistSq;     // distance squared to nearest (so far) edge texel
-    SkPoint fDistVector; // distance vector to nearest (so far) edge texel
+    float* fAlpha;      // alpha value of source texel
+    float* fDistSq;     // distance squared to nearest (so far) edge texel
+    float* fDistX;      // distance vector to nearest (so far) edge texel
+    float* fDistY;
+    float* fEdge;       // 1 for edge texels, 0 otherwise
 };
 
-enum NeighborFlags {
-    kLeft_NeighborFlag        = 0x01,
-    kRight_NeighborFlag       = 0x02,
-    kTopLeft_NeighborFlag     = 0x04,
-    kTop_NeighborFlag         = 0x08,
-    kTopRight_NeighborFlag    = 0x10,
-    kBottomLeft_NeighborFlag  = 0x20,
-    kBottom_NeighborFlag      = 0x40,
-    kBottomRight_NeighborFlag = 0x80,
-    kAll_NeighborFlags        = 0xff,
-
-    kNeighborFlagCount        = 8
-};
+typedef SkNf<1, float> Sk1f;
 
 // We treat an "edge" as a place where we cross from >=128 to <128, or vice versa, or
 // where we have two non-zero pixels that are <128.
-// 'neighborFlags' is used to limit the directions in which we test to avoid indexing
-// outside of the image
-static bool found_edge(const unsigned char* imagePtr, int width, int neighborFlags) {
-    // the order of these should match the neighbor flags above
-    const int kNum8ConnectedNeighbors = 8;
+// F is an SkNf of floats; this marks the run of texels starting at 'index'. Texels outside the
+// padded image have zero alpha, so no neighbor needs to be masked off.
+template <typename F>
+static void find_edges(const DFData& data, int index, int width) {
+    const float kHalf = 128*0.00392156862f;  // 1/255
     const int offsets[8] = {-1, 1, -width-1, -width, -width+1, width-1, width, width+1 };
-    SkASSERT(kNum8ConnectedNeighbors == kNeighborFlagCount);
-
-    // search for an edge
-    unsigned char currVal = *imagePtr;
-    unsigned char currCheck = (currVal >> 7);
-    for (int i = 0; i < kNum8ConnectedNeighbors; ++i) {
-        unsigned char neighborVal;
-        if ((1 << i) & neighborFlags) {
-            const unsigned char* checkPtr = imagePtr + offsets[i];
-            neighborVal = *checkPtr;
-        } else {
-            neighborVal = 0;
-        }
-        unsigned char neighborCheck = (neighborVal >> 7);
-        SkASSERT(currCheck == 0 || currCheck == 1);
-        SkASSERT(neighborCheck == 0 || neighborCheck == 1);
-        // if sharp transition
-        if (currCheck != neighborCheck ||
-            // or both <128 and >0
-            (!currCheck && !neighborCheck && currVal && neighborVal)) {
-            return true;
-        }
-    }
 
-    return false;
+    // high is 1 for values >= 128, low is 1 for non-zero values < 128
+    F currAlpha = F::Load(data.fAlpha + index);
+    F currHigh = F::Select(currAlpha >= F(kHalf), F(1), F(0));
+    F currLow = F::Select(currAlpha > F(0), F(1), F(0)) - currHigh;
+
+    F score(0);
+    for (int i = 0; i < 8; ++i) {
+        F alpha = F::Load(data.fAlpha + index + offsets[i]);
+        F high = F::Select(alpha >= F(kHalf), F(1), F(0));
+        F low = F::Select(alpha > F(0), F(1), F(0)) - high;
+        // a sharp transition, or both <128 and >0
+        F diff = currHigh - high;
+        score = score + diff*diff + currLow*low;
+    }
+    F::Select(score > F(0), F(1), F(0)).store(data.fEdge + index);
 }
 
-static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned char* image,
+// N is the number of texels the vector passes work on at once, 1 to do without SIMD.
+template <int N>
+static void init_glyph_data(const DFData& data, const unsigned char* image,
                             int dataWidth, int dataHeight,
                             int imageWidth, int imageHeight,
                             int pad) {
-    data += pad*dataWidth;
-    data += pad;
-    edges += (pad*dataWidth + pad);
-
+    float* alpha = data.fAlpha + pad*dataWidth + pad;
     for (int j = 0; j < imageHeight; ++j) {
         for (int i = 0; i < imageWidth; ++i) {
             if (255 == *image) {
-                data->fAlpha = 1.0f;
+                *alpha = 1.0f;
             } else {
-                data->fAlpha = (*image)*0.00392156862f;  // 1/255
-            }
-            int checkMask = kAll_NeighborFlags;
-            if (i == 0) {
-                checkMask &= ~(kLeft_NeighborFlag|kTopLeft_NeighborFlag|kBottomLeft_NeighborFlag);
+                *alpha = (*image)*0.00392156862f;  // 1/255
             }
-            if (i == imageWidth-1) {
-                checkMask &= ~(kRight_NeighborFlag|kTopRight_NeighborFlag|kBottomRight_NeighborFlag);
-            }
-            if (j == 0) {
-                checkMask &= ~(kTopLeft_NeighborFlag|kTop_NeighborFlag|kTopRight_NeighborFlag);
-            }
-            if (j == imageHeight-1) {
-                checkMask &= ~(kBottomLeft_NeighborFlag|kBottom_NeighborFlag|kBottomRight_NeighborFlag);
-            }
-            if (found_edge(image, imageWidth, checkMask)) {
-                *edges = 255;  // using 255 makes for convenient debug rendering
-            }
-            ++data;
+            ++alpha;
             ++image;
-            ++edges;
         }
-        data += 2*pad;
-        edges += 2*pad;
+        alpha += 2*pad;
+    }
+
+    // Edges never fall in the one-texel border, which also keeps the neighbor reads in bounds.
+    for (int j = 1; j < dataHeight-1; ++j) {
+        int index = j*dataWidth + 1;
+        int end = (j+1)*dataWidth - 1;
+        for (; index + N <= end; index += N) {
+            find_edges<SkNf<N, float> >(data, index, dataWidth);
+        }
+        for (; index < end; ++index) {
+            find_edges<Sk1f>(data, index, dataWidth);
+        }
     }
 }
 
@@ -145,170 +122,113 @@ static float edge_distance(const SkPoint& direction, float alpha) {
     return distance;
 }
 
-static void init_distances(DFData* data, unsigned char* edges, int width, int height) {
-    // skip one pixel border
-    DFData* currData = data;
-    DFData* prevData = data - width;
-    DFData* nextData = data + width;
+static void init_distances(const DFData& data, int width, int height) {
+    // init everything to "far away", then fix up the edges
+    int count = width*height;
+    int index = 0;
+    for (; index + 4 <= count; index += 4) {
+        Sk4f(2000000.f).store(data.fDistSq + index);
+        Sk4f(1000.f).store(data.fDistX + index);
+        Sk4f(1000.f).store(data.fDistY + index);
+    }
+    for (; index < count; ++index) {
+        data.fDistSq[index] = 2000000.f;
+        data.fDistX[index] = 1000.f;
+        data.fDistY[index] = 1000.f;
+    }
 
+    const float* alpha = data.fAlpha;
     for (int j = 0; j < height; ++j) {
         for (int i = 0; i < width; ++i) {
-            if (*edges) {
-                // we should not be in the one-pixel outside band
-                SkASSERT(i > 0 && i < width-1 && j > 0 && j < height-1);
-                // gradient will point from low to high
-                // +y is down in this case
-                // i.e., if you're outside, gradient points towards edge
-                // if you're inside, gradient points away from edge
-                SkPoint currGrad;
-                currGrad.fX = (prevData+1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*(currData+1)->fAlpha
-                             - SK_ScalarSqrt2*(currData-1)->fAlpha
-                             + (nextData+1)->fAlpha - (nextData-1)->fAlpha;
-                currGrad.fY = (nextData-1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*nextData->fAlpha
-                             - SK_ScalarSqrt2*prevData->fAlpha
-                             + (nextData+1)->fAlpha - (prevData+1)->fAlpha;
-                currGrad.setLengthFast(1.0f);
-
-                // init squared distance to edge and distance vector
-                float dist = edge_distance(currGrad, currData->fAlpha);
-                currGrad.scale(dist, &currData->fDistVector);
-                currData->fDistSq = dist*dist;
-            } else {
-                // init distance to "far away"
-                currData->fDistSq = 2000000.f;
-                currData->fDistVector.fX = 1000.f;
-                currData->fDistVector.fY = 1000.f;
+            int curr = j*width + i;
+            if (!data.fEdge[curr]) {
+                continue;
             }
-            ++currData;
-            ++prevData;
-            ++nextData;
-            ++edges;
+            // we should not be in the one-pixel outside band
+            SkASSERT(i > 0 && i < width-1 && j > 0 && j < height-1);
+            int prev = curr - width;
+            int next = curr + width;
+            // gradient will point from low to high
+            // +y is down in this case
+            // i.e., if you're outside, gradient points towards edge
+            // if you're inside, gradient points away from edge
+            SkPoint currGrad;
+            currGrad.fX = alpha[prev+1] - alpha[prev-1]
+                         + SK_ScalarSqrt2*alpha[curr+1]
+                         - SK_ScalarSqrt2*alpha[curr-1]
+                         + alpha[next+1] - alpha[next-1];
+            currGrad.fY = alpha[next-1] - alpha[prev-1]
+                         + SK_ScalarSqrt2*alpha[next]
+                         - SK_ScalarSqrt2*alpha[prev]
+                         + alpha[next+1] - alpha[prev+1];
+            currGrad.setLengthFast(1.0f);
+
+            // init squared distance to edge and distance vector
+            float dist = edge_distance(currGrad, alpha[curr]);
+            data.fDistSq[curr] = dist*dist;
+            data.fDistX[curr] = currGrad.fX*dist;
+            data.fDistY[curr] = currGrad.fY*dist;
         }
     }
 }
 
 // Danielsson's 8SSEDT
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
-    // upper left
-    DFData* check = curr - width-1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // up
-    check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // upper right
-    check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Tests whether the F-width run of texels at 'index' is closer to the edge found by the texels at
+// 'index + offset', which lie at (dx, dy) relative to them. Edge texels are left alone.
+template <typename F>
+static inline void check_neighbor(const DFData& data, int index, int offset, float dx, float dy) {
+    int check = index + offset;
+    F checkX = F::Load(data.fDistX + check);
+    F checkY = F::Load(data.fDistY + check);
+    F checkDistSq = F::Load(data.fDistSq + check);
+    F dot = F(dx)*checkX + F(dy)*checkY;
+    // |check + (dx, dy)|^2, grouped the same way as the scalar 8SSEDT
+    F distSq = (dx && dy) ? checkDistSq + F(2.0f)*(dot + F(1.0f))
+                          : checkDistSq + F(2.0f)*dot + F(1.0f);
+
+    // edge texels keep their initial distance
+    F currDistSq = F::Load(data.fDistSq + index);
+    F isEdge = F::Load(data.fEdge + index);
+    auto closer = F::Select(isEdge > F(0), currDistSq, distSq) < currDistSq;
+    if (!closer.anyTrue()) {
+        return;
     }
+    F::Select(closer, distSq, currDistSq).store(data.fDistSq + index);
+    F::Select(closer, checkX + F(dx), F::Load(data.fDistX + index)).store(data.fDistX + index);
+    F::Select(closer, checkY + F(dy), F::Load(data.fDistY + index)).store(data.fDistY + index);
 }
 
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Checks the three neighbors in the row above (dy = -1) or below (dy = 1) of the texels in
+// [begin, end). These only depend on the other row, so they are done N texels at a time.
+template <int N>
+static void check_row(const DFData& data, int begin, int end, int width, int dy) {
+    typedef SkNf<N, float> F;
+    int offset = dy*width;
+    int index = begin;
+    for (; index + N <= end; index += N) {
+        check_neighbor<F>(data, index, offset-1, -1.0f, (float)dy);
+        check_neighbor<F>(data, index, offset,    0.0f, (float)dy);
+        check_neighbor<F>(data, index, offset+1,  1.0f, (float)dy);
     }
-}
-
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
-    DFData* check = curr - 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (; index < end; ++index) {
+        check_neighbor<Sk1f>(data, index, offset-1, -1.0f, (float)dy);
+        check_neighbor<Sk1f>(data, index, offset,    0.0f, (float)dy);
+        check_neighbor<Sk1f>(data, index, offset+1,  1.0f, (float)dy);
     }
 }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Propagates from the left neighbor, forwards in x. Each texel depends on the one before it.
+static void check_left(const DFData& data, int begin, int end) {
+    for (int index = begin; index < end; ++index) {
+        check_neighbor<Sk1f>(data, index, -1, -1.0f, 0.0f);
     }
+}
 
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Propagates from the right neighbor, backwards in x.
+static void check_right(const DFData& data, int begin, int end) {
+    for (int index = end-1; index >= begin; --index) {
+        check_neighbor<Sk1f>(data, index, 1, 1.0f, 0.0f);
     }
 }
 
@@ -325,10 +245,23 @@ static unsigned char pack_distance_field_val(float dist, float distanceMagnitude
         return (unsigned char)((distanceMagnitude-dist)*128.0f/distanceMagnitude);
     }
 }
+
+// Four at a time. Clamping to [0, 255] gives the same results as the branches above.
+static void pack_distance_field_vals(const Sk4f& dist, float distanceMagnitude,
+                                     unsigned char vals[4]) {
+    Sk4f scaled = (Sk4f(distanceMagnitude) - dist)*Sk4f(128.0f/distanceMagnitude);
+    scaled = Sk4f::Min(Sk4f::Max(scaled, Sk4f(0)), Sk4f(255));
+    int32_t ints[4];
+    scaled.castTrunc().store(ints);
+    for (int i = 0; i < 4; ++i) {
+        vals[i] = (unsigned char)ints[i];
+    }
+}
 #endif
 
 // assumes a padded 8-bit image and distance field
 // width and height are the original width and height of the image
+template <int N>
 static bool generate_distance_field_from_image(unsigned char* distanceField,
                                                const unsigned char* copyPtr,
                                                int width, int height) {
@@ -342,126 +275,96 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
     // set params for distance field data
     int dataWidth = width + 2*pad;
     int dataHeight = height + 2*pad;
+    int dataCount = dataWidth*dataHeight;
 
     // create temp data
-    size_t dataSize = dataWidth*dataHeight*sizeof(DFData);
+    size_t dataSize = 5*dataCount*sizeof(float);
     SkAutoSMalloc<1024> dfStorage(dataSize);
-    DFData* dataPtr = (DFData*) dfStorage.get();
-    sk_bzero(dataPtr, dataSize);
-
-    SkAutoSMalloc<1024> edgeStorage(dataWidth*dataHeight*sizeof(char));
-    unsigned char* edgePtr = (unsigned char*) edgeStorage.get();
-    sk_bzero(edgePtr, dataWidth*dataHeight*sizeof(char));
+    sk_bzero(dfStorage.get(), dataSize);
+    DFData data;
+    data.fAlpha = (float*) dfStorage.get();
+    data.fDistSq = data.fAlpha + dataCount;
+    data.fDistX = data.fDistSq + dataCount;
+    data.fDistY = data.fDistX + dataCount;
+    data.fEdge = data.fDistY + dataCount;
 
     // copy glyph into distance field storage
-    init_glyph_data(dataPtr, edgePtr, copyPtr,
+    init_glyph_data<N>(data, copyPtr,
                     dataWidth, dataHeight,
                     width+2, height+2, SK_DistanceFieldPad);
 
     // create initial distance data, particularly at edges
-    init_distances(dataPtr, edgePtr, dataWidth, dataHeight);
+    init_distances(data, dataWidth, dataHeight);
 
     // now perform Euclidean distance transform to propagate distances
 
-    // forwards in y
-    DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
-    unsigned char* currEdge = edgePtr+dataWidth+1;
+    // forwards in y, skipping the outer buffer
     for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
+        int begin = j*dataWidth + 1;
+        int end = begin + dataWidth-2;
+        // upper left, up, upper right, then left going forwards in x
+        check_row<N>(data, begin, end, dataWidth, -1);
+        check_left(data, begin, end);
+        // right, going backwards in x
+        check_right(data, begin, end);
     }
 
     // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+    for (int j = dataHeight-2; j > 0; --j) {
+        int begin = j*dataWidth + 1;
+        int end = begin + dataWidth-2;
+        // left, going forwards in x
+        check_left(data, begin, end);
+        // bottom left, bottom, bottom right, then right going backwards in x
+        check_row<N>(data, begin, end, dataWidth, 1);
+        check_right(data, begin, end);
     }
 
     // copy results to final distance field data
-    currData = dataPtr + dataWidth+1;
-    currEdge = edgePtr + dataWidth+1;
     unsigned char *dfPtr = distanceField;
     for (int j = 1; j < dataHeight-1; ++j) {
-        for (int i = 1; i < dataWidth-1; ++i) {
+        int index = j*dataWidth + 1;
+        int end = (j+1)*dataWidth - 1;
 #if DUMP_EDGE
-            float alpha = currData->fAlpha;
+        for (; index < end; ++index) {
+            float alpha = data.fAlpha[index];
             float edge = 0.0f;
-            if (*currEdge) {
+            if (data.fEdge[index]) {
                 edge = 0.25f;
             }
             // blend with original image
             float result = alpha + (1.0f-alpha)*edge;
             unsigned char val = sk_float_round2int(255*result);
             *dfPtr++ = val;
+        }
 #else
+        for (; N > 1 && index + 4 <= end; index += 4) {
+            Sk4f dist = Sk4f::Load(data.fDistSq + index).sqrt();
+            dist = Sk4f::Select(Sk4f::Load(data.fAlpha + index) > Sk4f(0.5f),
+                                Sk4f(0) - dist, dist);
+            pack_distance_field_vals(dist, (float)SK_DistanceFieldMagnitude, dfPtr);
+            dfPtr += 4;
+        }
+        for (; index < end; ++index) {
             float dist;
-            if (currData->fAlpha > 0.5f) {
-                dist = -SkScalarSqrt(currData->fDistSq);
+            if (data.fAlpha[index] > 0.5f) {
+                dist = -SkScalarSqrt(data.fDistSq[index]);
             } else {
-                dist = SkScalarSqrt(currData->fDistSq);
+                dist = SkScalarSqrt(data.fDistSq[index]);
             }
             *dfPtr++ = pack_distance_field_val(dist, (float)SK_DistanceFieldMagnitude);
-#endif
-            ++currData;
-            ++currEdge;
         }
-        currData += 2;
-        currEdge += 2;
+#endif
     }
 
     return true;
 }
 
 // assumes an 8-bit image and distance field
-bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
-                                        const unsigned char* image,
-                                        int width, int height, size_t rowBytes) {
+template <int N>
+static bool generate_distance_field_from_a8_image(unsigned char* distanceField,
+                                                  const unsigned char* image,
+                                                  int width, int height, size_t rowBytes) {
     SkASSERT(distanceField);
     SkASSERT(image);
 
@@ -476,14 +379,28 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
     unsigned char* currDestPtr = copyPtr + width + 2;
     for (int i = 0; i < height; ++i) {
         *currDestPtr++ = 0;
-        memcpy(currDestPtr, currSrcScanLine, rowBytes);
+        memcpy(currDestPtr, currSrcScanLine, width);
         currSrcScanLine += rowBytes;
         currDestPtr += width;
         *currDestPtr++ = 0;
     }
     sk_bzero(currDestPtr, (width+2)*sizeof(char));
 
-    return generate_distance_field_from_image(distanceField, copyPtr, width, height);
+    return generate_distance_field_from_image<N>(distanceField, copyPtr, width, height);
+}
+
+bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
+                                        const unsigned char* image,
+                                        int width, int height, size_t rowBytes) {
+    return generate_distance_field_from_a8_image<4>(distanceField, image, width, height,
+                                                    rowBytes);
+}
+
+bool SkGenerateDistanceFieldFromA8ImageNoSIMD(unsigned char* distanceField,
+                                              const unsigned char* image,
+                                              int width, int height, size_t rowBytes) {
+    return generate_distance_field_from_a8_image<1>(distanceField, image, width, height,
+                                                    rowBytes);
 }
 
 // assumes a 1-bit image and 8-bit distance field
@@ -517,5 +434,5 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
     }
     sk_bzero(currDestPtr, (width+2)*sizeof(char));
 
-    return generate_distance_field_from_image(distanceField, copyPtr, width, height);
+    return generate_distance_field_from_image<4>(distanceField, copyPtr, width, height);
 }
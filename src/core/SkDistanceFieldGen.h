@@ -37,6 +37,13 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
                                         const unsigned char* image,
                                         int w, int h, size_t rowBytes);
 
+/** Like SkGenerateDistanceFieldFromA8Image, but one texel at a time, without SIMD. For testing
+ *  that both give the same field.
+ */
+bool SkGenerateDistanceFieldFromA8ImageNoSIMD(unsigned char* distanceField,
+                                              const unsigned char* image,
+                                              int w, int h, size_t rowBytes);
+
 /** Given 1-bit mask data, generate the associated distance field
 
  *  @param distanceField     The distance field to be generated. Should already be allocated
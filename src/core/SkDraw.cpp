@@ -13,6 +13,7 @@
 #include "SkDevice.h"
 #include "SkDeviceLooper.h"
 #include "SkFixed.h"
+#include "SkMaskCache.h"
 #include "SkMaskFilter.h"
 #include "SkPaint.h"
 #include "SkPathEffect.h"
@@ -24,6 +25,8 @@
 #include "SkSmallAllocator.h"
 #include "SkString.h"
 #include "SkStroke.h"
+#include "SkStrokeRec.h"
+#include "SkTDArray.h"
 #include "SkTextMapStateProc.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
@@ -1074,6 +1077,11 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
         }
     }
 
+    if (pathPtr == &origSrcPath && !drawCoverage && NULL == customBlitter &&
+            this->drawPathWithMaskCache(origSrcPath, *matrix, *paint)) {
+        return;
+    }
+
     if (paint->getPathEffect() || paint->getStyle() != SkPaint::kFill_Style) {
         SkRect cullRect;
         const SkRect* cullRectPtr = NULL;
@@ -1136,6 +1144,110 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
     proc(*devPathPtr, *fRC, blitter);
 }
 
+// Complex anti-aliased paths are often drawn over and over at the same scale (icons, glyph-like
+// shapes). Small paths with at least this many points are rasterized once into an A8 coverage
+// mask that lives in SkResourceCache, and later draws just blit that mask.
+static const int kMinPathPointsForMaskCache = 32;
+
+// The cached mask covers the whole path rather than just the clip, so keep it small.
+static const int64_t kMaxPathMaskCacheArea = 256 * 256;
+
+bool SkDraw::drawPathWithMaskCache(const SkPath& path, const SkMatrix& matrix,
+                                   const SkPaint& paint) const {
+    if (!paint.isAntiAlias() || paint.getPathEffect() || paint.getRasterizer() ||
+            paint.getMaskFilter() || paint.getLooper() || matrix.hasPerspective() ||
+            path.isVolatile() || path.isInverseFillType() ||
+            path.countPoints() < kMinPathPointsForMaskCache) {
+        return false;
+    }
+
+    // Reject paths whose mask would be too big before stroking or transforming them. The stroke
+    // outset is in local space, and a pixel more covers hairlines and anti-aliasing.
+    SkRect storage;
+    SkRect devBounds;
+    matrix.mapRect(&devBounds, paint.computeFastBounds(path.getBounds(), &storage));
+    devBounds.outset(SK_Scalar1, SK_Scalar1);
+    if (!devBounds.isFinite() ||
+            devBounds.width() * devBounds.height() > SkIntToScalar(kMaxPathMaskCacheArea)) {
+        return false;
+    }
+
+    // Whole pixels of translation just offset the mask. The rest is quantized to a quarter
+    // pixel (as we do for glyphs) and becomes part of the key.
+    const SkScalar kMaxTranslate = SkIntToScalar(1 << 28);
+    const SkScalar tx = matrix.getTranslateX();
+    const SkScalar ty = matrix.getTranslateY();
+    if (!(SkScalarAbs(tx) < kMaxTranslate && SkScalarAbs(ty) < kMaxTranslate)) {
+        return false;
+    }
+    const int qx = SkScalarRoundToInt(tx * 4);
+    const int qy = SkScalarRoundToInt(ty * 4);
+    SkMatrix keyMatrix(matrix);
+    keyMatrix.setTranslateX(SkIntToScalar(qx & 3) / 4);
+    keyMatrix.setTranslateY(SkIntToScalar(qy & 3) / 4);
+
+    const SkStrokeRec stroke(paint);
+
+    SkMask mask;
+    SkAutoTUnref<SkCachedData> data(SkMaskCache::FindAndRef(path, keyMatrix, stroke, &mask));
+    if (NULL == data.get()) {
+        // Same order of operations as drawPath(): stroke in local space, then transform.
+        SkPath devPath;
+        bool doFill = true;
+        if (paint.getStyle() != SkPaint::kFill_Style) {
+            SkPath fillPath;
+            doFill = paint.getFillPath(path, &fillPath, NULL,
+                                       compute_res_scale_for_stroking(*fMatrix));
+            fillPath.transform(keyMatrix, &devPath);
+        } else {
+            path.transform(keyMatrix, &devPath);
+        }
+        // DrawToMask() draws devPath with an anti-aliased paint; volatile keeps it from coming
+        // back here.
+        devPath.setIsVolatile(true);
+
+        const SkPaint::Style style = doFill ? SkPaint::kFill_Style : SkPaint::kStroke_Style;
+        if (!DrawToMask(devPath, NULL, NULL, NULL, &mask,
+                        SkMask::kJustComputeBounds_CreateMode, style)) {
+            return false;
+        }
+        if ((int64_t)mask.fBounds.width() * mask.fBounds.height() > kMaxPathMaskCacheArea) {
+            return false;
+        }
+        mask.fFormat = SkMask::kA8_Format;
+        mask.fRowBytes = mask.fBounds.width();
+        const size_t size = mask.computeImageSize();
+        if (0 == size) {
+            return false;
+        }
+        data.reset(SkResourceCache::NewCachedData(size));
+        if (NULL == data.get()) {
+            return false;
+        }
+        mask.fImage = (uint8_t*)data->writable_data();
+        memset(mask.fImage, 0, size);
+        DrawToMask(devPath, NULL, NULL, NULL, &mask, SkMask::kJustRenderImage_CreateMode, style);
+
+        SkMaskCache::Add(path, keyMatrix, stroke, mask, data);
+    }
+    mask.fBounds.offset(qx >> 2, qy >> 2);
+
+    SkAutoBlitterChoose blitterStorage(fDst, *fMatrix, paint);
+    SkBlitter* blitter = blitterStorage.get();
+
+    SkAAClipBlitterWrapper wrapper;
+    const SkRegion* clipRgn;
+    if (fRC->isBW()) {
+        clipRgn = &fRC->bwRgn();
+    } else {
+        wrapper.init(*fRC, blitter);
+        clipRgn = &wrapper.getRgn();
+        blitter = wrapper.getBlitter();
+    }
+    blitter->blitMaskRegion(mask, *clipRgn);
+    return true;
+}
+
 /** For the purposes of drawing bitmaps, if a matrix is "almost" translate
     go ahead and treat it as if it were, so that subsequent code can go fast.
  */
@@ -1440,13 +1552,16 @@ void SkDraw::drawText_asPaths(const char text[], size_t byteLength,
 
 //////////////////////////////////////////////////////////////////////////////
 
+// Prevent glyphs from being drawn outside of or straddling the edge of device space.
+static bool glyph_origin_in_range(Sk48Dot16 fx, Sk48Dot16 fy) {
+    return (fx >> 16) <= INT_MAX - (INT16_MAX + UINT16_MAX) &&
+           (fx >> 16) >= INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/) &&
+           (fy >> 16) <= INT_MAX - (INT16_MAX + UINT16_MAX) &&
+           (fy >> 16) >= INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/);
+}
+
 static void D1G_RectClip(const SkDraw1Glyph& state, Sk48Dot16 fx, Sk48Dot16 fy, const SkGlyph& glyph) {
-    // Prevent glyphs from being drawn outside of or straddling the edge of device space.
-    if ((fx >> 16) > INT_MAX - (INT16_MAX + UINT16_MAX) ||
-        (fx >> 16) < INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/) ||
-        (fy >> 16) > INT_MAX - (INT16_MAX + UINT16_MAX) ||
-        (fy >> 16) < INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/))
-    {
+    if (!glyph_origin_in_range(fx, fy)) {
         return;
     }
 
@@ -1532,6 +1647,54 @@ static bool needsRasterTextBlit(const SkDraw& draw) {
     return !hasCustomD1GProc(draw);
 }
 
+// Runs shorter than this are not worth handing to other threads.
+#define kMinGlyphsToPrefetch    16
+
+/*
+ *  Scales the images for a long run of glyphs up front, so the blit loop finds them ready. The
+ *  caller walks the run once, add()ing each glyph at the origin it will be drawn at, and only
+ *  the glyphs that land inside the clip are prefetched.
+ */
+class GlyphPrefetcher {
+public:
+    GlyphPrefetcher(const SkDraw& draw, SkGlyphCache* cache, const SkPaint& paint,
+                    size_t byteLength)
+        : fCache(cache)
+        , fClipBounds(draw.fRC->getBounds()) {
+        fEnabled = needsRasterTextBlit(draw) &&
+                   SkPaint::kGlyphID_TextEncoding == paint.getTextEncoding() &&
+                   !cache->isSubpixel() &&
+                   SkToInt(byteLength >> 1) >= kMinGlyphsToPrefetch;
+    }
+
+    bool enabled() const { return fEnabled; }
+
+    // fx and fy are the origin the glyph will be passed to the SkDraw1Glyph proc with.
+    void add(const SkGlyph& glyph, Sk48Dot16 fx, Sk48Dot16 fy) {
+        if (0 == glyph.fWidth || !glyph_origin_in_range(fx, fy)) {
+            return;
+        }
+        SkIRect bounds;
+        bounds.setXYWH(Sk48Dot16FloorToInt(fx) + glyph.fLeft, Sk48Dot16FloorToInt(fy) + glyph.fTop,
+                       glyph.fWidth, glyph.fHeight);
+        if (SkIRect::Intersects(bounds, fClipBounds)) {
+            *fGlyphIDs.append() = glyph.getGlyphID();
+        }
+    }
+
+    void prefetch() {
+        if (fGlyphIDs.count() >= kMinGlyphsToPrefetch) {
+            fCache->prefetchImages(fGlyphIDs.begin(), fGlyphIDs.count());
+        }
+    }
+
+private:
+    SkGlyphCache*       fCache;
+    SkIRect             fClipBounds;
+    SkTDArray<uint16_t> fGlyphIDs;
+    bool                fEnabled;
+};
+
 SkDraw1Glyph::Proc SkDraw1Glyph::init(const SkDraw* draw, SkBlitter* blitter, SkGlyphCache* cache,
                                       const SkPaint& pnt) {
     fDraw = draw;
@@ -1663,6 +1826,23 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     Sk48Dot16 fx = SkScalarTo48Dot16(x + d1g.fHalfSampleX);
     Sk48Dot16 fy = SkScalarTo48Dot16(y + d1g.fHalfSampleY);
 
+    GlyphPrefetcher prefetcher(*this, cache, paint, byteLength);
+    if (prefetcher.enabled()) {
+        // Lay the run out the same way as the loop below. The cache isn't subpixel, so the
+        // positions passed to glyphCacheProc are ignored.
+        SkAutoKern prefetchKern;
+        Sk48Dot16 px = fx;
+        Sk48Dot16 py = fy;
+        for (const char* t = text; t < stop;) {
+            const SkGlyph& glyph = glyphCacheProc(cache, &t, 0, 0);
+            px += prefetchKern.adjust(glyph);
+            prefetcher.add(glyph, px, py);
+            px += glyph.fAdvanceX;
+            py += glyph.fAdvanceY;
+        }
+        prefetcher.prefetch();
+    }
+
     while (text < stop) {
         const SkGlyph& glyph = glyphCacheProc(cache, &text, fx & fxMask, fy & fyMask);
 
@@ -1768,6 +1948,22 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     SkDraw1Glyph::Proc proc = d1g.init(this, blitter, cache, paint);
     SkTextMapStateProc tmsProc(*fMatrix, offset, scalarsPerPosition);
 
+    GlyphPrefetcher prefetcher(*this, cache, paint, byteLength);
+    if (prefetcher.enabled()) {
+        // Place each glyph the same way as the non-subpixel loops below.
+        const SkScalar* p = pos;
+        for (const char* t = text; t < stop; p += scalarsPerPosition) {
+            const SkGlyph& glyph = glyphCacheProc(cache, &t, 0, 0);
+            SkPoint tmsLoc;
+            tmsProc(p, &tmsLoc);
+            SkPoint alignLoc;
+            alignProc(tmsLoc, glyph, &alignLoc);
+            prefetcher.add(glyph, SkScalarTo48Dot16(alignLoc.fX + SK_ScalarHalf),
+                           SkScalarTo48Dot16(alignLoc.fY + SK_ScalarHalf));
+        }
+        prefetcher.prefetch();
+    }
+
     if (cache->isSubpixel()) {
         // maybe we should skip the rounding if linearText is set
         SkAxisAlignment baseline = SkComputeAxisAlignmentForHText(*fMatrix);
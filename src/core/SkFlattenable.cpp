@@ -6,6 +6,10 @@
  */
 
 #include "SkFlattenable.h"
+#include "SkAtomics.h"
+#include "SkChecksum.h"
+#include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkPtrRecorder.h"
 #include "SkReadBuffer.h"
 
@@ -56,30 +60,34 @@ struct Entry {
     SkFlattenable::Type     fType;
 };
 
+// gEntries only grows. Register() fills in an entry under gRegisterMutex, then publishes it by
+// storing gCount with release semantics, so lookups that load gCount with acquire semantics only
+// ever see complete entries and need no lock.
 static int gCount;
 static Entry gEntries[MAX_ENTRY_COUNT];
+SK_DECLARE_STATIC_MUTEX(gRegisterMutex);
+
+static int entry_count() {
+    return sk_atomic_load(&gCount, sk_memory_order_acquire);
+}
 
 void SkFlattenable::Register(const char name[], Factory factory, SkFlattenable::Type type) {
     SkASSERT(name);
     SkASSERT(factory);
 
-    static bool gOnce = false;
-    if (!gOnce) {
-        gCount = 0;
-        gOnce = true;
-    }
-
-    SkASSERT(gCount < MAX_ENTRY_COUNT);
+    SkAutoMutexAcquire lock(gRegisterMutex);
+    int count = gCount;
+    SkASSERT(count < MAX_ENTRY_COUNT);
 
-    gEntries[gCount].fName = name;
-    gEntries[gCount].fFactory = factory;
-    gEntries[gCount].fType = type;
-    gCount += 1;
+    gEntries[count].fName = name;
+    gEntries[count].fFactory = factory;
+    gEntries[count].fType = type;
+    sk_atomic_store(&gCount, count + 1, sk_memory_order_release);
 }
 
 #ifdef SK_DEBUG
 static void report_no_entries(const char* functionName) {
-    if (!gCount) {
+    if (!entry_count()) {
         SkDebugf("%s has no registered name/factory/type entries."
                  " Call SkFlattenable::InitializeFlattenablesIfNeeded() before using gEntries",
                  functionName);
@@ -87,18 +95,78 @@ static void report_no_entries(const char* functionName) {
 }
 #endif
 
+// Open addressed hash tables of gEntries by name and by factory, built once the flattenables
+// are initialized. Each slot holds an index into gEntries plus one, or 0 if it is empty.
+#define INDEX_SIZE  (2 * MAX_ENTRY_COUNT)
+
+static uint16_t gNameIndex[INDEX_SIZE];
+static uint16_t gFactoryIndex[INDEX_SIZE];
+// Entries registered after the index was built are searched linearly. Only written by
+// build_index(), so SkOnce publishes it along with the index.
+static int gIndexedCount;
+
+static uint32_t hash_name(const char name[]) {
+    return SkChecksum::Murmur3(name, strlen(name));
+}
+
+static uint32_t hash_factory(SkFlattenable::Factory factory) {
+    return SkChecksum::Murmur3(&factory, sizeof(factory));
+}
+
+static void build_index() {
+    // Later entries replace earlier ones of the same name or factory, as in a search from the
+    // last entry back.
+    const int count = entry_count();
+    for (int i = 0; i < count; ++i) {
+        uint32_t slot = hash_name(gEntries[i].fName) & (INDEX_SIZE - 1);
+        while (gNameIndex[slot] && strcmp(gEntries[gNameIndex[slot] - 1].fName,
+                                          gEntries[i].fName)) {
+            slot = (slot + 1) & (INDEX_SIZE - 1);
+        }
+        gNameIndex[slot] = SkToU16(i + 1);
+
+        slot = hash_factory(gEntries[i].fFactory) & (INDEX_SIZE - 1);
+        while (gFactoryIndex[slot] && gEntries[gFactoryIndex[slot] - 1].fFactory !=
+                                      gEntries[i].fFactory) {
+            slot = (slot + 1) & (INDEX_SIZE - 1);
+        }
+        gFactoryIndex[slot] = SkToU16(i + 1);
+    }
+    gIndexedCount = count;
+}
+
+SK_DECLARE_STATIC_ONCE(gIndexOnce);
+
+// The flattenables must be initialized first.
+static void index_if_needed() {
+    SkOnce(&gIndexOnce, build_index);
+}
+
+static const Entry* find_name(const char name[]) {
+    index_if_needed();
+    for (int i = entry_count() - 1; i >= gIndexedCount; --i) {
+        if (strcmp(gEntries[i].fName, name) == 0) {
+            return &gEntries[i];
+        }
+    }
+    uint32_t slot = hash_name(name) & (INDEX_SIZE - 1);
+    while (gNameIndex[slot]) {
+        const Entry* entry = &gEntries[gNameIndex[slot] - 1];
+        if (strcmp(entry->fName, name) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    return NULL;
+}
+
 SkFlattenable::Factory SkFlattenable::NameToFactory(const char name[]) {
     InitializeFlattenablesIfNeeded();
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            return entries[i].fFactory;
-        }
-    }
-    return NULL;
+    const Entry* entry = find_name(name);
+    return entry ? entry->fFactory : NULL;
 }
 
 bool SkFlattenable::NameToType(const char name[], SkFlattenable::Type* type) {
@@ -107,12 +175,10 @@ bool SkFlattenable::NameToType(const char name[], SkFlattenable::Type* type) {
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            *type = entries[i].fType;
-            return true;
-        }
+    const Entry* entry = find_name(name);
+    if (entry) {
+        *type = entry->fType;
+        return true;
     }
     return false;
 }
@@ -122,11 +188,19 @@ const char* SkFlattenable::FactoryToName(Factory fact) {
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (entries[i].fFactory == fact) {
-            return entries[i].fName;
+    index_if_needed();
+    for (int i = entry_count() - 1; i >= gIndexedCount; --i) {
+        if (gEntries[i].fFactory == fact) {
+            return gEntries[i].fName;
+        }
+    }
+    uint32_t slot = hash_factory(fact) & (INDEX_SIZE - 1);
+    while (gFactoryIndex[slot]) {
+        const Entry* entry = &gEntries[gFactoryIndex[slot] - 1];
+        if (entry->fFactory == fact) {
+            return entry->fName;
         }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
     }
     return NULL;
 }
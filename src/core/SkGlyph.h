@@ -117,6 +117,7 @@ class SkGlyph {
  private:
     // TODO(herb) remove friend statement after SkGlyphCache cleanup.
     friend class SkGlyphCache;
+    friend class SkGlyphDiskCache;
 
     void initCommon(uint32_t id) {
         fID             = id;
@@ -11,6 +11,7 @@
 #include "SkLazyPtr.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTLS.h"
 #include "SkTypeface.h"
@@ -67,6 +68,9 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     fDesc = desc->copy();
     fScalerContext->getFontMetrics(&fFontMetrics);
 
+    fDiskCache = SkGlyphDiskCache::Get();
+    fDiskStrike = fDiskCache ? fDiskCache->findStrike(fDesc, typeface) : NULL;
+
     // Create the sentinel SkGlyph.
     SkGlyph* sentinel = fGlyphArray.insert(0);
     sentinel->initGlyphFromCombinedID(SkGlyph::kImpossibleID);
@@ -236,7 +240,7 @@ SkGlyph* SkGlyphCache::lookupByChar(SkUnichar charCode, MetricsType type, SkFixe
         RecordHashSuccess();
         glyph = &fGlyphArray[rec->fGlyphIndex];
         if (type == kFull_MetricsType && glyph->isJustAdvance()) {
-            fScalerContext->getMetrics(glyph);
+            this->getMetrics(glyph);
         }
     }
     return glyph;
@@ -255,7 +259,7 @@ SkGlyph* SkGlyphCache::lookupByCombinedID(uint32_t id, MetricsType type) {
     } else {
         RecordHashSuccess();
         if (type == kFull_MetricsType && glyph->isJustAdvance()) {
-           fScalerContext->getMetrics(glyph);
+            this->getMetrics(glyph);
         }
     }
     return glyph;
@@ -282,7 +286,7 @@ uint16_t SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     SkGlyph* glyph = &gptr[glyph_index];
     if (glyph->fID == id) {
         if (kFull_MetricsType == mtype && glyph->isJustAdvance()) {
-            fScalerContext->getMetrics(glyph);
+            this->getMetrics(glyph);
         }
         SkASSERT(glyph->fID != SkGlyph::kImpossibleID);
         return glyph_index;
@@ -305,13 +309,23 @@ uint16_t SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
         fScalerContext->getAdvance(glyph);
     } else {
         SkASSERT(kFull_MetricsType == mtype);
-        fScalerContext->getMetrics(glyph);
+        this->getMetrics(glyph);
     }
 
     SkASSERT(glyph->fID != SkGlyph::kImpossibleID);
     return glyph_index;
 }
 
+void SkGlyphCache::getMetrics(SkGlyph* glyph) {
+    if (fDiskStrike && fDiskCache->findMetrics(fDiskStrike, glyph)) {
+        return;
+    }
+    fScalerContext->getMetrics(glyph);
+    if (fDiskStrike) {
+        fDiskCache->addMetrics(fDiskStrike, *glyph);
+    }
+}
+
 const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
     if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
         if (NULL == glyph.fImage) {
@@ -320,7 +334,12 @@ const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
                                         SkChunkAlloc::kReturnNil_AllocFailType);
             // check that alloc() actually succeeded
             if (glyph.fImage) {
-                fScalerContext->getImage(glyph);
+                if (NULL == fDiskStrike || !fDiskCache->findImage(fDiskStrike, glyph)) {
+                    fScalerContext->getImage(glyph);
+                    if (fDiskStrike) {
+                        fDiskCache->addImage(fDiskStrike, glyph);
+                    }
+                }
                 // TODO: the scaler may have changed the maskformat during
                 // getImage (e.g. from AA or LCD to BW) which means we may have
                 // overallocated the buffer. Check if the new computedImageSize
@@ -336,7 +355,12 @@ const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     if (glyph.fWidth) {
         if (glyph.fPath == NULL) {
             const_cast<SkGlyph&>(glyph).fPath = SkNEW(SkPath);
-            fScalerContext->getPath(glyph, glyph.fPath);
+            if (NULL == fDiskStrike || !fDiskCache->findPath(fDiskStrike, glyph, glyph.fPath)) {
+                fScalerContext->getPath(glyph, glyph.fPath);
+                if (fDiskStrike) {
+                    fDiskCache->addPath(fDiskStrike, glyph);
+                }
+            }
             fMemoryUsed += sizeof(SkPath) +
                     glyph.fPath->countPoints() * sizeof(SkPoint);
         }
@@ -344,6 +368,95 @@ const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     return glyph.fPath;
 }
 
+namespace {
+
+struct PrefetchTask {
+    SkScalerContext* fScalerContext;
+    SkGlyph**        fGlyphs;
+    int              fCount;
+};
+
+void prefetch_images(PrefetchTask* task) {
+    for (int i = 0; i < task->fCount; ++i) {
+        task->fScalerContext->getImage(*task->fGlyphs[i]);
+    }
+}
+
+}  // namespace
+
+// Don't bother with a task for fewer glyphs than this.
+#define kMinPrefetchGlyphsPerTask   8
+#define kMaxPrefetchTasks           4
+
+void SkGlyphCache::prefetchImages(const uint16_t glyphIDs[], int count) {
+    VALIDATE();
+
+    // Adding glyphs can move the others, so look them all up before holding on to any.
+    for (int i = 0; i < count; ++i) {
+        this->lookupByCombinedID(SkGlyph::MakeID(glyphIDs[i]), kFull_MetricsType);
+    }
+
+    // Allocate the images here, since fGlyphAlloc is not thread safe.
+    SkTDArray<SkGlyph*> pending;
+    for (int i = 0; i < count; ++i) {
+        SkGlyph* glyph = this->lookupByCombinedID(SkGlyph::MakeID(glyphIDs[i]),
+                                                  kFull_MetricsType);
+        if (glyph->fWidth == 0 || glyph->fWidth >= kMaxGlyphWidth || glyph->fImage) {
+            continue;
+        }
+        size_t size = glyph->computeImageSize();
+        glyph->fImage = fGlyphAlloc.alloc(size, SkChunkAlloc::kReturnNil_AllocFailType);
+        if (glyph->fImage) {
+            fMemoryUsed += size;
+            if (NULL == fDiskStrike || !fDiskCache->findImage(fDiskStrike, *glyph)) {
+                *pending.append() = glyph;
+            }
+        }
+    }
+
+    // The first task uses our own scalercontext, the others use their own. Those are only
+    // needed for this call, so they are freed on return rather than counted in fMemoryUsed.
+    int taskCount = 1;
+    SkAutoTDelete<SkScalerContext> contexts[kMaxPrefetchTasks - 1];
+    if (fScalerContext->canGenerateImagesConcurrently()) {
+        int maxTaskCount = SkTMin(kMaxPrefetchTasks,
+                                  pending.count() / kMinPrefetchGlyphsPerTask);
+        for (; taskCount < maxTaskCount; ++taskCount) {
+            contexts[taskCount - 1].reset(
+                    fScalerContext->getTypeface()->createScalerContext(fDesc, true));
+            if (NULL == contexts[taskCount - 1].get()) {
+                break;
+            }
+        }
+    }
+
+    if (taskCount < 2) {
+        for (int i = 0; i < pending.count(); ++i) {
+            fScalerContext->getImage(*pending[i]);
+        }
+    } else {
+        PrefetchTask tasks[kMaxPrefetchTasks];
+        int start = 0;
+        for (int i = 0; i < taskCount; ++i) {
+            int end = (i + 1) * pending.count() / taskCount;
+            tasks[i].fScalerContext = (0 == i) ? fScalerContext : contexts[i - 1].get();
+            tasks[i].fGlyphs = pending.begin() + start;
+            tasks[i].fCount = end - start;
+            start = end;
+        }
+
+        SkTaskGroup tg;
+        tg.batch(prefetch_images, tasks, taskCount);
+        tg.wait();
+    }
+
+    if (fDiskStrike) {
+        for (int i = 0; i < pending.count(); ++i) {
+            fDiskCache->addImage(fDiskStrike, *pending[i]);
+        }
+    }
+}
+
 void SkGlyphCache::dump() const {
     const SkTypeface* face = fScalerContext->getTypeface();
     const SkScalerContextRec& rec = fScalerContext->getRec();
@@ -691,6 +804,7 @@ void SkGlyphCache_Globals::validate() const {
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkTextMeasureCache.h"
 #include "SkTypefaceCache.h"
 
 size_t SkGraphics::GetFontCacheLimit() {
@@ -719,9 +833,19 @@ int SkGraphics::GetFontCacheCountUsed() {
 
 void SkGraphics::PurgeFontCache() {
     getSharedGlobals().purgeAll();
+    SkTextMeasureCache::Purge();
     SkTypefaceCache::PurgeAll();
 }
 
+void SkGraphics::SetFontDiskCache(const char path[], size_t byteLimit) {
+    SkGlyphDiskCache::Set(path, byteLimit);
+}
+
+bool SkGraphics::FlushFontDiskCache() {
+    SkGlyphDiskCache* diskCache = SkGlyphDiskCache::Get();
+    return diskCache ? diskCache->flush() : true;
+}
+
 size_t SkGraphics::GetTLSFontCacheLimit() {
     const SkGlyphCache_Globals* tls = SkGlyphCache_Globals::FindTLS();
     return tls ? tls->getCacheSizeLimit() : 0;
@@ -13,6 +13,7 @@
 #include "SkChunkAlloc.h"
 #include "SkDescriptor.h"
 #include "SkGlyph.h"
+#include "SkGlyphDiskCache.h"
 #include "SkScalerContext.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
@@ -88,6 +89,13 @@ public:
     */
     const SkPath* findPath(const SkGlyph&);
 
+    /** Generate the images for the given glyphs (at subpixel position 0, 0) ahead of
+        findImage(). When enough of them are missing, and the scalercontext can generate
+        images concurrently, they are scaled several at a time on SkTaskGroup threads, each
+        with its own temporary scalercontext. Glyphs that already have an image are skipped.
+    */
+    void prefetchImages(const uint16_t glyphIDs[], int count);
+
     /** Return the vertical metrics for this strike.
     */
     const SkPaint::FontMetrics& getFontMetrics() const {
@@ -197,11 +205,17 @@ private:
     // Return the index of id in the fGlyphArray. If it does
     // not exist, create a new one using MetricsType.
     uint16_t lookupMetrics(uint32_t id, MetricsType type);
+
+    // Fill in the glyph's full metrics, from the disk cache if it has them.
+    void getMetrics(SkGlyph*);
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     SkGlyphCache*        fNext, *fPrev;
     SkDescriptor*        fDesc;
     SkScalerContext*     fScalerContext;
+    // Where glyphs are read from and written to on disk, if anywhere.
+    SkGlyphDiskCache*           fDiskCache;
+    SkGlyphDiskCache::Strike*   fDiskStrike;
     SkPaint::FontMetrics fFontMetrics;
 
     enum {
@@ -0,0 +1,790 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphDiskCache.h"
+
+#include "SkAtomics.h"
+#include "SkChecksum.h"
+#include "SkDescriptor.h"
+#include "SkGlyph.h"
+#include "SkGraphics.h"
+#include "SkPath.h"
+#include "SkScalerContext.h"
+#include "SkStream.h"
+#include "SkTSort.h"
+#include "SkTypeface.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#ifdef SK_BUILD_FOR_WIN
+    #include <io.h>
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+/*  The file is laid out as
+
+        FileHeader
+        FileStrike[fStrikeCount]    sorted by fHash
+        FileGlyph[fGlyphCount]      grouped by strike, sorted by fID within a strike
+        data                        strike keys, images and paths, each 4-byte aligned
+
+    All offsets are from the start of the file, and everything is in native byte order; a file
+    written on a machine with a different layout fails the magic check and is ignored.
+*/
+
+#define kFileMagic      SkSetFourByteTag('s', 'k', 'g', 'd')
+#define kFileVersion    1
+
+struct SkGlyphDiskCache::FileHeader {
+    uint32_t    fMagic;
+    uint32_t    fVersion;
+    uint32_t    fGeneration;    // bumped by every flush, used to age the glyphs
+    uint32_t    fStrikeCount;
+    uint32_t    fGlyphCount;
+    uint32_t    fFileSize;
+};
+
+struct SkGlyphDiskCache::FileStrike {
+    uint32_t    fHash;
+    uint32_t    fKeyOffset;
+    uint32_t    fKeySize;
+    uint32_t    fFirstGlyph;
+    uint32_t    fGlyphCount;
+};
+
+// The parts of SkGlyph the scalercontext fills in when it generates the metrics.
+struct SkGlyphDiskCache::Metrics {
+    SkFixed     fAdvanceX, fAdvanceY;
+    uint16_t    fWidth, fHeight;
+    int16_t     fTop, fLeft;
+    uint8_t     fMaskFormat;
+    int8_t      fRsbDelta, fLsbDelta;
+    int8_t      fForceBW;
+
+    void set(const SkGlyph& glyph) {
+        fAdvanceX = glyph.fAdvanceX;
+        fAdvanceY = glyph.fAdvanceY;
+        fWidth = glyph.fWidth;
+        fHeight = glyph.fHeight;
+        fTop = glyph.fTop;
+        fLeft = glyph.fLeft;
+        fMaskFormat = glyph.fMaskFormat;
+        fRsbDelta = glyph.fRsbDelta;
+        fLsbDelta = glyph.fLsbDelta;
+        fForceBW = glyph.fForceBW;
+    }
+
+    void get(SkGlyph* glyph) const {
+        glyph->fAdvanceX = fAdvanceX;
+        glyph->fAdvanceY = fAdvanceY;
+        glyph->fWidth = fWidth;
+        glyph->fHeight = fHeight;
+        glyph->fTop = fTop;
+        glyph->fLeft = fLeft;
+        glyph->fMaskFormat = fMaskFormat;
+        glyph->fRsbDelta = fRsbDelta;
+        glyph->fLsbDelta = fLsbDelta;
+        glyph->fForceBW = fForceBW;
+    }
+};
+
+struct SkGlyphDiskCache::FileGlyph {
+    uint32_t    fID;
+    uint32_t    fLastUse;       // generation of the flush that last saw this glyph used
+    uint32_t    fImageOffset;
+    uint32_t    fImageSize;     // 0 if the image was never generated
+    uint32_t    fPathOffset;
+    uint32_t    fPathSize;      // 0 if the path was never generated
+    Metrics     fMetrics;
+};
+
+// A glyph generated in this process.
+struct SkGlyphDiskCache::Pending {
+    uint32_t                fID;
+    Metrics                 fMetrics;
+    SkAutoTUnref<SkData>    fImage;
+    SkAutoTUnref<SkData>    fPath;
+};
+
+class SkGlyphDiskCache::Strike {
+public:
+    Strike(uint32_t hash, const void* key, size_t keySize)
+        : fHash(hash)
+        , fKey(SkData::NewWithCopy(key, keySize))
+        , fFileIndex(-1) {}
+
+    ~Strike() { fPending.deleteAll(); }
+
+    bool equals(uint32_t hash, const void* key, size_t keySize) const {
+        return fHash == hash && fKey->size() == keySize && 0 == memcmp(fKey->data(), key, keySize);
+    }
+
+    uint32_t                fHash;
+    SkAutoTUnref<SkData>    fKey;
+    int                     fFileIndex;     // index of our FileStrike, or -1
+    SkTDArray<Pending*>     fPending;       // sorted by fID
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGlyphDiskCache::SkGlyphDiskCache(const char path[], size_t byteLimit)
+    : fPath(path)
+    , fByteLimit(byteLimit)
+    , fHeader(NULL)
+    , fPendingBytes(0)
+    , fHits(0)
+    , fMisses(0) {
+    this->mapFile();
+}
+
+SkGlyphDiskCache::~SkGlyphDiskCache() {
+    fStrikes.deleteAll();
+}
+
+void SkGlyphDiskCache::mapFile() {
+    fHeader = NULL;
+    fTouched.reset();
+    fData.reset(SkData::NewFromFileName(fPath.c_str()));
+    if (NULL == fData.get() || fData->size() < sizeof(FileHeader)) {
+        return;
+    }
+
+    // Check that everything the header and tables point at is inside the file, so lookups
+    // don't have to.
+    const FileHeader* header = (const FileHeader*)fData->data();
+    const size_t size = fData->size();
+    if (header->fMagic != kFileMagic || header->fVersion != kFileVersion ||
+        header->fFileSize != size) {
+        return;
+    }
+    const uint64_t tableSize = sizeof(FileHeader) +
+                               (uint64_t)header->fStrikeCount * sizeof(FileStrike) +
+                               (uint64_t)header->fGlyphCount * sizeof(FileGlyph);
+    if (tableSize > size) {
+        return;
+    }
+    const FileStrike* strikes = (const FileStrike*)(header + 1);
+    const FileGlyph* glyphs = (const FileGlyph*)(strikes + header->fStrikeCount);
+    for (uint32_t i = 0; i < header->fStrikeCount; ++i) {
+        const FileStrike& strike = strikes[i];
+        if ((uint64_t)strike.fKeyOffset + strike.fKeySize > size ||
+            (uint64_t)strike.fFirstGlyph + strike.fGlyphCount > header->fGlyphCount) {
+            return;
+        }
+    }
+    for (uint32_t i = 0; i < header->fGlyphCount; ++i) {
+        const FileGlyph& glyph = glyphs[i];
+        if ((uint64_t)glyph.fImageOffset + glyph.fImageSize > size ||
+            (uint64_t)glyph.fPathOffset + glyph.fPathSize > size) {
+            return;
+        }
+    }
+
+    fHeader = header;
+    fTouched.setCount(header->fGlyphCount);
+    sk_bzero(fTouched.begin(), fTouched.count());
+}
+
+const SkGlyphDiskCache::FileStrike* SkGlyphDiskCache::fileStrikes() const {
+    SkASSERT(fHeader);
+    return (const FileStrike*)(fHeader + 1);
+}
+
+const SkGlyphDiskCache::FileGlyph* SkGlyphDiskCache::fileGlyphs() const {
+    return (const FileGlyph*)(this->fileStrikes() + fHeader->fStrikeCount);
+}
+
+SkGlyphDiskCache::Strike* SkGlyphDiskCache::findStrike(const SkDescriptor* desc,
+                                                       SkTypeface* typeface) {
+    uint32_t recSize;
+    const void* recData = desc->findEntry(kRec_SkDescriptorTag, &recSize);
+    if (1 != desc->getCount() || NULL == recData || recSize != sizeof(SkScalerContext::Rec) ||
+        NULL == typeface) {
+        return NULL;
+    }
+
+    // The 'head' table holds the font's revision, dates and whole-file checksum, so it tells
+    // fonts apart far more reliably than their names do.
+    const SkFontTableTag headTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    const size_t headSize = typeface->getTableSize(headTag);
+    if (0 == headSize) {
+        return NULL;
+    }
+    SkString familyName;
+    typeface->getFamilyName(&familyName);
+    SkAutoSTMalloc<64, uint8_t> fingerprint(headSize + familyName.size());
+    typeface->getTableData(headTag, 0, headSize, fingerprint.get());
+    memcpy(fingerprint.get() + headSize, familyName.c_str(), familyName.size());
+
+    SkScalerContext::Rec rec;
+    memcpy(&rec, recData, sizeof(rec));
+    rec.fFontID = SkChecksum::Murmur3(fingerprint.get(), headSize + familyName.size());
+    const uint32_t hash = SkChecksum::Murmur3(&rec, sizeof(rec));
+
+    SkAutoMutexAcquire lock(fMutex);
+    for (int i = 0; i < fStrikes.count(); ++i) {
+        if (fStrikes[i]->equals(hash, &rec, sizeof(rec))) {
+            return fStrikes[i];
+        }
+    }
+    Strike* strike = SkNEW_ARGS(Strike, (hash, &rec, sizeof(rec)));
+    strike->fFileIndex = this->findFileStrike(strike);
+    *fStrikes.append() = strike;
+    return strike;
+}
+
+int SkGlyphDiskCache::findFileStrike(const Strike* strike) const {
+    if (NULL == fHeader) {
+        return -1;
+    }
+    const FileStrike* strikes = this->fileStrikes();
+    int lo = 0;
+    int hi = fHeader->fStrikeCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (strikes[mid].fHash < strike->fHash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const char* base = (const char*)fData->data();
+    for (; lo < (int)fHeader->fStrikeCount && strikes[lo].fHash == strike->fHash; ++lo) {
+        if (strike->equals(strikes[lo].fHash, base + strikes[lo].fKeyOffset,
+                           strikes[lo].fKeySize)) {
+            return lo;
+        }
+    }
+    return -1;
+}
+
+const SkGlyphDiskCache::FileGlyph* SkGlyphDiskCache::findFileGlyph(const Strike* strike,
+                                                                   uint32_t id) {
+    if (NULL == fHeader || strike->fFileIndex < 0) {
+        return NULL;
+    }
+    const FileStrike& fileStrike = this->fileStrikes()[strike->fFileIndex];
+    const FileGlyph* glyphs = this->fileGlyphs() + fileStrike.fFirstGlyph;
+    int lo = 0;
+    int hi = fileStrike.fGlyphCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (glyphs[mid].fID < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < (int)fileStrike.fGlyphCount && glyphs[lo].fID == id) {
+        fTouched[fileStrike.fFirstGlyph + lo] = 1;
+        return &glyphs[lo];
+    }
+    return NULL;
+}
+
+// Returns the index of the first pending glyph with an ID no less than id.
+template <typename T> static int lower_bound(const SkTDArray<T*>& pending, uint32_t id);
+
+SkGlyphDiskCache::Pending* SkGlyphDiskCache::FindPending(const Strike* strike, uint32_t id) {
+    int index = lower_bound(strike->fPending, id);
+    if (index < strike->fPending.count() && strike->fPending[index]->fID == id) {
+        return strike->fPending[index];
+    }
+    return NULL;
+}
+
+template <typename T> static int lower_bound(const SkTDArray<T*>& pending, uint32_t id) {
+    int lo = 0;
+    int hi = pending.count();
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (pending[mid]->fID < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+SkGlyphDiskCache::Pending* SkGlyphDiskCache::findOrCreatePending(Strike* strike,
+                                                                 const SkGlyph& glyph) {
+    const uint32_t id = glyph.fID;
+    int index = lower_bound(strike->fPending, id);
+    Pending* pending;
+    if (index < strike->fPending.count() && strike->fPending[index]->fID == id) {
+        pending = strike->fPending[index];
+    } else {
+        pending = SkNEW(Pending);
+        pending->fID = id;
+        *strike->fPending.insert(index) = pending;
+        fPendingBytes += sizeof(FileGlyph);
+    }
+    pending->fMetrics.set(glyph);
+    return pending;
+}
+
+bool SkGlyphDiskCache::findMetrics(Strike* strike, SkGlyph* glyph) {
+    SkAutoMutexAcquire lock(fMutex);
+    const uint32_t id = glyph->fID;
+    if (const Pending* pending = FindPending(strike, id)) {
+        pending->fMetrics.get(glyph);
+        ++fHits;
+        return true;
+    }
+    if (const FileGlyph* fileGlyph = this->findFileGlyph(strike, id)) {
+        fileGlyph->fMetrics.get(glyph);
+        ++fHits;
+        return true;
+    }
+    ++fMisses;
+    return false;
+}
+
+bool SkGlyphDiskCache::findImage(Strike* strike, const SkGlyph& glyph) {
+    SkASSERT(glyph.fImage);
+    SkAutoMutexAcquire lock(fMutex);
+    const size_t size = glyph.computeImageSize();
+    const uint32_t id = glyph.fID;
+    const Pending* pending = FindPending(strike, id);
+    if (pending && pending->fImage.get()) {
+        const SkData* image = pending->fImage;
+        if (image->size() == size) {
+            memcpy(glyph.fImage, image->data(), size);
+            ++fHits;
+            return true;
+        }
+    }
+    const FileGlyph* fileGlyph = this->findFileGlyph(strike, id);
+    if (fileGlyph && fileGlyph->fImageSize == size) {
+        memcpy(glyph.fImage, fData->bytes() + fileGlyph->fImageOffset, size);
+        ++fHits;
+        return true;
+    }
+    ++fMisses;
+    return false;
+}
+
+bool SkGlyphDiskCache::findPath(Strike* strike, const SkGlyph& glyph, SkPath* path) {
+    SkAutoMutexAcquire lock(fMutex);
+    const uint32_t id = glyph.fID;
+    const Pending* pending = FindPending(strike, id);
+    if (pending && pending->fPath.get()) {
+        const SkData* data = pending->fPath;
+        if (path->readFromMemory(data->data(), data->size())) {
+            ++fHits;
+            return true;
+        }
+    }
+    const FileGlyph* fileGlyph = this->findFileGlyph(strike, id);
+    if (fileGlyph && fileGlyph->fPathSize &&
+        path->readFromMemory(fData->bytes() + fileGlyph->fPathOffset, fileGlyph->fPathSize)) {
+        ++fHits;
+        return true;
+    }
+    ++fMisses;
+    return false;
+}
+
+void SkGlyphDiskCache::addMetrics(Strike* strike, const SkGlyph& glyph) {
+    SkAutoMutexAcquire lock(fMutex);
+    if (fPendingBytes < fByteLimit) {
+        this->findOrCreatePending(strike, glyph);
+    }
+}
+
+void SkGlyphDiskCache::addImage(Strike* strike, const SkGlyph& glyph) {
+    SkASSERT(glyph.fImage);
+    SkAutoMutexAcquire lock(fMutex);
+    const size_t size = glyph.computeImageSize();
+    if (fPendingBytes + size < fByteLimit) {
+        Pending* pending = this->findOrCreatePending(strike, glyph);
+        if (NULL == pending->fImage.get()) {
+            pending->fImage.reset(SkData::NewWithCopy(glyph.fImage, size));
+            fPendingBytes += size;
+        }
+    }
+}
+
+void SkGlyphDiskCache::addPath(Strike* strike, const SkGlyph& glyph) {
+    SkASSERT(glyph.fPath);
+    SkAutoMutexAcquire lock(fMutex);
+    const size_t size = glyph.fPath->writeToMemory(NULL);
+    if (fPendingBytes + size < fByteLimit) {
+        Pending* pending = this->findOrCreatePending(strike, glyph);
+        if (NULL == pending->fPath.get()) {
+            SkData* data = SkData::NewUninitialized(size);
+            glyph.fPath->writeToMemory(data->writable_data());
+            pending->fPath.reset(data);
+            fPendingBytes += size;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A glyph to write out, from the mapped file, this process, or both.
+struct SkGlyphDiskCache::OutGlyph {
+    int         fStrike;        // index into the flush's strike list
+    uint32_t    fID;
+    uint32_t    fLastUse;
+    const Metrics* fMetrics;
+    const void* fImage;
+    uint32_t    fImageSize;
+    const void* fPath;
+    uint32_t    fPathSize;
+
+    size_t fileSize() const {
+        return sizeof(FileGlyph) + SkAlign4(fImageSize) + SkAlign4(fPathSize);
+    }
+};
+
+struct SkGlyphDiskCache::OutStrike {
+    uint32_t    fHash;
+    const void* fKey;
+    uint32_t    fKeySize;
+    int         fFirstGlyph;    // where the strike's glyphs from the file start
+    int         fGlyphCount;    // how many of the strike's glyphs are kept
+};
+
+// Most recently used first.
+struct SkGlyphDiskCache::LastUseGreater {
+    bool operator()(const OutGlyph* a, const OutGlyph* b) const {
+        return a->fLastUse > b->fLastUse;
+    }
+};
+
+// The order glyphs are laid out in the file: by strike hash, then strike, then ID.
+struct SkGlyphDiskCache::FileOrderLess {
+    explicit FileOrderLess(const SkTDArray<OutStrike>& strikes) : fStrikes(strikes) {}
+
+    bool operator()(const OutGlyph* a, const OutGlyph* b) const {
+        const uint32_t hashA = fStrikes[a->fStrike].fHash;
+        const uint32_t hashB = fStrikes[b->fStrike].fHash;
+        if (hashA != hashB) {
+            return hashA < hashB;
+        }
+        if (a->fStrike != b->fStrike) {
+            return a->fStrike < b->fStrike;
+        }
+        return a->fID < b->fID;
+    }
+
+    const SkTDArray<OutStrike>& fStrikes;
+};
+
+/*  Creates and opens a new file next to path, named after this process and a counter, for
+    writing a new cache file into. It is created exclusively, so that processes and threads
+    flushing at the same time never write into the same file. Returns NULL on failure.
+*/
+static FILE* create_tmp_file(const SkString& path, SkString* tmpPath) {
+    static int32_t gTmpFileCount;
+#ifdef SK_BUILD_FOR_WIN
+    const int pid = _getpid();
+#else
+    const int pid = getpid();
+#endif
+    // A file left behind by a process that died mid-flush may have the same name; skip it.
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        tmpPath->printf("%s.%d.%d.tmp", path.c_str(), pid, sk_atomic_inc(&gTmpFileCount));
+#ifdef SK_BUILD_FOR_WIN
+        const int fd = _open(tmpPath->c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY,
+                             _S_IREAD | _S_IWRITE);
+#else
+        const int fd = open(tmpPath->c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+#endif
+        if (fd < 0) {
+            if (EEXIST == errno) {
+                continue;
+            }
+            return NULL;
+        }
+#ifdef SK_BUILD_FOR_WIN
+        FILE* file = _fdopen(fd, "wb");
+        if (NULL == file) {
+            _close(fd);
+        }
+#else
+        FILE* file = fdopen(fd, "wb");
+        if (NULL == file) {
+            close(fd);
+        }
+#endif
+        if (NULL == file) {
+            remove(tmpPath->c_str());
+        }
+        return file;
+    }
+    return NULL;
+}
+
+// Writes to a FILE* that the caller opened, and closes it.
+class TmpFileWStream : public SkWStream {
+public:
+    explicit TmpFileWStream(FILE* file) : fFILE(file), fBytesWritten(0), fOK(true) {}
+    ~TmpFileWStream() {
+        if (fFILE) {
+            fclose(fFILE);
+        }
+    }
+
+    bool write(const void* buffer, size_t size) override {
+        if (size > 0 && fOK) {
+            fOK = 1 == fwrite(buffer, size, 1, fFILE);
+            fBytesWritten += fOK ? size : 0;
+        }
+        return fOK;
+    }
+
+    size_t bytesWritten() const override { return fBytesWritten; }
+
+    // Returns false if any write, or closing the file, failed.
+    bool close() {
+        fOK = 0 == fclose(fFILE) && fOK;
+        fFILE = NULL;
+        return fOK;
+    }
+
+private:
+    FILE*   fFILE;
+    size_t  fBytesWritten;
+    bool    fOK;
+};
+
+bool SkGlyphDiskCache::flush() {
+    SkAutoMutexAcquire lock(fMutex);
+
+    const uint32_t generation = fHeader ? fHeader->fGeneration + 1 : 1;
+
+    // Gather the glyphs in the file, noting which of them were used since it was mapped...
+    SkTDArray<OutStrike> strikes;
+    SkTDArray<OutGlyph> glyphs;
+    if (fHeader) {
+        const FileStrike* fileStrikes = this->fileStrikes();
+        const FileGlyph* fileGlyphs = this->fileGlyphs();
+        for (uint32_t i = 0; i < fHeader->fStrikeCount; ++i) {
+            const FileStrike& fileStrike = fileStrikes[i];
+            OutStrike* strike = strikes.append();
+            strike->fHash = fileStrike.fHash;
+            strike->fKey = fData->bytes() + fileStrike.fKeyOffset;
+            strike->fKeySize = fileStrike.fKeySize;
+            strike->fFirstGlyph = glyphs.count();
+            for (uint32_t j = 0; j < fileStrike.fGlyphCount; ++j) {
+                const uint32_t index = fileStrike.fFirstGlyph + j;
+                const FileGlyph& fileGlyph = fileGlyphs[index];
+                OutGlyph* glyph = glyphs.append();
+                glyph->fStrike = i;
+                glyph->fID = fileGlyph.fID;
+                glyph->fLastUse = fTouched[index] ? generation : fileGlyph.fLastUse;
+                glyph->fMetrics = &fileGlyph.fMetrics;
+                glyph->fImage = fData->bytes() + fileGlyph.fImageOffset;
+                glyph->fImageSize = fileGlyph.fImageSize;
+                glyph->fPath = fData->bytes() + fileGlyph.fPathOffset;
+                glyph->fPathSize = fileGlyph.fPathSize;
+            }
+        }
+    }
+
+    // ... then merge in the ones generated by this process.
+    for (int i = 0; i < fStrikes.count(); ++i) {
+        const Strike* strike = fStrikes[i];
+        if (0 == strike->fPending.count()) {
+            continue;
+        }
+        int strikeIndex = strike->fFileIndex;
+        int fileGlyph = 0;
+        int fileGlyphEnd = 0;
+        if (strikeIndex >= 0) {
+            fileGlyph = strikes[strikeIndex].fFirstGlyph;
+            fileGlyphEnd = fileGlyph + this->fileStrikes()[strikeIndex].fGlyphCount;
+        } else {
+            strikeIndex = strikes.count();
+            OutStrike* outStrike = strikes.append();
+            outStrike->fHash = strike->fHash;
+            outStrike->fKey = strike->fKey->data();
+            outStrike->fKeySize = SkToU32(strike->fKey->size());
+        }
+        // Both the pending glyphs and the strike's glyphs in the file are sorted by ID.
+        for (int j = 0; j < strike->fPending.count(); ++j) {
+            const Pending* pending = strike->fPending[j];
+            while (fileGlyph < fileGlyphEnd && glyphs[fileGlyph].fID < pending->fID) {
+                ++fileGlyph;
+            }
+            OutGlyph* glyph;
+            if (fileGlyph < fileGlyphEnd && glyphs[fileGlyph].fID == pending->fID) {
+                glyph = &glyphs[fileGlyph];
+            } else {
+                glyph = glyphs.append();
+                glyph->fStrike = strikeIndex;
+                glyph->fID = pending->fID;
+                glyph->fImageSize = glyph->fPathSize = 0;
+                glyph->fImage = glyph->fPath = NULL;
+            }
+            glyph->fLastUse = generation;
+            glyph->fMetrics = &pending->fMetrics;
+            if (pending->fImage.get()) {
+                glyph->fImage = pending->fImage->data();
+                glyph->fImageSize = SkToU32(pending->fImage->size());
+            }
+            if (pending->fPath.get()) {
+                glyph->fPath = pending->fPath->data();
+                glyph->fPathSize = SkToU32(pending->fPath->size());
+            }
+        }
+    }
+
+    // Keep the most recently used glyphs that fit under the limit. Strikes are counted as if
+    // all of them were kept.
+    size_t fileSize = sizeof(FileHeader);
+    for (int i = 0; i < strikes.count(); ++i) {
+        fileSize += sizeof(FileStrike) + SkAlign4(strikes[i].fKeySize);
+        strikes[i].fGlyphCount = 0;
+    }
+    SkTDArray<OutGlyph*> kept;
+    kept.setReserve(glyphs.count());
+    for (int i = 0; i < glyphs.count(); ++i) {
+        *kept.append() = &glyphs[i];
+    }
+    if (kept.count() > 1) {
+        SkTQSort(kept.begin(), kept.end() - 1, LastUseGreater());
+    }
+    int keptCount = 0;
+    while (keptCount < kept.count() && fileSize + kept[keptCount]->fileSize() <= fByteLimit) {
+        fileSize += kept[keptCount]->fileSize();
+        ++keptCount;
+    }
+    kept.setCount(keptCount);
+
+    // Lay the survivors out by strike hash, then strike, then ID.
+    if (kept.count() > 1) {
+        SkTQSort(kept.begin(), kept.end() - 1, FileOrderLess(strikes));
+    }
+    for (int i = 0; i < kept.count(); ++i) {
+        strikes[kept[i]->fStrike].fGlyphCount += 1;
+    }
+
+    // Work out where everything goes.
+    SkTDArray<FileStrike> outStrikes;
+    SkTDArray<FileGlyph> outGlyphs;
+    outGlyphs.setCount(kept.count());
+    uint32_t strikeCount = 0;
+    for (int i = 0; i < kept.count(); ++i) {
+        if (0 == i || kept[i]->fStrike != kept[i - 1]->fStrike) {
+            ++strikeCount;
+        }
+    }
+    uint32_t offset = SkToU32(sizeof(FileHeader) + strikeCount * sizeof(FileStrike) +
+                              kept.count() * sizeof(FileGlyph));
+    for (int i = 0; i < kept.count(); ++i) {
+        const OutGlyph& glyph = *kept[i];
+        if (0 == i || glyph.fStrike != kept[i - 1]->fStrike) {
+            const OutStrike& strike = strikes[glyph.fStrike];
+            FileStrike* outStrike = outStrikes.append();
+            outStrike->fHash = strike.fHash;
+            outStrike->fKeyOffset = offset;
+            outStrike->fKeySize = strike.fKeySize;
+            outStrike->fFirstGlyph = i;
+            outStrike->fGlyphCount = strike.fGlyphCount;
+            offset += SkAlign4(strike.fKeySize);
+        }
+        FileGlyph& outGlyph = outGlyphs[i];
+        outGlyph.fID = glyph.fID;
+        outGlyph.fLastUse = glyph.fLastUse;
+        outGlyph.fMetrics = *glyph.fMetrics;
+        outGlyph.fImageOffset = offset;
+        outGlyph.fImageSize = glyph.fImageSize;
+        offset += SkAlign4(glyph.fImageSize);
+        outGlyph.fPathOffset = offset;
+        outGlyph.fPathSize = glyph.fPathSize;
+        offset += SkAlign4(glyph.fPathSize);
+    }
+
+    FileHeader header;
+    header.fMagic = kFileMagic;
+    header.fVersion = kFileVersion;
+    header.fGeneration = generation;
+    header.fStrikeCount = strikeCount;
+    header.fGlyphCount = kept.count();
+    header.fFileSize = offset;
+
+    // Write a new file and swap it in, so that other processes only ever map complete files.
+    SkString tmpPath;
+    FILE* tmpFile = create_tmp_file(fPath, &tmpPath);
+    if (NULL == tmpFile) {
+        return false;
+    }
+    {
+        TmpFileWStream stream(tmpFile);
+        static const uint32_t kZero = 0;
+        bool ok = stream.write(&header, sizeof(header)) &&
+                  stream.write(outStrikes.begin(), outStrikes.bytes()) &&
+                  stream.write(outGlyphs.begin(), outGlyphs.bytes());
+        for (int i = 0; ok && i < kept.count(); ++i) {
+            const OutGlyph& glyph = *kept[i];
+            if (0 == i || glyph.fStrike != kept[i - 1]->fStrike) {
+                const OutStrike& strike = strikes[glyph.fStrike];
+                ok = stream.write(strike.fKey, strike.fKeySize) &&
+                     stream.write(&kZero, SkAlign4(strike.fKeySize) - strike.fKeySize);
+            }
+            ok = ok && stream.write(glyph.fImage, glyph.fImageSize) &&
+                 stream.write(&kZero, SkAlign4(glyph.fImageSize) - glyph.fImageSize) &&
+                 stream.write(glyph.fPath, glyph.fPathSize) &&
+                 stream.write(&kZero, SkAlign4(glyph.fPathSize) - glyph.fPathSize);
+        }
+        ok = stream.close() && ok && stream.bytesWritten() == header.fFileSize;
+        if (!ok) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (0 != rename(tmpPath.c_str(), fPath.c_str())) {
+        // Windows won't rename over an existing file.
+        remove(fPath.c_str());
+        if (0 != rename(tmpPath.c_str(), fPath.c_str())) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    // Everything pending is in the file now.
+    for (int i = 0; i < fStrikes.count(); ++i) {
+        fStrikes[i]->fPending.deleteAll();
+        fStrikes[i]->fPending.reset();
+    }
+    fPendingBytes = 0;
+    this->mapFile();
+    for (int i = 0; i < fStrikes.count(); ++i) {
+        fStrikes[i]->fFileIndex = this->findFileStrike(fStrikes[i]);
+    }
+    return true;
+}
+
+void SkGlyphDiskCache::getStats(Stats* stats) const {
+    SkAutoMutexAcquire lock(fMutex);
+    stats->fHits = fHits;
+    stats->fMisses = fMisses;
+    stats->fGlyphsOnDisk = fHeader ? fHeader->fGlyphCount : 0;
+    stats->fBytesOnDisk = fHeader ? fHeader->fFileSize : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SkGlyphDiskCache* gGlyphDiskCache;
+
+SkGlyphDiskCache* SkGlyphDiskCache::Get() {
+    return gGlyphDiskCache;
+}
+
+void SkGlyphDiskCache::Set(const char path[], size_t byteLimit) {
+    SkGraphics::PurgeFontCache();
+    SkDELETE(gGlyphDiskCache);
+    gGlyphDiskCache = path ? SkNEW_ARGS(SkGlyphDiskCache, (path, byteLimit)) : NULL;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphDiskCache_DEFINED
+#define SkGlyphDiskCache_DEFINED
+
+#include "SkData.h"
+#include "SkMutex.h"
+#include "SkString.h"
+#include "SkTDArray.h"
+
+class SkDescriptor;
+class SkPath;
+class SkTypeface;
+class SkGlyph;
+
+/**
+ *  A second level store beneath SkGlyphCache that keeps glyph metrics, images and paths in a
+ *  file, so that they survive from one process to the next.
+ *
+ *  The file is memory mapped when the store is created, so that is all it costs at startup.
+ *  Glyphs the scalercontexts generate afterwards are held in memory until flush(), which
+ *  rewrites the file, dropping the glyphs that were used least recently to stay under the
+ *  byte limit.
+ *
+ *  Glyphs are keyed by a checksum of their strike's scalercontext rec plus their packed ID. The
+ *  rec's font ID only means something in this process, so it is replaced by a fingerprint of the
+ *  typeface's 'head' table and family name. Strikes with path effects, mask filters or
+ *  rasterizers, and typefaces without a 'head' table, are not stored.
+ *
+ *  All of the methods are thread safe.
+ */
+class SkGlyphDiskCache : SkNoncopyable {
+public:
+    SkGlyphDiskCache(const char path[], size_t byteLimit);
+    ~SkGlyphDiskCache();
+
+    /** The glyphs of one strike. Strikes are owned by the store. */
+    class Strike;
+
+    /**
+     *  Return the strike for this descriptor, creating it if needed, or NULL if its glyphs
+     *  can't be stored.
+     */
+    Strike* findStrike(const SkDescriptor*, SkTypeface*);
+
+    /**
+     *  If the store has the glyph, these copy its metrics, image (into the already allocated
+     *  glyph.fImage) or path and return true.
+     */
+    bool findMetrics(Strike*, SkGlyph*);
+    bool findImage(Strike*, const SkGlyph&);
+    bool findPath(Strike*, const SkGlyph&, SkPath*);
+
+    /** Remember a glyph generated by the strike's scalercontext, to be written by flush(). */
+    void addMetrics(Strike*, const SkGlyph&);
+    void addImage(Strike*, const SkGlyph&);
+    void addPath(Strike*, const SkGlyph&);
+
+    /**
+     *  Write out the file and map it again. Returns false if the file couldn't be written, in
+     *  which case the glyphs added since the last flush are kept for the next try.
+     */
+    bool flush();
+
+    struct Stats {
+        int     fHits;          //!< lookups answered by the store
+        int     fMisses;        //!< lookups the scalercontext had to answer
+        int     fGlyphsOnDisk;  //!< glyphs in the mapped file
+        size_t  fBytesOnDisk;   //!< size of the mapped file
+    };
+    void getStats(Stats*) const;
+
+    /**
+     *  The store used by every SkGlyphCache, or NULL. Set() purges the font cache, so that no
+     *  SkGlyphCache refers to the previous store, and should be called before text is drawn on
+     *  other threads. Passing a NULL path turns the store off.
+     */
+    static SkGlyphDiskCache* Get();
+    static void Set(const char path[], size_t byteLimit);
+
+private:
+    struct FileHeader;
+    struct FileStrike;
+    struct FileGlyph;
+    struct Metrics;
+    struct Pending;
+    struct OutStrike;
+    struct OutGlyph;
+    struct LastUseGreater;
+    struct FileOrderLess;
+
+    void mapFile();
+    const FileStrike* fileStrikes() const;
+    const FileGlyph* fileGlyphs() const;
+    int findFileStrike(const Strike*) const;
+    const FileGlyph* findFileGlyph(const Strike*, uint32_t id);
+    static Pending* FindPending(const Strike*, uint32_t id);
+    Pending* findOrCreatePending(Strike*, const SkGlyph&);
+
+    mutable SkMutex         fMutex;
+    SkString                fPath;
+    size_t                  fByteLimit;
+    SkAutoTUnref<SkData>    fData;
+    const FileHeader*       fHeader;    // NULL if there is no usable file
+    SkTDArray<uint8_t>      fTouched;   // one per glyph in the file, set when it is used
+    SkTDArray<Strike*>      fStrikes;
+    size_t                  fPendingBytes;
+    int                     fHits;
+    int                     fMisses;
+};
+
+#endif  // SkGlyphDiskCache_DEFINED
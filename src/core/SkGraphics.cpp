@@ -126,6 +126,7 @@ void SkGraphics::Init() {
 }
 
 void SkGraphics::Term() {
+    FlushFontDiskCache();
     PurgeFontCache();
     PurgeResourceCache();
     SkPaint::Term();
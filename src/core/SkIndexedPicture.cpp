@@ -0,0 +1,127 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkIndexedPicture.h"
+#include "SkAtomics.h"
+#include "SkPictureCommon.h"
+#include "SkPictureData.h"
+#include "SkPicturePlayback.h"
+#include "SkReader32.h"
+#include "SkRecord.h"
+#include "SkRecorder.h"
+
+static bool is_text_op(DrawType op) {
+    switch (op) {
+        case DRAW_POS_TEXT:
+        case DRAW_POS_TEXT_TOP_BOTTOM:
+        case DRAW_POS_TEXT_H:
+        case DRAW_POS_TEXT_H_TOP_BOTTOM:
+        case DRAW_TEXT:
+        case DRAW_TEXT_BLOB:
+        case DRAW_TEXT_ON_PATH:
+        case DRAW_TEXT_TOP_BOTTOM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+SkIndexedPicture* SkIndexedPicture::Create(const SkPictureData* data) {
+    SkAutoTDelete<const SkPictureData> owned(data);
+    SkASSERT(data->opBlocks().count() > 0);
+
+    // Only the op codes and sizes are read here; the ops themselves are read by playback().
+    // Playback jumps from a block's start to its stop, so both have to be op boundaries, and
+    // a block may only skip ops that change no canvas state.
+    const SkTDArray<SkPictureOpBlock>& blocks = data->opBlocks();
+    int nextBlock = 0;
+    bool inBlock = false;
+    int opCount = 0;
+    bool hasText = false;
+    SkReader32 reader(data->opData()->bytes(), data->opData()->size());
+    while (!reader.eof()) {
+        const size_t start = reader.offset();
+        uint32_t size;
+        DrawType op = SkPicturePlayback::ReadOpAndSize(&reader, &size);
+        if (size < 4 || size > reader.size() - start) {
+            return NULL;
+        }
+        const size_t stop = start + size;
+        if (!inBlock && nextBlock < blocks.count()) {
+            if (blocks[nextBlock].fStart < start) {
+                return NULL;
+            }
+            inBlock = blocks[nextBlock].fStart == start;
+        }
+        if (inBlock) {
+            if (!SkPicturePlayback::IsDrawOp(op) || stop > blocks[nextBlock].fStop) {
+                return NULL;
+            }
+            if (stop == blocks[nextBlock].fStop) {
+                inBlock = false;
+                nextBlock++;
+            }
+        }
+        opCount++;
+        hasText = hasText || is_text_op(op);
+        reader.setOffset(stop);
+    }
+    if (nextBlock != blocks.count()) {
+        return NULL;
+    }
+    for (int i = 0; !hasText && i < data->pictureCount(); ++i) {
+        hasText = data->picture(i)->hasText();
+    }
+    return SkNEW_ARGS(SkIndexedPicture, (owned.detach(), opCount, hasText));
+}
+
+SkIndexedPicture::SkIndexedPicture(const SkPictureData* data, int opCount, bool hasText)
+    : fData(data)
+    , fOpCount(opCount)
+    , fNumSlowPaths(-1)
+    , fHasText(hasText) {}
+
+void SkIndexedPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkASSERT(canvas);
+
+    SkPicturePlayback playback(fData);
+    playback.draw(canvas, callback);
+}
+
+SkRect SkIndexedPicture::cullRect()            const { return fData->info().fCullRect; }
+bool   SkIndexedPicture::hasText()             const { return fHasText; }
+bool   SkIndexedPicture::willPlayBackBitmaps() const { return fData->containsBitmaps(); }
+int    SkIndexedPicture::approximateOpCount()  const { return fOpCount; }
+
+int SkIndexedPicture::numSlowPaths() const {
+    int32_t numSlowPaths = sk_atomic_load(&fNumSlowPaths, sk_memory_order_relaxed);
+    if (numSlowPaths < 0) {
+        // Count them the same way SkBigPicture does, from a record that is only kept for this.
+        // Only GPU rasterization asks, so loading doesn't pay for this. Racing threads just
+        // count the same number.
+        SkRecord record;
+        SkRecorder recorder(&record, fData->info().fCullRect);
+        SkPicturePlayback playback(fData);
+        playback.draw(&recorder, NULL);
+        SkPathCounter counter;
+        for (unsigned i = 0; i < record.count(); ++i) {
+            record.visit<void>(i, counter);
+        }
+        numSlowPaths = counter.fNumSlowPathsAndDashEffects;
+        sk_atomic_store(&fNumSlowPaths, numSlowPaths, sk_memory_order_relaxed);
+    }
+    return numSlowPaths;
+}
+
+size_t SkIndexedPicture::approximateBytesUsed() const {
+    size_t bytes = sizeof(*this) + sizeof(SkPictureData) + fData->opData()->size() +
+                   fData->opBlocks().bytes();
+    for (int i = 0; i < fData->pictureCount(); ++i) {
+        bytes += fData->picture(i)->approximateBytesUsed();
+    }
+    return bytes;
+}
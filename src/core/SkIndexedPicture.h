@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkIndexedPicture_DEFINED
+#define SkIndexedPicture_DEFINED
+
+#include "SkPicture.h"
+#include "SkTemplates.h"
+
+class SkPictureData;
+
+// An implementation of SkPicture that plays a deserialized SkPictureData back directly, instead of
+// recording it into an SkRecord first.  The data has an op index, so playback only reads the ops
+// of the blocks that intersect the clip.
+class SkIndexedPicture final : public SkPicture {
+public:
+    // We take ownership.  Returns NULL, and deletes the data, if its op index does not match its
+    // ops: every block must start and end on op boundaries, and hold only draw ops.
+    static SkIndexedPicture* Create(const SkPictureData*);
+
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override;
+    bool hasText() const override;
+    bool willPlayBackBitmaps() const override;
+    int approximateOpCount() const override;
+    size_t approximateBytesUsed() const override;
+
+private:
+    SkIndexedPicture(const SkPictureData*, int opCount, bool hasText);
+
+    int numSlowPaths() const override;
+
+    SkAutoTDelete<const SkPictureData> fData;
+    int                                fOpCount;
+    mutable int32_t                    fNumSlowPaths;  // -1 until numSlowPaths() counts them.
+    bool                               fHasText;
+};
+
+#endif//SkIndexedPicture_DEFINED
@@ -181,3 +181,99 @@ void SkMaskCache::Add(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality,
     RectsBlurKey key(sigma, style, quality, rects, count);
     return CHECK_LOCAL(localCache, add, Add, SkNEW_ARGS(RectsBlurRec, (key, mask, data)));
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SkPath.h"
+#include "SkStrokeRec.h"
+
+namespace {
+static unsigned gPathMaskKeyNamespaceLabel;
+
+struct PathMaskKey : public SkResourceCache::Key {
+public:
+    PathMaskKey(const SkPath& path, const SkMatrix& matrix, const SkStrokeRec& stroke)
+        : fGenID(path.getGenerationID())
+        , fFillType(path.getFillType())
+        , fStyle(stroke.getStyle())
+        , fCap(stroke.getCap())
+        , fJoin(stroke.getJoin())
+        , fStrokeWidth(stroke.getWidth())
+        , fMiter(stroke.getMiter())
+    {
+        SkASSERT(!matrix.hasPerspective());
+        fMatrix[0] = matrix.getScaleX();
+        fMatrix[1] = matrix.getSkewX();
+        fMatrix[2] = matrix.getTranslateX();
+        fMatrix[3] = matrix.getSkewY();
+        fMatrix[4] = matrix.getScaleY();
+        fMatrix[5] = matrix.getTranslateY();
+
+        this->init(&gPathMaskKeyNamespaceLabel, 0,
+                   sizeof(fGenID) + sizeof(fFillType) + sizeof(fStyle) + sizeof(fCap) +
+                   sizeof(fJoin) + sizeof(fStrokeWidth) + sizeof(fMiter) + sizeof(fMatrix));
+    }
+
+    uint32_t    fGenID;
+    int32_t     fFillType;
+    int32_t     fStyle;
+    int32_t     fCap;
+    int32_t     fJoin;
+    SkScalar    fStrokeWidth;
+    SkScalar    fMiter;
+    SkScalar    fMatrix[6];
+};
+
+struct PathMaskRec : public SkResourceCache::Rec {
+    PathMaskRec(const PathMaskKey& key, const SkMask& mask, SkCachedData* data)
+        : fKey(key)
+    {
+        fValue.fMask = mask;
+        fValue.fData = data;
+        fValue.fData->attachToCacheAndRef();
+    }
+    ~PathMaskRec() {
+        fValue.fData->detachFromCacheAndUnref();
+    }
+
+    PathMaskKey    fKey;
+    MaskValue      fValue;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fValue.fData->size(); }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const PathMaskRec& rec = static_cast<const PathMaskRec&>(baseRec);
+        MaskValue* result = static_cast<MaskValue*>(contextData);
+
+        SkCachedData* tmpData = rec.fValue.fData;
+        tmpData->ref();
+        if (NULL == tmpData->data()) {
+            tmpData->unref();
+            return false;
+        }
+        *result = rec.fValue;
+        return true;
+    }
+};
+} // namespace
+
+SkCachedData* SkMaskCache::FindAndRef(const SkPath& path, const SkMatrix& matrix,
+                                      const SkStrokeRec& stroke, SkMask* mask,
+                                      SkResourceCache* localCache) {
+    MaskValue result;
+    PathMaskKey key(path, matrix, stroke);
+    if (!CHECK_LOCAL(localCache, find, Find, key, PathMaskRec::Visitor, &result)) {
+        return NULL;
+    }
+
+    *mask = result.fMask;
+    mask->fImage = (uint8_t*)(result.fData->data());
+    return result.fData;
+}
+
+void SkMaskCache::Add(const SkPath& path, const SkMatrix& matrix, const SkStrokeRec& stroke,
+                      const SkMask& mask, SkCachedData* data, SkResourceCache* localCache) {
+    PathMaskKey key(path, matrix, stroke);
+    return CHECK_LOCAL(localCache, add, Add, SkNEW_ARGS(PathMaskRec, (key, mask, data)));
+}
@@ -15,6 +15,10 @@
 #include "SkResourceCache.h"
 #include "SkRRect.h"
 
+class SkMatrix;
+class SkPath;
+class SkStrokeRec;
+
 class SkMaskCache {
 public:
     /**
@@ -39,6 +43,19 @@ public:
     static void Add(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality,
                     const SkRect rects[], int count, const SkMask& mask, SkCachedData* data,
                     SkResourceCache* localCache = NULL);
+
+    /**
+     * Anti-aliased A8 coverage masks of paths, keyed on the path's generation ID and fill type,
+     * the (affine) matrix it was rasterized with, and its stroke parameters. The mask's bounds
+     * are relative to the matrix, so callers that want to share masks across integer
+     * translations should pass a matrix whose translation has already been reduced to a
+     * (quantized) subpixel offset.
+     */
+    static SkCachedData* FindAndRef(const SkPath& path, const SkMatrix& matrix,
+                                    const SkStrokeRec& stroke, SkMask* mask,
+                                    SkResourceCache* localCache = NULL);
+    static void Add(const SkPath& path, const SkMatrix& matrix, const SkStrokeRec& stroke,
+                    const SkMask& mask, SkCachedData* data, SkResourceCache* localCache = NULL);
 };
 
 #endif
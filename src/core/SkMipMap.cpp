@@ -8,55 +8,47 @@
 #include "SkMipMap.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
-
-static void downsample32_nocheck(void* dst, int, int, const void* srcPtr, const SkPixmap& srcPM) {
-    const uint32_t* p = static_cast<const uint32_t*>(srcPtr);
-    const uint32_t* baseP = p;
-    uint32_t c, ag, rb;
-
-    c = *p; ag = (c >> 8) & 0xFF00FF; rb = c & 0xFF00FF;
-    p += 1;
-
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-
-    p = baseP;
-    p += srcPM.rowBytes() >> 2;
-
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-    p += 1;
-
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-
-    *(uint32_t*)dst = ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+#include "Sk4px.h"
+
+// Each downsample proc writes count dst pixels for one dst row. Every dst pixel is the
+// (truncated) average of a full 2x2 block of src pixels: the dst dimensions are the src
+// dimensions halved and rounded down, so a trailing odd src row or column is never needed.
+typedef void SkDownSampleProc(void* dst, const void* src, size_t srcRB, int count);
+
+static inline uint32_t average32(uint32_t c00, uint32_t c01, uint32_t c10, uint32_t c11) {
+    uint32_t ag = ((c00 >> 8) & 0xFF00FF) + ((c01 >> 8) & 0xFF00FF) +
+                  ((c10 >> 8) & 0xFF00FF) + ((c11 >> 8) & 0xFF00FF);
+    uint32_t rb = (c00 & 0xFF00FF) + (c01 & 0xFF00FF) + (c10 & 0xFF00FF) + (c11 & 0xFF00FF);
+    return ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
 }
 
-static void downsample32_check(void* dst, int x, int y, const void* srcPtr, const SkPixmap& srcPM) {
-    const uint32_t* p = static_cast<const uint32_t*>(srcPtr);
-    const uint32_t* baseP = p;
-
-    x <<= 1;
-    y <<= 1;
-    SkASSERT(srcPM.addr32(x, y) == p);
-
-    SkPMColor c, ag, rb;
-
-    c = *p; ag = (c >> 8) & 0xFF00FF; rb = c & 0xFF00FF;
-    if (x < srcPM.width() - 1) {
-        p += 1;
-    }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-
-    p = baseP;
-    if (y < srcPM.height() - 1) {
-        p += srcPM.rowBytes() >> 2;
+static void downsample32(void* dst, const void* src, size_t srcRB, int count) {
+    const uint32_t* p0 = static_cast<const uint32_t*>(src);
+    const uint32_t* p1 = (const uint32_t*)((const char*)p0 + srcRB);
+    uint32_t* d = static_cast<uint32_t*>(dst);
+
+    // Adding the 4 src pixels at p and the 4 at p+1 leaves the sum of each horizontal pair in
+    // lanes 0 and 2, giving us 2 dst pixels per iteration.  The load at p+1 reads one pixel past
+    // the pair, so we only take this path while there is at least one more dst pixel after it.
+    while (count > 2) {
+        Sk16h sum = Sk4px::Load4(p0).widenLo() + Sk4px::Load4(p0 + 1).widenLo() +
+                    Sk4px::Load4(p1).widenLo() + Sk4px::Load4(p1 + 1).widenLo();
+        // Each component sum is at most 4*255, so sum << 6 fits in 16 bits and its high byte
+        // is exactly sum >> 2, matching average32().
+        uint32_t px[4];
+        Sk4px::Wide(sum << 6).addNarrowHi(Sk16h(0)).store4(px);
+        d[0] = px[0];
+        d[1] = px[2];
+        p0 += 4;
+        p1 += 4;
+        d += 2;
+        count -= 2;
     }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-    if (x < srcPM.width() - 1) {
-        p += 1;
+    for (int i = 0; i < count; ++i) {
+        d[i] = average32(p0[0], p0[1], p1[0], p1[1]);
+        p0 += 2;
+        p1 += 2;
     }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-
-    *((uint32_t*)dst) = ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
 }
 
 static inline uint32_t expand16(U16CPU c) {
@@ -69,33 +61,17 @@ static inline U16CPU pack16(uint32_t c) {
     return (c & ~SK_G16_MASK_IN_PLACE) | ((c >> 16) & SK_G16_MASK_IN_PLACE);
 }
 
-static void downsample16(void* dst, int x, int y, const void* srcPtr, const SkPixmap& srcPM) {
-    const uint16_t* p = static_cast<const uint16_t*>(srcPtr);
-    const uint16_t* baseP = p;
-
-    x <<= 1;
-    y <<= 1;
-    SkASSERT(srcPM.addr16(x, y) == p);
-
-    SkPMColor c;
+static void downsample16(void* dst, const void* src, size_t srcRB, int count) {
+    const uint16_t* p0 = static_cast<const uint16_t*>(src);
+    const uint16_t* p1 = (const uint16_t*)((const char*)p0 + srcRB);
+    uint16_t* d = static_cast<uint16_t*>(dst);
 
-    c = expand16(*p);
-    if (x < srcPM.width() - 1) {
-        p += 1;
+    for (int i = 0; i < count; ++i) {
+        uint32_t c = expand16(p0[0]) + expand16(p0[1]) + expand16(p1[0]) + expand16(p1[1]);
+        d[i] = (uint16_t)pack16(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    c += expand16(*p);
-
-    p = baseP;
-    if (y < srcPM.height() - 1) {
-        p += srcPM.rowBytes() >> 1;
-    }
-    c += expand16(*p);
-    if (x < srcPM.width() - 1) {
-        p += 1;
-    }
-    c += expand16(*p);
-
-    *((uint16_t*)dst) = (uint16_t)pack16(c >> 2);
 }
 
 static uint32_t expand4444(U16CPU c) {
@@ -106,66 +82,55 @@ static U16CPU collaps4444(uint32_t c) {
     return (c & 0xF0F) | ((c >> 12) & ~0xF0F);
 }
 
-static void downsample4444(void* dst, int x, int y, const void* srcPtr, const SkPixmap& srcPM) {
-    const uint16_t* p = static_cast<const uint16_t*>(srcPtr);
-    const uint16_t* baseP = p;
-
-    x <<= 1;
-    y <<= 1;
-    SkASSERT(srcPM.addr16(x, y) == p);
-
-    uint32_t c;
-
-    c = expand4444(*p);
-    if (x < srcPM.width() - 1) {
-        p += 1;
+static void downsample4444(void* dst, const void* src, size_t srcRB, int count) {
+    const uint16_t* p0 = static_cast<const uint16_t*>(src);
+    const uint16_t* p1 = (const uint16_t*)((const char*)p0 + srcRB);
+    uint16_t* d = static_cast<uint16_t*>(dst);
+
+    for (int i = 0; i < count; ++i) {
+        uint32_t c = expand4444(p0[0]) + expand4444(p0[1]) +
+                     expand4444(p1[0]) + expand4444(p1[1]);
+        d[i] = (uint16_t)collaps4444(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    c += expand4444(*p);
+}
 
-    p = baseP;
-    if (y < srcPM.height() - 1) {
-        p += srcPM.rowBytes() >> 1;
-    }
-    c += expand4444(*p);
-    if (x < srcPM.width() - 1) {
-        p += 1;
-    }
-    c += expand4444(*p);
+static void downsample8(void* dst, const void* src, size_t srcRB, int count) {
+    const uint8_t* p0 = static_cast<const uint8_t*>(src);
+    const uint8_t* p1 = p0 + srcRB;
+    uint8_t* d = static_cast<uint8_t*>(dst);
 
-   *((uint16_t*)dst) = (uint16_t)collaps4444(c >> 2);
+    // A tight loop over the row with no per-pixel bounds checks, which compilers vectorize.
+    for (int i = 0; i < count; ++i) {
+        d[i] = (p0[2*i] + p0[2*i + 1] + p1[2*i] + p1[2*i + 1]) >> 2;
+    }
 }
 
-static void downsample8_nocheck(void* dst, int, int, const void* srcPtr, const SkPixmap& srcPM) {
-    const size_t rb = srcPM.rowBytes();
-    const uint8_t* p = static_cast<const uint8_t*>(srcPtr);
-    *(uint8_t*)dst = (p[0] + p[1] + p[rb] + p[rb + 1]) >> 2;
+int SkMipMap::ComputeLevelCount(int width, int height) {
+    int count = 0;
+    for (;;) {
+        width >>= 1;
+        height >>= 1;
+        if (0 == width || 0 == height) {
+            break;
+        }
+        count += 1;
+    }
+    return count;
 }
 
-static void downsample8_check(void* dst, int x, int y, const void* srcPtr, const SkPixmap& srcPM) {
-    const uint8_t* p = static_cast<const uint8_t*>(srcPtr);
-    const uint8_t* baseP = p;
-
-    x <<= 1;
-    y <<= 1;
-    SkASSERT(srcPM.addr8(x, y) == p);
-
-    unsigned c = *p;
-    if (x < srcPM.width() - 1) {
-        p += 1;
+int SkMipMap::ComputeLevel(SkScalar scale) {
+    if (scale >= SK_Scalar1 || scale <= 0 || !SkScalarIsFinite(scale)) {
+        return 0;
     }
-    c += *p;
 
-    p = baseP;
-    if (y < srcPM.height() - 1) {
-        p += srcPM.rowBytes();
-    }
-    c += *p;
-    if (x < srcPM.width() - 1) {
-        p += 1;
+    SkScalar L = -SkScalarLog2(scale);
+    if (!SkScalarIsFinite(L)) {
+        return 0;
     }
-    c += *p;
-
-    *(uint8_t*)dst = c >> 2;
+    SkASSERT(L >= 0);
+    return SkScalarFloorToInt(L);
 }
 
 size_t SkMipMap::AllocLevelsSize(int levelCount, size_t pixelSize) {
@@ -179,55 +144,50 @@ size_t SkMipMap::AllocLevelsSize(int levelCount, size_t pixelSize) {
     return sk_64_asS32(size);
 }
 
-typedef void SkDownSampleProc(void*, int x, int y, const void* srcPtr, const SkPixmap& srcPM);
-
-SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
-    SkDownSampleProc* proc_nocheck, *proc_check;
+SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact,
+                          int maxLevelCount) {
+    SkDownSampleProc* proc;
 
     const SkColorType ct = src.colorType();
     const SkAlphaType at = src.alphaType();
     switch (ct) {
         case kRGBA_8888_SkColorType:
         case kBGRA_8888_SkColorType:
-            proc_check = downsample32_check;
-            proc_nocheck = downsample32_nocheck;
+            proc = downsample32;
             break;
         case kRGB_565_SkColorType:
-            proc_check = downsample16;
-            proc_nocheck = proc_check;
+            proc = downsample16;
             break;
         case kARGB_4444_SkColorType:
-            proc_check = downsample4444;
-            proc_nocheck = proc_check;
+            proc = downsample4444;
             break;
         case kAlpha_8_SkColorType:
         case kGray_8_SkColorType:
-            proc_check = downsample8_check;
-            proc_nocheck = downsample8_nocheck;
+            proc = downsample8;
             break;
         default:
             return NULL; // don't build mipmaps for any other colortypes (yet)
     }
 
+    // Only allocate (and generate) the levels that were asked for. Deeper levels cost nothing
+    // until some draw needs them, at which point the cache builds a deeper mipmap.
+    const int totalLevels = ComputeLevelCount(src.width(), src.height());
+    const int countLevels = SkTMin(totalLevels, maxLevelCount);
+    if (countLevels <= 0) {
+        return NULL;
+    }
+
     // whip through our loop to compute the exact size needed
     size_t  size = 0;
-    int     countLevels = 0;
     {
         int width = src.width();
         int height = src.height();
-        for (;;) {
+        for (int i = 0; i < countLevels; ++i) {
             width >>= 1;
             height >>= 1;
-            if (0 == width || 0 == height) {
-                break;
-            }
             size += SkColorTypeMinRowBytes(ct, width) * height;
-            countLevels += 1;
         }
     }
-    if (0 == countLevels) {
-        return NULL;
-    }
 
     size_t storageSize = SkMipMap::AllocLevelsSize(countLevels, size);
     if (0 == storageSize) {
@@ -257,6 +217,7 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
 
     // init
     mipmap->fCount = countLevels;
+    mipmap->fIsComplete = (countLevels == totalLevels);
     mipmap->fLevels = (Level*)mipmap->writable_data();
 
     Level* levels = mipmap->fLevels;
@@ -280,35 +241,12 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
 
         SkPixmap dstPM(SkImageInfo::Make(width, height, ct, at), addr, rowBytes);
 
-        const int widthEven = width & ~1;
-        const int heightEven = height & ~1;
-        const size_t pixelSize = srcPM.info().bytesPerPixel();
-
-        const void* srcBasePtr = srcPM.addr();
-        void* dstBasePtr = dstPM.writable_addr();
-        for (int y = 0; y < heightEven; y++) {
-            const void* srcPtr = srcBasePtr;
-            void* dstPtr = dstBasePtr;
-            for (int x = 0; x < widthEven; x++) {
-                proc_nocheck(dstPtr, x, y, srcPtr, srcPM);
-                srcPtr = (char*)srcPtr + pixelSize * 2;
-                dstPtr = (char*)dstPtr + pixelSize;
-            }
-            if (width & 1) {
-                proc_check(dstPtr, widthEven, y, srcPtr, srcPM);
-            }
-
-            srcBasePtr = (char*)srcBasePtr + srcPM.rowBytes() * 2;
-            dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
-        }
-        if (height & 1) {
-            const void* srcPtr = srcBasePtr;
-            void* dstPtr = dstBasePtr;
-            for (int x = 0; x < width; x++) {
-                proc_check(dstPtr, x, heightEven, srcPtr, srcPM);
-                srcPtr = (char*)srcPtr + pixelSize * 2;
-                dstPtr = (char*)dstPtr + pixelSize;
-            }
+        const char* srcRow = static_cast<const char*>(srcPM.addr());
+        char* dstRow = static_cast<char*>(dstPM.writable_addr());
+        for (int y = 0; y < height; y++) {
+            proc(dstRow, srcRow, srcPM.rowBytes(), width);
+            srcRow += srcPM.rowBytes() * 2;
+            dstRow += dstPM.rowBytes();
         }
         srcPM = dstPM;
         addr += height * rowBytes;
@@ -318,6 +256,10 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
     return mipmap;
 }
 
+bool SkMipMap::hasLevels(int levelCount) const {
+    return fIsComplete || fCount >= levelCount;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool SkMipMap::extractLevel(SkScalar scale, Level* levelPtr) const {
@@ -325,19 +267,7 @@ bool SkMipMap::extractLevel(SkScalar scale, Level* levelPtr) const {
         return false;
     }
 
-    if (scale >= SK_Scalar1 || scale <= 0 || !SkScalarIsFinite(scale)) {
-        return false;
-    }
-
-    SkScalar L = -SkScalarLog2(scale);
-    if (!SkScalarIsFinite(L)) {
-        return false;
-    }
-    SkASSERT(L >= 0);
-//    int rndLevel = SkScalarRoundToInt(L);
-    int level = SkScalarFloorToInt(L);
-//    SkDebugf("mipmap scale=%g L=%g level=%d rndLevel=%d\n", scale, L, level, rndLevel);
-
+    int level = ComputeLevel(scale);
     SkASSERT(level >= 0);
     if (level <= 0) {
         return false;
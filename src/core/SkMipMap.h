@@ -18,7 +18,23 @@ typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
 
 class SkMipMap : public SkCachedData {
 public:
-    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc);
+    /**
+     *  Build the first maxLevelCount levels of the mipmap for src (all of them by default).
+     *  Levels past maxLevelCount are neither generated nor allocated.
+     */
+    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc,
+                           int maxLevelCount = SK_MaxS32);
+
+    /**
+     *  Returns the number of levels a complete mipmap of a width x height image would have.
+     */
+    static int ComputeLevelCount(int width, int height);
+
+    /**
+     *  Returns the (1-based) level extractLevel() would pick for scale, or 0 if the scale
+     *  does not call for any downsampling.
+     */
+    static int ComputeLevel(SkScalar scale);
 
     struct Level {
         void*       fPixels;
@@ -27,8 +43,20 @@ public:
         float       fScale; // < 1.0
     };
 
+    /**
+     *  Returns the level for scale, or the deepest level built if the mipmap was built with
+     *  fewer levels than scale calls for (see hasLevels()).
+     */
     bool extractLevel(SkScalar scale, Level*) const;
 
+    int countLevels() const { return fCount; }
+
+    /**
+     *  Returns true if this mipmap holds at least levelCount levels, or all of the levels
+     *  its source supports.
+     */
+    bool hasLevels(int levelCount) const;
+
 protected:
     void onDataChange(void* oldData, void* newData) override {
         fLevels = (Level*)newData; // could be NULL
@@ -37,6 +65,7 @@ protected:
 private:
     Level*  fLevels;
     int     fCount;
+    bool    fIsComplete;
 
     // we take ownership of levels, and will free it with sk_free()
     SkMipMap(void* malloc, size_t size) : INHERITED(malloc, size) {}
@@ -40,6 +40,8 @@ public:
 protected:
     REQUIRE(0 == (N & (N-1)));
     SkNb<N/2, Bytes> fLo, fHi;
+
+    template <int, typename> friend class SkNf;
 };
 
 template <int N, typename T>
@@ -136,6 +138,12 @@ public:
         return SkNf(SkNf<N/2,T>::Max(l.fLo, r.fLo), SkNf<N/2,T>::Max(l.fHi, r.fHi));
     }
 
+    // Lanes where cond is true come from t, the rest from e.
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        return SkNf(SkNf<N/2,T>::Select(cond.fLo, t.fLo, e.fLo),
+                    SkNf<N/2,T>::Select(cond.fHi, t.fHi, e.fHi));
+    }
+
     SkNf  sqrt() const { return SkNf(fLo. sqrt(), fHi. sqrt()); }
 
     // Generally, increasing precision, increasing cost.
@@ -170,6 +178,8 @@ public:
     bool anyTrue() const { return fVal; }
 protected:
     bool fVal;
+
+    template <int, typename> friend class SkNf;
 };
 
 template <typename T>
@@ -235,6 +245,9 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return SkNf(SkTMin(l.fVal, r.fVal)); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return SkNf(SkTMax(l.fVal, r.fVal)); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        return cond.fVal ? t : e;
+    }
 
     SkNf  sqrt() const { return SkNf(Sqrt(fVal));        }
     SkNf rsqrt0() const { return SkNf((T)1 / Sqrt(fVal)); }
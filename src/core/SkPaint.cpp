@@ -30,6 +30,7 @@
 #include "SkStroke.h"
 #include "SkTextFormatParams.h"
 #include "SkTextToPathIter.h"
+#include "SkTextMeasureCache.h"
 #include "SkTLazy.h"
 #include "SkTypeface.h"
 #include "SkXfermode.h"
@@ -898,6 +899,31 @@ SkScalar SkPaint::measure_text(SkGlyphCache* cache,
     return Sk48Dot16ToScalar(x);
 }
 
+namespace {
+
+// Finds the advances of the text in SkTextMeasureCache, and gives back any glyph cache that had
+// to be detached to measure them.
+class AutoMeasureRun : SkNoncopyable {
+public:
+    AutoMeasureRun(const SkPaint& paint, const void* text, size_t length) : fCache(NULL) {
+        fRun.reset(SkTextMeasureCache::FindOrMeasure(paint, text, length, &fCache));
+    }
+
+    ~AutoMeasureRun() {
+        if (fCache) {
+            SkGlyphCache::AttachCache(fCache);
+        }
+    }
+
+    const SkTextMeasureCache::Run* operator->() const { return fRun.get(); }
+
+private:
+    SkGlyphCache*                                   fCache;
+    SkAutoTUnref<const SkTextMeasureCache::Run>     fRun;
+};
+
+}  // namespace
+
 SkScalar SkPaint::measureText(const void* textData, size_t length, SkRect* bounds) const {
     const char* text = (const char*)textData;
     SkASSERT(text != NULL || length == 0);
@@ -906,6 +932,12 @@ SkScalar SkPaint::measureText(const void* textData, size_t length, SkRect* bound
     const SkPaint& paint = canon.getPaint();
     SkScalar scale = canon.getScale();
 
+    if (NULL == bounds && SkTextMeasureCache::CanCache(paint, length)) {
+        AutoMeasureRun run(paint, text, length);
+        SkScalar width = Sk48Dot16ToScalar(run->fWidth);
+        return scale ? SkScalarMul(width, scale) : width;
+    }
+
     SkAutoGlyphCache    autoCache(paint, NULL, NULL);
     SkGlyphCache*       cache = autoCache.getCache();
 
@@ -931,6 +963,37 @@ SkScalar SkPaint::measureText(const void* textData, size_t length, SkRect* bound
     return width;
 }
 
+void SkPaint::measureTexts(int count, const void* const texts[], const size_t lengths[],
+                           SkScalar widths[]) const {
+    SkASSERT(count >= 0);
+
+    SkCanonicalizePaint canon(*this);
+    const SkPaint& paint = canon.getPaint();
+    SkScalar scale = canon.getScale();
+
+    // Detached the first time a run isn't in SkTextMeasureCache, and shared by the rest.
+    SkGlyphCache* cache = NULL;
+    for (int i = 0; i < count; ++i) {
+        SkASSERT(texts[i] != NULL || lengths[i] == 0);
+        SkScalar width = 0;
+        if (SkTextMeasureCache::CanCache(paint, lengths[i])) {
+            SkAutoTUnref<const SkTextMeasureCache::Run> run(
+                    SkTextMeasureCache::FindOrMeasure(paint, texts[i], lengths[i], &cache));
+            width = Sk48Dot16ToScalar(run->fWidth);
+        } else if (lengths[i] > 0) {
+            if (NULL == cache) {
+                cache = paint.detachCache(NULL, NULL, false);
+            }
+            int tempCount;
+            width = paint.measure_text(cache, (const char*)texts[i], lengths[i], &tempCount, NULL);
+        }
+        widths[i] = scale ? SkScalarMul(width, scale) : width;
+    }
+    if (cache) {
+        SkGlyphCache::AttachCache(cache);
+    }
+}
+
 size_t SkPaint::breakText(const void* textD, size_t length, SkScalar maxWidth,
                           SkScalar* measuredWidth) const {
     if (0 == length || 0 >= maxWidth) {
@@ -960,14 +1023,36 @@ size_t SkPaint::breakText(const void* textD, size_t length, SkScalar maxWidth,
         maxWidth /= scale;
     }
 
+    // use 64bits for our accumulator, to avoid overflowing 16.16
+    Sk48Dot16        max = SkScalarToFixed(maxWidth);
+    Sk48Dot16        width = 0;
+
+    if (SkTextMeasureCache::CanCache(paint, length)) {
+        AutoMeasureRun run(paint, text, length);
+        size_t measured = 0;
+        for (int i = 0; i < run->fCount; ++i) {
+            SkFixed x = run->fKerns[i] + run->fAdvances[i];
+            if ((width += x) > max) {
+                width -= x;
+                break;
+            }
+            measured = run->fEnds[i];
+        }
+        if (measuredWidth) {
+            SkScalar scalarWidth = Sk48Dot16ToScalar(width);
+            if (scale) {
+                scalarWidth = SkScalarMul(scalarWidth, scale);
+            }
+            *measuredWidth = scalarWidth;
+        }
+        return measured;
+    }
+
     SkAutoGlyphCache    autoCache(paint, NULL, NULL);
     SkGlyphCache*       cache = autoCache.getCache();
 
     SkMeasureCacheProc glyphCacheProc = paint.getMeasureCacheProc(false);
     const int        xyIndex = paint.isVerticalText() ? 1 : 0;
-    // use 64bits for our accumulator, to avoid overflowing 16.16
-    Sk48Dot16        max = SkScalarToFixed(maxWidth);
-    Sk48Dot16        width = 0;
 
     SkAutoKern  autokern;
 
@@ -1079,6 +1164,17 @@ int SkPaint::getTextWidths(const void* textData, size_t byteLength,
     const SkPaint& paint = canon.getPaint();
     SkScalar scale = canon.getScale();
 
+    if (NULL == bounds && SkTextMeasureCache::CanCache(paint, byteLength)) {
+        // Each width is the glyph's advance plus the kerning against the glyph after it.
+        AutoMeasureRun run(paint, textData, byteLength);
+        const int count = run->fCount;
+        for (int i = 0; i < count; ++i) {
+            SkFixed w = run->fAdvances[i] + (i + 1 < count ? run->fKerns[i + 1] : 0);
+            widths[i] = scale ? SkScalarMul(SkFixedToScalar(w), scale) : SkFixedToScalar(w);
+        }
+        return count;
+    }
+
     SkAutoGlyphCache    autoCache(paint, NULL, NULL);
     SkGlyphCache*       cache = autoCache.getCache();
     SkMeasureCacheProc  glyphCacheProc;
@@ -1872,6 +1872,27 @@ size_t SkPath::writeToMemory(void* storage) const {
     return buffer.pos();
 }
 
+size_t SkPath::writeCompactToMemory(void* storage, SkScalar tolerance) const {
+    SkDEBUGCODE(this->validate();)
+
+    // With no storage, the buffer only counts the bytes.
+    SkWBuffer   buffer(storage);
+
+    int32_t packed = (1 << kCompact_SerializationShift) |
+                     (fConvexity << kConvexity_SerializationShift) |
+                     (fFillType << kFillType_SerializationShift) |
+                     (fFirstDirection << kDirection_SerializationShift) |
+                     (fIsVolatile << kIsVolatile_SerializationShift) |
+                     kCurrent_Version;
+
+    buffer.write32(packed);
+
+    fPathRef->writeToCompactBuffer(&buffer, tolerance);
+
+    buffer.padToAlign4();
+    return buffer.pos();
+}
+
 size_t SkPath::readFromMemory(const void* storage, size_t length) {
     SkRBufferWithSizeCheck buffer(storage, length);
 
@@ -1886,7 +1907,12 @@ size_t SkPath::readFromMemory(const void* storage, size_t length) {
     fFillType = (packed >> kFillType_SerializationShift) & 0xFF;
     uint8_t dir = (packed >> kDirection_SerializationShift) & 0x3;
     fIsVolatile = (packed >> kIsVolatile_SerializationShift) & 0x1;
-    SkPathRef* pathRef = SkPathRef::CreateFromBuffer(&buffer);
+    SkPathRef* pathRef;
+    if ((packed >> kCompact_SerializationShift) & 0x1) {
+        pathRef = SkPathRef::CreateFromCompactBuffer(&buffer);
+    } else {
+        pathRef = SkPathRef::CreateFromBuffer(&buffer);
+    }
 
     // compatibility check
     if (version < kPathPrivFirstDirection_Version) {
@@ -1908,7 +1934,7 @@ size_t SkPath::readFromMemory(const void* storage, size_t length) {
     }
 
     size_t sizeRead = 0;
-    if (buffer.isValid()) {
+    if (buffer.isValid() && pathRef) {
         fPathRef.reset(pathRef);
         SkDEBUGCODE(this->validate();)
         buffer.skipToAlign4();
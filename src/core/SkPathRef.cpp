@@ -6,6 +6,7 @@
  */
 
 #include "SkBuffer.h"
+#include "SkFloatBits.h"
 #include "SkLazyPtr.h"
 #include "SkPath.h"
 #include "SkPathRef.h"
@@ -260,6 +261,345 @@ uint32_t SkPathRef::writeSize() const {
                     sizeof(SkRect));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Compact serialization:
+//
+//  u8      flags (kIsOval_CompactFlag)
+//  varint  verb count, point count, conic weight count
+//  varint  (run << 3) | verb, for each run of the same verb, in memory order
+//  u8      point mode
+//  ...     points, as described by the mode
+//  f32     conic weights
+//  0 to 3 bytes of padding, to a multiple of 4 bytes
+
+enum {
+    kIsOval_CompactFlag = 1 << 0,
+};
+
+enum {
+    // f32 x and y of each point.
+    kRaw_PointMode,
+    // varint zigzag deltas of each x and y from the previous point's, of the float bits mapped to
+    // ints that sort the same way as the floats.
+    kDelta_PointMode,
+    // s8 exponent, then varint zigzag deltas of each x and y from the previous point's, as ints n
+    // for the coordinates n * 2^exponent.
+    kGrid_PointMode,
+};
+
+static const int kCompactMaxRun = (1 << 28) - 1;
+
+static const uint8_t gCompactPtsInVerb[] = {
+    1,  // kMove
+    1,  // kLine
+    2,  // kQuad
+    2,  // kConic
+    3,  // kCubic
+    0,  // kClose
+};
+
+static const uint8_t gCompactSegmentMask[] = {
+    0,                              // kMove
+    SkPath::kLine_SegmentMask,
+    SkPath::kQuad_SegmentMask,
+    SkPath::kConic_SegmentMask,
+    SkPath::kCubic_SegmentMask,
+    0,                              // kClose
+};
+
+static inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Maps float bits to ints in the same order as the floats, so that nearby coordinates have
+// small deltas. This is its own inverse.
+static inline int32_t float_to_ordered(float value) {
+    int32_t bits = SkFloat2Bits(value);
+    return bits < 0 ? bits ^ 0x7FFFFFFF : bits;
+}
+
+static inline float ordered_to_float(int32_t value) {
+    return SkBits2Float(value < 0 ? value ^ 0x7FFFFFFF : value);
+}
+
+static inline size_t varint_size(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static void write_varint(SkWBuffer* buffer, uint32_t value) {
+    uint8_t bytes[5];
+    size_t n = 0;
+    while (value >= 0x80) {
+        bytes[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = (uint8_t)value;
+    buffer->write(bytes, n);
+}
+
+static inline bool read_varint(const uint8_t** ptr, const uint8_t* stop, uint32_t* value) {
+    const uint8_t* p = *ptr;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p >= stop) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            *ptr = p;
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rounds to the nearest int. Unlike floor(x + 0.5), this is exact near 2^24.
+static inline int32_t round_to_int(float value) {
+    const float floor = floorf(value);
+    return (int32_t)floor + (value - floor >= 0.5f ? 1 : 0);
+}
+
+// Finds the coarsest power of 2 grid that every coordinate is on, or, if tolerance is larger,
+// the coarsest one whose points are all within tolerance. Returns false if some coordinate is
+// not finite, or is too large to be exactly n * 2^exponent for an int n with |n| < 2^24.
+static bool compute_grid(const SkScalar coords[], int count, SkScalar tolerance, int* exponent) {
+    static const int kNoExponent = 1000;
+    const bool exact = !(tolerance > 0 && SkScalarIsFinite(tolerance));
+    int e = kNoExponent;
+    for (int i = 0; i < count; ++i) {
+        const int32_t bits = SkFloat2Bits(coords[i]);
+        const int biased = (bits >> 23) & 0xFF;
+        if (0xFF == biased) {
+            return false;
+        }
+        if (exact && 0 == coords[i] && 0 != bits) {
+            // -0 would be read back as 0.
+            return false;
+        }
+        uint32_t mantissa = bits & 0x7FFFFF;
+        if (biased) {
+            mantissa |= 0x800000;
+        }
+        if (mantissa) {
+            // The exponent of the lowest set bit.
+            const int lowest = 31 - SkCLZ(mantissa & (0 - mantissa));
+            e = SkMin32(e, (biased ? biased : 1) - 150 + lowest);
+        }
+    }
+    if (!exact) {
+        // The largest power of 2 no larger than 2 * tolerance.
+        int toleranceExponent;
+        frexpf(2 * tolerance, &toleranceExponent);
+        e = kNoExponent == e ? toleranceExponent - 1 : SkMax32(e, toleranceExponent - 1);
+    } else if (kNoExponent == e) {
+        // Every coordinate is 0.
+        e = 0;
+    }
+    // Keep both 2^e and 2^-e normal floats, so multiplying by them is exact.
+    if (e < -126 || e > 126) {
+        return false;
+    }
+
+    const float scale = ldexpf(1, -e);
+    const float limit = (float)(1 << 24);
+    for (int i = 0; i < count; ++i) {
+        if (!(SkScalarAbs(coords[i] * scale) < limit)) {
+            return false;
+        }
+    }
+    *exponent = e;
+    return true;
+}
+
+void SkPathRef::writeToCompactBuffer(SkWBuffer* buffer, SkScalar tolerance) const {
+    SkDEBUGCODE(this->validate();)
+
+    buffer->write8(fIsOval ? kIsOval_CompactFlag : 0);
+    write_varint(buffer, fVerbCnt);
+    write_varint(buffer, fPointCnt);
+    write_varint(buffer, fConicWeights.count());
+
+    const uint8_t* verbs = this->verbsMemBegin();
+    for (int i = 0; i < fVerbCnt;) {
+        const uint8_t verb = verbs[i];
+        int run = 1;
+        while (i + run < fVerbCnt && verbs[i + run] == verb && run < kCompactMaxRun) {
+            ++run;
+        }
+        write_varint(buffer, ((uint32_t)run << 3) | verb);
+        i += run;
+    }
+
+    const SkScalar* coords = &fPoints[0].fX;
+    const int coordCount = 2 * fPointCnt;
+    int exponent;
+    if (compute_grid(coords, coordCount, tolerance, &exponent)) {
+        buffer->write8(kGrid_PointMode);
+        buffer->write8((int8_t)exponent);
+        const float scale = ldexpf(1, -exponent);
+        int32_t prev[2] = { 0, 0 };
+        for (int i = 0; i < coordCount; ++i) {
+            const int32_t n = round_to_int(coords[i] * scale);
+            write_varint(buffer, zigzag(n - prev[i & 1]));
+            prev[i & 1] = n;
+        }
+    } else {
+        // Scattered or non-finite coordinates may take more than 4 bytes each as deltas.
+        size_t deltaSize = 0;
+        uint32_t prev[2] = { 0, 0 };
+        for (int i = 0; i < coordCount; ++i) {
+            const uint32_t n = (uint32_t)float_to_ordered(coords[i]);
+            deltaSize += varint_size(zigzag((int32_t)(n - prev[i & 1])));
+            prev[i & 1] = n;
+        }
+        if (deltaSize < coordCount * sizeof(SkScalar)) {
+            buffer->write8(kDelta_PointMode);
+            prev[0] = prev[1] = 0;
+            for (int i = 0; i < coordCount; ++i) {
+                const uint32_t n = (uint32_t)float_to_ordered(coords[i]);
+                write_varint(buffer, zigzag((int32_t)(n - prev[i & 1])));
+                prev[i & 1] = n;
+            }
+        } else {
+            buffer->write8(kRaw_PointMode);
+            buffer->write(fPoints, fPointCnt * sizeof(SkPoint));
+        }
+    }
+
+    buffer->write(fConicWeights.begin(), fConicWeights.bytes());
+    buffer->padToAlign4();
+}
+
+SkPathRef* SkPathRef::CreateFromCompactBuffer(SkRBufferWithSizeCheck* buffer) {
+    const size_t startPos = buffer->pos();
+    const uint8_t* start = (const uint8_t*)buffer->skip(0);
+    const uint8_t* p = start;
+    const uint8_t* stop = p + (buffer->size() - startPos);
+
+    if (p >= stop) {
+        return NULL;
+    }
+    const uint8_t flags = *p++;
+
+    uint32_t verbCount, pointCount, conicCount;
+    if (!read_varint(&p, stop, &verbCount) ||
+        !read_varint(&p, stop, &pointCount) ||
+        !read_varint(&p, stop, &conicCount)) {
+        return NULL;
+    }
+    // Each point takes at least 2 bytes, and each conic weight 4, so these reject counts that
+    // could not fit before allocating. Every kClose follows a verb with points, so there are at
+    // most twice as many verbs as points.
+    const size_t available = stop - p;
+    if (pointCount > available / 2 || conicCount > available / 4 ||
+        verbCount > 2 * pointCount) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkPathRef> ref(SkNEW(SkPathRef));
+    ref->resetToSize(verbCount, pointCount, conicCount);
+
+    uint8_t* verbs = ref->verbsMemWritable();
+    uint32_t ptsInVerbs = 0, conicVerbs = 0;
+    uint8_t segmentMask = 0;
+    for (uint32_t i = 0; i < verbCount;) {
+        uint32_t value;
+        if (!read_varint(&p, stop, &value)) {
+            return NULL;
+        }
+        const uint8_t verb = value & 7;
+        const uint32_t run = value >> 3;
+        if (verb > SkPath::kClose_Verb || 0 == run || run > verbCount - i) {
+            return NULL;
+        }
+        memset(verbs + i, verb, run);
+        ptsInVerbs += run * gCompactPtsInVerb[verb];
+        if (SkPath::kConic_Verb == verb) {
+            conicVerbs += run;
+        }
+        segmentMask |= gCompactSegmentMask[verb];
+        i += run;
+    }
+    if (ptsInVerbs != pointCount || conicVerbs != conicCount) {
+        return NULL;
+    }
+
+    if (p >= stop) {
+        return NULL;
+    }
+    const uint8_t mode = *p++;
+    SkScalar* coords = &ref->fPoints[0].fX;
+    const uint32_t coordCount = 2 * pointCount;
+    if (kGrid_PointMode == mode) {
+        if (p >= stop) {
+            return NULL;
+        }
+        const int exponent = (int8_t)*p++;
+        if (exponent < -126 || exponent > 126) {
+            return NULL;
+        }
+        const float scale = ldexpf(1, exponent);
+        int32_t prev[2] = { 0, 0 };
+        for (uint32_t i = 0; i < coordCount; ++i) {
+            uint32_t value;
+            if (!read_varint(&p, stop, &value)) {
+                return NULL;
+            }
+            const int32_t n = (int32_t)((uint32_t)prev[i & 1] + (uint32_t)unzigzag(value));
+            coords[i] = (float)n * scale;
+            prev[i & 1] = n;
+        }
+    } else if (kDelta_PointMode == mode) {
+        uint32_t prev[2] = { 0, 0 };
+        for (uint32_t i = 0; i < coordCount; ++i) {
+            uint32_t value;
+            if (!read_varint(&p, stop, &value)) {
+                return NULL;
+            }
+            const uint32_t n = prev[i & 1] + (uint32_t)unzigzag(value);
+            coords[i] = ordered_to_float((int32_t)n);
+            prev[i & 1] = n;
+        }
+    } else if (kRaw_PointMode == mode) {
+        const size_t pointBytes = pointCount * sizeof(SkPoint);
+        if ((size_t)(stop - p) < pointBytes) {
+            return NULL;
+        }
+        memcpy(coords, p, pointBytes);
+        p += pointBytes;
+    } else {
+        return NULL;
+    }
+
+    const size_t weightBytes = conicCount * sizeof(SkScalar);
+    if ((size_t)(stop - p) < weightBytes) {
+        return NULL;
+    }
+    memcpy(ref->fConicWeights.begin(), p, weightBytes);
+    p += weightBytes;
+
+    if (!buffer->read(NULL, SkAlign4(startPos + (p - start)) - startPos)) {
+        return NULL;
+    }
+
+    // resetToSize clears fSegmentMask and fIsOval, and marks the bounds dirty, so they (and
+    // fIsFinite) are computed from the points.
+    ref->fSegmentMask = segmentMask;
+    ref->fIsOval = SkToBool(flags & kIsOval_CompactFlag);
+    return ref.detach();
+}
+
 void SkPathRef::copy(const SkPathRef& ref,
                      int additionalReserveVerbs,
                      int additionalReservePoints) {
@@ -6,6 +6,7 @@
  */
 
 #include "SkAtomics.h"
+#include "SkIndexedPicture.h"
 #include "SkMessageBus.h"
 #include "SkPicture.h"
 #include "SkPictureData.h"
@@ -142,6 +143,18 @@ SkPicture* SkPicture::CreateFromStream(SkStream* stream, InstallPixelRefProc pro
     return Forwardport(info, data);
 }
 
+SkPicture* SkPicture::CreateIndexedFromStream(SkStream* stream, InstallPixelRefProc proc) {
+    SkPictInfo info;
+    if (!InternalOnly_StreamIsSKP(stream, &info) || !stream->readBool()) {
+        return nullptr;
+    }
+    SkAutoTDelete<SkPictureData> data(SkPictureData::CreateFromStream(stream, info, proc));
+    if (data && data->opBlocks().count() > 0) {
+        return SkIndexedPicture::Create(data.detach());
+    }
+    return Forwardport(info, data);
+}
+
 SkPicture* SkPicture::CreateFromBuffer(SkReadBuffer& buffer) {
     SkPictInfo info;
     if (!InternalOnly_BufferIsSKP(&buffer, &info) || !buffer.readBool()) {
@@ -161,13 +174,22 @@ SkPictureData* SkPicture::backport() const {
 }
 
 void SkPicture::serialize(SkWStream* stream, SkPixelSerializer* pixelSerializer) const {
+    this->serialize(stream, pixelSerializer, false);
+}
+
+void SkPicture::serializeWithOpIndex(SkWStream* stream, SkPixelSerializer* pixelSerializer) const {
+    this->serialize(stream, pixelSerializer, true);
+}
+
+void SkPicture::serialize(SkWStream* stream, SkPixelSerializer* pixelSerializer,
+                          bool writeOpIndex) const {
     SkPictInfo info = this->createHeader();
     SkAutoTDelete<SkPictureData> data(this->backport());
 
     stream->write(&info, sizeof(info));
     if (data) {
         stream->writeBool(true);
-        data->serialize(stream, pixelSerializer);
+        data->serialize(stream, pixelSerializer, writeOpIndex);
     } else {
         stream->writeBool(false);
     }
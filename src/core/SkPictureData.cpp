@@ -6,8 +6,10 @@
  */
 #include <new>
 #include "SkPictureData.h"
+#include "SkPicturePlayback.h"
 #include "SkPictureRecord.h"
 #include "SkReadBuffer.h"
+#include "SkShader.h"
 #include "SkTextBlob.h"
 #include "SkTypeface.h"
 #include "SkWriteBuffer.h"
@@ -99,6 +101,13 @@ bool SkPictureData::containsBitmaps() const {
     if (fBitmaps.count() > 0) {
         return true;
     }
+    for (int i = 0; i < fPaints.count(); ++i) {
+        const SkShader* shader = fPaints[i].getShader();
+        if (shader &&
+            shader->asABitmap(NULL, NULL, NULL) == SkShader::kDefault_BitmapType) {
+            return true;
+        }
+    }
     for (int i = 0; i < fPictureCount; ++i) {
         if (fPictureRefs[i]->willPlayBackBitmaps()) {
             return true;
@@ -220,10 +229,21 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
 }
 
 void SkPictureData::serialize(SkWStream* stream,
-                              SkPixelSerializer* pixelSerializer) const {
+                              SkPixelSerializer* pixelSerializer,
+                              bool writeOpIndex) const {
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
+    // The op index has to follow the ops, so that the reader can check it against them.
+    if (writeOpIndex) {
+        SkTDArray<SkPictureOpBlock> blocks;
+        SkPicturePlayback::ComputeOpBlocks(this, &blocks);
+        if (blocks.count() > 0) {
+            write_tag_size(stream, SK_PICT_OP_INDEX_TAG, blocks.count());
+            stream->write(blocks.begin(), blocks.bytes());
+        }
+    }
+
     if (fPictureCount > 0) {
         write_tag_size(stream, SK_PICT_PICTURE_TAG, fPictureCount);
         for (int i = 0; i < fPictureCount; i++) {
@@ -237,7 +257,8 @@ void SkPictureData::serialize(SkWStream* stream,
         SkRefCntSet  typefaceSet;
         SkFactorySet factSet;
 
-        SkWriteBuffer buffer(SkWriteBuffer::kCrossProcess_Flag);
+        SkWriteBuffer buffer(SkWriteBuffer::kCrossProcess_Flag |
+                             SkWriteBuffer::kCompactPaths_Flag);
         buffer.setTypefaceRecorder(&typefaceSet);
         buffer.setFactoryRecorder(&factSet);
         buffer.setPixelSerializer(pixelSerializer);
@@ -321,6 +342,26 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
                 return false;
             }
             break;
+        case SK_PICT_OP_INDEX_TAG: {
+            // Every block holds at least one 4 byte op.
+            if (NULL == fOpData || size > fOpData->size() / 4) {
+                return false;
+            }
+            fOpBlocks.setCount(size);
+            if (stream->read(fOpBlocks.begin(), fOpBlocks.bytes()) != fOpBlocks.bytes()) {
+                return false;
+            }
+            uint32_t prevStop = 0;
+            for (int i = 0; i < fOpBlocks.count(); ++i) {
+                const SkPictureOpBlock& block = fOpBlocks[i];
+                if (block.fStart < prevStop || block.fStart >= block.fStop ||
+                    block.fStop > fOpData->size() || SkAlign4(block.fStart) != block.fStart ||
+                    !block.fBounds.isFinite()) {
+                    return false;
+                }
+                prevStop = block.fStop;
+            }
+        } break;
         case SK_PICT_FACTORY_TAG: {
             SkASSERT(!haveBuffer);
             size = stream->readU32();
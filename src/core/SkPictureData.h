@@ -43,6 +43,7 @@ struct SkPictInfo {
 #define SK_PICT_FACTORY_TAG    SkSetFourByteTag('f', 'a', 'c', 't')
 #define SK_PICT_TYPEFACE_TAG   SkSetFourByteTag('t', 'p', 'f', 'c')
 #define SK_PICT_PICTURE_TAG    SkSetFourByteTag('p', 'c', 't', 'r')
+#define SK_PICT_OP_INDEX_TAG   SkSetFourByteTag('i', 'n', 'd', 'x')
 
 // This tag specifies the size of the ReadBuffer, needed for the following tags
 #define SK_PICT_BUFFER_SIZE_TAG     SkSetFourByteTag('a', 'r', 'a', 'y')
@@ -55,6 +56,15 @@ struct SkPictInfo {
 // Always write this guy last (with no length field afterwards)
 #define SK_PICT_EOF_TAG     SkSetFourByteTag('e', 'o', 'f', ' ')
 
+// A run of consecutive draw ops in the op data, [fStart, fStop) in bytes, and the bounds they draw
+// inside, in the picture's coordinates. Playback can skip the whole run when it is outside the
+// clip, since it changes no canvas state.
+struct SkPictureOpBlock {
+    SkRect      fBounds;
+    uint32_t    fStart;
+    uint32_t    fStop;
+};
+
 class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&, bool deepCopyOps);
@@ -66,7 +76,9 @@ public:
 
     virtual ~SkPictureData();
 
-    void serialize(SkWStream*, SkPixelSerializer*) const;
+    // The op index is only written if writeOpIndex is true. Nested pictures never get one,
+    // since they are always read back with SkPicture::CreateFromStream().
+    void serialize(SkWStream*, SkPixelSerializer*, bool writeOpIndex) const;
     void flatten(SkWriteBuffer&) const;
 
     bool containsBitmaps() const;
@@ -77,6 +89,11 @@ public:
 
     const SkData* opData() const { return fOpData; }
 
+    // Empty unless the stream this was read from had an op index.
+    const SkTDArray<SkPictureOpBlock>& opBlocks() const { return fOpBlocks; }
+
+    const SkPictInfo& info() const { return fInfo; }
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
@@ -95,6 +112,12 @@ public:
         return fPaths[index];
     }
 
+    int pictureCount() const { return fPictureCount; }
+    const SkPicture* picture(int index) const {
+        SkASSERT(index >= 0 && index < fPictureCount);
+        return fPictureRefs[index];
+    }
+
     const SkPicture* getPicture(SkReader32* reader) const {
         int index = reader->readInt();
         SkASSERT(index > 0 && index <= fPictureCount);
@@ -151,6 +174,7 @@ private:
     SkTArray<SkPath>   fPaths;
 
     SkData* fOpData;    // opcodes and parameters
+    SkTDArray<SkPictureOpBlock> fOpBlocks;
 
     const SkPicture** fPictureRefs;
     int fPictureCount;
@@ -5,12 +5,15 @@
  * found in the LICENSE file.
  */
 
+#include "SkBBoxHierarchy.h"
 #include "SkCanvas.h"
 #include "SkPatchUtils.h"
 #include "SkPictureData.h"
 #include "SkPicturePlayback.h"
 #include "SkPictureRecord.h"
 #include "SkReader32.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
 #include "SkTextBlob.h"
 #include "SkTDArray.h"
 #include "SkTypes.h"
@@ -76,12 +79,39 @@ void SkPicturePlayback::draw(SkCanvas* canvas, SkPicture::AbortCallback* callbac
 
     SkAutoCanvasRestore acr(canvas, false);
 
+    // Blocks of draws in the op index can be skipped, without reading their ops, when they are
+    // outside the canvas' clip (mapped back to the picture's coordinates, like the BBH query in
+    // SkRecordDraw).
+    const SkTDArray<SkPictureOpBlock>& blocks = fPictureData->opBlocks();
+    int nextBlock = blocks.count();
+    SkRect query = SkRect::MakeEmpty();
+    if (blocks.count() > 0) {
+        if (!canvas->getClipBounds(&query)) {
+            query.setEmpty();
+        }
+        if (!query.contains(fPictureData->info().fCullRect)) {
+            nextBlock = 0;
+        }
+    }
+
     while (!reader.eof()) {
         if (callback && callback->abort()) {
             return;
         }
 
         fCurOffset = reader.offset();
+
+        // Clips that become empty jump ahead to their restore, possibly past some blocks.
+        while (nextBlock < blocks.count() && blocks[nextBlock].fStop <= fCurOffset) {
+            nextBlock++;
+        }
+        if (nextBlock < blocks.count() && blocks[nextBlock].fStart == fCurOffset) {
+            if (!SkRect::Intersects(blocks[nextBlock].fBounds, query)) {
+                reader.setOffset(blocks[nextBlock].fStop);
+                continue;
+            }
+            nextBlock++;
+        }
         uint32_t size;
         DrawType op = ReadOpAndSize(&reader, &size);
 
@@ -440,3 +470,112 @@ void SkPicturePlayback::handleOp(SkReader32* reader,
     }
 }
 
+
+bool SkPicturePlayback::IsDrawOp(DrawType op) {
+    switch (op) {
+        case DRAW_BITMAP:
+        case DRAW_BITMAP_MATRIX:
+        case DRAW_BITMAP_NINE:
+        case DRAW_BITMAP_RECT_TO_RECT:
+        case DRAW_CLEAR:
+        case DRAW_DRRECT:
+        case DRAW_OVAL:
+        case DRAW_PAINT:
+        case DRAW_PATCH:
+        case DRAW_PATH:
+        case DRAW_PICTURE:
+        case DRAW_PICTURE_MATRIX_PAINT:
+        case DRAW_POINTS:
+        case DRAW_POS_TEXT:
+        case DRAW_POS_TEXT_TOP_BOTTOM:
+        case DRAW_POS_TEXT_H:
+        case DRAW_POS_TEXT_H_TOP_BOTTOM:
+        case DRAW_RECT:
+        case DRAW_RRECT:
+        case DRAW_SPRITE:
+        case DRAW_TEXT:
+        case DRAW_TEXT_BLOB:
+        case DRAW_TEXT_ON_PATH:
+        case DRAW_TEXT_TOP_BOTTOM:
+        case DRAW_VERTICES:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Keeps the bounds SkRecordFillBounds computes for each op.
+class OpBoundsCollector : public SkBBoxHierarchy {
+public:
+    void insert(const SkRect bounds[], int N) override { fBounds.append(N, bounds); }
+    void search(const SkRect&, SkTDArray<unsigned>*) const override {}
+    size_t bytesUsed() const override { return fBounds.bytes(); }
+    SkRect getRootBound() const override { return SkRect::MakeEmpty(); }
+
+    SkTDArray<SkRect> fBounds;
+};
+
+// Small blocks skip more precisely; large ones keep the index small.
+static const int kMaxOpsPerBlock = 8;
+
+void SkPicturePlayback::ComputeOpBlocks(const SkPictureData* data,
+                                        SkTDArray<SkPictureOpBlock>* blocks) {
+    blocks->reset();
+
+    struct Op {
+        uint32_t fStart, fStop;     // in the op data
+        unsigned fFirst, fLast;     // the SkRecord ops it was recorded as
+        bool     fIsDraw;
+    };
+    SkTDArray<Op> ops;
+
+    // Record each op on its own to find its bounds, the same way SkPictureRecorder would.
+    const SkRect& cullRect = data->info().fCullRect;
+    SkRecord record;
+    SkRecorder recorder(&record, cullRect);
+    SkPicturePlayback playback(data);
+    SkReader32 reader(data->opData()->bytes(), data->opData()->size());
+    const SkMatrix initialMatrix = recorder.getTotalMatrix();
+    while (!reader.eof()) {
+        Op* op = ops.append();
+        op->fStart = SkToU32(reader.offset());
+        uint32_t size;
+        DrawType type = ReadOpAndSize(&reader, &size);
+        if (0 == size) {
+            return;     // Old ops, without their sizes.
+        }
+        op->fStop = op->fStart + size;
+        op->fIsDraw = IsDrawOp(type);
+        op->fFirst = record.count();
+        playback.handleOp(&reader, type, size, &recorder, initialMatrix);
+        op->fLast = record.count();
+    }
+
+    SkAutoTUnref<OpBoundsCollector> collector(SkNEW(OpBoundsCollector));
+    SkRecordFillBounds(cullRect, record, collector.get());
+    SkASSERT(collector->fBounds.count() == (int)record.count());
+
+    SkPictureOpBlock* block = NULL;
+    int opsInBlock = 0;
+    for (int i = 0; i < ops.count(); ++i) {
+        const Op& op = ops[i];
+        // Ops that were skipped by an empty clip were never recorded, so don't bound a block.
+        if (!op.fIsDraw || (block && (block->fStop != op.fStart || opsInBlock == kMaxOpsPerBlock))) {
+            block = NULL;
+        }
+        if (!op.fIsDraw) {
+            continue;
+        }
+        if (!block) {
+            block = blocks->append();
+            block->fBounds.setEmpty();
+            block->fStart = op.fStart;
+            opsInBlock = 0;
+        }
+        block->fStop = op.fStop;
+        for (unsigned j = op.fFirst; j < op.fLast; ++j) {
+            block->fBounds.join(collector->fBounds[j]);
+        }
+        opsInBlock++;
+    }
+}
@@ -14,6 +14,7 @@ class SkBitmap;
 class SkCanvas;
 class SkPaint;
 class SkPictureData;
+struct SkPictureOpBlock;
 
 // The basic picture playback class replays the provided picture into a canvas.
 class SkPicturePlayback : SkNoncopyable {
@@ -24,8 +25,19 @@ public:
     }
     virtual ~SkPicturePlayback() { }
 
+    // If the picture data has an op index, this skips its blocks that are outside the clip.
     virtual void draw(SkCanvas* canvas, SkPicture::AbortCallback*);
 
+    // Split the data's op stream into blocks of consecutive draw ops, bounded in the picture's
+    // cull rect, for its op index.  Leaves blocks empty if the ops can't be indexed.
+    static void ComputeOpBlocks(const SkPictureData*, SkTDArray<SkPictureOpBlock>* blocks);
+
+    // Read the next op code and the size of its whole chunk, including the op code.
+    static DrawType ReadOpAndSize(SkReader32* reader, uint32_t* size);
+
+    // Whether the op only draws, without changing the canvas' state. Only these go in op blocks.
+    static bool IsDrawOp(DrawType);
+
     // TODO: remove the curOp calls after cleaning up GrGatherDevice
     // Return the ID of the operation currently being executed when playing
     // back. 0 indicates no call is active.
@@ -44,8 +56,6 @@ protected:
                   SkCanvas* canvas,
                   const SkMatrix& initialMatrix);
 
-    static DrawType ReadOpAndSize(SkReader32* reader, uint32_t* size);
-
     class AutoResetOpID {
     public:
         AutoResetOpID(SkPicturePlayback* playback) : fPlayback(playback) { }
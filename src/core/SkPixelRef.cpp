@@ -358,6 +358,10 @@ bool SkPixelRef::onReadPixels(SkBitmap* dst, const SkIRect* subset) {
 
 void SkPixelRef::onNotifyPixelsChanged() { }
 
+bool SkPixelRef::onIsLazyGenerated() const {
+    return false;
+}
+
 SkData* SkPixelRef::onRefEncodedData() {
     return NULL;
 }
@@ -5,9 +5,13 @@
  * found in the LICENSE file.
  */
 
+#include "SkImage_Base.h"
 #include "SkLayerInfo.h"
 #include "SkRecordDraw.h"
+#include "SkRecorder.h"
 #include "SkPatchUtils.h"
+#include "SkTHash.h"
+#include "SkTLogic.h"
 
 void SkRecordDraw(const SkRecord& record,
                   SkCanvas* canvas,
@@ -772,6 +776,169 @@ private:
     SkRecords::FillBounds fFillBounds;
 };
 
+// SkRecord visitor to gather the bitmaps drawn by ops that intersect a query rect.
+class CollectBitmaps : SkNoncopyable {
+public:
+    CollectBitmaps(const SkRect& cullRect, const SkRecord& record,
+                   SkPicture const* const drawablePicts[], int drawableCount,
+                   const SkRect& queryRect, SkTHashSet<SkPixelRef*>* seen,
+                   SkTArray<SkBitmap>* bitmaps)
+        : fQueryRect(queryRect)
+        , fDrawablePicts(drawablePicts)
+        , fDrawableCount(drawableCount)
+        , fSeen(seen)
+        , fBitmaps(bitmaps)
+        , fFillBounds(cullRect, record)
+    {}
+
+    void setCurrentOp(unsigned currentOp) { fFillBounds.setCurrentOp(currentOp); }
+
+    template <typename T> void operator()(const T& op) {
+        fFillBounds(op);
+        this->collect(op);
+    }
+
+    // Collects from a picture drawn with the current CTM and matrix, whose ops intersect query.
+    void collectPicture(const SkPicture* picture, const SkMatrix& matrix, const SkRect& query) {
+        SkMatrix toIdentity = fFillBounds.ctm();
+        toIdentity.preConcat(matrix);
+
+        SkMatrix inverse;
+        SkRect localQuery = picture->cullRect();
+        if (toIdentity.invert(&inverse)) {
+            inverse.mapRect(&localQuery, query);
+        }
+        Collect(picture, localQuery, fSeen, fBitmaps);
+    }
+
+    static void Collect(const SkPicture* picture, const SkRect& query,
+                        SkTHashSet<SkPixelRef*>* seen, SkTArray<SkBitmap>* bitmaps) {
+        if (const SkBigPicture* bp = picture->asSkBigPicture()) {
+            Collect(picture->cullRect(), *bp->record(), bp->drawablePicts(), bp->drawableCount(),
+                    query, seen, bitmaps);
+        } else if (picture->willPlayBackBitmaps()) {
+            // Other pictures hold at most a few ops, so record them again to get at those.
+            SkRecord record;
+            SkRecorder recorder(&record, picture->cullRect());
+            picture->playback(&recorder);
+            Collect(picture->cullRect(), record, NULL, 0, query, seen, bitmaps);
+        }
+    }
+
+    static void Collect(const SkRect& cullRect, const SkRecord& record,
+                        SkPicture const* const drawablePicts[], int drawableCount,
+                        const SkRect& query, SkTHashSet<SkPixelRef*>* seen,
+                        SkTArray<SkBitmap>* bitmaps) {
+        CollectBitmaps visitor(cullRect, record, drawablePicts, drawableCount, query, seen,
+                               bitmaps);
+        for (unsigned curOp = 0; curOp < record.count(); curOp++) {
+            visitor.setCurrentOp(curOp);
+            record.visit<void>(curOp, visitor);
+        }
+    }
+
+private:
+    SK_CREATE_MEMBER_DETECTOR(bitmap);
+    SK_CREATE_MEMBER_DETECTOR(paint);
+
+    // Some ops have a paint, some have an optional paint.  Either way, get back a pointer.
+    static const SkPaint* AsPtr(const SkPaint& p) { return &p; }
+    static const SkPaint* AsPtr(const Optional<SkPaint>& p) { return p; }
+
+    // The bounds of the current op, which FillBounds only knows once it has visited a draw.
+    bool intersectsQuery() const {
+        return SkRect::Intersects(fFillBounds.getBounds(fFillBounds.currentOp()), fQueryRect);
+    }
+
+    // Ops with neither a bitmap nor a paint draw no bitmaps.
+    template <typename T>
+    SK_WHEN_C(!HasMember_bitmap<T>::value && !HasMember_paint<T>::value, void)
+    collect(const T&) {}
+
+    template <typename T>
+    SK_WHEN(HasMember_bitmap<T>, void) collect(const T& op) {
+        if (this->intersectsQuery()) {
+            this->addBitmap(op.bitmap.shallowCopy());
+            this->addPaint(AsPtr(op.paint));
+        }
+    }
+
+    template <typename T>
+    SK_WHEN_C(!HasMember_bitmap<T>::value && HasMember_paint<T>::value, void)
+    collect(const T& op) {
+        if (this->intersectsQuery()) {
+            this->addPaint(AsPtr(op.paint));
+        }
+    }
+
+    // The bounds of control ops aren't known until the end, and a layer's paint is only applied
+    // to what is drawn inside it.
+    void collect(const SaveLayer&) {}
+
+    void collect(const DrawImage& op) {
+        if (this->intersectsQuery()) {
+            this->addImage(op.image);
+            this->addPaint(op.paint);
+        }
+    }
+    void collect(const DrawImageRect& op) {
+        if (this->intersectsQuery()) {
+            this->addImage(op.image);
+            this->addPaint(op.paint);
+        }
+    }
+
+    void collect(const DrawPicture& op) {
+        SkRect query;
+        if (query.intersect(fFillBounds.getBounds(fFillBounds.currentOp()), fQueryRect)) {
+            this->collectPicture(op.picture, op.matrix, query);
+        }
+    }
+    void collect(const DrawDrawable& op) {
+        SkRect query;
+        if (op.index < fDrawableCount &&
+            query.intersect(fFillBounds.getBounds(fFillBounds.currentOp()), fQueryRect)) {
+            this->collectPicture(fDrawablePicts[op.index], SkMatrix::I(), query);
+        }
+    }
+
+    void addBitmap(const SkBitmap& bitmap) {
+        SkPixelRef* pr = bitmap.pixelRef();
+        if (pr && !fSeen->contains(pr)) {
+            fSeen->add(pr);
+            fBitmaps->push_back(bitmap);
+        }
+    }
+
+    void addImage(const SkImage* image) {
+        // A texture's pixels are already decoded, and getROPixels() would read them all back.
+        if (image->isTextureBacked()) {
+            return;
+        }
+        SkBitmap bitmap;
+        if (as_IB(image)->getROPixels(&bitmap)) {
+            this->addBitmap(bitmap);
+        }
+    }
+
+    void addPaint(const SkPaint* paint) {
+        const SkShader* shader = paint ? paint->getShader() : NULL;
+        SkBitmap bitmap;
+        if (shader &&
+            shader->asABitmap(&bitmap, NULL, NULL) == SkShader::kDefault_BitmapType) {
+            this->addBitmap(bitmap);
+        }
+    }
+
+    const SkRect             fQueryRect;
+    SkPicture const* const*  fDrawablePicts;
+    int                      fDrawableCount;
+    SkTHashSet<SkPixelRef*>* fSeen;
+    SkTArray<SkBitmap>*      fBitmaps;
+
+    SkRecords::FillBounds fFillBounds;
+};
+
 }  // namespace SkRecords
 
 void SkRecordFillBounds(const SkRect& cullRect, const SkRecord& record, SkBBoxHierarchy* bbh) {
@@ -798,3 +965,9 @@ void SkRecordComputeLayers(const SkRect& cullRect, const SkRecord& record,
     visitor.cleanUp(bbh);
 }
 
+
+void SkRecordCollectBitmaps(const SkPicture* picture, const SkRect& queryRect,
+                            SkTArray<SkBitmap>* bitmaps) {
+    SkTHashSet<SkPixelRef*> seen;
+    SkRecords::CollectBitmaps::Collect(picture, queryRect, &seen, bitmaps);
+}
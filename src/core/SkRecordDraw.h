@@ -13,6 +13,7 @@
 #include "SkCanvas.h"
 #include "SkMatrix.h"
 #include "SkRecord.h"
+#include "SkTArray.h"
 
 class SkDrawable;
 class SkLayerInfo;
@@ -24,6 +25,11 @@ void SkRecordComputeLayers(const SkRect& cullRect, const SkRecord& record,
                            const SkBigPicture::SnapshotArray*,
                            SkBBoxHierarchy* bbh, SkLayerInfo* data);
 
+// Collect the bitmaps drawn by the picture's ops whose bounds intersect queryRect, one for each
+// distinct SkPixelRef.  This includes bitmaps behind images and bitmap shaders, and those drawn by
+// nested pictures and drawables.
+void SkRecordCollectBitmaps(const SkPicture*, const SkRect& queryRect, SkTArray<SkBitmap>*);
+
 // Draw an SkRecord into an SkCanvas.  A convenience wrapper around SkRecords::Draw.
 void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePicts[],
                   SkDrawable* const drawables[], int drawableCount,
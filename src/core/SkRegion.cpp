@@ -8,7 +8,9 @@
 
 
 #include "SkRegionPriv.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkTSort.h"
 #include "SkThread.h"
 #include "SkUtils.h"
 
@@ -308,6 +310,42 @@ void SkRegion::BuildRectRuns(const SkIRect& bounds,
     runs[6] = kRunTypeSentinel;
 }
 
+/*  Given a scanline [Bottom, IntervalCount, [L R]..., Sentinel], return the index of the last
+ *  interval whose left edge is <= x, or -1 if there is none.
+ *
+ *  Intervals are sorted and disjoint, so their rights are sorted too, and that one interval
+ *  answers both contains and intersects queries. Short scanlines are counted without branches
+ *  (which compilers vectorize); long ones are binary searched.
+ */
+static int scanline_find_interval(const SkRegion::RunType runs[], SkRegion::RunType x) {
+    const int count = runs[1];
+    const SkRegion::RunType* intervals = runs + 2;  // skip Bottom and IntervalCount
+
+    const int kLinearLimit = 16;
+    if (count <= kLinearLimit) {
+        int n = 0;
+        for (int i = 0; i < count; ++i) {
+            n += (intervals[2 * i] <= x);
+        }
+        return n - 1;
+    }
+
+    if (x < intervals[0]) {
+        return -1;
+    }
+    int lo = 0;
+    int hi = count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) >> 1;
+        if (intervals[2 * mid] <= x) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
 bool SkRegion::contains(int32_t x, int32_t y) const {
     SkDEBUGCODE(this->validate();)
 
@@ -320,26 +358,8 @@ bool SkRegion::contains(int32_t x, int32_t y) const {
     SkASSERT(this->isComplex());
 
     const RunType* runs = fRunHead->findScanline(y);
-
-    // Skip the Bottom and IntervalCount
-    runs += 2;
-
-    // Just walk this scanline, checking each interval. The X-sentinel will
-    // appear as a left-inteval (runs[0]) and should abort the search.
-    //
-    // We could do a bsearch, using interval-count (runs[1]), but need to time
-    // when that would be worthwhile.
-    //
-    for (;;) {
-        if (x < runs[0]) {
-            break;
-        }
-        if (x < runs[1]) {
-            return true;
-        }
-        runs += 2;
-    }
-    return false;
+    const int index = scanline_find_interval(runs, x);
+    return index >= 0 && x < runs[2 + 2 * index + 1];
 }
 
 static SkRegion::RunType scanline_bottom(const SkRegion::RunType runs[]) {
@@ -353,17 +373,9 @@ static const SkRegion::RunType* scanline_next(const SkRegion::RunType runs[]) {
 
 static bool scanline_contains(const SkRegion::RunType runs[],
                               SkRegion::RunType L, SkRegion::RunType R) {
-    runs += 2;  // skip Bottom and IntervalCount
-    for (;;) {
-        if (L < runs[0]) {
-            break;
-        }
-        if (R <= runs[1]) {
-            return true;
-        }
-        runs += 2;
-    }
-    return false;
+    // Only the last interval starting at or before L can hold all of [L, R).
+    const int index = scanline_find_interval(runs, L);
+    return index >= 0 && R <= runs[2 + 2 * index + 1];
 }
 
 bool SkRegion::contains(const SkIRect& r) const {
@@ -433,17 +445,9 @@ const SkRegion::RunType* SkRegion::getRuns(RunType tmpStorage[],
 
 static bool scanline_intersects(const SkRegion::RunType runs[],
                                 SkRegion::RunType L, SkRegion::RunType R) {
-    runs += 2;  // skip Bottom and IntervalCount
-    for (;;) {
-        if (R <= runs[0]) {
-            break;
-        }
-        if (L < runs[1]) {
-            return true;
-        }
-        runs += 2;
-    }
-    return false;
+    // Of the intervals starting before R, the last one reaches furthest right.
+    const int index = scanline_find_interval(runs, R - 1);
+    return index >= 0 && L < runs[2 + 2 * index + 1];
 }
 
 bool SkRegion::intersects(const SkIRect& r) const {
@@ -585,16 +589,115 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+struct RectTopLessThan {
+    bool operator()(const SkIRect& a, const SkIRect& b) const { return a.fTop < b.fTop; }
+};
+
+struct Interval {
+    SkRegion::RunType fLeft, fRight;
+};
+
+struct IntervalLessThan {
+    bool operator()(const Interval& a, const Interval& b) const { return a.fLeft < b.fLeft; }
+};
+}  // namespace
+
+/*  Rather than unioning one rect at a time (which rebuilds the entire run array for every rect),
+ *  sort the rects by top and sweep once down their distinct y-edges. Each band between two
+ *  edges gets the merged x-intervals of the rects spanning it, and a band identical to the one
+ *  above it just extends that one, which yields the same canonical runs op() would.
+ */
 bool SkRegion::setRects(const SkIRect rects[], int count) {
-    if (0 == count) {
-        this->setEmpty();
-    } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
+    SkTDArray<SkIRect> sorted;
+    sorted.setReserve(count);
+    for (int i = 0; i < count; i++) {
+        if (!rects[i].isEmpty()) {
+            *sorted.append() = rects[i];
         }
     }
-    return !this->isEmpty();
+    if (sorted.isEmpty()) {
+        return this->setEmpty();
+    }
+    if (1 == sorted.count()) {
+        return this->setRect(sorted[0]);
+    }
+    SkTQSort(sorted.begin(), sorted.end() - 1, RectTopLessThan());
+
+    SkTDArray<RunType> edges;
+    edges.setReserve(sorted.count() * 2);
+    for (int i = 0; i < sorted.count(); i++) {
+        *edges.append() = sorted[i].fTop;
+        *edges.append() = sorted[i].fBottom;
+    }
+    SkTQSort(edges.begin(), edges.end() - 1);
+    int edgeCount = 1;
+    for (int i = 1; i < edges.count(); i++) {
+        if (edges[i] != edges[edgeCount - 1]) {
+            edges[edgeCount++] = edges[i];
+        }
+    }
+
+    SkTDArray<int>      active;     // indices into sorted of the rects spanning the band
+    SkTDArray<Interval> intervals;
+    SkTDArray<RunType>  runs;
+    *runs.append() = edges[0];      // top
+
+    int prevStart = -1;             // index in runs of the previous band's first interval
+    int prevCount = -1;             // ... and its interval count
+    int next = 0;
+    for (int e = 0; e < edgeCount - 1; e++) {
+        const RunType top = edges[e];
+        const RunType bottom = edges[e + 1];
+
+        for (int i = active.count() - 1; i >= 0; i--) {
+            if (sorted[active[i]].fBottom <= top) {
+                active.removeShuffle(i);
+            }
+        }
+        while (next < sorted.count() && sorted[next].fTop == top) {
+            *active.append() = next++;
+        }
+
+        intervals.rewind();
+        for (int i = 0; i < active.count(); i++) {
+            Interval* interval = intervals.append();
+            interval->fLeft = sorted[active[i]].fLeft;
+            interval->fRight = sorted[active[i]].fRight;
+        }
+        int intervalCount = 0;
+        if (intervals.count() > 0) {
+            SkTQSort(intervals.begin(), intervals.end() - 1, IntervalLessThan());
+            // merge overlapping or abutting intervals in place
+            for (int i = 1; i < intervals.count(); i++) {
+                Interval& last = intervals[intervalCount];
+                if (intervals[i].fLeft <= last.fRight) {
+                    last.fRight = SkTMax(last.fRight, intervals[i].fRight);
+                } else {
+                    intervals[++intervalCount] = intervals[i];
+                }
+            }
+            intervalCount += 1;
+        }
+
+        if (intervalCount == prevCount &&
+                !memcmp(&runs[prevStart], intervals.begin(), intervalCount * 2 * sizeof(RunType))) {
+            runs[prevStart - 2] = bottom;   // same as the band above, so just extend it
+            continue;
+        }
+        *runs.append() = bottom;
+        *runs.append() = intervalCount;
+        prevStart = runs.count();
+        prevCount = intervalCount;
+        for (int i = 0; i < intervalCount; i++) {
+            *runs.append() = intervals[i].fLeft;
+            *runs.append() = intervals[i].fRight;
+        }
+        *runs.append() = kRunTypeSentinel;
+    }
+    *runs.append() = kRunTypeSentinel;
+
+    return this->setRuns(runs.begin(), runs.count());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -219,6 +219,11 @@ public:
         return (glyphID < getGlyphCount()) ? generateGlyphToChar(glyphID) : 0;
     }
 
+    /** Return true if getImage() on several scalercontexts of this kind at once can run
+        concurrently, rather than each waiting on a lock shared by all of them.
+    */
+    virtual bool canGenerateImagesConcurrently() const { return true; }
+
     unsigned    getGlyphCount() { return this->generateGlyphCount(); }
     void        getAdvance(SkGlyph*);
     void        getMetrics(SkGlyph*);
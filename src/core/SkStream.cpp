@@ -847,31 +847,153 @@ bool SkDebugWStream::write(const void* buffer, size_t size)
 ///////////////////////////////////////////////////////////////////////////////
 
 
-static SkData* mmap_filename(const char path[]) {
-    SkFILE* file = sk_fopen(path, kRead_SkFILE_Flag);
+SkStreamAsset* SkStream::NewFromFile(const char path[]) {
+    SkFILE* file = path ? sk_fopen(path, kRead_SkFILE_Flag) : NULL;
     if (NULL == file) {
         return NULL;
     }
 
-    SkData* data = SkData::NewFromFILE(file);
-    sk_fclose(file);
-    return data;
-}
-
-SkStreamAsset* SkStream::NewFromFile(const char path[]) {
-    SkAutoTUnref<SkData> data(mmap_filename(path));
+    // Regular files are mapped, so that reading is just copying.
+    SkAutoTUnref<SkData> data(SkData::NewFromFILE(file));
     if (data.get()) {
+        sk_fclose(file);
         return SkNEW_ARGS(SkMemoryStream, (data.get()));
     }
 
-    // If we get here, then our attempt at using mmap failed, so try normal
-    // file access.
-    SkFILEStream* stream = SkNEW_ARGS(SkFILEStream, (path));
-    if (!stream->isValid()) {
-        SkDELETE(stream);
-        stream = NULL;
+    // If we get here, then our attempt at using mmap failed (e.g. the file is a pipe), so read
+    // the file in large blocks.
+    return SkNEW_ARGS(SkBufferedFILEStream, (file, path));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkBufferedFILEStream::SkBufferedFILEStream(SkFILE* file, const char path[])
+    : fFILE(file)
+    , fName(path)
+    , fSeekable(sk_fseek(file, 0))
+    , fFileAtEnd(false)
+    , fBufferStart(0)
+    , fBufferPos(0)
+    , fBufferEnd(0)
+    , fBuffer(kBufferSize) {
+    SkASSERT(file);
+}
+
+SkBufferedFILEStream::~SkBufferedFILEStream() {
+    sk_fclose(fFILE);
+}
+
+bool SkBufferedFILEStream::fill() {
+    // Keep the last block, so a pipe can still seek back within it.
+    if (fFileAtEnd) {
+        return false;
     }
-    return stream;
+    fBufferStart += fBufferEnd;
+    fBufferPos = 0;
+    fBufferEnd = sk_fread(fBuffer.get(), kBufferSize, fFILE);
+    fFileAtEnd = fBufferEnd < kBufferSize;
+    return fBufferEnd > 0;
+}
+
+size_t SkBufferedFILEStream::read(void* buffer, size_t size) {
+    size_t bytesRead = 0;
+    while (bytesRead < size) {
+        if (fBufferPos == fBufferEnd) {
+            const size_t remaining = size - bytesRead;
+            if (buffer && remaining >= kBufferSize && !fFileAtEnd) {
+                // Read large blocks straight into the caller's buffer.
+                const size_t n = sk_fread((char*)buffer + bytesRead, remaining, fFILE);
+                fBufferStart += fBufferEnd + n;
+                fBufferPos = 0;
+                fBufferEnd = 0;
+                fFileAtEnd = n < remaining;
+                bytesRead += n;
+                break;
+            }
+            if (!this->fill()) {
+                break;
+            }
+        }
+        const size_t n = SkTMin(size - bytesRead, fBufferEnd - fBufferPos);
+        if (buffer) {
+            memcpy((char*)buffer + bytesRead, fBuffer.get() + fBufferPos, n);
+        }
+        fBufferPos += n;
+        bytesRead += n;
+    }
+    return bytesRead;
+}
+
+bool SkBufferedFILEStream::isAtEnd() const {
+    return fFileAtEnd && fBufferPos == fBufferEnd;
+}
+
+bool SkBufferedFILEStream::rewind() {
+    return this->seek(0);
+}
+
+SkStreamAsset* SkBufferedFILEStream::duplicate() const {
+    // Opening a pipe again would not start it over.
+    if (!fSeekable || fName.isEmpty()) {
+        return NULL;
+    }
+    SkFILE* file = sk_fopen(fName.c_str(), kRead_SkFILE_Flag);
+    if (NULL == file) {
+        return NULL;
+    }
+    if (!sk_fidentical(file, fFILE)) {
+        sk_fclose(file);
+        return NULL;
+    }
+    return SkNEW_ARGS(SkBufferedFILEStream, (file, fName.c_str()));
+}
+
+size_t SkBufferedFILEStream::getPosition() const {
+    return fBufferStart + fBufferPos;
+}
+
+bool SkBufferedFILEStream::seek(size_t position) {
+    if (position >= fBufferStart && position - fBufferStart <= fBufferEnd) {
+        fBufferPos = position - fBufferStart;
+        return true;
+    }
+    if (fSeekable) {
+        position = SkTMin(position, this->getLength());
+        if (!sk_fseek(fFILE, position)) {
+            return false;
+        }
+        fBufferStart = position;
+        fBufferPos = 0;
+        fBufferEnd = 0;
+        fFileAtEnd = false;
+        return true;
+    }
+    if (position < fBufferStart) {
+        return false;
+    }
+    // Move forward by reading, stopping at the end of the file.
+    this->read(NULL, position - this->getPosition());
+    return true;
+}
+
+bool SkBufferedFILEStream::move(long offset) {
+    const size_t position = this->getPosition();
+    if (offset < 0 && (size_t)-offset > position) {
+        return this->seek(0);
+    }
+    return this->seek(position + offset);
+}
+
+SkStreamAsset* SkBufferedFILEStream::fork() const {
+    SkAutoTDelete<SkStreamAsset> that(this->duplicate());
+    if (NULL == that.get() || !that->seek(this->getPosition())) {
+        return NULL;
+    }
+    return that.detach();
+}
+
+size_t SkBufferedFILEStream::getLength() const {
+    return fSeekable ? sk_fgetsize(fFILE) : 0;
 }
 
 // Declared in SkStreamPriv.h:
@@ -8,9 +8,12 @@
 #ifndef SkStreamPriv_DEFINED
 #define SkStreamPriv_DEFINED
 
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+
 class SkAutoMalloc;
-class SkStream;
-class SkStreamRewindable;
 class SkData;
 
 /**
@@ -43,4 +46,55 @@ SkData *SkCopyStreamToData(SkStream* stream);
  */
 SkStreamRewindable* SkStreamRewindableFromSkStream(SkStream* stream);
 
+/**
+ *  An SkStreamAsset over a file that cannot be memory mapped, such as a pipe. It reads ahead
+ *  kBufferSize bytes at a time, so that the many small reads decoders make do not each go to the
+ *  file. SkStream::NewFromFile() returns one of these when it cannot map the file.
+ *
+ *  If the file cannot seek, the stream can still rewind or seek back within the block it read
+ *  last, which is enough for decoders that sniff the start of the stream, and seek forward by
+ *  reading. getLength() returns 0 if the file's length is not known.
+ */
+class SkBufferedFILEStream : public SkStreamAsset {
+public:
+    /**
+     *  Takes ownership of file, which must be at its start. path is used to reopen the file in
+     *  duplicate(), and may be NULL.
+     */
+    SkBufferedFILEStream(SkFILE* file, const char path[]);
+    virtual ~SkBufferedFILEStream();
+
+    size_t read(void* buffer, size_t size) override;
+    bool isAtEnd() const override;
+
+    bool rewind() override;
+    SkStreamAsset* duplicate() const override;
+
+    size_t getPosition() const override;
+    bool seek(size_t position) override;
+    bool move(long offset) override;
+    SkStreamAsset* fork() const override;
+
+    size_t getLength() const override;
+
+    enum {
+        kBufferSize = 64 * 1024
+    };
+
+private:
+    // Replaces the buffer with the next block of the file.
+    bool fill();
+
+    SkFILE*     fFILE;
+    SkString    fName;
+    const bool  fSeekable;
+    bool        fFileAtEnd;     // the last read from fFILE was short
+    size_t      fBufferStart;   // position of fBuffer[0] in the file
+    size_t      fBufferPos;     // next byte in fBuffer to read
+    size_t      fBufferEnd;     // bytes in fBuffer
+    SkAutoTMalloc<uint8_t> fBuffer;
+
+    typedef SkStreamAsset INHERITED;
+};
+
 #endif  // SkStreamPriv_DEFINED
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextMeasureCache.h"
+
+#include "SkAutoKern.h"
+#include "SkChecksum.h"
+#include "SkGlyphCache.h"
+#include "SkLazyPtr.h"
+#include "SkMutex.h"
+#include "SkPaint.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkTypeface.h"
+
+// Longer runs are rarely measured twice, and would crowd out the short ones.
+#define kMaxCachedTextLength    256
+#define kDefaultByteLimit       (256 * 1024)
+
+namespace {
+
+// The paint fields that can change the advances, followed by the text.
+struct KeyHeader {
+    uint32_t    fTypefaceID;
+    SkScalar    fTextSize;
+    SkScalar    fTextScaleX;
+    SkScalar    fTextSkewX;
+    SkScalar    fStrokeWidth;
+    SkScalar    fStrokeMiter;
+    uint32_t    fFlags;
+    uint8_t     fHinting;
+    uint8_t     fTextEncoding;
+    uint8_t     fStyle;
+    uint8_t     fStrokeJoin;
+};
+
+struct Key {
+    Key(const void* data, size_t size)
+        : fData(data)
+        , fSize(size)
+        , fHash(SkChecksum::Murmur3(data, size)) {}
+
+    bool operator==(const Key& that) const {
+        return fSize == that.fSize && 0 == memcmp(fData, that.fData, fSize);
+    }
+
+    const void* fData;
+    size_t      fSize;
+    uint32_t    fHash;
+};
+
+struct Entry {
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+
+    Entry(const Key& key, const SkTextMeasureCache::Run* run)
+        : fKeyData(key.fSize)
+        , fKey(fKeyData.get(), key.fSize)
+        , fRun(SkRef(run)) {
+        memcpy(fKeyData.get(), key.fData, key.fSize);
+        fKey.fHash = key.fHash;
+    }
+
+    size_t bytesUsed() const {
+        return sizeof(*this) + fKey.fSize + sizeof(SkTextMeasureCache::Run) +
+               fRun->fCount * (2 * sizeof(SkFixed) + sizeof(uint32_t));
+    }
+
+    static const Key& GetKey(const Entry& entry) { return entry.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    SkAutoTMalloc<char>                             fKeyData;
+    Key                                             fKey;
+    SkAutoTUnref<const SkTextMeasureCache::Run>     fRun;
+};
+
+struct Globals {
+    Globals() : fBytesUsed(0) {}
+
+    ~Globals() { this->purge(0); }
+
+    void purge(size_t byteLimit) {
+        while (fBytesUsed > byteLimit) {
+            Entry* entry = fLRU.tail();
+            fHash.remove(entry->fKey);
+            fLRU.remove(entry);
+            fBytesUsed -= entry->bytesUsed();
+            SkDELETE(entry);
+        }
+    }
+
+    SkMutex                     fMutex;
+    SkTDynamicHash<Entry, Key>  fHash;
+    SkTInternalLList<Entry>     fLRU;
+    size_t                      fBytesUsed;
+};
+
+SK_DECLARE_STATIC_LAZY_PTR(Globals, globals);
+
+}  // namespace
+
+SkTextMeasureCache::Run::Run(int count)
+    : fCount(count)
+    , fWidth(0)
+    , fAdvances(count)
+    , fKerns(count)
+    , fEnds(count) {}
+
+bool SkTextMeasureCache::CanCache(const SkPaint& paint, size_t length) {
+    return length > 0 && length <= kMaxCachedTextLength &&
+           NULL == paint.getPathEffect() &&
+           NULL == paint.getMaskFilter() &&
+           NULL == paint.getRasterizer();
+}
+
+// Measure every glyph of the text the way SkPaint::measure_text() does.
+static SkTextMeasureCache::Run* measure_run(const SkPaint& paint, SkMeasureCacheProc glyphCacheProc,
+                                            SkGlyphCache* cache, const char* text, size_t length) {
+    const int count = paint.countText(text, length);
+    SkTextMeasureCache::Run* run = SkNEW_ARGS(SkTextMeasureCache::Run, (count));
+
+    const bool devKern = paint.isDevKernText();
+    const int xyIndex = paint.isVerticalText() ? 1 : 0;
+    const char* start = text;
+    const char* stop = text + length;
+    int rsb = 0;
+    int n = 0;
+    while (text < stop && n < count) {
+        const SkGlyph& g = glyphCacheProc(cache, &text);
+        const SkFixed advance = (&g.fAdvanceX)[xyIndex];
+        const SkFixed kern = devKern ? SkAutoKern_AdjustF(rsb, g.fLsbDelta) : 0;
+        rsb = g.fRsbDelta;
+        // measure_text() doesn't kern the first glyph against 0, but breakText() does.
+        run->fWidth += (n > 0 ? kern : 0) + advance;
+        run->fAdvances[n] = advance;
+        run->fKerns[n] = kern;
+        run->fEnds[n] = SkToU32(text - start);
+        ++n;
+    }
+    run->fCount = n;
+    return run;
+}
+
+const SkTextMeasureCache::Run* SkTextMeasureCache::FindOrMeasure(const SkPaint& paint,
+                                                                 const void* text, size_t length,
+                                                                 SkGlyphCache** glyphCache) {
+    SkASSERT(CanCache(paint, length));
+
+    SkAutoSTMalloc<sizeof(KeyHeader) + 64, char> keyData(sizeof(KeyHeader) + length);
+    KeyHeader* header = (KeyHeader*)keyData.get();
+    sk_bzero(header, sizeof(*header));
+    header->fTypefaceID = SkTypeface::UniqueID(paint.getTypeface());
+    header->fTextSize = paint.getTextSize();
+    header->fTextScaleX = paint.getTextScaleX();
+    header->fTextSkewX = paint.getTextSkewX();
+    header->fFlags = paint.getFlags();
+    header->fHinting = SkToU8(paint.getHinting());
+    header->fTextEncoding = SkToU8(paint.getTextEncoding());
+    header->fStyle = SkToU8(paint.getStyle());
+    if (SkPaint::kFill_Style != paint.getStyle()) {
+        header->fStrokeWidth = paint.getStrokeWidth();
+        header->fStrokeMiter = paint.getStrokeMiter();
+        header->fStrokeJoin = SkToU8(paint.getStrokeJoin());
+    }
+    memcpy(header + 1, text, length);
+    const Key key(keyData.get(), sizeof(KeyHeader) + length);
+
+    Globals* g = globals.get();
+    {
+        SkAutoMutexAcquire lock(g->fMutex);
+        if (Entry* entry = g->fHash.find(key)) {
+            if (g->fLRU.head() != entry) {
+                g->fLRU.remove(entry);
+                g->fLRU.addToHead(entry);
+            }
+            return SkRef(entry->fRun.get());
+        }
+    }
+
+    if (NULL == *glyphCache) {
+        *glyphCache = paint.detachCache(NULL, NULL, false);
+    }
+    Run* run = measure_run(paint, paint.getMeasureCacheProc(false), *glyphCache,
+                           (const char*)text, length);
+
+    SkAutoMutexAcquire lock(g->fMutex);
+    if (NULL == g->fHash.find(key)) {
+        Entry* entry = SkNEW_ARGS(Entry, (key, run));
+        g->fHash.add(entry);
+        g->fLRU.addToHead(entry);
+        g->fBytesUsed += entry->bytesUsed();
+        g->purge(kDefaultByteLimit);
+    }
+    return run;
+}
+
+size_t SkTextMeasureCache::GetTotalBytesUsed() {
+    Globals* g = globals.get();
+    SkAutoMutexAcquire lock(g->fMutex);
+    return g->fBytesUsed;
+}
+
+void SkTextMeasureCache::Purge() {
+    Globals* g = globals.get();
+    SkAutoMutexAcquire lock(g->fMutex);
+    g->purge(0);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextMeasureCache_DEFINED
+#define SkTextMeasureCache_DEFINED
+
+#include "SkFixed.h"
+#include "SkRefCnt.h"
+#include "SkTemplates.h"
+
+class SkGlyphCache;
+class SkPaint;
+
+/**
+ *  A global, byte bounded LRU cache of the glyph advances of runs of text, keyed on the text
+ *  and the paint fields that affect them. It lets SkPaint::measureText(), breakText() and
+ *  getTextWidths() skip building a descriptor, finding the glyph cache and looking up every
+ *  glyph when the same strings are measured over and over, as layout tends to do.
+ *
+ *  Only short runs, measured with paints that have no path effect, mask filter or rasterizer,
+ *  are cached.
+ */
+class SkTextMeasureCache {
+public:
+    /** The glyph advances of one run, along the paint's text direction, unscaled. */
+    class Run : public SkNVRefCnt<Run> {
+    public:
+        explicit Run(int count);
+
+        int             fCount;
+        Sk48Dot16       fWidth;     // what measureText() returns
+        // Per glyph: the advance, the auto-kern adjustment against the previous glyph (against
+        // 0 for the first; all 0 without dev-kerning), and the byte offset just past the glyph.
+        SkAutoTMalloc<SkFixed>  fAdvances;
+        SkAutoTMalloc<SkFixed>  fKerns;
+        SkAutoTMalloc<uint32_t> fEnds;
+    };
+
+    /** Returns true if runs of this length measured with this paint can be cached. */
+    static bool CanCache(const SkPaint&, size_t length);
+
+    /**
+     *  Return the ref'd advances of the text, from the cache if they are there. Otherwise they
+     *  are measured with *glyphCache and added to the cache; if *glyphCache is NULL, a cache is
+     *  detached from the paint first, and the caller must attach it when done with it. The
+     *  paint must be canonical (see SkCanonicalizePaint) and CanCache() must be true.
+     */
+    static const Run* FindOrMeasure(const SkPaint&, const void* text, size_t length,
+                                    SkGlyphCache** glyphCache);
+
+    static size_t GetTotalBytesUsed();
+    static void Purge();
+};
+
+#endif  // SkTextMeasureCache_DEFINED
@@ -221,6 +221,21 @@ bool SkValidatingReadBuffer::validateAvailable(size_t size) {
     return this->validate((size <= SK_MaxU32) && fReader.isAvailable(static_cast<uint32_t>(size)));
 }
 
+SkValidatingReadBuffer::ResolvedName SkValidatingReadBuffer::resolveName(
+        const SkString& name) {
+    if (const ResolvedName* resolved = fResolvedNames.find(name)) {
+        return *resolved;
+    }
+    ResolvedName resolved;
+    resolved.fFactory = NULL;
+    resolved.fType = SkFlattenable::kSkUnused_Type;
+    resolved.fFound = SkFlattenable::NameToType(name.c_str(), &resolved.fType);
+    if (resolved.fFound) {
+        resolved.fFactory = SkFlattenable::NameToFactory(name.c_str());
+    }
+    return *fResolvedNames.set(name, resolved);
+}
+
 SkFlattenable* SkValidatingReadBuffer::readFlattenable(SkFlattenable::Type type) {
     SkString name;
     this->readString(&name);
@@ -229,13 +244,12 @@ SkFlattenable* SkValidatingReadBuffer::readFlattenable(SkFlattenable::Type type)
     }
 
     // Is this the type we wanted ?
-    const char* cname = name.c_str();
-    SkFlattenable::Type baseType;
-    if (!SkFlattenable::NameToType(cname, &baseType) || (baseType != type)) {
+    const ResolvedName resolved = this->resolveName(name);
+    if (!resolved.fFound || (resolved.fType != type)) {
         return NULL;
     }
 
-    SkFlattenable::Factory factory = SkFlattenable::NameToFactory(cname);
+    SkFlattenable::Factory factory = resolved.fFactory;
     if (NULL == factory) {
         return NULL; // writer failed to give us the flattenable
     }
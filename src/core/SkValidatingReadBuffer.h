@@ -15,6 +15,7 @@
 #include "SkPath.h"
 #include "SkPicture.h"
 #include "SkReader32.h"
+#include "SkTHash.h"
 
 class SkBitmap;
 
@@ -75,7 +76,17 @@ private:
         return SkIsAlign4((uintptr_t)ptr);
     }
 
+    // Flattenables are named in full every time they appear, so remember what each name
+    // resolved to (including to nothing) rather than looking it up again.
+    struct ResolvedName {
+        SkFlattenable::Factory  fFactory;
+        SkFlattenable::Type     fType;
+        bool                    fFound;
+    };
+    ResolvedName resolveName(const SkString& name);
+
     bool fError;
+    SkTHashMap<SkString, ResolvedName> fResolvedNames;
 
     typedef SkReadBuffer INHERITED;
 };
@@ -20,7 +20,8 @@ SkWriteBuffer::SkWriteBuffer(uint32_t flags)
     , fFactorySet(NULL)
     , fNamedFactorySet(NULL)
     , fBitmapHeap(NULL)
-    , fTFSet(NULL) {
+    , fTFSet(NULL)
+    , fPathTolerance(0) {
 }
 
 SkWriteBuffer::SkWriteBuffer(void* storage, size_t storageSize, uint32_t flags)
@@ -29,7 +30,8 @@ SkWriteBuffer::SkWriteBuffer(void* storage, size_t storageSize, uint32_t flags)
     , fNamedFactorySet(NULL)
     , fWriter(storage, storageSize)
     , fBitmapHeap(NULL)
-    , fTFSet(NULL) {
+    , fTFSet(NULL)
+    , fPathTolerance(0) {
 }
 
 SkWriteBuffer::~SkWriteBuffer() {
@@ -126,7 +128,13 @@ void SkWriteBuffer::writeRegion(const SkRegion& region) {
 }
 
 void SkWriteBuffer::writePath(const SkPath& path) {
-    fWriter.writePath(path);
+    if (SkToBool(fFlags & kCompactPaths_Flag)) {
+        size_t size = path.writeCompactToMemory(NULL, fPathTolerance);
+        SkASSERT(SkAlign4(size) == size);
+        path.writeCompactToMemory(fWriter.reserve(size), fPathTolerance);
+    } else {
+        fWriter.writePath(path);
+    }
 }
 
 size_t SkWriteBuffer::writeStream(SkStream* stream, size_t length) {
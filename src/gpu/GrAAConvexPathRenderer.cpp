@@ -778,129 +778,117 @@ public:
         fBatch.fCanTweakAlphaForCoverage = init.fCanTweakAlphaForCoverage;
     }
 
-    void generateGeometryLinesOnly(GrBatchTarget* batchTarget, const GrPipeline* pipeline) {
-        bool canTweakAlphaForCoverage = this->canTweakAlphaForCoverage();
+    bool canPrepareGeometry() const override { return true; }
 
-        SkMatrix invert;
-        if (this->usesLocalCoords() && !this->viewMatrix().invert(&invert)) {
-            SkDebugf("Could not invert viewmatrix\n");
+    // Computes the vertices and indices for every path up front so that this can run on a worker
+    // thread. generateGeometry then just copies them into the batch target.
+    void prepareGeometry() override {
+        if (fPrepared) {
             return;
         }
+        fPrepared = true;
 
-        // Setup GrGeometryProcessor
-        SkAutoTUnref<const GrGeometryProcessor> gp(
-                                                create_fill_gp(canTweakAlphaForCoverage, invert,
-                                                               this->usesLocalCoords(),
-                                                               this->coverageIgnored()));
-
-        batchTarget->initDraw(gp, pipeline);
-
-        size_t vertexStride = gp->getVertexStride();
-
-        SkASSERT(canTweakAlphaForCoverage ?
-                 vertexStride == sizeof(GrDefaultGeoProcFactory::PositionColorAttr) :
-                 vertexStride == sizeof(GrDefaultGeoProcFactory::PositionColorCoverageAttr));
+        bool canTweakAlphaForCoverage = this->canTweakAlphaForCoverage();
+        size_t vertexStride = this->preparedVertexStride();
 
         GrAAConvexTessellator tess;
 
         int instanceCount = fGeoData.count();
-
         for (int i = 0; i < instanceCount; i++) {
-            tess.rewind();
-
             Geometry& args = fGeoData[i];
+            int drawCount = fPreparedDraws.count();
 
-            if (!tess.tessellate(args.fViewMatrix, args.fPath)) {
-                continue;
-            }
+            if (this->useLinesOnlyTessellator()) {
+                tess.rewind();
 
-            const GrVertexBuffer* vertexBuffer;
-            int firstVertex;
+                if (!tess.tessellate(args.fViewMatrix, args.fPath)) {
+                    continue;
+                }
 
-            void* verts = batchTarget->makeVertSpace(vertexStride, tess.numPts(),
-                                                     &vertexBuffer, &firstVertex);
-            if (!verts) {
-                SkDebugf("Could not allocate vertices\n");
-                return;
-            }
+                void* verts = fPreparedVerts.append(SkToInt(tess.numPts() * vertexStride));
+                uint16_t* idxs = fPreparedIndices.append(tess.numIndices());
+                extract_verts(tess, verts, vertexStride, args.fColor, idxs,
+                              canTweakAlphaForCoverage);
+
+                Draw& draw = fPreparedDraws.push_back();
+                draw.fVertexCnt = tess.numPts();
+                draw.fIndexCnt = tess.numIndices();
+            } else {
+                // We use the fact that SkPath::transform path does subdivision based on
+                // perspective. Otherwise, we apply the view matrix when copying to the
+                // segment representation.
+                const SkMatrix* viewMatrix = &args.fViewMatrix;
+                if (viewMatrix->hasPerspective()) {
+                    args.fPath.transform(*viewMatrix);
+                    viewMatrix = &SkMatrix::I();
+                }
 
-            const GrIndexBuffer* indexBuffer;
-            int firstIndex;
+                int vertexCount;
+                int indexCount;
+                enum {
+                    kPreallocSegmentCnt = 512 / sizeof(Segment),
+                };
+                SkSTArray<kPreallocSegmentCnt, Segment, true> segments;
+                SkPoint fanPt;
+
+                if (!get_segments(args.fPath, *viewMatrix, &segments, &fanPt, &vertexCount,
+                                  &indexCount)) {
+                    continue;
+                }
 
-            uint16_t* idxs = batchTarget->makeIndexSpace(tess.numIndices(),
-                                                        &indexBuffer, &firstIndex);
-            if (!idxs) {
-                SkDebugf("Could not allocate indices\n");
-                return;
+                QuadVertex* verts = reinterpret_cast<QuadVertex*>(
+                        fPreparedVerts.append(SkToInt(vertexCount * vertexStride)));
+                uint16_t* idxs = fPreparedIndices.append(indexCount);
+                create_vertices(segments, fanPt, &fPreparedDraws, verts, idxs);
             }
 
-            extract_verts(tess, verts, vertexStride, args.fColor, idxs, canTweakAlphaForCoverage);
-
-            GrVertices info;
-            info.initIndexed(kTriangles_GrPrimitiveType,
-                             vertexBuffer, indexBuffer,
-                             firstVertex, firstIndex,
-                             tess.numPts(), tess.numIndices());
-            batchTarget->draw(info);
+            int* drawsForPath = fPreparedDrawCounts.append();
+            *drawsForPath = fPreparedDraws.count() - drawCount;
         }
     }
 
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
-#ifndef SK_IGNORE_LINEONLY_AA_CONVEX_PATH_OPTS
-        if (this->linesOnly()) {
-            this->generateGeometryLinesOnly(batchTarget, pipeline);
-            return;
-        }
-#endif
-
-        int instanceCount = fGeoData.count();
-
         SkMatrix invert;
         if (this->usesLocalCoords() && !this->viewMatrix().invert(&invert)) {
             SkDebugf("Could not invert viewmatrix\n");
             return;
         }
 
-        // Setup GrGeometryProcessor
-        SkAutoTUnref<GrGeometryProcessor> quadProcessor(
-                QuadEdgeEffect::Create(this->color(), invert, this->usesLocalCoords()));
+        // A no-op if the batch was already prepared on another thread.
+        this->prepareGeometry();
 
-        batchTarget->initDraw(quadProcessor, pipeline);
+        // Setup GrGeometryProcessor
+        SkAutoTUnref<const GrGeometryProcessor> gp;
+        if (this->useLinesOnlyTessellator()) {
+            gp.reset(create_fill_gp(this->canTweakAlphaForCoverage(), invert,
+                                    this->usesLocalCoords(), this->coverageIgnored()));
+        } else {
+            gp.reset(QuadEdgeEffect::Create(this->color(), invert, this->usesLocalCoords()));
+        }
 
-        // TODO generate all segments for all paths and use one vertex buffer
-        for (int i = 0; i < instanceCount; i++) {
-            Geometry& args = fGeoData[i];
+        batchTarget->initDraw(gp, pipeline);
 
-            // We use the fact that SkPath::transform path does subdivision based on
-            // perspective. Otherwise, we apply the view matrix when copying to the
-            // segment representation.
-            const SkMatrix* viewMatrix = &args.fViewMatrix;
-            if (viewMatrix->hasPerspective()) {
-                args.fPath.transform(*viewMatrix);
-                viewMatrix = &SkMatrix::I();
-            }
+        size_t vertexStride = gp->getVertexStride();
+        SkASSERT(vertexStride == this->preparedVertexStride());
 
-            int vertexCount;
-            int indexCount;
-            enum {
-                kPreallocSegmentCnt = 512 / sizeof(Segment),
-                kPreallocDrawCnt = 4,
-            };
-            SkSTArray<kPreallocSegmentCnt, Segment, true> segments;
-            SkPoint fanPt;
+        const char* srcVerts = fPreparedVerts.begin();
+        const uint16_t* srcIdxs = fPreparedIndices.begin();
+        const Draw* draw = fPreparedDraws.begin();
 
-            if (!get_segments(args.fPath, *viewMatrix, &segments, &fanPt, &vertexCount,
-                              &indexCount)) {
-                continue;
+        // TODO generate all segments for all paths and use one vertex buffer
+        for (int i = 0; i < fPreparedDrawCounts.count(); i++) {
+            int vertexCount = 0;
+            int indexCount = 0;
+            for (int j = 0; j < fPreparedDrawCounts[i]; ++j) {
+                vertexCount += draw[j].fVertexCnt;
+                indexCount += draw[j].fIndexCnt;
             }
 
             const GrVertexBuffer* vertexBuffer;
             int firstVertex;
 
-            size_t vertexStride = quadProcessor->getVertexStride();
-            QuadVertex* verts = reinterpret_cast<QuadVertex*>(batchTarget->makeVertSpace(
-                vertexStride, vertexCount, &vertexBuffer, &firstVertex));
-
+            void* verts = batchTarget->makeVertSpace(vertexStride, vertexCount,
+                                                     &vertexBuffer, &firstVertex);
             if (!verts) {
                 SkDebugf("Could not allocate vertices\n");
                 return;
@@ -909,24 +897,25 @@ public:
             const GrIndexBuffer* indexBuffer;
             int firstIndex;
 
-            uint16_t *idxs = batchTarget->makeIndexSpace(indexCount, &indexBuffer, &firstIndex);
+            uint16_t* idxs = batchTarget->makeIndexSpace(indexCount, &indexBuffer, &firstIndex);
             if (!idxs) {
                 SkDebugf("Could not allocate indices\n");
                 return;
             }
 
-            SkSTArray<kPreallocDrawCnt, Draw, true> draws;
-            create_vertices(segments, fanPt, &draws, verts, idxs);
+            memcpy(verts, srcVerts, vertexCount * vertexStride);
+            memcpy(idxs, srcIdxs, indexCount * sizeof(uint16_t));
+            srcVerts += vertexCount * vertexStride;
+            srcIdxs += indexCount;
 
             GrVertices vertices;
 
-            for (int i = 0; i < draws.count(); ++i) {
-                const Draw& draw = draws[i];
+            for (int j = 0; j < fPreparedDrawCounts[i]; ++j, ++draw) {
                 vertices.initIndexed(kTriangles_GrPrimitiveType, vertexBuffer, indexBuffer,
-                                     firstVertex, firstIndex, draw.fVertexCnt, draw.fIndexCnt);
+                                     firstVertex, firstIndex, draw->fVertexCnt, draw->fIndexCnt);
                 batchTarget->draw(vertices);
-                firstVertex += draw.fVertexCnt;
-                firstIndex += draw.fIndexCnt;
+                firstVertex += draw->fVertexCnt;
+                firstIndex += draw->fIndexCnt;
             }
         }
     }
@@ -934,7 +923,7 @@ public:
     SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
 
 private:
-    AAConvexPathBatch(const Geometry& geometry) {
+    AAConvexPathBatch(const Geometry& geometry) : fPrepared(false) {
         this->initClassID<AAConvexPathBatch>();
         fGeoData.push_back(geometry);
 
@@ -970,6 +959,23 @@ private:
         return true;
     }
 
+    bool useLinesOnlyTessellator() const {
+#ifndef SK_IGNORE_LINEONLY_AA_CONVEX_PATH_OPTS
+        return this->linesOnly();
+#else
+        return false;
+#endif
+    }
+
+    size_t preparedVertexStride() const {
+        if (!this->useLinesOnlyTessellator()) {
+            return sizeof(QuadVertex);
+        }
+        return this->canTweakAlphaForCoverage() ?
+               sizeof(GrDefaultGeoProcFactory::PositionColorAttr) :
+               sizeof(GrDefaultGeoProcFactory::PositionColorCoverageAttr);
+    }
+
     GrColor color() const { return fBatch.fColor; }
     bool linesOnly() const { return fBatch.fLinesOnly; }
     bool usesLocalCoords() const { return fBatch.fUsesLocalCoords; }
@@ -988,6 +994,14 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry: the vertices and indices of every path packed back to back, the
+    // draws they are split into, and how many of those draws belong to each path.
+    bool fPrepared;
+    SkTDArray<char> fPreparedVerts;
+    SkTDArray<uint16_t> fPreparedIndices;
+    DrawArray fPreparedDraws;
+    SkTDArray<int> fPreparedDrawCounts;
 };
 
 bool GrAAConvexPathRenderer::onDrawPath(GrDrawTarget* target,
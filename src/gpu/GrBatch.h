@@ -63,6 +63,18 @@ public:
 
     virtual bool onCombineIfPossible(GrBatch*) = 0;
 
+    /*
+     * Batches which do CPU-heavy work to compute their vertices (tessellation, segment extraction)
+     * can return true here and do that work in prepareGeometry. At flush time all such batches are
+     * prepared concurrently on SkTaskGroup threads before any geometry is generated, and
+     * generateGeometry then only copies the results into the GrBatchTarget in order.
+     * prepareGeometry runs after the batch has been combined and had its batch tracker
+     * initialized, and must not touch the GrBatchTarget, the GPU, or state shared with other
+     * batches.
+     */
+    virtual bool canPrepareGeometry() const { return false; }
+    virtual void prepareGeometry() {}
+
     virtual void generateGeometry(GrBatchTarget*, const GrPipeline*) = 0;
 
     const SkRect& bounds() const { return fBounds; }
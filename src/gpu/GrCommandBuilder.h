@@ -21,7 +21,7 @@ public:
 
     virtual ~GrCommandBuilder() {}
 
-    void reset() { fCommands.reset(); }
+    virtual void reset() { fCommands.reset(); }
     void flush(GrInOrderDrawBuffer* iodb) { fCommands.flush(iodb); }
 
     virtual Cmd* recordClearStencilClip(const SkIRect& rect,
@@ -69,13 +69,15 @@ protected:
     typedef GrTargetCommands::CopySurface CopySurface;
     typedef GrTargetCommands::XferBarrier XferBarrier;
 
-    GrCommandBuilder(GrGpu* gpu) : fCommands(gpu) {}
+    GrCommandBuilder(GrGpu* gpu) : fCommands(gpu), fGpu(gpu) {}
 
     GrTargetCommands::CmdBuffer* cmdBuffer() { return fCommands.cmdBuffer(); }
     GrBatchTarget* batchTarget() { return fCommands.batchTarget(); }
+    GrGpu* gpu() { return fGpu; }
 
 private:
     GrTargetCommands fCommands;
+    GrGpu*           fGpu;
 
 };
 
@@ -237,6 +237,13 @@ void GrContext::freeGpuResources() {
     fResourceCache->purgeAllUnlocked();
 }
 
+int GrContext::warmUpProgramCache(const SkData* const keys[], int count) {
+    if (fDrawingMgr.abandoned()) {
+        return 0;
+    }
+    return fGpu->warmUpProgramCache(keys, count);
+}
+
 void GrContext::getResourceCacheUsage(int* resourceCount, size_t* resourceBytes) const {
     if (resourceCount) {
         *resourceCount = fResourceCache->getBudgetedResourceCount();
@@ -33,6 +33,7 @@ class GrSurface;
 class GrTexture;
 class GrVertexBuffer;
 class GrVertices;
+class SkData;
 
 class GrGpu : public SkRefCnt {
 public:
@@ -279,6 +280,9 @@ public:
     // Called before certain draws in order to guarantee coherent results from dst reads.
     virtual void xferBarrier(GrRenderTarget*, GrXferBarrierType) = 0;
 
+    // Preloads programs from the client's persistent program cache. Returns the number found.
+    virtual int warmUpProgramCache(const SkData* const keys[], int count) { return 0; }
+
     struct DrawArgs {
         DrawArgs(const GrPrimitiveProcessor* primProc,
                  const GrPipeline* pipeline,
@@ -312,6 +316,10 @@ public:
             fTextureCreates = 0;
             fTextureUploads = 0;
             fStencilAttachmentCreates = 0;
+            fBatchesMerged = 0;
+            fBatchesIssued = 0;
+            fProgramCacheHits = 0;
+            fProgramCacheMisses = 0;
         }
 
         int renderTargetBinds() const { return fRenderTargetBinds; }
@@ -323,6 +331,14 @@ public:
         int textureUploads() const { return fTextureUploads; }
         void incTextureUploads() { fTextureUploads++; }
         void incStencilAttachmentCreates() { fStencilAttachmentCreates++; }
+        int batchesMerged() const { return fBatchesMerged; }
+        void incBatchesMerged() { fBatchesMerged++; }
+        int batchesIssued() const { return fBatchesIssued; }
+        void incBatchesIssued() { fBatchesIssued++; }
+        int programCacheHits() const { return fProgramCacheHits; }
+        void incProgramCacheHits() { fProgramCacheHits++; }
+        int programCacheMisses() const { return fProgramCacheMisses; }
+        void incProgramCacheMisses() { fProgramCacheMisses++; }
         void dump(SkString*);
 
     private:
@@ -331,6 +347,10 @@ public:
         int fTextureCreates;
         int fTextureUploads;
         int fStencilAttachmentCreates;
+        int fBatchesMerged;
+        int fBatchesIssued;
+        int fProgramCacheHits;
+        int fProgramCacheMisses;
 #else
         void dump(SkString*) {};
         void incRenderTargetBinds() {}
@@ -338,6 +358,10 @@ public:
         void incTextureCreates() {}
         void incTextureUploads() {}
         void incStencilAttachmentCreates() {}
+        void incBatchesMerged() {}
+        void incBatchesIssued() {}
+        void incProgramCacheHits() {}
+        void incProgramCacheMisses() {}
 #endif
     };
 
@@ -31,6 +31,7 @@ GrTargetCommands::Cmd* GrInOrderCommandBuilder::recordDrawBatch(State* state, Gr
         Cmd::kDrawBatch_CmdType == this->cmdBuffer()->back().type()) {
         DrawBatch* previous = static_cast<DrawBatch*>(&this->cmdBuffer()->back());
         if (previous->fState == state && previous->fBatch->combineIfPossible(batch)) {
+            this->gpu()->stats()->incBatchesMerged();
             return NULL;
         }
     }
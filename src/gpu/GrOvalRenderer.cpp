@@ -19,6 +19,7 @@
 #include "GrVertexBuffer.h"
 #include "SkRRect.h"
 #include "SkStrokeRec.h"
+#include "SkTDArray.h"
 #include "SkTLazy.h"
 #include "effects/GrRRectEffect.h"
 #include "gl/GrGLProcessor.h"
@@ -54,6 +55,11 @@ inline bool circle_stays_circle(const SkMatrix& m) {
     return m.isSimilarity();
 }
 
+// Oval and rrect vertices take little work to compute, so a batch only writes them ahead of time
+// in prepareGeometry, and copies them in generateGeometry, once it has enough instances for that
+// to beat writing them in place.
+static const int kMinPreparedInstances = 256;
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -676,6 +682,15 @@ public:
         fBatch.fCoverageIgnored = init.fCoverageIgnored;
     }
 
+    bool canPrepareGeometry() const override { return fGeoData.count() >= kMinPreparedInstances; }
+
+    void prepareGeometry() override {
+        if (fPreparedVerts.isEmpty()) {
+            fPreparedVerts.setCount(fGeoData.count() * kVerticesPerQuad);
+            this->writeVertices(fPreparedVerts.begin());
+        }
+    }
+
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
         SkMatrix invert;
         if (!this->viewMatrix().invert(&invert)) {
@@ -700,37 +715,10 @@ public:
             return;
         }
 
-        for (int i = 0; i < instanceCount; i++) {
-            Geometry& geom = fGeoData[i];
-
-            SkScalar innerRadius = geom.fInnerRadius;
-            SkScalar outerRadius = geom.fOuterRadius;
-
-            const SkRect& bounds = geom.fDevBounds;
-
-            // The inner radius in the vertex data must be specified in normalized space.
-            innerRadius = innerRadius / outerRadius;
-            verts[0].fPos = SkPoint::Make(bounds.fLeft,  bounds.fTop);
-            verts[0].fOffset = SkPoint::Make(-1, -1);
-            verts[0].fOuterRadius = outerRadius;
-            verts[0].fInnerRadius = innerRadius;
-
-            verts[1].fPos = SkPoint::Make(bounds.fLeft,  bounds.fBottom);
-            verts[1].fOffset = SkPoint::Make(-1, 1);
-            verts[1].fOuterRadius = outerRadius;
-            verts[1].fInnerRadius = innerRadius;
-
-            verts[2].fPos = SkPoint::Make(bounds.fRight, bounds.fBottom);
-            verts[2].fOffset = SkPoint::Make(1, 1);
-            verts[2].fOuterRadius = outerRadius;
-            verts[2].fInnerRadius = innerRadius;
-
-            verts[3].fPos = SkPoint::Make(bounds.fRight, bounds.fTop);
-            verts[3].fOffset = SkPoint::Make(1, -1);
-            verts[3].fOuterRadius = outerRadius;
-            verts[3].fInnerRadius = innerRadius;
-
-            verts += kVerticesPerQuad;
+        if (fPreparedVerts.isEmpty()) {
+            this->writeVertices(verts);
+        } else {
+            memcpy(verts, fPreparedVerts.begin(), fPreparedVerts.count() * sizeof(CircleVertex));
         }
         helper.issueDraw(batchTarget);
     }
@@ -767,6 +755,42 @@ private:
         return true;
     }
 
+    void writeVertices(CircleVertex* verts) const {
+        int instanceCount = fGeoData.count();
+        for (int i = 0; i < instanceCount; i++) {
+            const Geometry& geom = fGeoData[i];
+
+            SkScalar innerRadius = geom.fInnerRadius;
+            SkScalar outerRadius = geom.fOuterRadius;
+
+            const SkRect& bounds = geom.fDevBounds;
+
+            // The inner radius in the vertex data must be specified in normalized space.
+            innerRadius = innerRadius / outerRadius;
+            verts[0].fPos = SkPoint::Make(bounds.fLeft,  bounds.fTop);
+            verts[0].fOffset = SkPoint::Make(-1, -1);
+            verts[0].fOuterRadius = outerRadius;
+            verts[0].fInnerRadius = innerRadius;
+
+            verts[1].fPos = SkPoint::Make(bounds.fLeft,  bounds.fBottom);
+            verts[1].fOffset = SkPoint::Make(-1, 1);
+            verts[1].fOuterRadius = outerRadius;
+            verts[1].fInnerRadius = innerRadius;
+
+            verts[2].fPos = SkPoint::Make(bounds.fRight, bounds.fBottom);
+            verts[2].fOffset = SkPoint::Make(1, 1);
+            verts[2].fOuterRadius = outerRadius;
+            verts[2].fInnerRadius = innerRadius;
+
+            verts[3].fPos = SkPoint::Make(bounds.fRight, bounds.fTop);
+            verts[3].fOffset = SkPoint::Make(1, -1);
+            verts[3].fOuterRadius = outerRadius;
+            verts[3].fInnerRadius = innerRadius;
+
+            verts += kVerticesPerQuad;
+        }
+    }
+
     GrColor color() const { return fBatch.fColor; }
     bool usesLocalCoords() const { return fBatch.fUsesLocalCoords; }
     const SkMatrix& viewMatrix() const { return fGeoData[0].fViewMatrix; }
@@ -782,6 +806,9 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry, if it ran.
+    SkTDArray<CircleVertex> fPreparedVerts;
 };
 
 static GrBatch* create_circle_batch(GrColor color,
@@ -891,6 +918,15 @@ public:
         fBatch.fCoverageIgnored = init.fCoverageIgnored;
     }
 
+    bool canPrepareGeometry() const override { return fGeoData.count() >= kMinPreparedInstances; }
+
+    void prepareGeometry() override {
+        if (fPreparedVerts.isEmpty()) {
+            fPreparedVerts.setCount(fGeoData.count() * kVerticesPerQuad);
+            this->writeVertices(fPreparedVerts.begin());
+        }
+    }
+
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
         SkMatrix invert;
         if (!this->viewMatrix().invert(&invert)) {
@@ -915,8 +951,50 @@ public:
             return;
         }
 
+        if (fPreparedVerts.isEmpty()) {
+            this->writeVertices(verts);
+        } else {
+            memcpy(verts, fPreparedVerts.begin(), fPreparedVerts.count() * sizeof(EllipseVertex));
+        }
+        helper.issueDraw(batchTarget);
+    }
+
+    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
+
+private:
+    EllipseBatch(const Geometry& geometry) {
+        this->initClassID<EllipseBatch>();
+        fGeoData.push_back(geometry);
+
+        this->setBounds(geometry.fDevBounds);
+    }
+
+    bool onCombineIfPossible(GrBatch* t) override {
+        EllipseBatch* that = t->cast<EllipseBatch>();
+
+        // TODO use vertex color to avoid breaking batches
+        if (this->color() != that->color()) {
+            return false;
+        }
+
+        if (this->stroke() != that->stroke()) {
+            return false;
+        }
+
+        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
+        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
+            return false;
+        }
+
+        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
+        this->joinBounds(that->bounds());
+        return true;
+    }
+
+    void writeVertices(EllipseVertex* verts) const {
+        int instanceCount = fGeoData.count();
         for (int i = 0; i < instanceCount; i++) {
-            Geometry& geom = fGeoData[i];
+            const Geometry& geom = fGeoData[i];
 
             SkScalar xRadius = geom.fXRadius;
             SkScalar yRadius = geom.fYRadius;
@@ -952,39 +1030,6 @@ public:
 
             verts += kVerticesPerQuad;
         }
-        helper.issueDraw(batchTarget);
-    }
-
-    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
-
-private:
-    EllipseBatch(const Geometry& geometry) {
-        this->initClassID<EllipseBatch>();
-        fGeoData.push_back(geometry);
-
-        this->setBounds(geometry.fDevBounds);
-    }
-
-    bool onCombineIfPossible(GrBatch* t) override {
-        EllipseBatch* that = t->cast<EllipseBatch>();
-
-        // TODO use vertex color to avoid breaking batches
-        if (this->color() != that->color()) {
-            return false;
-        }
-
-        if (this->stroke() != that->stroke()) {
-            return false;
-        }
-
-        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
-        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
-            return false;
-        }
-
-        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
-        this->joinBounds(that->bounds());
-        return true;
     }
 
     GrColor color() const { return fBatch.fColor; }
@@ -1002,6 +1047,9 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry, if it ran.
+    SkTDArray<EllipseVertex> fPreparedVerts;
 };
 
 static GrBatch* create_ellipse_batch(GrColor color,
@@ -1155,6 +1203,15 @@ public:
         fBatch.fCoverageIgnored = init.fCoverageIgnored;
     }
 
+    bool canPrepareGeometry() const override { return fGeoData.count() >= kMinPreparedInstances; }
+
+    void prepareGeometry() override {
+        if (fPreparedVerts.isEmpty()) {
+            fPreparedVerts.setCount(fGeoData.count() * kVerticesPerQuad);
+            this->writeVertices(fPreparedVerts.begin());
+        }
+    }
+
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
         // Setup geometry processor
         SkAutoTUnref<GrGeometryProcessor> gp(DIEllipseEdgeEffect::Create(this->color(),
@@ -1174,38 +1231,10 @@ public:
             return;
         }
 
-        for (int i = 0; i < instanceCount; i++) {
-            Geometry& geom = fGeoData[i];
-
-            SkScalar xRadius = geom.fXRadius;
-            SkScalar yRadius = geom.fYRadius;
-
-            const SkRect& bounds = geom.fBounds;
-
-            // This adjusts the "radius" to include the half-pixel border
-            SkScalar offsetDx = geom.fGeoDx / xRadius;
-            SkScalar offsetDy = geom.fGeoDy / yRadius;
-
-            SkScalar innerRatioX = xRadius / geom.fInnerXRadius;
-            SkScalar innerRatioY = yRadius / geom.fInnerYRadius;
-
-            verts[0].fPos = SkPoint::Make(bounds.fLeft, bounds.fTop);
-            verts[0].fOuterOffset = SkPoint::Make(-1.0f - offsetDx, -1.0f - offsetDy);
-            verts[0].fInnerOffset = SkPoint::Make(-innerRatioX - offsetDx, -innerRatioY - offsetDy);
-
-            verts[1].fPos = SkPoint::Make(bounds.fLeft,  bounds.fBottom);
-            verts[1].fOuterOffset = SkPoint::Make(-1.0f - offsetDx, 1.0f + offsetDy);
-            verts[1].fInnerOffset = SkPoint::Make(-innerRatioX - offsetDx, innerRatioY + offsetDy);
-
-            verts[2].fPos = SkPoint::Make(bounds.fRight, bounds.fBottom);
-            verts[2].fOuterOffset = SkPoint::Make(1.0f + offsetDx, 1.0f + offsetDy);
-            verts[2].fInnerOffset = SkPoint::Make(innerRatioX + offsetDx, innerRatioY + offsetDy);
-
-            verts[3].fPos = SkPoint::Make(bounds.fRight, bounds.fTop);
-            verts[3].fOuterOffset = SkPoint::Make(1.0f + offsetDx, -1.0f - offsetDy);
-            verts[3].fInnerOffset = SkPoint::Make(innerRatioX + offsetDx, -innerRatioY - offsetDy);
-
-            verts += kVerticesPerQuad;
+        if (fPreparedVerts.isEmpty()) {
+            this->writeVertices(verts);
+        } else {
+            memcpy(verts, fPreparedVerts.begin(), fPreparedVerts.count() * sizeof(DIEllipseVertex));
         }
         helper.issueDraw(batchTarget);
     }
@@ -1242,6 +1271,43 @@ private:
         return true;
     }
 
+    void writeVertices(DIEllipseVertex* verts) const {
+        int instanceCount = fGeoData.count();
+        for (int i = 0; i < instanceCount; i++) {
+            const Geometry& geom = fGeoData[i];
+
+            SkScalar xRadius = geom.fXRadius;
+            SkScalar yRadius = geom.fYRadius;
+
+            const SkRect& bounds = geom.fBounds;
+
+            // This adjusts the "radius" to include the half-pixel border
+            SkScalar offsetDx = geom.fGeoDx / xRadius;
+            SkScalar offsetDy = geom.fGeoDy / yRadius;
+
+            SkScalar innerRatioX = xRadius / geom.fInnerXRadius;
+            SkScalar innerRatioY = yRadius / geom.fInnerYRadius;
+
+            verts[0].fPos = SkPoint::Make(bounds.fLeft, bounds.fTop);
+            verts[0].fOuterOffset = SkPoint::Make(-1.0f - offsetDx, -1.0f - offsetDy);
+            verts[0].fInnerOffset = SkPoint::Make(-innerRatioX - offsetDx, -innerRatioY - offsetDy);
+
+            verts[1].fPos = SkPoint::Make(bounds.fLeft,  bounds.fBottom);
+            verts[1].fOuterOffset = SkPoint::Make(-1.0f - offsetDx, 1.0f + offsetDy);
+            verts[1].fInnerOffset = SkPoint::Make(-innerRatioX - offsetDx, innerRatioY + offsetDy);
+
+            verts[2].fPos = SkPoint::Make(bounds.fRight, bounds.fBottom);
+            verts[2].fOuterOffset = SkPoint::Make(1.0f + offsetDx, 1.0f + offsetDy);
+            verts[2].fInnerOffset = SkPoint::Make(innerRatioX + offsetDx, innerRatioY + offsetDy);
+
+            verts[3].fPos = SkPoint::Make(bounds.fRight, bounds.fTop);
+            verts[3].fOuterOffset = SkPoint::Make(1.0f + offsetDx, -1.0f - offsetDy);
+            verts[3].fInnerOffset = SkPoint::Make(innerRatioX + offsetDx, -innerRatioY - offsetDy);
+
+            verts += kVerticesPerQuad;
+        }
+    }
+
     GrColor color() const { return fBatch.fColor; }
     bool usesLocalCoords() const { return fBatch.fUsesLocalCoords; }
     const SkMatrix& viewMatrix() const { return fGeoData[0].fViewMatrix; }
@@ -1257,6 +1323,9 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry, if it ran.
+    SkTDArray<DIEllipseVertex> fPreparedVerts;
 };
 
 static GrBatch* create_diellipse_batch(GrColor color,
@@ -1504,6 +1573,15 @@ public:
         fBatch.fCoverageIgnored = init.fCoverageIgnored;
     }
 
+    bool canPrepareGeometry() const override { return fGeoData.count() >= kMinPreparedInstances; }
+
+    void prepareGeometry() override {
+        if (fPreparedVerts.isEmpty()) {
+            fPreparedVerts.setCount(fGeoData.count() * kVertsPerRRect);
+            this->writeVertices(fPreparedVerts.begin());
+        }
+    }
+
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
         // reset to device coordinates
         SkMatrix invert;
@@ -1538,8 +1616,51 @@ public:
             return;
         }
 
+        if (fPreparedVerts.isEmpty()) {
+            this->writeVertices(verts);
+        } else {
+            memcpy(verts, fPreparedVerts.begin(), fPreparedVerts.count() * sizeof(CircleVertex));
+        }
+
+        helper.issueDraw(batchTarget);
+    }
+
+    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
+
+private:
+    RRectCircleRendererBatch(const Geometry& geometry) {
+        this->initClassID<RRectCircleRendererBatch>();
+        fGeoData.push_back(geometry);
+
+        this->setBounds(geometry.fDevBounds);
+    }
+
+    bool onCombineIfPossible(GrBatch* t) override {
+        RRectCircleRendererBatch* that = t->cast<RRectCircleRendererBatch>();
+
+        // TODO use vertex color to avoid breaking batches
+        if (this->color() != that->color()) {
+            return false;
+        }
+
+        if (this->stroke() != that->stroke()) {
+            return false;
+        }
+
+        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
+        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
+            return false;
+        }
+
+        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
+        this->joinBounds(that->bounds());
+        return true;
+    }
+
+    void writeVertices(CircleVertex* verts) const {
+        int instanceCount = fGeoData.count();
         for (int i = 0; i < instanceCount; i++) {
-            Geometry& args = fGeoData[i];
+            const Geometry& args = fGeoData[i];
 
             SkScalar outerRadius = args.fOuterRadius;
 
@@ -1581,40 +1702,6 @@ public:
                 verts++;
             }
         }
-
-        helper.issueDraw(batchTarget);
-    }
-
-    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
-
-private:
-    RRectCircleRendererBatch(const Geometry& geometry) {
-        this->initClassID<RRectCircleRendererBatch>();
-        fGeoData.push_back(geometry);
-
-        this->setBounds(geometry.fDevBounds);
-    }
-
-    bool onCombineIfPossible(GrBatch* t) override {
-        RRectCircleRendererBatch* that = t->cast<RRectCircleRendererBatch>();
-
-        // TODO use vertex color to avoid breaking batches
-        if (this->color() != that->color()) {
-            return false;
-        }
-
-        if (this->stroke() != that->stroke()) {
-            return false;
-        }
-
-        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
-        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
-            return false;
-        }
-
-        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
-        this->joinBounds(that->bounds());
-        return true;
     }
 
     GrColor color() const { return fBatch.fColor; }
@@ -1632,6 +1719,9 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry, if it ran.
+    SkTDArray<CircleVertex> fPreparedVerts;
 };
 
 class RRectEllipseRendererBatch : public GrBatch {
@@ -1677,6 +1767,15 @@ public:
         fBatch.fCoverageIgnored = init.fCoverageIgnored;
     }
 
+    bool canPrepareGeometry() const override { return fGeoData.count() >= kMinPreparedInstances; }
+
+    void prepareGeometry() override {
+        if (fPreparedVerts.isEmpty()) {
+            fPreparedVerts.setCount(fGeoData.count() * kVertsPerRRect);
+            this->writeVertices(fPreparedVerts.begin());
+        }
+    }
+
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
         // reset to device coordinates
         SkMatrix invert;
@@ -1711,8 +1810,50 @@ public:
             return;
         }
 
+        if (fPreparedVerts.isEmpty()) {
+            this->writeVertices(verts);
+        } else {
+            memcpy(verts, fPreparedVerts.begin(), fPreparedVerts.count() * sizeof(EllipseVertex));
+        }
+        helper.issueDraw(batchTarget);
+    }
+
+    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
+
+private:
+    RRectEllipseRendererBatch(const Geometry& geometry) {
+        this->initClassID<RRectEllipseRendererBatch>();
+        fGeoData.push_back(geometry);
+
+        this->setBounds(geometry.fDevBounds);
+    }
+
+    bool onCombineIfPossible(GrBatch* t) override {
+        RRectEllipseRendererBatch* that = t->cast<RRectEllipseRendererBatch>();
+
+        // TODO use vertex color to avoid breaking batches
+        if (this->color() != that->color()) {
+            return false;
+        }
+
+        if (this->stroke() != that->stroke()) {
+            return false;
+        }
+
+        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
+        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
+            return false;
+        }
+
+        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
+        this->joinBounds(that->bounds());
+        return true;
+    }
+
+    void writeVertices(EllipseVertex* verts) const {
+        int instanceCount = fGeoData.count();
         for (int i = 0; i < instanceCount; i++) {
-            Geometry& args = fGeoData[i];
+            const Geometry& args = fGeoData[i];
 
             // Compute the reciprocals of the radii here to save time in the shader
             SkScalar xRadRecip = SkScalarInvert(args.fXRadius);
@@ -1765,39 +1906,6 @@ public:
                 verts++;
             }
         }
-        helper.issueDraw(batchTarget);
-    }
-
-    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
-
-private:
-    RRectEllipseRendererBatch(const Geometry& geometry) {
-        this->initClassID<RRectEllipseRendererBatch>();
-        fGeoData.push_back(geometry);
-
-        this->setBounds(geometry.fDevBounds);
-    }
-
-    bool onCombineIfPossible(GrBatch* t) override {
-        RRectEllipseRendererBatch* that = t->cast<RRectEllipseRendererBatch>();
-
-        // TODO use vertex color to avoid breaking batches
-        if (this->color() != that->color()) {
-            return false;
-        }
-
-        if (this->stroke() != that->stroke()) {
-            return false;
-        }
-
-        SkASSERT(this->usesLocalCoords() == that->usesLocalCoords());
-        if (this->usesLocalCoords() && !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
-            return false;
-        }
-
-        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
-        this->joinBounds(that->bounds());
-        return true;
     }
 
     GrColor color() const { return fBatch.fColor; }
@@ -1815,6 +1923,9 @@ private:
 
     BatchTracker fBatch;
     SkSTArray<1, Geometry, true> fGeoData;
+
+    // Output of prepareGeometry, if it ran.
+    SkTDArray<EllipseVertex> fPreparedVerts;
 };
 
 static GrBatch* create_rrect_batch(GrColor color,
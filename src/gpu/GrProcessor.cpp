@@ -50,7 +50,7 @@ GrProcessorTestFactory<GrGeometryProcessor>::GetFactories() {
  * manually adjusted.
  */
 static const int kFPFactoryCount = 37;
-static const int kGPFactoryCount = 14;
+static const int kGPFactoryCount = 15;
 static const int kXPFactoryCount = 5;
 
 template<>
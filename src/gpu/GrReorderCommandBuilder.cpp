@@ -15,46 +15,93 @@ static bool intersect(const Left& a, const Right& b) {
            a.fTop < b.fBottom && b.fTop < a.fBottom;
 }
 
+void GrReorderCommandBuilder::reset() {
+    fCandidates.rewind();
+    INHERITED::reset();
+}
+
 GrTargetCommands::Cmd* GrReorderCommandBuilder::recordDrawBatch(State* state, GrBatch* batch) {
-    // Check if there is a Batch Draw we can batch with by linearly searching back until we either
-    // 1) check every draw
+    // Check if there is a Batch Draw we can batch with by searching back through the candidates
+    // until we either
+    // 1) check every draw since the last command we can't reorder across
     // 2) intersect with something
-    // 3) find a 'blocker'
-    // Experimentally we have found that most batching occurs within the first 10 comparisons.
-    static const int kMaxLookback = 10;
-    int i = 0;
-    if (!this->cmdBuffer()->empty()) {
-        GrTargetCommands::CmdBuffer::ReverseIter reverseIter(*this->cmdBuffer());
-
-        do {
-            if (Cmd::kDrawBatch_CmdType == reverseIter->type()) {
-                DrawBatch* previous = static_cast<DrawBatch*>(reverseIter.get());
-
-                if (previous->fState->getPipeline()->isEqual(*state->getPipeline()) &&
-                    previous->fBatch->combineIfPossible(batch)) {
-                    return NULL;
-                }
-
-                if (intersect(previous->fBatch->bounds(), batch->bounds())) {
-                    break;
-                }
-            } else if (Cmd::kClear_CmdType == reverseIter->type()) {
-                Clear* previous = static_cast<Clear*>(reverseIter.get());
-
-                // We set the color to illegal if we are doing a discard.
-                // If we can ignore the rect, then we do a full clear
-                if (previous->fColor == GrColor_ILLEGAL ||
-                    previous->fCanIgnoreRect ||
-                    intersect(batch->bounds(), previous->fRect)) {
-                    break;
-                }
-            } else {
-                // TODO temporary until we can navigate the other types of commands
-                break;
-            }
-        } while (reverseIter.previous() && ++i < kMaxLookback);
+    // 3) look at kMaxLookback candidates
+    // Batches whose bounds don't overlap are independent, so a new batch can merge with a
+    // compatible one many disjoint draws back. The walk is still capped: each step may compare
+    // pipelines, and a long run of draws that never merge would otherwise make recording
+    // quadratic in the number of draws.
+    static const int kMaxLookback = 64;
+    const int stop = SkTMax(fCandidates.count() - kMaxLookback, 0);
+    for (int i = fCandidates.count() - 1; i >= stop; --i) {
+        Candidate& candidate = fCandidates[i];
+        DrawBatch* previous = candidate.fDraw;
+
+        if (previous &&
+            previous->fBatch->classID() == batch->classID() &&
+            previous->fState->getPipeline()->isEqual(*state->getPipeline()) &&
+            previous->fBatch->combineIfPossible(batch)) {
+            // The merged batch now covers the new batch's bounds as well. Nothing recorded after
+            // it overlaps those, so it is still safe to merge into later.
+            candidate.fBounds = previous->fBatch->bounds();
+            this->gpu()->stats()->incBatchesMerged();
+            return NULL;
+        }
+
+        if (intersect(candidate.fBounds, batch->bounds())) {
+            break;
+        }
+    }
+
+    DrawBatch* db = GrNEW_APPEND_TO_RECORDER(*this->cmdBuffer(), DrawBatch, (state, batch,
+                                                                             this->batchTarget()));
+    Candidate* candidate = fCandidates.append();
+    candidate->fDraw = db;
+    candidate->fBounds = batch->bounds();
+    return db;
+}
+
+GrTargetCommands::Cmd* GrReorderCommandBuilder::recordClear(const SkIRect* rect,
+                                                            GrColor color,
+                                                            bool canIgnoreRect,
+                                                            GrRenderTarget* renderTarget) {
+    Clear* clr = static_cast<Clear*>(this->INHERITED::recordClear(rect, color, canIgnoreRect,
+                                                                  renderTarget));
+    // If we can ignore the rect, then we do a full clear
+    if (canIgnoreRect) {
+        fCandidates.rewind();
+    } else {
+        Candidate* candidate = fCandidates.append();
+        candidate->fDraw = NULL;
+        candidate->fBounds = SkRect::Make(clr->fRect);
     }
+    return clr;
+}
+
+GrTargetCommands::Cmd* GrReorderCommandBuilder::recordClearStencilClip(
+        const SkIRect& rect, bool insideClip, GrRenderTarget* renderTarget) {
+    fCandidates.rewind();
+    return this->INHERITED::recordClearStencilClip(rect, insideClip, renderTarget);
+}
+
+GrTargetCommands::Cmd* GrReorderCommandBuilder::recordDiscard(GrRenderTarget* renderTarget) {
+    fCandidates.rewind();
+    return this->INHERITED::recordDiscard(renderTarget);
+}
+
+GrTargetCommands::Cmd* GrReorderCommandBuilder::recordCopySurface(GrSurface* dst,
+                                                                  GrSurface* src,
+                                                                  const SkIRect& srcRect,
+                                                                  const SkIPoint& dstPoint) {
+    fCandidates.rewind();
+    return this->INHERITED::recordCopySurface(dst, src, srcRect, dstPoint);
+}
 
-    return GrNEW_APPEND_TO_RECORDER(*this->cmdBuffer(), DrawBatch, (state, batch,
-                                                                    this->batchTarget()));
+GrTargetCommands::Cmd*
+GrReorderCommandBuilder::recordXferBarrierIfNecessary(const GrPipeline& pipeline,
+                                                      const GrCaps& caps) {
+    Cmd* cmd = this->INHERITED::recordXferBarrierIfNecessary(pipeline, caps);
+    if (cmd) {
+        fCandidates.rewind();
+    }
+    return cmd;
 }
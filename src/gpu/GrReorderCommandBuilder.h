@@ -9,6 +9,7 @@
 #define GrReorderCommandBuilder_DEFINED
 
 #include "GrCommandBuilder.h"
+#include "SkTDArray.h"
 
 class GrReorderCommandBuilder : public GrCommandBuilder {
 public:
@@ -17,6 +18,12 @@ public:
 
     GrReorderCommandBuilder(GrGpu* gpu) : INHERITED(gpu) {}
 
+    void reset() override;
+
+    Cmd* recordClearStencilClip(const SkIRect& rect,
+                                bool insideClip,
+                                GrRenderTarget* renderTarget) override;
+    Cmd* recordDiscard(GrRenderTarget*) override;
     Cmd* recordDrawBatch(State*, GrBatch*) override;
     Cmd* recordStencilPath(const GrPipelineBuilder&,
                            const GrPathProcessor*,
@@ -49,8 +56,30 @@ public:
         SkFAIL("Unsupported\n");
         return NULL;
     }
+    Cmd* recordClear(const SkIRect* rect,
+                     GrColor,
+                     bool canIgnoreRect,
+                     GrRenderTarget*) override;
+    Cmd* recordCopySurface(GrSurface* dst,
+                           GrSurface* src,
+                           const SkIRect& srcRect,
+                           const SkIPoint& dstPoint) override;
+    Cmd* recordXferBarrierIfNecessary(const GrPipeline&, const GrCaps&) override;
 
 private:
+    /**
+     * A command that a new batch may be reordered across. Draws keep their batch so we can try
+     * to merge with them; bounded clears have a NULL fDraw and only block draws they touch.
+     */
+    struct Candidate {
+        DrawBatch* fDraw;
+        SkRect     fBounds;
+    };
+
+    // Every command recorded since the last one that nothing may be reordered across, in order.
+    // recordDrawBatch() only searches the most recent of these.
+    SkTDArray<Candidate> fCandidates;
+
     typedef GrCommandBuilder INHERITED;
 
 };
@@ -65,6 +65,22 @@ const GrIndexBuffer* GrResourceProvider::createQuadIndexBuffer() {
     return this->createInstancedIndexBuffer(kPattern, 6, kMaxQuads, 4, fQuadIndexBufferKey);
 }
 
+GrVertexBuffer* GrResourceProvider::createVertexBuffer(const void* data, size_t size,
+                                                       const GrUniqueKey& key) {
+    GrVertexBuffer* buffer = this->gpu()->createVertexBuffer(size, /* dynamic = */ false);
+    if (!buffer) {
+        return NULL;
+    }
+    if (!buffer->updateData(data, size)) {
+        buffer->unref();
+        return NULL;
+    }
+    if (key.isValid()) {
+        this->assignUniqueKeyToResource(key, buffer);
+    }
+    return buffer;
+}
+
 GrPath* GrResourceProvider::createPath(const SkPath& path, const GrStrokeInfo& stroke) {
     SkASSERT(this->gpu()->pathRendering());
     return this->gpu()->pathRendering()->createPath(path, stroke);
@@ -73,6 +73,13 @@ public:
         return this->createQuadIndexBuffer();
     }
 
+    /**
+     * Creates a static vertex buffer initialized with size bytes of data. If key is valid it is
+     * assigned to the buffer, so that the buffer can later be found with findAndRefTByUniqueKey().
+     * If the return is non-null, the caller owns a ref on the returned GrVertexBuffer.
+     */
+    GrVertexBuffer* createVertexBuffer(const void* data, size_t size, const GrUniqueKey& key);
+
     /**
      * Factories for GrPath and GrPathRange objects. It's an error to call these if path rendering
      * is not supported.
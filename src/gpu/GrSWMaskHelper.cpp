@@ -97,6 +97,23 @@ static bool choose_compressed_fmt(const GrCaps* caps,
     return false;
 }
 
+void stroke_to_paint(const SkStrokeRec& stroke, bool antiAlias, SkPaint* paint) {
+    if (stroke.isHairlineStyle()) {
+        paint->setStyle(SkPaint::kStroke_Style);
+        paint->setStrokeWidth(SK_Scalar1);
+    } else {
+        if (stroke.isFillStyle()) {
+            paint->setStyle(SkPaint::kFill_Style);
+        } else {
+            paint->setStyle(SkPaint::kStroke_Style);
+            paint->setStrokeJoin(stroke.getJoin());
+            paint->setStrokeCap(stroke.getCap());
+            paint->setStrokeWidth(stroke.getWidth());
+        }
+    }
+    paint->setAntiAlias(antiAlias);
+}
+
 }
 
 /**
@@ -126,20 +143,7 @@ void GrSWMaskHelper::draw(const SkPath& path, const SkStrokeRec& stroke, SkRegio
                           bool antiAlias, uint8_t alpha) {
 
     SkPaint paint;
-    if (stroke.isHairlineStyle()) {
-        paint.setStyle(SkPaint::kStroke_Style);
-        paint.setStrokeWidth(SK_Scalar1);
-    } else {
-        if (stroke.isFillStyle()) {
-            paint.setStyle(SkPaint::kFill_Style);
-        } else {
-            paint.setStyle(SkPaint::kStroke_Style);
-            paint.setStrokeJoin(stroke.getJoin());
-            paint.setStrokeCap(stroke.getCap());
-            paint.setStrokeWidth(stroke.getWidth());
-        }
-    }
-    paint.setAntiAlias(antiAlias);
+    stroke_to_paint(stroke, antiAlias, &paint);
 
     SkTBlitterAllocator allocator;
     SkBlitter* blitter = NULL;
@@ -343,6 +347,43 @@ GrTexture* GrSWMaskHelper::DrawPathMaskToTexture(GrContext* context,
     return texture;
 }
 
+void GrSWMaskHelper::DrawPathMaskToMemory(const SkPath& path,
+                                          const SkStrokeRec& stroke,
+                                          const SkIRect& resultBounds,
+                                          bool antiAlias,
+                                          const SkMatrix* matrix,
+                                          void* pixels,
+                                          size_t rowBytes) {
+    SkMatrix drawMatrix;
+    if (matrix) {
+        drawMatrix = *matrix;
+    } else {
+        drawMatrix.setIdentity();
+    }
+    drawMatrix.postTranslate(-resultBounds.fLeft * SK_Scalar1,
+                             -resultBounds.fTop * SK_Scalar1);
+    SkIRect bounds = SkIRect::MakeWH(resultBounds.width(), resultBounds.height());
+
+    SkPixmap dst(SkImageInfo::MakeA8(bounds.width(), bounds.height()), pixels, rowBytes);
+    for (int y = 0; y < bounds.height(); ++y) {
+        sk_bzero(dst.writable_addr8(0, y), bounds.width());
+    }
+
+    SkRasterClip rasterClip;
+    rasterClip.setRect(bounds);
+
+    SkDraw draw;
+    sk_bzero(&draw, sizeof(draw));
+    draw.fDst = dst;
+    draw.fRC = &rasterClip;
+    draw.fClip = &rasterClip.bwRgn();
+    draw.fMatrix = &drawMatrix;
+
+    SkPaint paint;
+    stroke_to_paint(stroke, antiAlias, &paint);
+    draw.drawPathCoverage(path, paint);
+}
+
 void GrSWMaskHelper::DrawToTargetWithPathMask(GrTexture* texture,
                                               GrDrawTarget* target,
                                               GrPipelineBuilder* pipelineBuilder,
@@ -81,6 +81,16 @@ public:
                                             bool antiAlias,
                                             const SkMatrix* matrix);
 
+    // Rasterizes a path's A8 coverage mask for "resultBounds" into caller-owned memory. It does
+    // not touch the GPU, so it may be called from worker threads.
+    static void DrawPathMaskToMemory(const SkPath& path,
+                                     const SkStrokeRec& stroke,
+                                     const SkIRect& resultBounds,
+                                     bool antiAlias,
+                                     const SkMatrix* matrix,
+                                     void* pixels,
+                                     size_t rowBytes);
+
     // This utility routine is used to add a path's mask to some other draw.
     // The ClipMaskManager uses it to accumulate clip masks while the
     // GrSoftwarePathRenderer uses it to fulfill a drawPath call.
@@ -7,9 +7,46 @@
  */
 
 #include "GrSoftwarePathRenderer.h"
+#include "GrBatch.h"
+#include "GrBatchAtlas.h"
+#include "GrBatchTarget.h"
 #include "GrContext.h"
+#include "GrResourceProvider.h"
 #include "GrSWMaskHelper.h"
 #include "GrVertexBuffer.h"
+#include "effects/GrMaskAtlasGeoProc.h"
+
+#include "SkTaskGroup.h"
+
+#define ATLAS_TEXTURE_WIDTH 1024
+#define ATLAS_TEXTURE_HEIGHT 1024
+#define PLOT_WIDTH  256
+#define PLOT_HEIGHT 256
+
+#define NUM_PLOTS_X   (ATLAS_TEXTURE_WIDTH / PLOT_WIDTH)
+#define NUM_PLOTS_Y   (ATLAS_TEXTURE_HEIGHT / PLOT_HEIGHT)
+
+// Masks up to this size in either dimension are packed into the atlas rather than getting a
+// texture of their own.
+static const int kMaxAtlasMaskDim = 128;
+
+////////////////////////////////////////////////////////////////////////////////
+#ifdef GR_TEST_UTILS
+static int32_t gAtlasMaskCount;
+
+int32_t GrSoftwarePathRenderer::AtlasMaskCount() {
+    return sk_atomic_load(&gAtlasMaskCount);
+}
+#endif
+
+GrSoftwarePathRenderer::GrSoftwarePathRenderer(GrContext* context)
+    : fContext(context)
+    , fAtlas(NULL) {
+}
+
+GrSoftwarePathRenderer::~GrSoftwarePathRenderer() {
+    SkDELETE(fAtlas);
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 bool GrSoftwarePathRenderer::canDrawPath(const GrDrawTarget*,
@@ -115,6 +152,274 @@ void draw_around_inv_path(GrDrawTarget* target,
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Draws software rasterized path masks out of a shared A8 atlas. The masks are rasterized in
+ * prepareGeometry, which spreads them across SkTaskGroup threads, and every mask in the batch is
+ * drawn as a quad with its own color so that batches of different colors still combine.
+ */
+class SWMaskAtlasBatch : public GrBatch {
+public:
+    struct Geometry {
+        Geometry(const SkStrokeRec& stroke) : fStroke(stroke) {}
+        SkPath fPath;
+        SkStrokeRec fStroke;
+        SkMatrix fViewMatrix;
+        SkIRect fDevBounds;
+        GrColor fColor;
+        bool fAntiAlias;
+        // Rasterized mask, tightly packed. Only valid after prepareGeometry.
+        uint8_t* fMask;
+    };
+
+    static GrBatch* Create(const Geometry& geometry, GrBatchAtlas* atlas) {
+        return SkNEW_ARGS(SWMaskAtlasBatch, (geometry, atlas));
+    }
+
+    const char* name() const override { return "SWMaskAtlasBatch"; }
+
+    void getInvariantOutputColor(GrInitInvariantOutput* out) const override {
+        out->setKnownFourComponents(fGeoData[0].fColor);
+    }
+
+    void getInvariantOutputCoverage(GrInitInvariantOutput* out) const override {
+        out->setUnknownSingleComponent();
+    }
+
+    void initBatchTracker(const GrPipelineInfo& init) override {
+        // Handle any color overrides
+        if (init.fColorIgnored) {
+            fGeoData[0].fColor = GrColor_ILLEGAL;
+        } else if (GrColor_ILLEGAL != init.fOverrideColor) {
+            fGeoData[0].fColor = init.fOverrideColor;
+        }
+
+        // setup batch properties
+        fBatch.fColorIgnored = init.fColorIgnored;
+        fBatch.fUsesLocalCoords = init.fUsesLocalCoords;
+        fBatch.fCoverageIgnored = init.fCoverageIgnored;
+    }
+
+    bool canPrepareGeometry() const override { return true; }
+
+    void prepareGeometry() override {
+        if (fPrepared) {
+            return;
+        }
+        fPrepared = true;
+
+        int instanceCount = fGeoData.count();
+        size_t maskSize = 0;
+        for (int i = 0; i < instanceCount; i++) {
+            const SkIRect& bounds = fGeoData[i].fDevBounds;
+            maskSize += bounds.width() * bounds.height();
+        }
+        fMaskStorage.reset(maskSize);
+        uint8_t* mask = fMaskStorage.get();
+        for (int i = 0; i < instanceCount; i++) {
+            const SkIRect& bounds = fGeoData[i].fDevBounds;
+            fGeoData[i].fMask = mask;
+            mask += bounds.width() * bounds.height();
+        }
+
+        if (instanceCount > 1) {
+            SkTaskGroup tg;
+            tg.batch(DrawMask, fGeoData.begin(), instanceCount);
+            tg.wait();
+        } else {
+            DrawMask(fGeoData.begin());
+        }
+    }
+
+    struct FlushInfo {
+        SkAutoTUnref<const GrVertexBuffer> fVertexBuffer;
+        SkAutoTUnref<const GrIndexBuffer>  fIndexBuffer;
+        int fVertexOffset;
+        int fInstancesToFlush;
+    };
+
+    void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
+        // A no-op if the masks were already rasterized ahead of the flush.
+        this->prepareGeometry();
+
+        // Quads are in device space, so local coords come from mapping back through the inverse
+        // view matrix.
+        SkMatrix invert = SkMatrix::I();
+        if (this->usesLocalCoords() && !this->viewMatrix().invert(&invert)) {
+            SkDebugf("Could not invert viewmatrix\n");
+            return;
+        }
+
+        GrTextureParams params(SkShader::kClamp_TileMode, GrTextureParams::kNone_FilterMode);
+        GrTexture* texture = fAtlas->getTexture();
+        SkAutoTUnref<const GrGeometryProcessor> gp(
+                GrMaskAtlasGeoProc::Create(this->colorIgnored() ? GrColor_ILLEGAL : GrColor_WHITE,
+                                           texture, params, invert, this->usesLocalCoords()));
+
+        batchTarget->initDraw(gp, pipeline);
+
+        FlushInfo flushInfo;
+        int instanceCount = fGeoData.count();
+
+        size_t vertexStride = gp->getVertexStride();
+        SkASSERT(vertexStride == sizeof(Vertex));
+        const GrVertexBuffer* vertexBuffer;
+        void* vertices = batchTarget->makeVertSpace(vertexStride,
+                                                    kVerticesPerQuad * instanceCount,
+                                                    &vertexBuffer,
+                                                    &flushInfo.fVertexOffset);
+        flushInfo.fVertexBuffer.reset(SkRef(vertexBuffer));
+        flushInfo.fIndexBuffer.reset(batchTarget->resourceProvider()->refQuadIndexBuffer());
+        if (!vertices || !flushInfo.fIndexBuffer) {
+            SkDebugf("Could not allocate vertices\n");
+            return;
+        }
+
+        SkScalar invWidth = SK_Scalar1 / texture->width();
+        SkScalar invHeight = SK_Scalar1 / texture->height();
+
+        Vertex* verts = reinterpret_cast<Vertex*>(vertices);
+        flushInfo.fInstancesToFlush = 0;
+        for (int i = 0; i < instanceCount; i++) {
+            const Geometry& args = fGeoData[i];
+            int width = args.fDevBounds.width();
+            int height = args.fDevBounds.height();
+
+            SkIPoint16 atlasLocation;
+            GrBatchAtlas::AtlasID id;
+            if (!fAtlas->addToAtlas(&id, batchTarget, width, height, args.fMask,
+                                    &atlasLocation)) {
+                // Draw what we have so far, which lets the atlas evict the plots it used.
+                this->flush(batchTarget, &flushInfo);
+                batchTarget->initDraw(gp, pipeline);
+                if (!fAtlas->addToAtlas(&id, batchTarget, width, height, args.fMask,
+                                        &atlasLocation)) {
+                    SkDebugf("Could not add mask to atlas\n");
+                    continue;
+                }
+            }
+            fAtlas->setLastUseToken(id, batchTarget->currentToken());
+#ifdef GR_TEST_UTILS
+            sk_atomic_inc(&gAtlasMaskCount);
+#endif
+
+            SkRect r = SkRect::Make(args.fDevBounds);
+            verts->fPosition.setRectFan(r.fLeft, r.fTop, r.fRight, r.fBottom, vertexStride);
+            verts->fTextureCoords.setRectFan(atlasLocation.fX * invWidth,
+                                             atlasLocation.fY * invHeight,
+                                             (atlasLocation.fX + width) * invWidth,
+                                             (atlasLocation.fY + height) * invHeight,
+                                             vertexStride);
+            for (int v = 0; v < kVerticesPerQuad; ++v) {
+                verts[v].fColor = args.fColor;
+            }
+            verts += kVerticesPerQuad;
+            flushInfo.fInstancesToFlush++;
+        }
+
+        this->flush(batchTarget, &flushInfo);
+
+        // The atlas has its own copy of the masks now.
+        fMaskStorage.reset(0);
+    }
+
+    SkSTArray<1, Geometry, true>* geoData() { return &fGeoData; }
+
+private:
+    struct Vertex {
+        SkPoint fPosition;
+        GrColor fColor;
+        SkPoint fTextureCoords;
+    };
+
+    SWMaskAtlasBatch(const Geometry& geometry, GrBatchAtlas* atlas)
+        : fAtlas(atlas)
+        , fPrepared(false) {
+        this->initClassID<SWMaskAtlasBatch>();
+        fBatch.fViewMatrix = geometry.fViewMatrix;
+        fGeoData.push_back(geometry);
+        fGeoData.back().fMask = NULL;
+
+        this->setBounds(SkRect::Make(geometry.fDevBounds));
+    }
+
+    static void DrawMask(Geometry* geometry) {
+        GrSWMaskHelper::DrawPathMaskToMemory(geometry->fPath, geometry->fStroke,
+                                             geometry->fDevBounds, geometry->fAntiAlias,
+                                             &geometry->fViewMatrix, geometry->fMask,
+                                             geometry->fDevBounds.width());
+    }
+
+    void flush(GrBatchTarget* batchTarget, FlushInfo* flushInfo) {
+        if (0 == flushInfo->fInstancesToFlush) {
+            return;
+        }
+        GrVertices vertices;
+        int maxInstancesPerDraw = flushInfo->fIndexBuffer->maxQuads();
+        vertices.initInstanced(kTriangles_GrPrimitiveType, flushInfo->fVertexBuffer,
+            flushInfo->fIndexBuffer, flushInfo->fVertexOffset, kVerticesPerQuad,
+            kIndicesPerQuad, flushInfo->fInstancesToFlush, maxInstancesPerDraw);
+        batchTarget->draw(vertices);
+        flushInfo->fVertexOffset += kVerticesPerQuad * flushInfo->fInstancesToFlush;
+        flushInfo->fInstancesToFlush = 0;
+    }
+
+    const SkMatrix& viewMatrix() const { return fBatch.fViewMatrix; }
+    bool usesLocalCoords() const { return fBatch.fUsesLocalCoords; }
+    bool colorIgnored() const { return fBatch.fColorIgnored; }
+
+    bool onCombineIfPossible(GrBatch* t) override {
+        SWMaskAtlasBatch* that = t->cast<SWMaskAtlasBatch>();
+
+        // Colors are per vertex and positions are in device space, so only local coords care
+        // about the view matrix.
+        if (this->usesLocalCoords() &&
+            !this->viewMatrix().cheapEqualTo(that->viewMatrix())) {
+            return false;
+        }
+
+        if (this->colorIgnored() != that->colorIgnored()) {
+            return false;
+        }
+
+        SkASSERT(!fPrepared && !that->fPrepared);
+        fGeoData.push_back_n(that->geoData()->count(), that->geoData()->begin());
+        this->joinBounds(that->bounds());
+        return true;
+    }
+
+    struct BatchTracker {
+        SkMatrix fViewMatrix;
+        bool fUsesLocalCoords;
+        bool fColorIgnored;
+        bool fCoverageIgnored;
+    };
+
+    BatchTracker fBatch;
+    SkSTArray<1, Geometry, true> fGeoData;
+    SkAutoTMalloc<uint8_t> fMaskStorage;
+    GrBatchAtlas* fAtlas;
+    bool fPrepared;
+};
+
+static GrBatchAtlas* create_atlas(GrContext* context) {
+    GrSurfaceDesc desc;
+    desc.fFlags = kNone_GrSurfaceFlags;
+    desc.fWidth = ATLAS_TEXTURE_WIDTH;
+    desc.fHeight = ATLAS_TEXTURE_HEIGHT;
+    desc.fConfig = kAlpha_8_GrPixelConfig;
+
+    // We don't want to flush the context so we claim we're in the middle of flushing so as to
+    // guarantee we do not recieve a texture with pending IO
+    GrTexture* texture = context->textureProvider()->refScratchTexture(
+        desc, GrTextureProvider::kApprox_ScratchTexMatch, true);
+    if (NULL == texture) {
+        return NULL;
+    }
+    return SkNEW_ARGS(GrBatchAtlas, (texture, NUM_PLOTS_X, NUM_PLOTS_Y));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // return true on success; false on failure
 bool GrSoftwarePathRenderer::onDrawPath(GrDrawTarget* target,
@@ -138,17 +443,37 @@ bool GrSoftwarePathRenderer::onDrawPath(GrDrawTarget* target,
         return true;
     }
 
-    SkAutoTUnref<GrTexture> texture(
-            GrSWMaskHelper::DrawPathMaskToTexture(fContext, path, stroke,
-                                                  devPathBounds,
-                                                  antiAlias, &viewMatrix));
-    if (NULL == texture) {
-        return false;
+    // The context drops its own renderer when it is abandoned or frees its resources, but a
+    // renderer that outlives its atlas texture has to start over with a new one.
+    if (fAtlas && fAtlas->getTexture()->wasDestroyed()) {
+        SkDELETE(fAtlas);
+        fAtlas = NULL;
     }
 
-    GrPipelineBuilder copy = *pipelineBuilder;
-    GrSWMaskHelper::DrawToTargetWithPathMask(texture, target, &copy, color, viewMatrix,
-                                             devPathBounds);
+    if (devPathBounds.width() <= kMaxAtlasMaskDim && devPathBounds.height() <= kMaxAtlasMaskDim &&
+        (fAtlas || (fAtlas = create_atlas(fContext)))) {
+        SWMaskAtlasBatch::Geometry geometry(stroke);
+        geometry.fPath = path;
+        geometry.fViewMatrix = viewMatrix;
+        geometry.fDevBounds = devPathBounds;
+        geometry.fColor = color;
+        geometry.fAntiAlias = antiAlias;
+
+        SkAutoTUnref<GrBatch> batch(SWMaskAtlasBatch::Create(geometry, fAtlas));
+        target->drawBatch(pipelineBuilder, batch);
+    } else {
+        SkAutoTUnref<GrTexture> texture(
+                GrSWMaskHelper::DrawPathMaskToTexture(fContext, path, stroke,
+                                                      devPathBounds,
+                                                      antiAlias, &viewMatrix));
+        if (NULL == texture) {
+            return false;
+        }
+
+        GrPipelineBuilder copy = *pipelineBuilder;
+        GrSWMaskHelper::DrawToTargetWithPathMask(texture, target, &copy, color, viewMatrix,
+                                                 devPathBounds);
+    }
 
     if (path.isInverseFillType()) {
         draw_around_inv_path(target, pipelineBuilder, color, viewMatrix, devClipBounds,
@@ -11,17 +11,18 @@
 
 #include "GrPathRenderer.h"
 
+class GrBatchAtlas;
 class GrContext;
 
 /**
  * This class uses the software side to render a path to an SkBitmap and
- * then uploads the result to the gpu
+ * then uploads the result to the gpu. Small masks are packed into a shared
+ * A8 atlas so that many of them can be drawn with a single draw.
  */
 class GrSoftwarePathRenderer : public GrPathRenderer {
 public:
-    GrSoftwarePathRenderer(GrContext* context)
-        : fContext(context) {
-    }
+    GrSoftwarePathRenderer(GrContext* context);
+    virtual ~GrSoftwarePathRenderer();
 
     virtual bool canDrawPath(const GrDrawTarget*,
                              const GrPipelineBuilder*,
@@ -29,6 +30,12 @@ public:
                              const SkPath&,
                              const GrStrokeInfo&,
                              bool antiAlias) const override;
+
+#ifdef GR_TEST_UTILS
+    /** The number of masks drawn out of the atlas so far, so tests can tell it was used. */
+    static int32_t AtlasMaskCount();
+#endif
+
 protected:
     virtual StencilSupport onGetStencilSupport(const GrDrawTarget*,
                                                const GrPipelineBuilder*,
@@ -45,6 +52,7 @@ protected:
 
 private:
     GrContext*     fContext;
+    GrBatchAtlas*  fAtlas;
 
     typedef GrPathRenderer INHERITED;
 };
@@ -8,12 +8,18 @@
 #include "GrTargetCommands.h"
 
 #include "GrInOrderDrawBuffer.h"
+#include "SkTaskGroup.h"
+#include "SkTDArray.h"
 
 void GrTargetCommands::reset() {
     fCmdBuffer.reset();
     fBatchTarget.reset();
 }
 
+static void prepare_geometry(GrBatch** batch) {
+    (*batch)->prepareGeometry();
+}
+
 void GrTargetCommands::flush(GrInOrderDrawBuffer* iodb) {
     if (fCmdBuffer.empty()) {
         return;
@@ -21,6 +27,24 @@ void GrTargetCommands::flush(GrInOrderDrawBuffer* iodb) {
 
     GrGpu* gpu = iodb->getGpu();
 
+    // Let batches do their CPU-heavy geometry work in parallel. Only generateGeometry touches the
+    // batch target, so vertex and index data still land in the buffers in command order below.
+    SkTDArray<GrBatch*> toPrepare;
+    CmdBuffer::Iter prepareIter(fCmdBuffer);
+    while (prepareIter.next()) {
+        if (Cmd::kDrawBatch_CmdType == prepareIter->type()) {
+            GrBatch* batch = reinterpret_cast<DrawBatch*>(prepareIter.get())->fBatch.get();
+            if (batch->canPrepareGeometry()) {
+                *toPrepare.append() = batch;
+            }
+        }
+    }
+    if (toPrepare.count() > 1) {
+        SkTaskGroup tg;
+        tg.batch(prepare_geometry, toPrepare.begin(), toPrepare.count());
+        tg.wait();
+    }
+
     // Loop over all batches and generate geometry
     CmdBuffer::Iter genIter(fCmdBuffer);
     while (genIter.next()) {
@@ -83,7 +107,8 @@ void GrTargetCommands::DrawPaths::execute(GrGpu* gpu) {
                                     fTransformType, fCount);
 }
 
-void GrTargetCommands::DrawBatch::execute(GrGpu*) {
+void GrTargetCommands::DrawBatch::execute(GrGpu* gpu) {
+    gpu->stats()->incBatchesIssued();
     fBatchTarget->flushNext(fBatch->numberOfDraws());
 }
 
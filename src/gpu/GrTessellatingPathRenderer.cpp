@@ -12,6 +12,8 @@
 #include "GrBatchTest.h"
 #include "GrDefaultGeoProcFactory.h"
 #include "GrPathUtils.h"
+#include "GrResourceProvider.h"
+#include "GrVertexBuffer.h"
 #include "GrVertices.h"
 #include "SkChunkAlloc.h"
 #include "SkGeometry.h"
@@ -67,7 +69,9 @@
  * linked list implementation. With the latter, all removals are O(1), and most insertions
  * are O(1), since we know the adjacent edge in the active edge list based on the topology.
  * Only type 2 vertices (see paper) require the O(N) lookups, and these are much less
- * frequent. There may be other data structures worth investigating, however.
+ * frequent. However, paths with many thousands of edges can have very long active edge lists,
+ * so once the list is long enough it is also indexed by a treap (see EdgeList), which makes
+ * those lookups O(lg N) at the cost of O(lg N) insertions and removals.
  *
  * Note that the orientation of the line sweep algorithms is determined by the aspect ratio of the
  * path bounds. When the path is taller than it is wide, we sort vertices based on increasing Y
@@ -206,10 +210,26 @@ SkPoint* emit_triangle(Vertex* v0, Vertex* v1, Vertex* v2, SkPoint* data) {
     return data;
 }
 
+/**
+ * The active edge list. Once it holds kMinIndexedEdges edges, it is also indexed by a treap (a
+ * randomized balanced binary tree) whose in-order traversal is the list order, so that vertices
+ * with no edges above can find their enclosing edges in O(lg N) rather than O(N). Short lists are
+ * not indexed, since there the linear search is cheaper than keeping the tree balanced.
+ */
+static const int kMinIndexedEdges = 64;
+
 struct EdgeList {
-    EdgeList() : fHead(NULL), fTail(NULL) {}
+    EdgeList() : fHead(NULL), fTail(NULL), fRoot(NULL), fCount(0), fIndexed(false), fSeed(1) {}
     Edge* fHead;
     Edge* fTail;
+    Edge* fRoot;                // Root of the treap, if fIndexed.
+    int   fCount;
+    bool  fIndexed;
+    uint32_t fSeed;
+    uint32_t nextPriority() {
+        fSeed = fSeed * 1664525 + 1013904223;
+        return fSeed;
+    }
 };
 
 /**
@@ -242,7 +262,11 @@ struct Edge {
         , fPrevEdgeBelow(NULL)
         , fNextEdgeBelow(NULL)
         , fLeftPoly(NULL)
-        , fRightPoly(NULL) {
+        , fRightPoly(NULL)
+        , fTreeParent(NULL)
+        , fTreeLeft(NULL)
+        , fTreeRight(NULL)
+        , fTreePriority(0) {
             recompute();
         }
     int      fWinding;          // 1 == edge goes downward; -1 = edge goes upward.
@@ -256,6 +280,10 @@ struct Edge {
     Edge*    fNextEdgeBelow;    // "
     Poly*    fLeftPoly;         // The Poly to the left of this edge, if any.
     Poly*    fRightPoly;        // The Poly to the right of this edge, if any.
+    Edge*    fTreeParent;       // The treap indexing the active edge list (see EdgeList).
+    Edge*    fTreeLeft;         // "
+    Edge*    fTreeRight;        // "
+    uint32_t fTreePriority;     // "
     double   fDX;               // The line equation for this edge, in implicit form.
     double   fDY;               // fDY * x + fDX * y + fC = 0, for point (x, y) on the line.
     double   fC;
@@ -641,10 +669,121 @@ Edge* new_edge(Vertex* prev, Vertex* next, SkChunkAlloc& alloc, Comparator& c) {
     return ALLOC_NEW(Edge, (top, bottom, winding), alloc);
 }
 
+// Makes edge take its parent's place in the treap, with the parent as its child.
+void tree_rotate_up(Edge* edge, EdgeList* edges) {
+    Edge* parent = edge->fTreeParent;
+    Edge* grandparent = parent->fTreeParent;
+    if (parent->fTreeLeft == edge) {
+        parent->fTreeLeft = edge->fTreeRight;
+        if (edge->fTreeRight) {
+            edge->fTreeRight->fTreeParent = parent;
+        }
+        edge->fTreeRight = parent;
+    } else {
+        parent->fTreeRight = edge->fTreeLeft;
+        if (edge->fTreeLeft) {
+            edge->fTreeLeft->fTreeParent = parent;
+        }
+        edge->fTreeLeft = parent;
+    }
+    parent->fTreeParent = edge;
+    edge->fTreeParent = grandparent;
+    if (!grandparent) {
+        edges->fRoot = edge;
+    } else if (grandparent->fTreeLeft == parent) {
+        grandparent->fTreeLeft = edge;
+    } else {
+        grandparent->fTreeRight = edge;
+    }
+}
+
+// Adds edge to the treap as the in-order successor of prev (or first, if prev is NULL).
+void tree_insert(Edge* edge, Edge* prev, EdgeList* edges) {
+    edge->fTreeLeft = edge->fTreeRight = NULL;
+    edge->fTreePriority = edges->nextPriority();
+    Edge* parent = NULL;
+    if (!edges->fRoot) {
+        edges->fRoot = edge;
+    } else if (prev && !prev->fTreeRight) {
+        parent = prev;
+        parent->fTreeRight = edge;
+    } else {
+        parent = prev ? prev->fTreeRight : edges->fRoot;
+        while (parent->fTreeLeft) {
+            parent = parent->fTreeLeft;
+        }
+        parent->fTreeLeft = edge;
+    }
+    edge->fTreeParent = parent;
+    while (edge->fTreeParent && edge->fTreeParent->fTreePriority < edge->fTreePriority) {
+        tree_rotate_up(edge, edges);
+    }
+}
+
+void tree_remove(Edge* edge, EdgeList* edges) {
+    // Rotate edge down to a leaf, keeping the heap order on priorities, then detach it.
+    while (edge->fTreeLeft || edge->fTreeRight) {
+        Edge* child;
+        if (!edge->fTreeRight) {
+            child = edge->fTreeLeft;
+        } else if (!edge->fTreeLeft) {
+            child = edge->fTreeRight;
+        } else {
+            child = edge->fTreeLeft->fTreePriority > edge->fTreeRight->fTreePriority
+                  ? edge->fTreeLeft : edge->fTreeRight;
+        }
+        tree_rotate_up(child, edges);
+    }
+    Edge* parent = edge->fTreeParent;
+    if (!parent) {
+        edges->fRoot = NULL;
+    } else if (parent->fTreeLeft == edge) {
+        parent->fTreeLeft = NULL;
+    } else {
+        parent->fTreeRight = NULL;
+    }
+    edge->fTreeParent = NULL;
+}
+
+// Builds the treap for the whole list in O(N), by keeping the right spine of the tree built so
+// far (the Cartesian tree construction).
+void tree_build(EdgeList* edges) {
+    edges->fRoot = NULL;
+    Edge* last = NULL;
+    for (Edge* edge = edges->fHead; edge; edge = edge->fRight) {
+        edge->fTreePriority = edges->nextPriority();
+        edge->fTreeRight = NULL;
+        Edge* parent = last;
+        Edge* child = NULL;
+        while (parent && parent->fTreePriority < edge->fTreePriority) {
+            child = parent;
+            parent = parent->fTreeParent;
+        }
+        edge->fTreeLeft = child;
+        if (child) {
+            child->fTreeParent = edge;
+        }
+        edge->fTreeParent = parent;
+        if (parent) {
+            parent->fTreeRight = edge;
+        } else {
+            edges->fRoot = edge;
+        }
+        last = edge;
+    }
+}
+
 void remove_edge(Edge* edge, EdgeList* edges) {
     LOG("removing edge %g -> %g\n", edge->fTop->fID, edge->fBottom->fID);
     SkASSERT(edge->isActive(edges));
+    if (edges->fIndexed) {
+        tree_remove(edge, edges);
+    }
     remove<Edge, &Edge::fLeft, &Edge::fRight>(edge, &edges->fHead, &edges->fTail);
+    if (--edges->fCount < kMinIndexedEdges / 2 && edges->fIndexed) {
+        edges->fIndexed = false;
+        edges->fRoot = NULL;
+    }
 }
 
 void insert_edge(Edge* edge, Edge* prev, EdgeList* edges) {
@@ -652,6 +791,13 @@ void insert_edge(Edge* edge, Edge* prev, EdgeList* edges) {
     SkASSERT(!edge->isActive(edges));
     Edge* next = prev ? prev->fRight : edges->fHead;
     insert<Edge, &Edge::fLeft, &Edge::fRight>(edge, prev, next, &edges->fHead, &edges->fTail);
+    ++edges->fCount;
+    if (edges->fIndexed) {
+        tree_insert(edge, prev, edges);
+    } else if (edges->fCount >= kMinIndexedEdges) {
+        tree_build(edges);
+        edges->fIndexed = true;
+    }
 }
 
 void find_enclosing_edges(Vertex* v, EdgeList* edges, Edge** left, Edge** right) {
@@ -660,6 +806,21 @@ void find_enclosing_edges(Vertex* v, EdgeList* edges, Edge** left, Edge** right)
         *right = v->fLastEdgeAbove->fRight;
         return;
     }
+    if (edges->fIndexed) {
+        // Find the rightmost edge which is left of v.
+        Edge* prev = NULL;
+        for (Edge* edge = edges->fRoot; edge != NULL;) {
+            if (edge->isLeftOf(v)) {
+                prev = edge;
+                edge = edge->fTreeRight;
+            } else {
+                edge = edge->fTreeLeft;
+            }
+        }
+        *left = prev;
+        *right = prev ? prev->fRight : edges->fHead;
+        return;
+    }
     Edge* next = NULL;
     Edge* prev;
     for (prev = edges->fTail; prev != NULL; prev = prev->fLeft) {
@@ -673,16 +834,37 @@ void find_enclosing_edges(Vertex* v, EdgeList* edges, Edge** left, Edge** right)
     return;
 }
 
+// Returns true if other belongs to the right of edge in the active edge list.
+bool edge_is_right_of(Edge* other, Edge* edge, Comparator& c) {
+    return (c.sweep_gt(edge->fTop->fPoint, other->fTop->fPoint) &&
+            other->isRightOf(edge->fTop)) ||
+           (c.sweep_gt(other->fTop->fPoint, edge->fTop->fPoint) && edge->isLeftOf(other->fTop)) ||
+           (c.sweep_lt(edge->fBottom->fPoint, other->fBottom->fPoint) &&
+            other->isRightOf(edge->fBottom)) ||
+           (c.sweep_lt(other->fBottom->fPoint, edge->fBottom->fPoint) &&
+            edge->isLeftOf(other->fBottom));
+}
+
 void find_enclosing_edges(Edge* edge, EdgeList* edges, Comparator& c, Edge** left, Edge** right) {
+    if (edges->fIndexed) {
+        // Find the leftmost edge which is right of edge.
+        Edge* next = NULL;
+        for (Edge* e = edges->fRoot; e != NULL;) {
+            if (edge_is_right_of(e, edge, c)) {
+                next = e;
+                e = e->fTreeLeft;
+            } else {
+                e = e->fTreeRight;
+            }
+        }
+        *left = next ? next->fLeft : edges->fTail;
+        *right = next;
+        return;
+    }
     Edge* prev = NULL;
     Edge* next;
     for (next = edges->fHead; next != NULL; next = next->fRight) {
-        if ((c.sweep_gt(edge->fTop->fPoint, next->fTop->fPoint) && next->isRightOf(edge->fTop)) ||
-            (c.sweep_gt(next->fTop->fPoint, edge->fTop->fPoint) && edge->isLeftOf(next->fTop)) ||
-            (c.sweep_lt(edge->fBottom->fPoint, next->fBottom->fPoint) &&
-             next->isRightOf(edge->fBottom)) ||
-            (c.sweep_lt(next->fBottom->fPoint, edge->fBottom->fPoint) &&
-             edge->isLeftOf(next->fBottom))) {
+        if (edge_is_right_of(next, edge, c)) {
             break;
         }
         prev = next;
@@ -1331,6 +1513,14 @@ SkPoint* polys_to_triangles(Poly* polys, SkPath::FillType fillType, SkPoint* dat
 
 };
 
+#ifdef GR_TEST_UTILS
+static int32_t gTessellationCount;
+
+int32_t GrTessellatingPathRenderer::TessellationCount() {
+    return sk_atomic_load(&gTessellationCount);
+}
+#endif
+
 GrTessellatingPathRenderer::GrTessellatingPathRenderer() {
 }
 
@@ -1384,61 +1574,65 @@ public:
     }
 
     void generateGeometry(GrBatchTarget* batchTarget, const GrPipeline* pipeline) override {
-        SkRect pathBounds = fPath.getBounds();
-        Comparator c;
-        if (pathBounds.width() > pathBounds.height()) {
-            c.sweep_lt = sweep_lt_horiz;
-            c.sweep_gt = sweep_gt_horiz;
-        } else {
-            c.sweep_lt = sweep_lt_vert;
-            c.sweep_gt = sweep_gt_vert;
-        }
         SkScalar screenSpaceTol = GrPathUtils::kDefaultTolerance;
-        SkScalar tol = GrPathUtils::scaleToleranceToSrc(screenSpaceTol, fViewMatrix, pathBounds);
-        int contourCnt;
-        int maxPts = GrPathUtils::worstCasePointCount(fPath, &contourCnt, tol);
-        if (maxPts <= 0) {
-            return;
-        }
-        if (maxPts > ((int)SK_MaxU16 + 1)) {
-            SkDebugf("Path not rendered, too many verts (%d)\n", maxPts);
-            return;
-        }
-        SkPath::FillType fillType = fPath.getFillType();
-        if (SkPath::IsInverseFillType(fillType)) {
-            contourCnt++;
-        }
+        SkScalar tol = GrPathUtils::scaleToleranceToSrc(screenSpaceTol, fViewMatrix,
+                                                        fPath.getBounds());
 
-        LOG("got %d pts, %d contours\n", maxPts, contourCnt);
         uint32_t flags = GrDefaultGeoProcFactory::kPosition_GPType;
         SkAutoTUnref<const GrGeometryProcessor> gp(
             GrDefaultGeoProcFactory::Create(flags, fColor, fPipelineInfo.fUsesLocalCoords,
                                             fPipelineInfo.fCoverageIgnored, fViewMatrix,
                                             SkMatrix::I()));
-        batchTarget->initDraw(gp, pipeline);
-
-        SkAutoTDeleteArray<Vertex*> contours(SkNEW_ARRAY(Vertex *, contourCnt));
+        size_t stride = gp->getVertexStride();
+        SkASSERT(stride == sizeof(SkPoint));
+        GrPrimitiveType primitiveType = WIREFRAME ? kLines_GrPrimitiveType
+                                                  : kTriangles_GrPrimitiveType;
 
-        // For the initial size of the chunk allocator, estimate based on the point count:
-        // one vertex per point for the initial passes, plus two for the vertices in the
-        // resulting Polys, since the same point may end up in two Polys.  Assume minimal
-        // connectivity of one Edge per Vertex (will grow for intersections).
-        SkChunkAlloc alloc(maxPts * (3 * sizeof(Vertex) + sizeof(Edge)));
-        path_to_contours(fPath, tol, fClipBounds, contours.get(), alloc);
-        Poly* polys;
-        polys = contours_to_polys(contours.get(), contourCnt, c, alloc);
-        int count = 0;
-        for (Poly* poly = polys; poly; poly = poly->fNext) {
-            if (apply_fill_type(fillType, poly->fWinding) && poly->fCount >= 3) {
-                count += (poly->fCount - 2) * (WIREFRAME ? 6 : 3);
+        // The triangles are in source space, so unless the path is volatile they can be reused
+        // by later draws of the same path at the same tolerance.
+        if (!fPath.isVolatile()) {
+            GrResourceProvider* rp = batchTarget->resourceProvider();
+            GrUniqueKey key;
+            this->computeKey(tol, &key);
+            SkAutoTUnref<GrVertexBuffer> vertexBuffer(
+                rp->findAndRefTByUniqueKey<GrVertexBuffer>(key));
+            if (!vertexBuffer) {
+                int count;
+                SkAutoTDelete<SkChunkAlloc> alloc;
+                Poly* polys = this->tessellate(tol, &count, &alloc);
+                if (0 == count) {
+                    return;
+                }
+                SkAutoTMalloc<SkPoint> verts(count);
+                int actualCount = static_cast<int>(
+                    polys_to_triangles(polys, fPath.getFillType(), verts.get()) - verts.get());
+                SkASSERT(actualCount <= count);
+                if (0 == actualCount) {
+                    return;
+                }
+                vertexBuffer.reset(rp->createVertexBuffer(verts.get(), actualCount * stride,
+                                                          key));
+                if (!vertexBuffer) {
+                    SkDebugf("Could not allocate vertices\n");
+                    return;
+                }
             }
+            batchTarget->initDraw(gp, pipeline);
+            GrVertices vertices;
+            vertices.init(primitiveType, vertexBuffer, 0,
+                          static_cast<int>(vertexBuffer->gpuMemorySize() / stride));
+            batchTarget->draw(vertices);
+            return;
         }
+
+        int count;
+        SkAutoTDelete<SkChunkAlloc> alloc;
+        Poly* polys = this->tessellate(tol, &count, &alloc);
         if (0 == count) {
             return;
         }
+        batchTarget->initDraw(gp, pipeline);
 
-        size_t stride = gp->getVertexStride();
-        SkASSERT(stride == sizeof(SkPoint));
         const GrVertexBuffer* vertexBuffer;
         int firstVertex;
         SkPoint* verts = static_cast<SkPoint*>(
@@ -1449,13 +1643,11 @@ public:
         }
 
         LOG("emitting %d verts\n", count);
-        SkPoint* end = polys_to_triangles(polys, fillType, verts);
+        SkPoint* end = polys_to_triangles(polys, fPath.getFillType(), verts);
         int actualCount = static_cast<int>(end - verts);
         LOG("actual count: %d\n", actualCount);
         SkASSERT(actualCount <= count);
 
-        GrPrimitiveType primitiveType = WIREFRAME ? kLines_GrPrimitiveType
-                                                  : kTriangles_GrPrimitiveType;
         GrVertices vertices;
         vertices.init(primitiveType, vertexBuffer, firstVertex, actualCount);
         batchTarget->draw(vertices);
@@ -1483,6 +1675,76 @@ private:
         viewMatrix.mapRect(&fBounds);
     }
 
+    /**
+     * Runs stages 1-5 on fPath, returning the monotone polygons and setting *count to an upper
+     * bound on the number of vertices polys_to_triangles() will emit for them (0 if there is
+     * nothing to draw). The polygons are allocated from alloc, which this initializes.
+     */
+    Poly* tessellate(SkScalar tol, int* count, SkAutoTDelete<SkChunkAlloc>* alloc) {
+#ifdef GR_TEST_UTILS
+        sk_atomic_inc(&gTessellationCount);
+#endif
+        *count = 0;
+        SkRect pathBounds = fPath.getBounds();
+        Comparator c;
+        if (pathBounds.width() > pathBounds.height()) {
+            c.sweep_lt = sweep_lt_horiz;
+            c.sweep_gt = sweep_gt_horiz;
+        } else {
+            c.sweep_lt = sweep_lt_vert;
+            c.sweep_gt = sweep_gt_vert;
+        }
+        int contourCnt;
+        int maxPts = GrPathUtils::worstCasePointCount(fPath, &contourCnt, tol);
+        if (maxPts <= 0) {
+            return NULL;
+        }
+        if (maxPts > ((int)SK_MaxU16 + 1)) {
+            SkDebugf("Path not rendered, too many verts (%d)\n", maxPts);
+            return NULL;
+        }
+        SkPath::FillType fillType = fPath.getFillType();
+        if (SkPath::IsInverseFillType(fillType)) {
+            contourCnt++;
+        }
+
+        LOG("got %d pts, %d contours\n", maxPts, contourCnt);
+        SkAutoTDeleteArray<Vertex*> contours(SkNEW_ARRAY(Vertex *, contourCnt));
+
+        // For the initial size of the chunk allocator, estimate based on the point count:
+        // one vertex per point for the initial passes, plus two for the vertices in the
+        // resulting Polys, since the same point may end up in two Polys.  Assume minimal
+        // connectivity of one Edge per Vertex (will grow for intersections).
+        alloc->reset(SkNEW_ARGS(SkChunkAlloc, (maxPts * (3 * sizeof(Vertex) + sizeof(Edge)))));
+        path_to_contours(fPath, tol, fClipBounds, contours.get(), *alloc->get());
+        Poly* polys = contours_to_polys(contours.get(), contourCnt, c, *alloc->get());
+        for (Poly* poly = polys; poly; poly = poly->fNext) {
+            if (apply_fill_type(fillType, poly->fWinding) && poly->fCount >= 3) {
+                *count += (poly->fCount - 2) * (WIREFRAME ? 6 : 3);
+            }
+        }
+        return polys;
+    }
+
+    /**
+     * The cache key for the triangles of fPath at tolerance tol. Inverse fills also depend on the
+     * clip bounds, since those close off the outer contour.
+     */
+    void computeKey(SkScalar tol, GrUniqueKey* key) const {
+        static const GrUniqueKey::Domain kDomain = GrUniqueKey::GenerateDomain();
+        bool inverse = fPath.isInverseFillType();
+        GrUniqueKey::Builder builder(key, kDomain, inverse ? 7 : 3);
+        builder[0] = fPath.getGenerationID();
+        builder[1] = fPath.getFillType();
+        builder[2] = SkFloat2Bits(tol);
+        if (inverse) {
+            builder[3] = SkFloat2Bits(fClipBounds.fLeft);
+            builder[4] = SkFloat2Bits(fClipBounds.fTop);
+            builder[5] = SkFloat2Bits(fClipBounds.fRight);
+            builder[6] = SkFloat2Bits(fClipBounds.fBottom);
+        }
+    }
+
     GrColor        fColor;
     SkPath         fPath;
     SkMatrix       fViewMatrix;
@@ -24,6 +24,12 @@ public:
                      const SkPath&,
                      const GrStrokeInfo&,
                      bool antiAlias) const override;
+
+#ifdef GR_TEST_UTILS
+    /** The number of paths tessellated so far, so tests can tell cached triangles were reused. */
+    static int32_t TessellationCount();
+#endif
+
 protected:
 
     StencilSupport onGetStencilSupport(const GrDrawTarget*,
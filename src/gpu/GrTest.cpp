@@ -68,6 +68,10 @@ void GrGpu::Stats::dump(SkString* out) {
     out->appendf("Textures Created: %d\n", fTextureCreates);
     out->appendf("Texture Uploads: %d\n", fTextureUploads);
     out->appendf("Stencil Buffer Creates: %d\n", fStencilAttachmentCreates);
+    out->appendf("Batches Merged: %d\n", fBatchesMerged);
+    out->appendf("Batches Issued: %d\n", fBatchesIssued);
+    out->appendf("Program Cache Hits: %d\n", fProgramCacheHits);
+    out->appendf("Program Cache Misses: %d\n", fProgramCacheMisses);
 }
 #endif
 
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrMaskAtlasGeoProc.h"
+#include "GrInvariantOutput.h"
+#include "GrTexture.h"
+#include "gl/GrGLProcessor.h"
+#include "gl/GrGLSL.h"
+#include "gl/GrGLTexture.h"
+#include "gl/GrGLGeometryProcessor.h"
+#include "gl/builders/GrGLProgramBuilder.h"
+
+class GrGLMaskAtlasGeoProc : public GrGLGeometryProcessor {
+public:
+    GrGLMaskAtlasGeoProc(const GrGeometryProcessor&, const GrBatchTracker&) {}
+
+    void onEmitCode(EmitArgs& args, GrGPArgs* gpArgs) override{
+        const GrMaskAtlasGeoProc& mage = args.fGP.cast<GrMaskAtlasGeoProc>();
+
+        GrGLGPBuilder* pb = args.fPB;
+        GrGLVertexBuilder* vsBuilder = pb->getVertexShaderBuilder();
+
+        // emit attributes
+        vsBuilder->emitAttributes(mage);
+
+        GrGLVertToFrag v(kVec2f_GrSLType);
+        pb->addVarying("TextureCoords", &v, kHigh_GrSLPrecision);
+        vsBuilder->codeAppendf("%s = %s;", v.vsOut(), mage.inTextureCoords()->fName);
+
+        // Setup pass through color
+        if (!mage.colorIgnored()) {
+            pb->addPassThroughAttribute(mage.inColor(), args.fOutputColor);
+        }
+
+        // Setup position
+        this->setupPosition(pb, gpArgs, mage.inPosition()->fName);
+
+        // emit transforms
+        this->emitTransforms(args.fPB, gpArgs->fPositionVar, mage.inPosition()->fName,
+                             mage.localMatrix(), args.fTransformsIn, args.fTransformsOut);
+
+        GrGLFragmentBuilder* fsBuilder = pb->getFragmentShaderBuilder();
+        fsBuilder->codeAppendf("%s = ", args.fOutputCoverage);
+        fsBuilder->appendTextureLookup(args.fSamplers[0], v.fsIn(), kVec2f_GrSLType);
+        fsBuilder->codeAppend(";");
+    }
+
+    virtual void setData(const GrGLProgramDataManager&,
+                         const GrPrimitiveProcessor&,
+                         const GrBatchTracker&) override {}
+
+    void setTransformData(const GrPrimitiveProcessor& primProc,
+                          const GrGLProgramDataManager& pdman,
+                          int index,
+                          const SkTArray<const GrCoordTransform*, true>& transforms) override {
+        this->setTransformDataHelper<GrMaskAtlasGeoProc>(primProc, pdman, index, transforms);
+    }
+
+    static inline void GenKey(const GrGeometryProcessor& proc,
+                              const GrBatchTracker& bt,
+                              const GrGLSLCaps&,
+                              GrProcessorKeyBuilder* b) {
+        const GrMaskAtlasGeoProc& gp = proc.cast<GrMaskAtlasGeoProc>();
+        uint32_t key = 0;
+        key |= gp.usesLocalCoords() && gp.localMatrix().hasPerspective() ? 0x1 : 0x0;
+        key |= gp.colorIgnored() ? 0x2 : 0x0;
+        b->add32(key);
+    }
+
+private:
+    typedef GrGLGeometryProcessor INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+GrMaskAtlasGeoProc::GrMaskAtlasGeoProc(GrColor color, GrTexture* texture,
+                                       const GrTextureParams& params,
+                                       const SkMatrix& localMatrix, bool usesLocalCoords)
+    : fColor(color)
+    , fLocalMatrix(localMatrix)
+    , fUsesLocalCoords(usesLocalCoords)
+    , fTextureAccess(texture, params) {
+    this->initClassID<GrMaskAtlasGeoProc>();
+    fInPosition = &this->addVertexAttrib(Attribute("inPosition", kVec2f_GrVertexAttribType));
+    fInColor = &this->addVertexAttrib(Attribute("inColor", kVec4ub_GrVertexAttribType));
+    fInTextureCoords = &this->addVertexAttrib(Attribute("inTextureCoords",
+                                                        kVec2f_GrVertexAttribType));
+    this->addTextureAccess(&fTextureAccess);
+}
+
+void GrMaskAtlasGeoProc::getGLProcessorKey(const GrBatchTracker& bt,
+                                           const GrGLSLCaps& caps,
+                                           GrProcessorKeyBuilder* b) const {
+    GrGLMaskAtlasGeoProc::GenKey(*this, bt, caps, b);
+}
+
+GrGLPrimitiveProcessor*
+GrMaskAtlasGeoProc::createGLInstance(const GrBatchTracker& bt,
+                                     const GrGLSLCaps& caps) const {
+    return SkNEW_ARGS(GrGLMaskAtlasGeoProc, (*this, bt));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GR_DEFINE_GEOMETRY_PROCESSOR_TEST(GrMaskAtlasGeoProc);
+
+GrGeometryProcessor* GrMaskAtlasGeoProc::TestCreate(SkRandom* random,
+                                                    GrContext*,
+                                                    const GrCaps&,
+                                                    GrTexture* textures[]) {
+    GrTextureParams params(SkShader::kClamp_TileMode,
+                           random->nextBool() ? GrTextureParams::kBilerp_FilterMode :
+                                                GrTextureParams::kNone_FilterMode);
+    return GrMaskAtlasGeoProc::Create(random->nextBool() ? GrRandomColor(random) : GrColor_ILLEGAL,
+                                      textures[GrProcessorUnitTest::kAlphaTextureIdx], params,
+                                      GrTest::TestMatrix(random), random->nextBool());
+}
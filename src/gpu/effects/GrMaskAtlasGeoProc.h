@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrMaskAtlasGeoProc_DEFINED
+#define GrMaskAtlasGeoProc_DEFINED
+
+#include "GrProcessor.h"
+#include "GrGeometryProcessor.h"
+
+class GrGLMaskAtlasGeoProc;
+
+/**
+ * Draws device space quads whose coverage is read from an A8 mask atlas. Each vertex carries its
+ * own color, so quads of different colors can share a draw. The texture coords are a custom
+ * attribute normalized to the atlas dimensions. The local matrix maps device space to local
+ * space.
+ */
+class GrMaskAtlasGeoProc : public GrGeometryProcessor {
+public:
+    static GrGeometryProcessor* Create(GrColor color, GrTexture* tex, const GrTextureParams& p,
+                                       const SkMatrix& localMatrix, bool usesLocalCoords) {
+        return SkNEW_ARGS(GrMaskAtlasGeoProc, (color, tex, p, localMatrix, usesLocalCoords));
+    }
+
+    virtual ~GrMaskAtlasGeoProc() {}
+
+    const char* name() const override { return "MaskAtlas"; }
+
+    const Attribute* inPosition() const { return fInPosition; }
+    const Attribute* inColor() const { return fInColor; }
+    const Attribute* inTextureCoords() const { return fInTextureCoords; }
+    GrColor color() const { return fColor; }
+    bool colorIgnored() const { return GrColor_ILLEGAL == fColor; }
+    const SkMatrix& localMatrix() const { return fLocalMatrix; }
+    bool usesLocalCoords() const { return fUsesLocalCoords; }
+
+    virtual void getGLProcessorKey(const GrBatchTracker& bt,
+                                   const GrGLSLCaps& caps,
+                                   GrProcessorKeyBuilder* b) const override;
+
+    virtual GrGLPrimitiveProcessor* createGLInstance(const GrBatchTracker& bt,
+                                                     const GrGLSLCaps& caps) const override;
+
+private:
+    GrMaskAtlasGeoProc(GrColor, GrTexture* texture, const GrTextureParams& params,
+                       const SkMatrix& localMatrix, bool usesLocalCoords);
+
+    GrColor          fColor;
+    SkMatrix         fLocalMatrix;
+    bool             fUsesLocalCoords;
+    GrTextureAccess  fTextureAccess;
+    const Attribute* fInPosition;
+    const Attribute* fInColor;
+    const Attribute* fInTextureCoords;
+
+    GR_DECLARE_GEOMETRY_PROCESSOR_TEST;
+
+    typedef GrGeometryProcessor INHERITED;
+};
+
+#endif
@@ -321,6 +321,13 @@ const GrGLInterface* GrGLAssembleGLInterface(void* ctx, GrGLGetProc get) {
         GET_PROC(GetProgramResourceLocation);
     }
 
+    if (glVer >= GR_GL_VER(4,1) || extensions.has("GL_ARB_get_program_binary")) {
+        // no ARB suffix for GL_ARB_get_program_binary
+        GET_PROC(GetProgramBinary);
+        GET_PROC(ProgramBinary);
+        GET_PROC(ProgramParameteri);
+    }
+
     if (glVer >= GR_GL_VER(3,1) || extensions.has("GL_ARB_draw_instanced")) {
         GET_PROC(DrawArraysInstanced);
         GET_PROC(DrawElementsInstanced);
@@ -677,6 +684,15 @@ const GrGLInterface* GrGLAssembleGLESInterface(void* ctx, GrGLGetProc get) {
         GET_PROC(GetProgramResourceLocation);
     }
 
+    if (version >= GR_GL_VER(3,0)) {
+        GET_PROC(GetProgramBinary);
+        GET_PROC(ProgramBinary);
+        GET_PROC(ProgramParameteri);
+    } else if (extensions.has("GL_OES_get_program_binary")) {
+        GET_PROC_SUFFIX(GetProgramBinary, OES);
+        GET_PROC_SUFFIX(ProgramBinary, OES);
+    }
+
     if (extensions.has("GL_NV_path_rendering")) {
         GET_PROC_SUFFIX(MatrixLoadf, EXT);
         GET_PROC_SUFFIX(MatrixLoadIdentity, EXT);
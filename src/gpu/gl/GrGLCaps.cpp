@@ -44,6 +44,7 @@ GrGLCaps::GrGLCaps(const GrContextOptions& contextOptions,
     fDebugSupport = false;
     fES2CompatibilitySupport = false;
     fMultisampleDisableSupport = false;
+    fProgramBinarySupport = false;
     fUseNonVBOVertexAndIndexDynamicData = false;
     fIsCoreProfile = false;
     fFullClearIsFree = false;
@@ -270,6 +271,14 @@ void GrGLCaps::init(const GrContextOptions& contextOptions,
         fMultisampleDisableSupport = false;
     }
 
+    // Drivers may expose the entry points but no binary formats, in which case there is nothing
+    // we can save.
+    if (gli->fFunctions.fGetProgramBinary && gli->fFunctions.fProgramBinary) {
+        GrGLint formatCount = 0;
+        GR_GL_GetIntegerv(gli, GR_GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        fProgramBinarySupport = formatCount > 0;
+    }
+
     /**************************************************************************
     * GrShaderCaps fields
     **************************************************************************/
@@ -1053,6 +1062,7 @@ SkString GrGLCaps::dump() const {
     r.appendf("Direct state access support: %s\n", (fDirectStateAccessSupport ? "YES": "NO"));
     r.appendf("Debug support: %s\n", (fDebugSupport ? "YES": "NO"));
     r.appendf("Multisample disable support: %s\n", (fMultisampleDisableSupport ? "YES" : "NO"));
+    r.appendf("Program binary support: %s\n", (fProgramBinarySupport ? "YES" : "NO"));
     r.appendf("Use non-VBO for dynamic data: %s\n",
              (fUseNonVBOVertexAndIndexDynamicData ? "YES" : "NO"));
     r.appendf("Full screen clear is free: %s\n", (fFullClearIsFree ? "YES" : "NO"));
@@ -241,6 +241,9 @@ public:
         return fMultisampleDisableSupport;
     }
 
+    /// Can linked programs be saved and restored with glGetProgramBinary/glProgramBinary?
+    bool programBinarySupport() const { return fProgramBinarySupport; }
+
     /// Use indices or vertices in CPU arrays rather than VBOs for dynamic content.
     bool useNonVBOVertexAndIndexDynamicData() const {
         return fUseNonVBOVertexAndIndexDynamicData;
@@ -364,6 +367,7 @@ private:
     bool fDebugSupport : 1;
     bool fES2CompatibilitySupport : 1;
     bool fMultisampleDisableSupport : 1;
+    bool fProgramBinarySupport : 1;
     bool fUseNonVBOVertexAndIndexDynamicData : 1;
     bool fIsCoreProfile : 1;
     bool fFullClearIsFree : 1;
@@ -428,6 +428,9 @@
 #define GR_GL_SHADER_TYPE                      0x8B4F
 #define GR_GL_DELETE_STATUS                    0x8B80
 #define GR_GL_LINK_STATUS                      0x8B82
+#define GR_GL_PROGRAM_BINARY_LENGTH            0x8741
+#define GR_GL_NUM_PROGRAM_BINARY_FORMATS       0x87FE
+#define GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT  0x8257
 #define GR_GL_VALIDATE_STATUS                  0x8B83
 #define GR_GL_ATTACHED_SHADERS                 0x8B85
 #define GR_GL_ACTIVE_UNIFORMS                  0x8B86
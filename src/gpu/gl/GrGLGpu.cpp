@@ -172,14 +172,15 @@ GrGpu* GrGLGpu::Create(GrBackendContext backendContext, const GrContextOptions&
     }
     GrGLContext* glContext = GrGLContext::Create(glInterface, options);
     if (glContext) {
-        return SkNEW_ARGS(GrGLGpu, (glContext, context));
+        return SkNEW_ARGS(GrGLGpu, (glContext, context, options.fPersistentCache));
     }
     return NULL;
 }
 
 static bool gPrintStartupSpew;
 
-GrGLGpu::GrGLGpu(GrGLContext* ctx, GrContext* context)
+GrGLGpu::GrGLGpu(GrGLContext* ctx, GrContext* context,
+                 GrContextOptions::PersistentCache* persistentCache)
     : GrGpu(context)
     , fGLContext(ctx) {
     SkASSERT(ctx);
@@ -206,7 +207,7 @@ GrGLGpu::GrGLGpu(GrGLContext* ctx, GrContext* context)
         SkDebugf("%s", this->glCaps().dump().c_str());
     }
 
-    fProgramCache = SkNEW_ARGS(ProgramCache, (this));
+    fProgramCache = SkNEW_ARGS(ProgramCache, (this, persistentCache));
 
     SkASSERT(this->glCaps().maxVertexAttributes() >= GrGeometryProcessor::kMaxVertexAttribs);
 
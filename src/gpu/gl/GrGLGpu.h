@@ -18,18 +18,17 @@
 #include "GrGLTexture.h"
 #include "GrGLVertexArray.h"
 #include "GrGLVertexBuffer.h"
+#include "GrContextOptions.h"
 #include "GrGpu.h"
 #include "GrPipelineBuilder.h"
 #include "GrXferProcessor.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 #include "SkTypes.h"
 
 class GrPipeline;
 class GrNonInstancedVertices;
 
-#ifdef SK_DEVELOPER
-#define PROGRAM_CACHE_STATS
-#endif
-
 class GrGLGpu : public GrGpu {
 public:
     static GrGpu* Create(GrBackendContext backendContext, const GrContextOptions& options,
@@ -113,8 +112,25 @@ public:
         return this->glInterface();
     }
 
+    int warmUpProgramCache(const SkData* const keys[], int count) override;
+
+    // Used by GrGLProgramBuilder to save and restore linked programs through the client's
+    // persistent cache (GrContextOptions::fPersistentCache), keyed by program descriptor. These
+    // are no-ops if there is no persistent cache.
+    bool hasPersistentProgramCache() const { return fProgramCache->hasPersistentCache(); }
+    SkData* loadCachedProgram(const GrProgramDesc& desc) {
+        return fProgramCache->loadPersistent(desc);
+    }
+    void storeCachedProgram(const GrProgramDesc& desc, const SkData& data) {
+        fProgramCache->storePersistent(desc, data);
+    }
+    GrGLuint takeWarmProgram(const GrProgramDesc& desc, SkData** data) {
+        return fProgramCache->takeWarmProgram(desc, data);
+    }
+
 private:
-    GrGLGpu(GrGLContext* ctx, GrContext* context);
+    GrGLGpu(GrGLContext* ctx, GrContext* context,
+            GrContextOptions::PersistentCache* persistentCache);
 
     // GrGpu overrides
     void onResetContext(uint32_t resetBits) override;
@@ -194,42 +210,49 @@ private:
 
     class ProgramCache : public ::SkNoncopyable {
     public:
-        ProgramCache(GrGLGpu* gpu);
+        ProgramCache(GrGLGpu* gpu, GrContextOptions::PersistentCache* persistentCache);
         ~ProgramCache();
 
         void abandon();
         GrGLProgram* refProgram(const DrawArgs&);
 
+        // Links the program saved in the persistent cache under each key ahead of time, so that
+        // building those programs later needs neither the persistent cache nor a driver link.
+        // Returns how many were linked.
+        int warmUp(const SkData* const keys[], int count);
+
+        bool hasPersistentCache() const { return SkToBool(fPersistentCache); }
+        SkData* loadPersistent(const GrProgramDesc&);
+        void storePersistent(const GrProgramDesc&, const SkData&);
+
+        // Hands over the program warmUp() linked for desc, along with the persistent cache data it
+        // was linked from. Returns 0 if there is none.
+        GrGLuint takeWarmProgram(const GrProgramDesc&, SkData** data);
+
     private:
         enum {
             // We may actually have kMaxEntries+1 shaders in the GL context because we create a new
             // shader before evicting from the cache.
             kMaxEntries = 128,
-            kHashBits = 6,
         };
 
         struct Entry;
+        struct WarmEntry;
+        struct WarmKey;
 
-        struct ProgDescLess;
-
-        // binary search for entry matching desc. returns index into fEntries that matches desc or ~
-        // of the index of where it should be inserted.
-        int search(const GrProgramDesc& desc) const;
-
-        // sorted array of all the entries
-        Entry*                      fEntries[kMaxEntries];
-        // hash table based on lowest kHashBits bits of the program key. Used to avoid binary
-        // searching fEntries.
-        Entry*                      fHashTable[1 << kHashBits];
-
-        int                         fCount;
-        unsigned int                fCurrLRUStamp;
-        GrGLGpu*                    fGpu;
-#ifdef PROGRAM_CACHE_STATS
-        int                         fTotalRequests;
-        int                         fCacheMisses;
-        int                         fHashMisses; // cache hit but hash table missed
-#endif
+        void purgeEntry(Entry*);
+
+        // All the programs, found by descriptor. fLRUList holds the same entries ordered from most
+        // to least recently used, so both lookup and eviction are O(1).
+        SkTDynamicHash<Entry, GrProgramDesc>    fHashTable;
+        SkTInternalLList<Entry>                 fLRUList;
+
+        // Programs linked by warmUp() that no draw has used yet. A GrGLProgram also needs the
+        // processors it draws with, so these become LRU entries when a draw first needs them.
+        SkTDynamicHash<WarmEntry, WarmKey>      fWarmEntries;
+
+        GrGLGpu*                                fGpu;
+        GrContextOptions::PersistentCache*      fPersistentCache;
     };
 
     void flushDither(bool dither);
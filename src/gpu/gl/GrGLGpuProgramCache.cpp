@@ -11,187 +11,180 @@
 #include "GrProcessor.h"
 #include "GrGLProcessor.h"
 #include "GrGLPathRendering.h"
-#include "SkRTConf.h"
-#include "SkTSearch.h"
-
-#ifdef PROGRAM_CACHE_STATS
-SK_CONF_DECLARE(bool, c_DisplayCache, "gpu.displayCache", false,
-                "Display program cache usage.");
-#endif
+#include "SkChecksum.h"
+#include "SkData.h"
 
 typedef GrGLProgramDataManager::UniformHandle UniformHandle;
 
 struct GrGLGpu::ProgramCache::Entry {
     SK_DECLARE_INST_COUNT(Entry);
-    Entry() : fProgram(NULL), fLRUStamp(0) {}
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+
+    explicit Entry(GrGLProgram* program) : fProgram(program) {}
+
+    static const GrProgramDesc& GetKey(const Entry& entry) { return entry.fProgram->getDesc(); }
+    static uint32_t Hash(const GrProgramDesc& desc) { return desc.getChecksum(); }
 
     SkAutoTUnref<GrGLProgram>   fProgram;
-    unsigned int                fLRUStamp;
 };
 
-struct GrGLGpu::ProgramCache::ProgDescLess {
-    bool operator() (const GrProgramDesc& desc, const Entry* entry) {
-        SkASSERT(entry->fProgram.get());
-        return GrProgramDesc::Less(desc, entry->fProgram->getDesc());
-    }
+// Raw descriptor bytes, as handed to the persistent cache.
+struct GrGLGpu::ProgramCache::WarmKey {
+    WarmKey(const void* data, size_t size) : fData(data), fSize(size) {}
 
-    bool operator() (const Entry* entry, const GrProgramDesc& desc) {
-        SkASSERT(entry->fProgram.get());
-        return GrProgramDesc::Less(entry->fProgram->getDesc(), desc);
+    bool operator==(const WarmKey& that) const {
+        return fSize == that.fSize && 0 == memcmp(fData, that.fData, fSize);
     }
+
+    const void* fData;
+    size_t      fSize;
 };
 
-GrGLGpu::ProgramCache::ProgramCache(GrGLGpu* gpu)
-    : fCount(0)
-    , fCurrLRUStamp(0)
-    , fGpu(gpu)
-#ifdef PROGRAM_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
-{
-    for (int i = 0; i < 1 << kHashBits; ++i) {
-        fHashTable[i] = NULL;
-    }
+struct GrGLGpu::ProgramCache::WarmEntry {
+    WarmEntry(const SkData* key, SkData* data, GrGLuint programID)
+        : fKeyData(SkRef(key))
+        , fData(data)
+        , fKey(key->data(), key->size())
+        , fProgramID(programID) {}
+
+    static const WarmKey& GetKey(const WarmEntry& entry) { return entry.fKey; }
+    static uint32_t Hash(const WarmKey& key) { return SkChecksum::Murmur3(key.fData, key.fSize); }
+
+    SkAutoTUnref<const SkData>  fKeyData;
+    SkAutoTUnref<SkData>        fData;
+    WarmKey                     fKey;
+    GrGLuint                    fProgramID;
+};
+
+GrGLGpu::ProgramCache::ProgramCache(GrGLGpu* gpu,
+                                    GrContextOptions::PersistentCache* persistentCache)
+    : fGpu(gpu)
+    , fPersistentCache(persistentCache) {
 }
 
 GrGLGpu::ProgramCache::~ProgramCache() {
-    for (int i = 0; i < fCount; ++i){
-        SkDELETE(fEntries[i]);
+    while (Entry* entry = fLRUList.head()) {
+        fLRUList.remove(entry);
+        SkDELETE(entry);
     }
-    // dump stats
-#ifdef PROGRAM_CACHE_STATS
-    if (c_DisplayCache) {
-        SkDebugf("--- Program Cache ---\n");
-        SkDebugf("Total requests: %d\n", fTotalRequests);
-        SkDebugf("Cache misses: %d\n", fCacheMisses);
-        SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ?
-                                            100.f * fCacheMisses / fTotalRequests :
-                                            0.f);
-        int cacheHits = fTotalRequests - fCacheMisses;
-        SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
-        SkDebugf("---------------------\n");
+    fHashTable.reset();
+
+    SkTDynamicHash<WarmEntry, WarmKey>::Iter iter(&fWarmEntries);
+    for (; !iter.done(); ++iter) {
+        GR_GL_CALL(fGpu->glInterface(), DeleteProgram((*iter).fProgramID));
+        SkDELETE(&*iter);
     }
-#endif
+    fWarmEntries.reset();
 }
 
 void GrGLGpu::ProgramCache::abandon() {
-    for (int i = 0; i < fCount; ++i) {
-        SkASSERT(fEntries[i]->fProgram.get());
-        fEntries[i]->fProgram->abandon();
-        SkDELETE(fEntries[i]);
+    while (Entry* entry = fLRUList.head()) {
+        SkASSERT(entry->fProgram.get());
+        entry->fProgram->abandon();
+        fLRUList.remove(entry);
+        SkDELETE(entry);
+    }
+    fHashTable.reset();
+
+    SkTDynamicHash<WarmEntry, WarmKey>::Iter iter(&fWarmEntries);
+    for (; !iter.done(); ++iter) {
+        SkDELETE(&*iter);
     }
-    fCount = 0;
+    fWarmEntries.reset();
 }
 
-int GrGLGpu::ProgramCache::search(const GrProgramDesc& desc) const {
-    ProgDescLess less;
-    return SkTSearch(fEntries, fCount, desc, sizeof(Entry*), less);
+void GrGLGpu::ProgramCache::purgeEntry(Entry* entry) {
+    fHashTable.remove(entry->fProgram->getDesc());
+    fLRUList.remove(entry);
+    SkDELETE(entry);
 }
 
 GrGLProgram* GrGLGpu::ProgramCache::refProgram(const DrawArgs& args) {
-#ifdef PROGRAM_CACHE_STATS
-    ++fTotalRequests;
-#endif
-
-    Entry* entry = NULL;
+    Entry* entry = fHashTable.find(*args.fDesc);
+    if (entry) {
+        fGpu->stats()->incProgramCacheHits();
+        // Move the entry to the front of the LRU list.
+        if (fLRUList.head() != entry) {
+            fLRUList.remove(entry);
+            fLRUList.addToHead(entry);
+        }
+        return SkRef(entry->fProgram.get());
+    }
 
-    uint32_t hashIdx = args.fDesc->getChecksum();
-    hashIdx ^= hashIdx >> 16;
-    if (kHashBits <= 8) {
-        hashIdx ^= hashIdx >> 8;
+    // We have a cache miss
+    fGpu->stats()->incProgramCacheMisses();
+    GrGLProgram* program = GrGLProgramBuilder::CreateProgram(args, fGpu);
+    if (NULL == program) {
+        return NULL;
     }
-    hashIdx &=((1 << kHashBits) - 1);
-    Entry* hashedEntry = fHashTable[hashIdx];
-    if (hashedEntry && hashedEntry->fProgram->getDesc() == *args.fDesc) {
-        SkASSERT(hashedEntry->fProgram);
-        entry = hashedEntry;
+    if (fHashTable.count() >= kMaxEntries) {
+        this->purgeEntry(fLRUList.tail());
     }
+    entry = SkNEW_ARGS(Entry, (program));
+    fHashTable.add(entry);
+    fLRUList.addToHead(entry);
+    return SkRef(program);
+}
 
-    int entryIdx;
-    if (NULL == entry) {
-        entryIdx = this->search(*args.fDesc);
-        if (entryIdx >= 0) {
-            entry = fEntries[entryIdx];
-#ifdef PROGRAM_CACHE_STATS
-            ++fHashMisses;
-#endif
-        }
+int GrGLGpu::ProgramCache::warmUp(const SkData* const keys[], int count) {
+    if (NULL == fPersistentCache || !fGpu->glCaps().programBinarySupport()) {
+        return 0;
     }
-
-    if (NULL == entry) {
-        // We have a cache miss
-#ifdef PROGRAM_CACHE_STATS
-        ++fCacheMisses;
-#endif
-        GrGLProgram* program = GrGLProgramBuilder::CreateProgram(args, fGpu);
-        if (NULL == program) {
-            return NULL;
+    int linked = 0;
+    for (int i = 0; i < count; ++i) {
+        const SkData* key = keys[i];
+        WarmKey warmKey(key->data(), key->size());
+        if (fWarmEntries.find(warmKey)) {
+            ++linked;
+            continue;
         }
-        int purgeIdx = 0;
-        if (fCount < kMaxEntries) {
-            entry = SkNEW(Entry);
-            purgeIdx = fCount++;
-            fEntries[purgeIdx] = entry;
-        } else {
-            SkASSERT(fCount == kMaxEntries);
-            purgeIdx = 0;
-            for (int i = 1; i < kMaxEntries; ++i) {
-                if (fEntries[i]->fLRUStamp < fEntries[purgeIdx]->fLRUStamp) {
-                    purgeIdx = i;
-                }
-            }
-            entry = fEntries[purgeIdx];
-            int purgedHashIdx = entry->fProgram->getDesc().getChecksum() & ((1 << kHashBits) - 1);
-            if (fHashTable[purgedHashIdx] == entry) {
-                fHashTable[purgedHashIdx] = NULL;
-            }
+        // Don't hold more linked programs than the cache itself would.
+        if (fWarmEntries.count() >= kMaxEntries) {
+            break;
         }
-        SkASSERT(fEntries[purgeIdx] == entry);
-        entry->fProgram.reset(program);
-        // We need to shift fEntries around so that the entry currently at purgeIdx is placed
-        // just before the entry at ~entryIdx (in order to keep fEntries sorted by descriptor).
-        entryIdx = ~entryIdx;
-        if (entryIdx < purgeIdx) {
-            //  Let E and P be the entries at index entryIdx and purgeIdx, respectively.
-            //  If the entries array looks like this:
-            //       aaaaEbbbbbPccccc
-            //  we rearrange it to look like this:
-            //       aaaaPEbbbbbccccc
-            size_t copySize = (purgeIdx - entryIdx) * sizeof(Entry*);
-            memmove(fEntries + entryIdx + 1, fEntries + entryIdx, copySize);
-            fEntries[entryIdx] = entry;
-        } else if (purgeIdx < entryIdx) {
-            //  If the entries array looks like this:
-            //       aaaaPbbbbbEccccc
-            //  we rearrange it to look like this:
-            //       aaaabbbbbPEccccc
-            size_t copySize = (entryIdx - purgeIdx - 1) * sizeof(Entry*);
-            memmove(fEntries + purgeIdx, fEntries + purgeIdx + 1, copySize);
-            fEntries[entryIdx - 1] = entry;
+        SkAutoTUnref<SkData> data(fPersistentCache->load(*key));
+        if (!data) {
+            continue;
         }
-#ifdef SK_DEBUG
-        SkASSERT(fEntries[0]->fProgram.get());
-        for (int i = 0; i < fCount - 1; ++i) {
-            SkASSERT(fEntries[i + 1]->fProgram.get());
-            const GrProgramDesc& a = fEntries[i]->fProgram->getDesc();
-            const GrProgramDesc& b = fEntries[i + 1]->fProgram->getDesc();
-            SkASSERT(GrProgramDesc::Less(a, b));
-            SkASSERT(!GrProgramDesc::Less(b, a));
+        GrGLuint programID = GrGLProgramBuilder::LinkCachedProgram(fGpu, *data);
+        if (programID) {
+            fWarmEntries.add(SkNEW_ARGS(WarmEntry, (key, data.detach(), programID)));
+            ++linked;
         }
-#endif
     }
+    return linked;
+}
 
-    fHashTable[hashIdx] = entry;
-    entry->fLRUStamp = fCurrLRUStamp;
+GrGLuint GrGLGpu::ProgramCache::takeWarmProgram(const GrProgramDesc& desc, SkData** data) {
+    WarmKey warmKey(desc.asKey(), desc.keyLength());
+    WarmEntry* warmEntry = fWarmEntries.find(warmKey);
+    if (NULL == warmEntry) {
+        return 0;
+    }
+    // A program is only built once while it stays in the cache, so hand over the program.
+    GrGLuint programID = warmEntry->fProgramID;
+    *data = warmEntry->fData.detach();
+    fWarmEntries.remove(warmKey);
+    SkDELETE(warmEntry);
+    return programID;
+}
 
-    if (SK_MaxU32 == fCurrLRUStamp) {
-        // wrap around! just trash our LRU, one time hit.
-        for (int i = 0; i < fCount; ++i) {
-            fEntries[i]->fLRUStamp = 0;
-        }
+SkData* GrGLGpu::ProgramCache::loadPersistent(const GrProgramDesc& desc) {
+    if (NULL == fPersistentCache) {
+        return NULL;
     }
-    ++fCurrLRUStamp;
-    return SkRef(entry->fProgram.get());
+    SkAutoTUnref<SkData> key(SkData::NewWithoutCopy(desc.asKey(), desc.keyLength()));
+    return fPersistentCache->load(*key);
+}
+
+void GrGLGpu::ProgramCache::storePersistent(const GrProgramDesc& desc, const SkData& data) {
+    if (NULL == fPersistentCache) {
+        return;
+    }
+    SkAutoTUnref<SkData> key(SkData::NewWithoutCopy(desc.asKey(), desc.keyLength()));
+    fPersistentCache->store(*key, data);
+}
+
+int GrGLGpu::warmUpProgramCache(const SkData* const keys[], int count) {
+    return fProgramCache->warmUp(keys, count);
 }
@@ -18,6 +18,7 @@
 #include "GrCoordTransform.h"
 #include "GrGLProgramBuilder.h"
 #include "GrTexture.h"
+#include "SkData.h"
 #include "SkRTConf.h"
 #include "SkTraceEvent.h"
 
@@ -395,6 +396,21 @@ void GrGLProgramBuilder::emitSamplers(const GrProcessor& processor,
 }
 
 GrGLProgram* GrGLProgramBuilder::finalize() {
+    fVS.finalizeSource();
+    fFS.finalizeSource();
+
+    SkString source;
+    bool persistent = fGpu->hasPersistentProgramCache();
+    if (persistent) {
+        fVS.appendSource(&source);
+        fFS.appendSource(&source);
+        GrGLuint cachedProgramID = this->loadCachedProgram(source);
+        if (cachedProgramID) {
+            this->resolveUniformLocations(cachedProgramID);
+            return this->createProgram(cachedProgramID);
+        }
+    }
+
     // verify we can get a program id
     GrGLuint programID;
     GL_CALL_RET(programID, CreateProgram());
@@ -426,6 +442,10 @@ GrGLProgram* GrGLProgramBuilder::finalize() {
         this->bindUniformLocations(programID);
     }
     fFS.bindFragmentShaderLocations(programID);
+    if (persistent && fGpu->glCaps().programBinarySupport() &&
+        fGpu->glInterface()->fFunctions.fProgramParameteri) {
+        GL_CALL(ProgramParameteri(programID, GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GR_GL_TRUE));
+    }
     GL_CALL(LinkProgram(programID));
 
     // Calling GetProgramiv is expensive in Chromium. Assume success in release builds.
@@ -442,9 +462,132 @@ GrGLProgram* GrGLProgramBuilder::finalize() {
 
     this->cleanupShaders(shadersToDelete);
 
+    if (persistent) {
+        this->storeCachedProgram(programID, source);
+    }
+
     return this->createProgram(programID);
 }
 
+namespace {
+// Layout of the data saved in the persistent program cache: this header, the source of all the
+// program's shaders, then the linked program binary. Processor
+// class IDs are assigned at run time, so the same descriptor can mean different shaders in another
+// process; comparing the saved source with the freshly generated source catches that.
+struct CachedProgramHeader {
+    uint32_t fVersion;
+    uint32_t fSourceLength;
+    uint32_t fBinaryFormat;
+    uint32_t fBinaryLength;
+};
+
+static const uint32_t kCachedProgramVersion = 1;
+}
+
+// Finds the header and saved source in data. Returns false if data isn't a valid cache entry.
+static bool parse_cached_program(const SkData& data, CachedProgramHeader* header,
+                                 const char** source) {
+    if (data.size() < sizeof(CachedProgramHeader)) {
+        return false;
+    }
+    memcpy(header, data.data(), sizeof(*header));
+    *source = static_cast<const char*>(data.data()) + sizeof(*header);
+    return kCachedProgramVersion == header->fVersion &&
+           0 != header->fBinaryLength &&
+           data.size() == sizeof(*header) + header->fSourceLength + header->fBinaryLength;
+}
+
+static bool cached_program_matches(const SkData& data, const SkString& source) {
+    CachedProgramHeader header;
+    const char* cachedSource;
+    return parse_cached_program(data, &header, &cachedSource) &&
+           source.size() == header.fSourceLength &&
+           0 == memcmp(cachedSource, source.c_str(), header.fSourceLength);
+}
+
+GrGLuint GrGLProgramBuilder::LinkCachedProgram(GrGLGpu* gpu, const SkData& data) {
+    CachedProgramHeader header;
+    const char* cachedSource;
+    if (!gpu->glCaps().programBinarySupport() ||
+        !parse_cached_program(data, &header, &cachedSource)) {
+        return 0;
+    }
+    GrGLuint programID;
+    GR_GL_CALL_RET(gpu->glInterface(), programID, CreateProgram());
+    if (0 == programID) {
+        return 0;
+    }
+    GR_GL_CALL(gpu->glInterface(), ProgramBinary(programID, header.fBinaryFormat,
+                                                 cachedSource + header.fSourceLength,
+                                                 header.fBinaryLength));
+    // The driver rejects binaries from other driver versions. That is expected, so unlike
+    // checkLinkStatus this doesn't treat failure as an error; the caller compiles and relinks.
+    GrGLint linked = GR_GL_INIT_ZERO;
+    GR_GL_CALL(gpu->glInterface(), GetProgramiv(programID, GR_GL_LINK_STATUS, &linked));
+    if (!linked) {
+        GR_GL_CALL(gpu->glInterface(), DeleteProgram(programID));
+        return 0;
+    }
+    return programID;
+}
+
+GrGLuint GrGLProgramBuilder::loadCachedProgram(const SkString& source) {
+    // A program linked ahead of time by GrContext::warmUpProgramCache() only needs its saved
+    // source checked.
+    SkData* warmData;
+    GrGLuint programID = fGpu->takeWarmProgram(this->desc(), &warmData);
+    if (programID) {
+        SkAutoTUnref<SkData> data(warmData);
+        if (cached_program_matches(*data, source)) {
+            return programID;
+        }
+        GL_CALL(DeleteProgram(programID));
+        return 0;
+    }
+
+    if (!fGpu->glCaps().programBinarySupport()) {
+        return 0;
+    }
+    SkAutoTUnref<SkData> data(fGpu->loadCachedProgram(this->desc()));
+    if (!data || !cached_program_matches(*data, source)) {
+        return 0;
+    }
+    return LinkCachedProgram(fGpu, *data);
+}
+
+void GrGLProgramBuilder::storeCachedProgram(GrGLuint programID, const SkString& source) {
+    // loadCachedProgram() can only use entries with a binary, so don't store any without one.
+    if (!fGpu->glCaps().programBinarySupport()) {
+        return;
+    }
+    GrGLint length = GR_GL_INIT_ZERO;
+    GL_CALL(GetProgramiv(programID, GR_GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+        return;
+    }
+    SkAutoMalloc binary(length);
+    GrGLsizei actualLength = GR_GL_INIT_ZERO;
+    GrGLenum format = GR_GL_INIT_ZERO;
+    GL_CALL(GetProgramBinary(programID, length, &actualLength, &format, binary.get()));
+    if (actualLength <= 0 || actualLength > length) {
+        return;
+    }
+
+    CachedProgramHeader header;
+    header.fVersion = kCachedProgramVersion;
+    header.fSourceLength = SkToU32(source.size());
+    header.fBinaryFormat = format;
+    header.fBinaryLength = actualLength;
+
+    SkAutoTUnref<SkData> data(SkData::NewUninitialized(sizeof(header) + header.fSourceLength +
+                                                       header.fBinaryLength));
+    char* dst = static_cast<char*>(data->writable_data());
+    memcpy(dst, &header, sizeof(header));
+    memcpy(dst + sizeof(header), source.c_str(), header.fSourceLength);
+    memcpy(dst + sizeof(header) + header.fSourceLength, binary.get(), header.fBinaryLength);
+    fGpu->storeCachedProgram(this->desc(), *data);
+}
+
 void GrGLProgramBuilder::bindUniformLocations(GrGLuint programID) {
     int count = fUniforms.count();
     for (int i = 0; i < count; ++i) {
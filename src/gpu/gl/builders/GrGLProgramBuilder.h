@@ -18,6 +18,8 @@
 #include "../../GrPendingFragmentStage.h"
 #include "../../GrPipeline.h"
 
+class SkData;
+
 /*
  * This is the base class for a series of interfaces.  This base class *MUST* remain abstract with
  * NO data members because it is used in multiple interface inheritance.
@@ -229,6 +231,13 @@ public:
      */
     static GrGLProgram* CreateProgram(const DrawArgs&, GrGLGpu*);
 
+    /**
+     * Links a program from data saved in the persistent program cache, without checking which
+     * shaders it was built from. Returns the new program's ID, or 0 if the data isn't valid or the
+     * driver rejects the binary.
+     */
+    static GrGLuint LinkCachedProgram(GrGLGpu*, const SkData&);
+
     UniformHandle addUniformArray(uint32_t visibility,
                                   GrSLType type,
                                   GrSLPrecision precision,
@@ -322,6 +331,10 @@ protected:
                       GrGLInstalledProc<Proc>*);
 
     GrGLProgram* finalize();
+    // Tries to restore the program from the persistent program cache. Returns the ID of a program
+    // linked from a saved binary for exactly this source, or 0.
+    GrGLuint loadCachedProgram(const SkString& source);
+    void storeCachedProgram(GrGLuint programID, const SkString& source);
     void bindUniformLocations(GrGLuint programID);
     bool checkLinkStatus(GrGLuint programID);
     void resolveUniformLocations(GrGLuint programID);
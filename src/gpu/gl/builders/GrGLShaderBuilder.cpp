@@ -191,8 +191,7 @@ void GrGLShaderBuilder::compileAndAppendLayoutQualifiers() {
     GR_STATIC_ASSERT(SK_ARRAY_COUNT(interfaceQualifierNames) == kLastInterfaceQualifier + 1);
 }
 
-bool
-GrGLShaderBuilder::finalize(GrGLuint programId, GrGLenum type, SkTDArray<GrGLuint>* shaderIds) {
+void GrGLShaderBuilder::finalizeCode() {
     SkASSERT(!fFinalized);
     // append the 'footer' to code
     this->code().append("}");
@@ -202,6 +201,19 @@ GrGLShaderBuilder::finalize(GrGLuint programId, GrGLenum type, SkTDArray<GrGLuin
         fCompilerStringLengths[i] = (int)fShaderStrings[i].size();
     }
 
+    fFinalized = true;
+}
+
+void GrGLShaderBuilder::appendSource(SkString* out) const {
+    SkASSERT(fFinalized);
+    for (int i = 0; i < fCompilerStrings.count(); i++) {
+        out->append(fCompilerStrings[i], fCompilerStringLengths[i]);
+    }
+}
+
+bool GrGLShaderBuilder::compileAndAttach(GrGLuint programId, GrGLenum type,
+                                         SkTDArray<GrGLuint>* shaderIds) {
+    SkASSERT(fFinalized);
     GrGLGpu* gpu = fProgramBuilder->gpu();
     GrGLuint shaderId = GrGLCompileAndAttachShader(gpu->glContext(),
                                                    programId,
@@ -211,8 +223,6 @@ GrGLShaderBuilder::finalize(GrGLuint programId, GrGLenum type, SkTDArray<GrGLuin
                                                    fCompilerStrings.count(),
                                                    gpu->stats());
 
-    fFinalized = true;
-
     if (!shaderId) {
         return false;
     }
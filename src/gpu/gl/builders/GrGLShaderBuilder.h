@@ -172,7 +172,12 @@ protected:
     SkString& functions() { return fShaderStrings[kFunctions]; }
     SkString& main() { return fShaderStrings[kMain]; }
     SkString& code() { return fShaderStrings[fCodeIndex]; }
-    bool finalize(GrGLuint programId, GrGLenum type, SkTDArray<GrGLuint>* shaderIds);
+
+    // Closes main() and gathers the shader strings. No code may be added afterwards.
+    void finalizeCode();
+    // Appends the complete text of the finalized shader to out.
+    void appendSource(SkString* out) const;
+    bool compileAndAttach(GrGLuint programId, GrGLenum type, SkTDArray<GrGLuint>* shaderIds);
 
     enum {
         kVersionDecl,
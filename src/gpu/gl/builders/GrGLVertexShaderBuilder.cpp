@@ -85,12 +85,16 @@ void GrGLVertexBuilder::bindVertexAttributes(GrGLuint programID) {
 
 bool
 GrGLVertexBuilder::compileAndAttachShaders(GrGLuint programId, SkTDArray<GrGLuint>* shaderIds) {
+    return this->compileAndAttach(programId, GR_GL_VERTEX_SHADER, shaderIds);
+}
+
+void GrGLVertexBuilder::finalizeSource() {
     this->versionDecl() = GrGetGLSLVersionDecl(fProgramBuilder->ctxInfo());
     this->compileAndAppendLayoutQualifiers();
     fProgramBuilder->appendUniformDecls(GrGLProgramBuilder::kVertex_Visibility, &this->uniforms());
     this->appendDecls(fInputs, &this->inputs());
     this->appendDecls(fOutputs, &this->outputs());
-    return this->finalize(programId, GR_GL_VERTEX_SHADER, shaderIds);
+    this->finalizeCode();
 }
 
 bool GrGLVertexBuilder::addAttribute(const GrShaderVar& var) {
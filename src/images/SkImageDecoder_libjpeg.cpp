@@ -1325,8 +1325,8 @@ static void Write_Index_YUV(uint8_t* SK_RESTRICT dst,
     }
 }
 
-static WriteScanline ChooseWriter(const SkBitmap& bm) {
-    switch (bm.colorType()) {
+static WriteScanline ChooseWriter(SkColorType colorType) {
+    switch (colorType) {
         case kN32_SkColorType:
             return Write_32_YUV;
         case kRGB_565_SkColorType:
@@ -1340,8 +1340,125 @@ static WriteScanline ChooseWriter(const SkBitmap& bm) {
     }
 }
 
+static void set_compress_params(jpeg_compress_struct* cinfo, int width, int height,
+                                int quality) {
+    cinfo->image_width = width;
+    cinfo->image_height = height;
+    cinfo->input_components = 3;
+#ifdef WE_CONVERT_TO_YUV
+    cinfo->in_color_space = JCS_YCbCr;
+#else
+    cinfo->in_color_space = JCS_RGB;
+#endif
+    cinfo->input_gamma = 1;
+
+    jpeg_set_defaults(cinfo);
+    jpeg_set_quality(cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+#ifdef DCT_IFAST_SUPPORTED
+    cinfo->dct_method = JDCT_IFAST;
+#endif
+}
+
+// Hands the rows to libjpeg as they come. It compresses a row of MCUs at a time, so only
+// those rows and one converted row are held.
+class SkJPEGRowWriter : public SkImageEncoder::RowWriter {
+public:
+    SkJPEGRowWriter(SkWStream* stream, const SkImageInfo& info, WriteScanline writer)
+        : fDest(stream)
+        , fWriter(writer)
+        , fWidth(info.width())
+        , fHeight(info.height())
+        , fRow(info.width() * 3)
+        , fCreated(false)
+        , fFailed(false) {}
+
+    ~SkJPEGRowWriter() override {
+        if (fCreated) {
+            jpeg_destroy_compress(&fCInfo);
+        }
+    }
+
+    bool begin(int quality) {
+        fCInfo.err = jpeg_std_error(&fErr);
+        fErr.error_exit = skjpeg_error_exit;
+        if (setjmp(fErr.fJmpBuf)) {
+            return false;
+        }
+        jpeg_create_compress(&fCInfo);
+        fCreated = true;
+        fCInfo.dest = &fDest;
+        set_compress_params(&fCInfo, fWidth, fHeight, quality);
+        jpeg_start_compress(&fCInfo, TRUE);
+        return true;
+    }
+
+    bool writeRows(const void* pixels, size_t rowBytes, int rowCount) override {
+        if (fFailed || rowCount < 0 ||
+                rowCount > (int)(fCInfo.image_height - fCInfo.next_scanline)) {
+            fFailed = true;
+            return false;
+        }
+        if (setjmp(fErr.fJmpBuf)) {
+            fFailed = true;
+            return false;
+        }
+        const char* srcRow = (const char*)pixels;
+        for (int y = 0; y < rowCount; ++y) {
+            JSAMPROW row_pointer[1];
+            fWriter(fRow.get(), srcRow, fWidth, NULL);
+            row_pointer[0] = fRow.get();
+            (void) jpeg_write_scanlines(&fCInfo, row_pointer, 1);
+            srcRow += rowBytes;
+        }
+        return true;
+    }
+
+    bool finish() override {
+        if (fFailed || fCInfo.next_scanline != fCInfo.image_height) {
+            fFailed = true;
+            return false;
+        }
+        if (setjmp(fErr.fJmpBuf)) {
+            fFailed = true;
+            return false;
+        }
+        jpeg_finish_compress(&fCInfo);
+        // Anything more is an error.
+        fFailed = true;
+        return true;
+    }
+
+private:
+    jpeg_compress_struct    fCInfo;
+    skjpeg_error_mgr        fErr;
+    skjpeg_destination_mgr  fDest;
+    const WriteScanline     fWriter;
+    const int               fWidth;
+    const int               fHeight;
+    SkAutoTMalloc<uint8_t>  fRow;
+    bool                    fCreated;
+    bool                    fFailed;
+};
+
 class SkJPEGImageEncoder : public SkImageEncoder {
 protected:
+    RowWriter* onBeginRows(SkWStream* stream, const SkImageInfo& info, int quality) override {
+        // Without a color table, only the direct color types can be written.
+        if (kIndex_8_SkColorType == info.colorType()) {
+            return NULL;
+        }
+        const WriteScanline writer = ChooseWriter(info.colorType());
+        if (NULL == writer) {
+            return NULL;
+        }
+        SkAutoTDelete<SkJPEGRowWriter> rowWriter(SkNEW_ARGS(SkJPEGRowWriter,
+                                                            (stream, info, writer)));
+        if (!rowWriter->begin(quality)) {
+            return NULL;
+        }
+        return rowWriter.detach();
+    }
+
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) {
 #ifdef TIME_ENCODE
         SkAutoTime atm("JPEG Encode");
@@ -1366,28 +1483,14 @@ protected:
         }
 
         // Keep after setjmp or mark volatile.
-        const WriteScanline writer = ChooseWriter(bm);
+        const WriteScanline writer = ChooseWriter(bm.colorType());
         if (NULL == writer) {
             return false;
         }
 
         jpeg_create_compress(&cinfo);
         cinfo.dest = &sk_wstream;
-        cinfo.image_width = bm.width();
-        cinfo.image_height = bm.height();
-        cinfo.input_components = 3;
-#ifdef WE_CONVERT_TO_YUV
-        cinfo.in_color_space = JCS_YCbCr;
-#else
-        cinfo.in_color_space = JCS_RGB;
-#endif
-        cinfo.input_gamma = 1;
-
-        jpeg_set_defaults(&cinfo);
-        jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
-#ifdef DCT_IFAST_SUPPORTED
-        cinfo.dct_method = JDCT_IFAST;
-#endif
+        set_compress_params(&cinfo, bm.width(), bm.height(), quality);
 
         jpeg_start_compress(&cinfo, TRUE);
 
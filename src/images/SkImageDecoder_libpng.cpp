@@ -14,6 +14,7 @@
 #include "SkRTConf.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
@@ -23,6 +24,7 @@
     #include "pngprefix.h"
 #endif
 #include "png.h"
+#include "zlib.h"
 
 /* These were dropped in libpng >= 1.4 */
 #ifndef png_infopp_NULL
@@ -1102,47 +1104,311 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+SK_COMPILE_ASSERT(SkPNGEncoderOptions::kNone_Filter == PNG_FILTER_NONE, png_filter_none);
+SK_COMPILE_ASSERT(SkPNGEncoderOptions::kSub_Filter == PNG_FILTER_SUB, png_filter_sub);
+SK_COMPILE_ASSERT(SkPNGEncoderOptions::kUp_Filter == PNG_FILTER_UP, png_filter_up);
+SK_COMPILE_ASSERT(SkPNGEncoderOptions::kAvg_Filter == PNG_FILTER_AVG, png_filter_avg);
+SK_COMPILE_ASSERT(SkPNGEncoderOptions::kPaeth_Filter == PNG_FILTER_PAETH, png_filter_paeth);
+
+static int zlib_level(const SkPNGEncoderOptions& options) {
+    return SkTPin(options.fZLibLevel, 0, 9);
+}
+
+/*  Parallel encoding: the rows are cut into bands, which are filtered on SkTaskGroup's threads
+    and then deflated on them, each band primed with the last 32K of the band before it so
+    little is lost to the cuts. All but the last band end with a sync flush, which leaves them
+    byte aligned, so their raw deflate streams can be concatenated between one zlib header and
+    one Adler-32 trailer, and written out as consecutive IDAT chunks.
+*/
+
+// Aim for bands this big, so there are enough of them to go around without
+// restarting the compressor too often.
+#define PNG_BAND_BYTES      (512 * 1024)
+#define PNG_WINDOW_SIZE     (1 << 15)
+
+struct PNGEncodeBands;
+
+struct PNGBand {
+    PNGEncodeBands*         fShared;
+    int                     fIndex;
+    int                     fStartRow;
+    int                     fRowCount;
+    SkAutoTMalloc<uint8_t>  fFiltered;      // fRowCount rows, each with its filter byte
+    SkAutoTMalloc<uint8_t>  fDeflated;      // with room for the zlib header and trailer
+    size_t                  fDeflatedSize;
+    uLong                   fAdler;
+    bool                    fSuccess;
+};
+
+struct PNGEncodeBands {
+    const SkBitmap*         fBitmap;
+    transform_scanline_proc fProc;
+    int                     fBytesPerPixel;
+    size_t                  fRowBytes;      // of a transformed row, without the filter byte
+    unsigned                fFilters;
+    int                     fZLibLevel;
+    PNGBand*                fBands;
+    int                     fBandCount;
+};
+
+static inline uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkAbs32(p - a);
+    int pb = SkAbs32(p - b);
+    int pc = SkAbs32(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Write the filter byte and the filtered row to dst, and return the sum of the filtered bytes
+// as signed values, libpng's measure of how well a filter did.
+static uint32_t filter_row(unsigned filter, const uint8_t* SK_RESTRICT row,
+                           const uint8_t* SK_RESTRICT prev, int bpp, size_t n,
+                           uint8_t* SK_RESTRICT dst) {
+    uint8_t* out = dst + 1;
+    size_t i;
+    switch (filter) {
+        case PNG_FILTER_SUB:
+            dst[0] = PNG_FILTER_VALUE_SUB;
+            for (i = 0; i < (size_t)bpp; ++i) {
+                out[i] = row[i];
+            }
+            for (; i < n; ++i) {
+                out[i] = row[i] - row[i - bpp];
+            }
+            break;
+        case PNG_FILTER_UP:
+            dst[0] = PNG_FILTER_VALUE_UP;
+            for (i = 0; i < n; ++i) {
+                out[i] = row[i] - prev[i];
+            }
+            break;
+        case PNG_FILTER_AVG:
+            dst[0] = PNG_FILTER_VALUE_AVG;
+            for (i = 0; i < (size_t)bpp; ++i) {
+                out[i] = row[i] - (prev[i] >> 1);
+            }
+            for (; i < n; ++i) {
+                out[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+            }
+            break;
+        case PNG_FILTER_PAETH:
+            dst[0] = PNG_FILTER_VALUE_PAETH;
+            for (i = 0; i < (size_t)bpp; ++i) {
+                out[i] = row[i] - prev[i];
+            }
+            for (; i < n; ++i) {
+                out[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+        default:
+            SkASSERT(PNG_FILTER_NONE == filter);
+            dst[0] = PNG_FILTER_VALUE_NONE;
+            memcpy(out, row, n);
+            break;
+    }
+
+    uint32_t sum = 0;
+    for (i = 0; i < n; ++i) {
+        sum += SkAbs32((int8_t)out[i]);
+    }
+    return sum;
+}
+
+static void filter_band(PNGBand* band) {
+    const PNGEncodeBands& shared = *band->fShared;
+    const SkBitmap& bitmap = *shared.fBitmap;
+    const size_t n = shared.fRowBytes;
+
+    // The band's first row is filtered against the last row of the band before it.
+    SkAutoTMalloc<uint8_t> rows(2 * n);
+    uint8_t* prev = rows.get();
+    uint8_t* row = prev + n;
+    if (band->fStartRow > 0) {
+        shared.fProc((const char*)bitmap.getAddr(0, band->fStartRow - 1), bitmap.width(),
+                     (char*)prev);
+    } else {
+        sk_bzero(prev, n);
+    }
+
+    SkAutoTMalloc<uint8_t> scratch(n + 1);
+    uint8_t* dst = band->fFiltered.get();
+    for (int y = 0; y < band->fRowCount; ++y) {
+        shared.fProc((const char*)bitmap.getAddr(0, band->fStartRow + y), bitmap.width(),
+                     (char*)row);
+        uint32_t bestSum = SK_MaxU32;
+        for (unsigned filter = PNG_FILTER_NONE; filter <= PNG_FILTER_PAETH; filter <<= 1) {
+            if (!(shared.fFilters & filter)) {
+                continue;
+            }
+            uint32_t sum = filter_row(filter, row, prev, shared.fBytesPerPixel, n,
+                                      scratch.get());
+            if (sum < bestSum) {
+                bestSum = sum;
+                memcpy(dst, scratch.get(), n + 1);
+            }
+        }
+        dst += n + 1;
+        SkTSwap(prev, row);
+    }
+}
+
+static void deflate_band(PNGBand* band) {
+    const PNGEncodeBands& shared = *band->fShared;
+    const size_t size = band->fRowCount * (shared.fRowBytes + 1);
+    const bool first = 0 == band->fIndex;
+    const bool last = shared.fBandCount - 1 == band->fIndex;
+    band->fSuccess = false;
+    band->fAdler = adler32(adler32(0, Z_NULL, 0), band->fFiltered.get(), (uInt)size);
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    const int strategy = PNG_FILTER_NONE == shared.fFilters ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (Z_OK != deflateInit2(&zs, shared.fZLibLevel, Z_DEFLATED, -15, 8, strategy)) {
+        return;
+    }
+    if (!first) {
+        const PNGBand& prev = shared.fBands[band->fIndex - 1];
+        const size_t prevSize = prev.fRowCount * (shared.fRowBytes + 1);
+        const size_t dictSize = SkTMin<size_t>(prevSize, PNG_WINDOW_SIZE);
+        deflateSetDictionary(&zs, prev.fFiltered.get() + prevSize - dictSize, (uInt)dictSize);
+    }
+
+    // Room for the zlib header, the sync flush's empty block and the trailer.
+    const size_t capacity = deflateBound(&zs, (uLong)size) + 16;
+    band->fDeflated.reset(capacity);
+    uint8_t* out = band->fDeflated.get() + (first ? 2 : 0);
+    zs.next_in = band->fFiltered.get();
+    zs.avail_in = (uInt)size;
+    zs.next_out = out;
+    zs.avail_out = (uInt)(capacity - 6);
+    const int result = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    band->fDeflatedSize = zs.next_out - band->fDeflated.get();
+    band->fSuccess = (last ? Z_STREAM_END == result : Z_OK == result) && 0 == zs.avail_in;
+    deflateEnd(&zs);
+}
+
+// Write the bitmap's IDAT chunks, or return false without writing any.
+static bool write_bands(png_structp png_ptr, const SkBitmap& bitmap, transform_scanline_proc proc,
+                        int bytesPerPixel, unsigned filters, int level) {
+    PNGEncodeBands shared;
+    shared.fBitmap = &bitmap;
+    shared.fProc = proc;
+    shared.fBytesPerPixel = bytesPerPixel;
+    shared.fRowBytes = bitmap.width() * bytesPerPixel;
+    shared.fFilters = filters;
+    shared.fZLibLevel = level;
+
+    const int height = bitmap.height();
+    const int rowsPerBand = SkTMax<int>(1, PNG_BAND_BYTES / (shared.fRowBytes + 1));
+    shared.fBandCount = (height + rowsPerBand - 1) / rowsPerBand;
+    SkAutoTArray<PNGBand> bands(shared.fBandCount);
+    shared.fBands = bands.get();
+    for (int i = 0; i < shared.fBandCount; ++i) {
+        PNGBand& band = bands[i];
+        band.fShared = &shared;
+        band.fIndex = i;
+        band.fStartRow = i * rowsPerBand;
+        band.fRowCount = SkTMin(rowsPerBand, height - band.fStartRow);
+        band.fFiltered.reset(band.fRowCount * (shared.fRowBytes + 1));
+    }
+
+    // Every band must be filtered before any is deflated, since each primes its compressor
+    // with the end of the one before.
+    {
+        SkTaskGroup tg;
+        tg.batch(filter_band, bands.get(), shared.fBandCount);
+    }
+    {
+        SkTaskGroup tg;
+        tg.batch(deflate_band, bands.get(), shared.fBandCount);
+    }
+
+    uLong adler = bands[0].fAdler;
+    for (int i = 0; i < shared.fBandCount; ++i) {
+        if (!bands[i].fSuccess) {
+            return false;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, bands[i].fAdler,
+                                    bands[i].fRowCount * (shared.fRowBytes + 1));
+        }
+    }
+
+    // zlib header: deflate with a 32K window, and a hint of the level, as zlib writes it.
+    PNGBand& first = bands[0];
+    const int levelHint = level < 2 ? 0 : (level < 6 ? 1 : (6 == level ? 2 : 3));
+    first.fDeflated[0] = 0x78;
+    first.fDeflated[1] = levelHint << 6;
+    first.fDeflated[1] += 31 - ((0x78 << 8) + first.fDeflated[1]) % 31;
+
+    PNGBand& last = bands[shared.fBandCount - 1];
+    uint8_t* trailer = last.fDeflated.get() + last.fDeflatedSize;
+    trailer[0] = (uint8_t)(adler >> 24);
+    trailer[1] = (uint8_t)(adler >> 16);
+    trailer[2] = (uint8_t)(adler >> 8);
+    trailer[3] = (uint8_t)adler;
+    last.fDeflatedSize += 4;
+
+    for (int i = 0; i < shared.fBandCount; ++i) {
+        png_write_chunk(png_ptr, (png_bytep)"IDAT", bands[i].fDeflated.get(),
+                        bands[i].fDeflatedSize);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 class SkPNGImageEncoder : public SkImageEncoder {
+public:
+    SkPNGImageEncoder() {}
+    explicit SkPNGImageEncoder(const SkPNGEncoderOptions& options) : fOptions(options) {}
+
 protected:
     bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) override;
+    RowWriter* onBeginRows(SkWStream*, const SkImageInfo&, int quality) override;
 private:
     bool doEncode(SkWStream* stream, const SkBitmap& bm,
                   const bool& hasAlpha, int colorType,
                   int bitDepth, SkColorType ct,
-                  png_color_8& sig_bit);
+                  png_color_8& sig_bit, int quality);
+
+    SkPNGEncoderOptions fOptions;
 
     typedef SkImageEncoder INHERITED;
 };
 
-bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap, int /*quality*/) {
-    SkColorType ct = bitmap.colorType();
-
-    const bool hasAlpha = !bitmap.isOpaque();
-    int colorType = PNG_COLOR_MASK_COLOR;
-    int bitDepth = 8;   // default for color
-    png_color_8 sig_bit;
+// Pick the png color type and significant bits for the SkColorType, or return false if it
+// can't be encoded.
+static bool choose_png_color_type(SkColorType ct, bool hasAlpha, int* colorType,
+                                  png_color_8* sig_bit) {
+    *colorType = PNG_COLOR_MASK_COLOR;
 
     switch (ct) {
         case kIndex_8_SkColorType:
-            colorType |= PNG_COLOR_MASK_PALETTE;
+            *colorType |= PNG_COLOR_MASK_PALETTE;
             // fall through to the ARGB_8888 case
         case kN32_SkColorType:
-            sig_bit.red = 8;
-            sig_bit.green = 8;
-            sig_bit.blue = 8;
-            sig_bit.alpha = 8;
+            sig_bit->red = 8;
+            sig_bit->green = 8;
+            sig_bit->blue = 8;
+            sig_bit->alpha = 8;
             break;
         case kARGB_4444_SkColorType:
-            sig_bit.red = 4;
-            sig_bit.green = 4;
-            sig_bit.blue = 4;
-            sig_bit.alpha = 4;
+            sig_bit->red = 4;
+            sig_bit->green = 4;
+            sig_bit->blue = 4;
+            sig_bit->alpha = 4;
             break;
         case kRGB_565_SkColorType:
-            sig_bit.red = 5;
-            sig_bit.green = 6;
-            sig_bit.blue = 5;
-            sig_bit.alpha = 0;
+            sig_bit->red = 5;
+            sig_bit->green = 6;
+            sig_bit->blue = 5;
+            sig_bit->alpha = 0;
             break;
         default:
             return false;
@@ -1150,11 +1416,77 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap, int
 
     if (hasAlpha) {
         // don't specify alpha if we're a palette, even if our ctable has alpha
-        if (!(colorType & PNG_COLOR_MASK_PALETTE)) {
-            colorType |= PNG_COLOR_MASK_ALPHA;
+        if (!(*colorType & PNG_COLOR_MASK_PALETTE)) {
+            *colorType |= PNG_COLOR_MASK_ALPHA;
         }
     } else {
-        sig_bit.alpha = 0;
+        sig_bit->alpha = 0;
+    }
+    return true;
+}
+
+static unsigned png_filters(const SkPNGEncoderOptions& options) {
+    unsigned filters = options.fFilters & SkPNGEncoderOptions::kAll_Filters;
+    if (0 == filters) {
+        filters = SkPNGEncoderOptions::kAll_Filters;
+    }
+    return filters;
+}
+
+/*  Write everything up to the image data: the signature, IHDR, and PLTE, tRNS and sBIT as
+    needed. This calls libpng, so png_ptr's jmpbuf must have been set.
+*/
+static void write_png_info(png_structp png_ptr, png_infop info_ptr, SkWStream* stream,
+                           int width, int height, int bitDepth, int colorType,
+                           png_color_8& sig_bit, SkColorTable* ctable, bool hasAlpha,
+                           int level, unsigned filters) {
+    png_set_write_fn(png_ptr, (void*)stream, sk_write_fn, png_flush_ptr_NULL);
+
+    /* Set the image information here.  Width and height are up to 2^31,
+    * bit_depth is one of 1, 2, 4, 8, or 16, but valid values also depend on
+    * the color_type selected. color_type is one of PNG_COLOR_TYPE_GRAY,
+    * PNG_COLOR_TYPE_GRAY_ALPHA, PNG_COLOR_TYPE_PALETTE, PNG_COLOR_TYPE_RGB,
+    * or PNG_COLOR_TYPE_RGB_ALPHA.  interlace is either PNG_INTERLACE_NONE or
+    * PNG_INTERLACE_ADAM7, and the compression_type and filter_type MUST
+    * currently be PNG_COMPRESSION_TYPE_BASE and PNG_FILTER_TYPE_BASE. REQUIRED
+    */
+
+    png_set_IHDR(png_ptr, info_ptr, width, height,
+                 bitDepth, colorType,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
+                 PNG_FILTER_TYPE_BASE);
+
+    // set our colortable/trans arrays if needed
+    png_color paletteColors[256];
+    png_byte trans[256];
+    if (ctable) {
+        int numTrans = pack_palette(ctable, paletteColors, trans, hasAlpha);
+        png_set_PLTE(png_ptr, info_ptr, paletteColors, ctable->count());
+        if (numTrans > 0) {
+            png_set_tRNS(png_ptr, info_ptr, trans, numTrans, NULL);
+        }
+    }
+#ifdef PNG_sBIT_SUPPORTED
+    png_set_sBIT(png_ptr, info_ptr, &sig_bit);
+#endif
+
+    png_set_compression_level(png_ptr, level);
+    if (SkPNGEncoderOptions::kAll_Filters != filters) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+    }
+    png_write_info(png_ptr, info_ptr);
+}
+
+bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap, int quality) {
+    SkColorType ct = bitmap.colorType();
+
+    const bool hasAlpha = !bitmap.isOpaque();
+    int colorType;
+    int bitDepth = 8;   // default for color
+    png_color_8 sig_bit;
+
+    if (!choose_png_color_type(ct, hasAlpha, &colorType, &sig_bit)) {
+        return false;
     }
 
     SkAutoLockPixels alp(bitmap);
@@ -1173,13 +1505,13 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap, int
         bitDepth = computeBitDepth(ctable->count());
     }
 
-    return doEncode(stream, bitmap, hasAlpha, colorType, bitDepth, ct, sig_bit);
+    return doEncode(stream, bitmap, hasAlpha, colorType, bitDepth, ct, sig_bit, quality);
 }
 
 bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
                   const bool& hasAlpha, int colorType,
                   int bitDepth, SkColorType ct,
-                  png_color_8& sig_bit) {
+                  png_color_8& sig_bit, int quality) {
 
     png_structp png_ptr;
     png_infop info_ptr;
@@ -1204,42 +1536,38 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
         return false;
     }
 
-    png_set_write_fn(png_ptr, (void*)stream, sk_write_fn, png_flush_ptr_NULL);
-
-    /* Set the image information here.  Width and height are up to 2^31,
-    * bit_depth is one of 1, 2, 4, 8, or 16, but valid values also depend on
-    * the color_type selected. color_type is one of PNG_COLOR_TYPE_GRAY,
-    * PNG_COLOR_TYPE_GRAY_ALPHA, PNG_COLOR_TYPE_PALETTE, PNG_COLOR_TYPE_RGB,
-    * or PNG_COLOR_TYPE_RGB_ALPHA.  interlace is either PNG_INTERLACE_NONE or
-    * PNG_INTERLACE_ADAM7, and the compression_type and filter_type MUST
-    * currently be PNG_COMPRESSION_TYPE_BASE and PNG_FILTER_TYPE_BASE. REQUIRED
-    */
+    const int level = zlib_level(fOptions);
+    unsigned filters = png_filters(fOptions);
+    write_png_info(png_ptr, info_ptr, stream, bitmap.width(), bitmap.height(), bitDepth,
+                   colorType, sig_bit, kIndex_8_SkColorType == ct ? bitmap.getColorTable() : NULL,
+                   hasAlpha, level, filters);
 
-    png_set_IHDR(png_ptr, info_ptr, bitmap.width(), bitmap.height(),
-                 bitDepth, colorType,
-                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
-                 PNG_FILTER_TYPE_BASE);
+    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
 
-    // set our colortable/trans arrays if needed
-    png_color paletteColors[256];
-    png_byte trans[256];
-    if (kIndex_8_SkColorType == ct) {
-        SkColorTable* ct = bitmap.getColorTable();
-        int numTrans = pack_palette(ct, paletteColors, trans, hasAlpha);
-        png_set_PLTE(png_ptr, info_ptr, paletteColors, ct->count());
-        if (numTrans > 0) {
-            png_set_tRNS(png_ptr, info_ptr, trans, numTrans, NULL);
+    if (fOptions.fParallel && 8 == bitDepth &&
+            (size_t)bitmap.width() * bitmap.height() * 4 > 2 * PNG_BAND_BYTES) {
+        int bytesPerPixel = 3;
+        if (colorType & PNG_COLOR_MASK_PALETTE) {
+            bytesPerPixel = 1;
+            // Match libpng, which doesn't filter palette images unless asked to.
+            if (SkPNGEncoderOptions::kAll_Filters == filters) {
+                filters = PNG_FILTER_NONE;
+            }
+        } else if (colorType & PNG_COLOR_MASK_ALPHA) {
+            bytesPerPixel = 4;
+        }
+        if (write_bands(png_ptr, bitmap, proc, bytesPerPixel, filters, level)) {
+            png_write_chunk(png_ptr, (png_bytep)"IEND", NULL, 0);
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return true;
         }
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return false;
     }
-#ifdef PNG_sBIT_SUPPORTED
-    png_set_sBIT(png_ptr, info_ptr, &sig_bit);
-#endif
-    png_write_info(png_ptr, info_ptr);
 
     const char* srcImage = (const char*)bitmap.getPixels();
     SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
     char* storage = (char*)rowStorage.get();
-    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
 
     for (int y = 0; y < bitmap.height(); y++) {
         png_bytep row_ptr = (png_bytep)storage;
@@ -1255,9 +1583,120 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     return true;
 }
 
+// Writes the rows as they come to libpng, which deflates them as it goes, so only its window
+// and one transformed row are held.
+class SkPNGRowWriter : public SkImageEncoder::RowWriter {
+public:
+    SkPNGRowWriter(const SkImageInfo& info, transform_scanline_proc proc)
+        : fPng(NULL)
+        , fInfo(NULL)
+        , fProc(proc)
+        , fWidth(info.width())
+        , fHeight(info.height())
+        , fRowsWritten(0)
+        , fRow(info.width() * 4)
+        , fFailed(false) {}
+
+    ~SkPNGRowWriter() override {
+        if (fPng) {
+            png_destroy_write_struct(&fPng, fInfo ? &fInfo : png_infopp_NULL);
+        }
+    }
+
+    bool begin(SkWStream* stream, int colorType, png_color_8& sig_bit, bool hasAlpha,
+               int level, unsigned filters) {
+        fPng = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, sk_error_fn, NULL);
+        if (NULL == fPng) {
+            return false;
+        }
+        fInfo = png_create_info_struct(fPng);
+        if (NULL == fInfo) {
+            return false;
+        }
+        if (setjmp(png_jmpbuf(fPng))) {
+            return false;
+        }
+        write_png_info(fPng, fInfo, stream, fWidth, fHeight, 8, colorType, sig_bit, NULL,
+                       hasAlpha, level, filters);
+        return true;
+    }
+
+    bool writeRows(const void* pixels, size_t rowBytes, int rowCount) override {
+        if (fFailed || rowCount < 0 || rowCount > fHeight - fRowsWritten) {
+            fFailed = true;
+            return false;
+        }
+        if (setjmp(png_jmpbuf(fPng))) {
+            fFailed = true;
+            return false;
+        }
+        const char* src = (const char*)pixels;
+        for (int y = 0; y < rowCount; ++y) {
+            png_bytep row_ptr = (png_bytep)fRow.get();
+            fProc(src, fWidth, fRow.get());
+            png_write_rows(fPng, &row_ptr, 1);
+            src += rowBytes;
+        }
+        fRowsWritten += rowCount;
+        return true;
+    }
+
+    bool finish() override {
+        if (fFailed || fRowsWritten != fHeight) {
+            fFailed = true;
+            return false;
+        }
+        if (setjmp(png_jmpbuf(fPng))) {
+            fFailed = true;
+            return false;
+        }
+        png_write_end(fPng, fInfo);
+        // Anything more is an error.
+        fFailed = true;
+        return true;
+    }
+
+private:
+    png_structp             fPng;
+    png_infop               fInfo;
+    transform_scanline_proc fProc;
+    const int               fWidth;
+    const int               fHeight;
+    int                     fRowsWritten;
+    SkAutoTMalloc<char>     fRow;
+    bool                    fFailed;
+};
+
+SkImageEncoder::RowWriter* SkPNGImageEncoder::onBeginRows(SkWStream* stream,
+                                                          const SkImageInfo& info, int quality) {
+    // Without a color table, only the direct color types can be written.
+    const SkColorType ct = info.colorType();
+    if (kIndex_8_SkColorType == ct) {
+        return NULL;
+    }
+    const bool hasAlpha = !info.isOpaque();
+    int colorType;
+    png_color_8 sig_bit;
+    if (!choose_png_color_type(ct, hasAlpha, &colorType, &sig_bit)) {
+        return NULL;
+    }
+
+    SkAutoTDelete<SkPNGRowWriter> writer(SkNEW_ARGS(SkPNGRowWriter,
+                                                    (info, choose_proc(ct, hasAlpha))));
+    if (!writer->begin(stream, colorType, sig_bit, hasAlpha, zlib_level(fOptions),
+                       png_filters(fOptions))) {
+        return NULL;
+    }
+    return writer.detach();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_DECODER_CREATOR(PNGImageDecoder);
 DEFINE_ENCODER_CREATOR(PNGImageEncoder);
+
+SkImageEncoder* CreatePNGImageEncoder(const SkPNGEncoderOptions& options) {
+    return SkNEW_ARGS(SkPNGImageEncoder, (options));
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 static bool is_png(SkStreamRewindable* stream) {
@@ -12,6 +12,27 @@
 
 SkImageEncoder::~SkImageEncoder() {}
 
+SkPNGEncoderOptions::SkPNGEncoderOptions(Preset preset) : fParallel(false) {
+    switch (preset) {
+        case kFastest_Preset:
+            fZLibLevel = 1;
+            fFilters = kSub_Filter;
+            break;
+        case kFast_Preset:
+            fZLibLevel = 3;
+            fFilters = kNone_Filter | kSub_Filter | kUp_Filter;
+            break;
+        case kDefault_Preset:
+            fZLibLevel = 6;
+            fFilters = kAll_Filters;
+            break;
+        case kSmallest_Preset:
+            fZLibLevel = 9;
+            fFilters = kAll_Filters;
+            break;
+    }
+}
+
 bool SkImageEncoder::encodeStream(SkWStream* stream, const SkBitmap& bm,
                                   int quality) {
     quality = SkMin32(100, SkMax32(0, quality));
@@ -34,6 +55,15 @@ SkData* SkImageEncoder::encodeData(const SkBitmap& bm, int quality) {
     return NULL;
 }
 
+SkImageEncoder::RowWriter* SkImageEncoder::beginRows(SkWStream* stream, const SkImageInfo& info,
+                                                     int quality) {
+    if (NULL == stream || info.isEmpty()) {
+        return NULL;
+    }
+    quality = SkMin32(100, SkMax32(0, quality));
+    return this->onBeginRows(stream, info, quality);
+}
+
 bool SkImageEncoder::EncodeFile(const char file[], const SkBitmap& bm, Type t,
                                 int quality) {
     SkAutoTDelete<SkImageEncoder> enc(SkImageEncoder::Create(t));
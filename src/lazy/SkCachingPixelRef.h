@@ -45,6 +45,7 @@ protected:
     bool onNewLockPixels(LockRec*) override;
     void onUnlockPixels() override;
     bool onLockPixelsAreWritable() const override { return false; }
+    bool onIsLazyGenerated() const override { return true; }
 
     SkData* onRefEncodedData() override {
         return fImageGenerator->refEncodedData();
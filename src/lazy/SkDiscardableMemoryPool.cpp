@@ -7,6 +7,7 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkDiscardableMemoryPool.h"
+#include "SkGraphics.h"
 #include "SkImageGenerator.h"
 #include "SkLazyPtr.h"
 #include "SkTInternalLList.h"
@@ -18,6 +19,35 @@
 
 namespace {
 
+// Blocks smaller than kMinSlabSize are allocated at their exact size and freed when purged.
+// Blocks in [kMinSlabSize, kMaxSlabSize] are rounded up to one of four size classes per power
+// of two (wasting at most 25%), and their slabs are recycled.
+static const size_t kMinSlabSize = 1 << 12;
+static const size_t kMaxSlabSize = 1u << 31;
+static const int    kSizeClassCount = (30 - 11 + 1) * 4;
+
+/**
+ *  Returns the size class for bytes, and sets *slabSize to the size of the slab to allocate,
+ *  or returns -1 (and sets *slabSize to bytes) if bytes is not slab-allocated.
+ */
+static int size_class(size_t bytes, size_t* slabSize) {
+    if (bytes < kMinSlabSize || bytes > kMaxSlabSize) {
+        *slabSize = bytes;
+        return -1;
+    }
+    const uint32_t b = (uint32_t)(bytes - 1);
+    const int top = 31 - SkCLZ(b);              // index of the highest set bit, >= 11
+    const int mantissa = (b >> (top - 2)) & 3;  // the two bits below it
+    *slabSize = (size_t)((4 | mantissa) + 1) << (top - 2);
+    SkASSERT(*slabSize >= bytes && *slabSize - bytes <= bytes / 4);
+    return (top - 11) * 4 + mantissa;
+}
+
+static size_t slab_size(int sizeClass) {
+    SkASSERT(sizeClass >= 0 && sizeClass < kSizeClassCount);
+    return (size_t)((4 | (sizeClass & 3)) + 1) << (sizeClass / 4 + 9);
+}
+
 class PoolDiscardableMemory;
 
 /**
@@ -41,24 +71,39 @@ public:
     /** purges all unlocked DMs */
     void dumpPool() override;
 
+    void getStats(Stats*) override;
+    void resetStats() override;
+
     #if SK_LAZY_CACHE_STATS  // Defined in SkDiscardableMemoryPool.h
-    int getCacheHits() override { return fCacheHits; }
-    int getCacheMisses() override { return fCacheMisses; }
+    int getCacheHits() override { return sk_atomic_load(&fStats.fHits); }
+    int getCacheMisses() override { return sk_atomic_load(&fStats.fMisses); }
     void resetCacheHitsAndMisses() override {
-        fCacheHits = fCacheMisses = 0;
+        sk_atomic_store(&fStats.fHits, 0);
+        sk_atomic_store(&fStats.fMisses, 0);
     }
-    int          fCacheHits;
-    int          fCacheMisses;
     #endif  // SK_LAZY_CACHE_STATS
 
 private:
+    struct FreeSlab {
+        FreeSlab* fNext;
+    };
+
     SkBaseMutex* fMutex;
     size_t       fBudget;
     size_t       fUsed;
+    // Only unlocked, unpurged DMs are in fList, so purging is O(1) per DM.
     SkTInternalLList<PoolDiscardableMemory> fList;
+    // Purged slabs, by size class, kept for reuse.
+    FreeSlab*    fFreeSlabs[kSizeClassCount];
+    size_t       fRecycled;
+    Stats        fStats;
 
     /** Function called to free memory if needed */
     void dumpDownTo(size_t budget);
+    /** Frees recycled slabs until no more than limit bytes are held. */
+    void trimRecycledTo(size_t limit);
+    /** Recycles or frees the memory of a DM that is being purged or deleted. */
+    void releaseBlock(void* pointer, int sizeClass, size_t bytes);
     /** called by DiscardableMemoryPool upon destruction */
     void free(PoolDiscardableMemory* dm);
     /** called by DiscardableMemoryPool::lock() */
@@ -78,7 +123,7 @@ private:
 class PoolDiscardableMemory : public SkDiscardableMemory {
 public:
     PoolDiscardableMemory(DiscardableMemoryPool* pool,
-                            void* pointer, size_t bytes);
+                          void* pointer, size_t bytes, int sizeClass);
     virtual ~PoolDiscardableMemory();
     bool lock() override;
     void* data() override;
@@ -88,17 +133,21 @@ private:
     SK_DECLARE_INTERNAL_LLIST_INTERFACE(PoolDiscardableMemory);
     DiscardableMemoryPool* const fPool;
     bool                         fLocked;
+    // Written under the pool's mutex, but may be read without it by lock().
     void*                        fPointer;
     const size_t                 fBytes;
+    const int                    fSizeClass;
 };
 
 PoolDiscardableMemory::PoolDiscardableMemory(DiscardableMemoryPool* pool,
                                              void* pointer,
-                                             size_t bytes)
+                                             size_t bytes,
+                                             int sizeClass)
     : fPool(pool)
     , fLocked(true)
     , fPointer(pointer)
-    , fBytes(bytes) {
+    , fBytes(bytes)
+    , fSizeClass(sizeClass) {
     SkASSERT(fPool != NULL);
     SkASSERT(fPointer != NULL);
     SkASSERT(fBytes > 0);
@@ -132,57 +181,87 @@ DiscardableMemoryPool::DiscardableMemoryPool(size_t budget,
                                              SkBaseMutex* mutex)
     : fMutex(mutex)
     , fBudget(budget)
-    , fUsed(0) {
-    #if SK_LAZY_CACHE_STATS
-    fCacheHits = 0;
-    fCacheMisses = 0;
-    #endif  // SK_LAZY_CACHE_STATS
+    , fUsed(0)
+    , fRecycled(0) {
+    sk_bzero(fFreeSlabs, sizeof(fFreeSlabs));
+    sk_bzero(&fStats, sizeof(fStats));
 }
 DiscardableMemoryPool::~DiscardableMemoryPool() {
     // PoolDiscardableMemory objects that belong to this pool are
     // always deleted before deleting this pool since each one has a
     // ref to the pool.
     SkASSERT(fList.isEmpty());
+    this->trimRecycledTo(0);
+}
+
+void DiscardableMemoryPool::trimRecycledTo(size_t limit) {
+    // Free the biggest slabs first.
+    for (int i = kSizeClassCount - 1; i >= 0 && fRecycled > limit; --i) {
+        while (fFreeSlabs[i] && fRecycled > limit) {
+            FreeSlab* slab = fFreeSlabs[i];
+            fFreeSlabs[i] = slab->fNext;
+            fRecycled -= slab_size(i);
+            sk_free(slab);
+        }
+    }
+}
+
+void DiscardableMemoryPool::releaseBlock(void* pointer, int sizeClass, size_t bytes) {
+    if (sizeClass >= 0 && fRecycled + bytes <= fBudget / 4) {
+        FreeSlab* slab = (FreeSlab*)pointer;
+        slab->fNext = fFreeSlabs[sizeClass];
+        fFreeSlabs[sizeClass] = slab;
+        fRecycled += bytes;
+    } else {
+        sk_free(pointer);
+    }
 }
 
 void DiscardableMemoryPool::dumpDownTo(size_t budget) {
     if (fMutex != NULL) {
         fMutex->assertHeld();
     }
-    if (fUsed <= budget) {
-        return;
-    }
-    typedef SkTInternalLList<PoolDiscardableMemory>::Iter Iter;
-    Iter iter;
-    PoolDiscardableMemory* cur = iter.init(fList, Iter::kTail_IterStart);
-    while ((fUsed > budget) && (cur)) {
-        if (!cur->fLocked) {
-            PoolDiscardableMemory* dm = cur;
-            SkASSERT(dm->fPointer != NULL);
-            sk_free(dm->fPointer);
-            dm->fPointer = NULL;
-            SkASSERT(fUsed >= dm->fBytes);
-            fUsed -= dm->fBytes;
-            cur = iter.prev();
-            // Purged DMs are taken out of the list.  This saves times
-            // looking them up.  Purged DMs are NOT deleted.
-            fList.remove(dm);
-        } else {
-            cur = iter.prev();
-        }
+    // Everything in fList is unlocked, so we purge from the tail (least recently unlocked).
+    while (fUsed > budget && fList.tail()) {
+        PoolDiscardableMemory* dm = fList.tail();
+        SkASSERT(!dm->fLocked);
+        SkASSERT(dm->fPointer != NULL);
+        // Purged DMs are taken out of the list.  This saves times
+        // looking them up.  Purged DMs are NOT deleted.
+        fList.remove(dm);
+        this->releaseBlock(dm->fPointer, dm->fSizeClass, dm->fBytes);
+        sk_atomic_store(&dm->fPointer, (void*)NULL, sk_memory_order_relaxed);
+        SkASSERT(fUsed >= dm->fBytes);
+        fUsed -= dm->fBytes;
+        ++fStats.fPurges;
     }
 }
 
 SkDiscardableMemory* DiscardableMemoryPool::create(size_t bytes) {
-    void* addr = sk_malloc_flags(bytes, 0);
+    size_t slabSize;
+    const int sizeClass = size_class(bytes, &slabSize);
+
+    void* addr = NULL;
+    if (sizeClass >= 0) {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        if (FreeSlab* slab = fFreeSlabs[sizeClass]) {
+            fFreeSlabs[sizeClass] = slab->fNext;
+            fRecycled -= slabSize;
+            ++fStats.fRecycles;
+            addr = slab;
+        }
+    }
     if (NULL == addr) {
-        return NULL;
+        addr = sk_malloc_flags(slabSize, 0);
+        if (NULL == addr) {
+            return NULL;
+        }
     }
     PoolDiscardableMemory* dm = SkNEW_ARGS(PoolDiscardableMemory,
-                                             (this, addr, bytes));
+                                           (this, addr, slabSize, sizeClass));
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
-    fList.addToHead(dm);
-    fUsed += bytes;
+    // dm starts out locked, so it does not go in fList until unlock().
+    fUsed += slabSize;
     this->dumpDownTo(fBudget);
     return dm;
 }
@@ -191,11 +270,11 @@ void DiscardableMemoryPool::free(PoolDiscardableMemory* dm) {
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     // This is called by dm's destructor.
     if (dm->fPointer != NULL) {
-        sk_free(dm->fPointer);
+        fList.remove(dm);
+        this->releaseBlock(dm->fPointer, dm->fSizeClass, dm->fBytes);
         dm->fPointer = NULL;
         SkASSERT(fUsed >= dm->fBytes);
         fUsed -= dm->fBytes;
-        fList.remove(dm);
     } else {
         SkASSERT(!fList.isInList(dm));
     }
@@ -203,27 +282,20 @@ void DiscardableMemoryPool::free(PoolDiscardableMemory* dm) {
 
 bool DiscardableMemoryPool::lock(PoolDiscardableMemory* dm) {
     SkASSERT(dm != NULL);
-    if (NULL == dm->fPointer) {
-        #if SK_LAZY_CACHE_STATS
-        SkAutoMutexAcquire autoMutexAcquire(fMutex);
-        ++fCacheMisses;
-        #endif  // SK_LAZY_CACHE_STATS
+    // Purged memory never comes back, so a miss does not need the mutex.
+    if (NULL == sk_atomic_load(&dm->fPointer, sk_memory_order_relaxed)) {
+        sk_atomic_inc(&fStats.fMisses);
         return false;
     }
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     if (NULL == dm->fPointer) {
         // May have been purged while waiting for lock.
-        #if SK_LAZY_CACHE_STATS
-        ++fCacheMisses;
-        #endif  // SK_LAZY_CACHE_STATS
+        sk_atomic_inc(&fStats.fMisses);
         return false;
     }
     dm->fLocked = true;
     fList.remove(dm);
-    fList.addToHead(dm);
-    #if SK_LAZY_CACHE_STATS
-    ++fCacheHits;
-    #endif  // SK_LAZY_CACHE_STATS
+    sk_atomic_inc(&fStats.fHits);
     return true;
 }
 
@@ -231,6 +303,7 @@ void DiscardableMemoryPool::unlock(PoolDiscardableMemory* dm) {
     SkASSERT(dm != NULL);
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     dm->fLocked = false;
+    fList.addToHead(dm);
     this->dumpDownTo(fBudget);
 }
 
@@ -241,10 +314,30 @@ void DiscardableMemoryPool::setRAMBudget(size_t budget) {
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     fBudget = budget;
     this->dumpDownTo(fBudget);
+    this->trimRecycledTo(fBudget / 4);
 }
 void DiscardableMemoryPool::dumpPool() {
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     this->dumpDownTo(0);
+    this->trimRecycledTo(0);
+}
+
+void DiscardableMemoryPool::getStats(Stats* stats) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    stats->fHits = sk_atomic_load(&fStats.fHits);
+    stats->fMisses = sk_atomic_load(&fStats.fMisses);
+    stats->fPurges = fStats.fPurges;
+    stats->fRecycles = fStats.fRecycles;
+    stats->fBytesUsed = fUsed;
+    stats->fBytesRecycled = fRecycled;
+}
+
+void DiscardableMemoryPool::resetStats() {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    sk_atomic_store(&fStats.fHits, 0);
+    sk_atomic_store(&fStats.fMisses, 0);
+    fStats.fPurges = 0;
+    fStats.fRecycles = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -267,3 +360,29 @@ SkDiscardableMemoryPool* SkGetGlobalDiscardableMemoryPool() {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+
+void SkGraphics::GetDiscardableMemoryStats(DiscardableMemoryStats* stats) {
+    SkDiscardableMemoryPool::Stats poolStats;
+    SkGetGlobalDiscardableMemoryPool()->getStats(&poolStats);
+    stats->fHits = poolStats.fHits;
+    stats->fMisses = poolStats.fMisses;
+    stats->fPurges = poolStats.fPurges;
+    stats->fRecycles = poolStats.fRecycles;
+    stats->fBytesUsed = poolStats.fBytesUsed;
+    stats->fBytesRecycled = poolStats.fBytesRecycled;
+}
+
+void SkGraphics::ResetDiscardableMemoryStats() {
+    SkGetGlobalDiscardableMemoryPool()->resetStats();
+}
+
+size_t SkGraphics::GetDiscardableMemoryByteLimit() {
+    return SkGetGlobalDiscardableMemoryPool()->getRAMBudget();
+}
+
+size_t SkGraphics::SetDiscardableMemoryByteLimit(size_t newLimit) {
+    SkDiscardableMemoryPool* pool = SkGetGlobalDiscardableMemoryPool();
+    size_t prevLimit = pool->getRAMBudget();
+    pool->setRAMBudget(newLimit);
+    return prevLimit;
+}
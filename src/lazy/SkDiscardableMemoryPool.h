@@ -24,6 +24,10 @@
  *  budget of memory.  When the allocated memory exceeds this size,
  *  unlocked blocks of memory are purged.  If all memory is locked, it
  *  can exceed the memory-use budget.
+ *
+ *  Large blocks are rounded up to one of a set of size classes, and when
+ *  they are purged their memory is kept (up to a quarter of the budget)
+ *  to serve later allocations of the same class, rather than freed.
  */
 class SkDiscardableMemoryPool : public SkDiscardableMemory::Factory {
 public:
@@ -33,9 +37,22 @@ public:
     virtual void setRAMBudget(size_t budget) = 0;
     virtual size_t getRAMBudget() = 0;
 
-    /** purges all unlocked DMs */
+    /** purges all unlocked DMs, and frees any slabs kept for reuse */
     virtual void dumpPool() = 0;
 
+    struct Stats {
+        int32_t fHits;           //!< successful calls to SkDiscardableMemory::lock()
+        int32_t fMisses;         //!< lock() calls that found the memory purged
+        int32_t fPurges;         //!< blocks purged to stay within the budget, or by dumpPool()
+        int32_t fRecycles;       //!< allocations served from a previously purged slab
+        size_t  fBytesUsed;      //!< same as getRAMUsed()
+        size_t  fBytesRecycled;  //!< purged slabs held for reuse, not counted in fBytesUsed
+    };
+
+    /** Always available, regardless of SK_LAZY_CACHE_STATS. */
+    virtual void getStats(Stats*) = 0;
+    virtual void resetStats() = 0;
+
     #if SK_LAZY_CACHE_STATS
     /**
      * These two values are a count of the number of successful and
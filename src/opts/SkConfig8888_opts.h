@@ -0,0 +1,30 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_DEFINED
+#define SkConfig8888_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Converts a row of 32 bit pixels between RGBA and BGRA, and/or premul and unpremul, exactly
+ *  as the portable versions in src/core/SkConfig8888.cpp do. dst may equal src, but may not
+ *  otherwise overlap it.
+ */
+typedef void (*SkConfig8888RowProc)(uint32_t* dst, const uint32_t* src, int count);
+
+enum SkConfig8888ProcType {
+    kSwapRB_SkConfig8888ProcType,
+    kPremul_SkConfig8888ProcType,
+    kSwapRBPremul_SkConfig8888ProcType,
+    kUnpremul_SkConfig8888ProcType,
+    kSwapRBUnpremul_SkConfig8888ProcType,
+};
+
+SkConfig8888RowProc SkConfig8888GetPlatformProc(SkConfig8888ProcType type);
+
+#endif
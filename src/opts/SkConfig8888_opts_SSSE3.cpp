@@ -0,0 +1,203 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkConfig8888_opts_SSSE3.h"
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+
+/* With the exception of the compilers that don't support it, we always build the
+ * SSSE3 functions and enable the caller to determine SSSE3 support.  However for
+ * compilers that do not support SSSE3 we provide a stub implementation.
+ */
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+#include <tmmintrin.h>  // SSSE3
+
+// These assume alpha is the high byte, and green the second lowest, so that swapping R and B
+// swaps bytes 0 and 2 of every pixel, and premul and unpremul apply to bytes 0, 1 and 2. The
+// caller checks this.
+
+namespace {
+
+enum AlphaVerb {
+    kNothing_AlphaVerb,
+    kPremul_AlphaVerb,
+    kUnpremul_AlphaVerb,
+};
+
+// The portable version from SkConfig8888.cpp, for the last few pixels.
+template <bool doSwapRB, AlphaVerb doAlpha> uint32_t convert32(uint32_t c) {
+    if (doSwapRB) {
+        c = SkSwizzle_RB(c);
+    }
+    switch (doAlpha) {
+        case kNothing_AlphaVerb:
+            break;
+        case kPremul_AlphaVerb:
+            c = SkPreMultiplyARGB(SkGetPackedA32(c), SkGetPackedR32(c),
+                                  SkGetPackedG32(c), SkGetPackedB32(c));
+            break;
+        case kUnpremul_AlphaVerb:
+            c = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(c);
+            break;
+    }
+    return c;
+}
+
+static inline __m128i swap_rb(__m128i px) {
+    const __m128i kSwapRB = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    return _mm_shuffle_epi8(px, kSwapRB);
+}
+
+static inline __m128i alpha_mask() {
+    return _mm_set1_epi32(0xFF000000);
+}
+
+// SkMulDiv255Round(c, a) of 8 16 bit lanes: with p = c * a + 128, (p + (p >> 8)) >> 8, which
+// is the same as the high half of p * 257.
+static inline __m128i mul_div_255_round(__m128i c, __m128i a) {
+    __m128i p = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_mulhi_epu16(p, _mm_set1_epi16(257));
+}
+
+static inline __m128i premul(__m128i px) {
+    // Each pixel's alpha, in each of its four 16 bit lanes.
+    const __m128i kAlphaLo = _mm_setr_epi8(3, -1, 3, -1, 3, -1, 3, -1,
+                                           7, -1, 7, -1, 7, -1, 7, -1);
+    const __m128i kAlphaHi = _mm_setr_epi8(11, -1, 11, -1, 11, -1, 11, -1,
+                                           15, -1, 15, -1, 15, -1, 15, -1);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i lo = mul_div_255_round(_mm_unpacklo_epi8(px, zero), _mm_shuffle_epi8(px, kAlphaLo));
+    __m128i hi = mul_div_255_round(_mm_unpackhi_epi8(px, zero), _mm_shuffle_epi8(px, kAlphaHi));
+    __m128i result = _mm_packus_epi16(lo, hi);
+
+    // Keep the original alpha.
+    const __m128i mask = alpha_mask();
+    return _mm_or_si128(_mm_andnot_si128(mask, result), _mm_and_si128(mask, px));
+}
+
+// SkUnPreMultiply::ApplyScale(), (s * c + (1 << 23)) >> 24, of 8 16 bit components c whose
+// 32 bit scales s are split into their high halves sh and low halves sl. s * c needs 40 bits,
+// but it is sh * c * 2^16 + sl * c, and both products fit in 32, so this computes
+//     (sh * c + ((sl * c + (1 << 23)) >> 16)) >> 8
+// which is the same.
+static inline __m128i apply_scale(__m128i c, __m128i sh, __m128i sl) {
+    const __m128i hl = _mm_mullo_epi16(c, sh);
+    const __m128i hh = _mm_mulhi_epu16(c, sh);
+    const __m128i ll = _mm_mullo_epi16(c, sl);
+    const __m128i lh = _mm_mulhi_epu16(c, sl);
+    const __m128i round = _mm_set1_epi32(1 << 23);
+
+    __m128i a = _mm_add_epi32(_mm_unpacklo_epi16(hl, hh),
+                              _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi16(ll, lh), round), 16));
+    __m128i b = _mm_add_epi32(_mm_unpackhi_epi16(hl, hh),
+                              _mm_srli_epi32(_mm_add_epi32(_mm_unpackhi_epi16(ll, lh), round), 16));
+    return _mm_packs_epi32(_mm_srli_epi32(a, 8), _mm_srli_epi32(b, 8));
+}
+
+static inline __m128i unpremul(__m128i px, const uint32_t* src) {
+    const __m128i mask = alpha_mask();
+    if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(px, mask), mask))) {
+        // All opaque; unpremultiplying changes nothing.
+        return px;
+    }
+
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const __m128i scales = _mm_setr_epi32(table[src[0] >> 24], table[src[1] >> 24],
+                                          table[src[2] >> 24], table[src[3] >> 24]);
+    const __m128i kHighLo = _mm_setr_epi8(2, 3, 2, 3, 2, 3, 2, 3, 6, 7, 6, 7, 6, 7, 6, 7);
+    const __m128i kLowLo  = _mm_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 4, 5, 4, 5, 4, 5, 4, 5);
+    const __m128i kHighHi = _mm_setr_epi8(10, 11, 10, 11, 10, 11, 10, 11,
+                                          14, 15, 14, 15, 14, 15, 14, 15);
+    const __m128i kLowHi  = _mm_setr_epi8(8, 9, 8, 9, 8, 9, 8, 9, 12, 13, 12, 13, 12, 13, 12, 13);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i lo = apply_scale(_mm_unpacklo_epi8(px, zero),
+                             _mm_shuffle_epi8(scales, kHighLo), _mm_shuffle_epi8(scales, kLowLo));
+    __m128i hi = apply_scale(_mm_unpackhi_epi8(px, zero),
+                             _mm_shuffle_epi8(scales, kHighHi), _mm_shuffle_epi8(scales, kLowHi));
+    __m128i result = _mm_packus_epi16(lo, hi);
+
+    // Keep the original alpha.
+    return _mm_or_si128(_mm_andnot_si128(mask, result), _mm_and_si128(mask, px));
+}
+
+template <bool doSwapRB, AlphaVerb doAlpha>
+void convert32_row(uint32_t* dst, const uint32_t* src, int count) {
+    // This has to be correct if src == dst (but not partial overlap).
+    while (count >= 4) {
+        __m128i px = _mm_loadu_si128((const __m128i*)src);
+        if (doSwapRB) {
+            px = swap_rb(px);
+        }
+        switch (doAlpha) {
+            case kNothing_AlphaVerb:
+                break;
+            case kPremul_AlphaVerb:
+                px = premul(px);
+                break;
+            case kUnpremul_AlphaVerb:
+                // Alpha is in the same place whether or not R and B were swapped.
+                px = unpremul(px, src);
+                break;
+        }
+        _mm_storeu_si128((__m128i*)dst, px);
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    for (int i = 0; i < count; ++i) {
+        dst[i] = convert32<doSwapRB, doAlpha>(src[i]);
+    }
+}
+
+}  // namespace
+
+void SkSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kNothing_AlphaVerb>(dst, src, count);
+}
+
+void SkPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<false, kPremul_AlphaVerb>(dst, src, count);
+}
+
+void SkSwapRBPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kPremul_AlphaVerb>(dst, src, count);
+}
+
+void SkUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<false, kUnpremul_AlphaVerb>(dst, src, count);
+}
+
+void SkSwapRBUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kUnpremul_AlphaVerb>(dst, src, count);
+}
+
+#else // SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+void SkSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void SkPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void SkSwapRBPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void SkUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void SkSwapRBUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_SSSE3_DEFINED
+#define SkConfig8888_opts_SSSE3_DEFINED
+
+#include "SkTypes.h"
+
+void SkSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void SkPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void SkSwapRBPremul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void SkUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void SkSwapRBUnpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+
+#endif
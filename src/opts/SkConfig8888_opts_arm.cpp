@@ -0,0 +1,37 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkConfig8888_opts.h"
+#include "SkConfig8888_opts_neon.h"
+#include "SkUtilsArm.h"
+
+SkConfig8888RowProc SkConfig8888GetPlatformProc(SkConfig8888ProcType type) {
+#if SK_ARM_NEON_IS_NONE || SK_A32_SHIFT != 24 || SK_G32_SHIFT != 8
+    return NULL;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return NULL;
+    }
+#endif
+    switch (type) {
+        case kSwapRB_SkConfig8888ProcType:
+            return SkSwapRB_neon;
+        case kPremul_SkConfig8888ProcType:
+            return SkPremul_neon;
+        case kSwapRBPremul_SkConfig8888ProcType:
+            return SkSwapRBPremul_neon;
+        case kUnpremul_SkConfig8888ProcType:
+            return SkUnpremul_neon;
+        case kSwapRBUnpremul_SkConfig8888ProcType:
+            return SkSwapRBUnpremul_neon;
+        default:
+            return NULL;
+    }
+#endif
+}
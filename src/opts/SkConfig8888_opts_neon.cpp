@@ -0,0 +1,130 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkConfig8888_opts.h"
+#include "SkConfig8888_opts_neon.h"
+#include "SkUnPreMultiply.h"
+
+#include <arm_neon.h>
+
+/* neon versions of the row procs of SkConfig8888.
+ * portable versions are in src/core/SkConfig8888.cpp.
+ *
+ * These assume alpha is the high byte, and green the second lowest, so that swapping R and B
+ * swaps bytes 0 and 2 of every pixel, and premul and unpremul apply to bytes 0, 1 and 2. The
+ * caller checks this.
+ */
+
+enum AlphaVerb {
+    kNothing_AlphaVerb,
+    kPremul_AlphaVerb,
+    kUnpremul_AlphaVerb,
+};
+
+template <bool doSwapRB, AlphaVerb doAlpha> static uint32_t convert32(uint32_t c) {
+    if (doSwapRB) {
+        c = SkSwizzle_RB(c);
+    }
+    switch (doAlpha) {
+        case kNothing_AlphaVerb:
+            break;
+        case kPremul_AlphaVerb:
+            c = SkPreMultiplyARGB(SkGetPackedA32(c), SkGetPackedR32(c),
+                                  SkGetPackedG32(c), SkGetPackedB32(c));
+            break;
+        case kUnpremul_AlphaVerb:
+            c = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(c);
+            break;
+    }
+    return c;
+}
+
+// SkMulDiv255Round(c, a): with p = c * a + 128, (p + (p >> 8)) >> 8.
+static inline uint8x8_t mul_div_255_round(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t p = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(p, vshrq_n_u16(p, 8)), 8);
+}
+
+// SkUnPreMultiply::ApplyScale(), (s * c + (1 << 23)) >> 24, of four components.
+static inline uint32x4_t apply_scale(uint32x4_t s, uint16x4_t c) {
+    const uint32x4_t c32 = vmovl_u16(c);
+    const uint64x2_t round = vdupq_n_u64(1 << 23);
+    uint64x2_t lo = vaddq_u64(vmull_u32(vget_low_u32(s), vget_low_u32(c32)), round);
+    uint64x2_t hi = vaddq_u64(vmull_u32(vget_high_u32(s), vget_high_u32(c32)), round);
+    return vcombine_u32(vshrn_n_u64(lo, 24), vshrn_n_u64(hi, 24));
+}
+
+static inline uint8x8_t unpremul(uint32x4_t s0, uint32x4_t s1, uint8x8_t c) {
+    const uint16x8_t c16 = vmovl_u8(c);
+    uint16x8_t result = vcombine_u16(vqmovn_u32(apply_scale(s0, vget_low_u16(c16))),
+                                     vqmovn_u32(apply_scale(s1, vget_high_u16(c16))));
+    return vqmovn_u16(result);
+}
+
+template <bool doSwapRB, AlphaVerb doAlpha>
+static void convert32_row(uint32_t* dst, const uint32_t* src, int count) {
+    // This has to be correct if src == dst (but not partial overlap).
+    while (count >= 8) {
+        // Bytes 0 to 3 of 8 pixels, in 4 vectors.
+        uint8x8x4_t px = vld4_u8((const uint8_t*)src);
+        if (doSwapRB) {
+            uint8x8_t tmp = px.val[0];
+            px.val[0] = px.val[2];
+            px.val[2] = tmp;
+        }
+        switch (doAlpha) {
+            case kNothing_AlphaVerb:
+                break;
+            case kPremul_AlphaVerb:
+                px.val[0] = mul_div_255_round(px.val[0], px.val[3]);
+                px.val[1] = mul_div_255_round(px.val[1], px.val[3]);
+                px.val[2] = mul_div_255_round(px.val[2], px.val[3]);
+                break;
+            case kUnpremul_AlphaVerb: {
+                const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+                uint32_t scales[8];
+                for (int i = 0; i < 8; ++i) {
+                    scales[i] = table[src[i] >> 24];
+                }
+                const uint32x4_t s0 = vld1q_u32(scales);
+                const uint32x4_t s1 = vld1q_u32(scales + 4);
+                px.val[0] = unpremul(s0, s1, px.val[0]);
+                px.val[1] = unpremul(s0, s1, px.val[1]);
+                px.val[2] = unpremul(s0, s1, px.val[2]);
+                break;
+            }
+        }
+        vst4_u8((uint8_t*)dst, px);
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+    for (int i = 0; i < count; ++i) {
+        dst[i] = convert32<doSwapRB, doAlpha>(src[i]);
+    }
+}
+
+void SkSwapRB_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kNothing_AlphaVerb>(dst, src, count);
+}
+
+void SkPremul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<false, kPremul_AlphaVerb>(dst, src, count);
+}
+
+void SkSwapRBPremul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kPremul_AlphaVerb>(dst, src, count);
+}
+
+void SkUnpremul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<false, kUnpremul_AlphaVerb>(dst, src, count);
+}
+
+void SkSwapRBUnpremul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, kUnpremul_AlphaVerb>(dst, src, count);
+}
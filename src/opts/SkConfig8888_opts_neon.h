@@ -0,0 +1,19 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_neon_DEFINED
+#define SkConfig8888_opts_neon_DEFINED
+
+#include "SkTypes.h"
+
+void SkSwapRB_neon(uint32_t* dst, const uint32_t* src, int count);
+void SkPremul_neon(uint32_t* dst, const uint32_t* src, int count);
+void SkSwapRBPremul_neon(uint32_t* dst, const uint32_t* src, int count);
+void SkUnpremul_neon(uint32_t* dst, const uint32_t* src, int count);
+void SkSwapRBUnpremul_neon(uint32_t* dst, const uint32_t* src, int count);
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkConfig8888_opts.h"
+
+SkConfig8888RowProc SkConfig8888GetPlatformProc(SkConfig8888ProcType) {
+    return NULL;
+}
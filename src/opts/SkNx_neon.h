@@ -102,6 +102,9 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return vmin_f32(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return vmax_f32(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        return vbsl_f32(cond.fVec, t.fVec, e.fVec);
+    }
 
     SkNf rsqrt0() const { return vrsqrte_f32(fVec); }
     SkNf rsqrt1() const {
@@ -171,6 +174,9 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return vminq_f64(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return vmaxq_f64(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        return vbslq_f64(cond.fVec, t.fVec, e.fVec);
+    }
 
     SkNf  sqrt() const { return vsqrtq_f64(fVec);  }
 
@@ -279,6 +285,9 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return vminq_f32(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return vmaxq_f32(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        return vbslq_f32(cond.fVec, t.fVec, e.fVec);
+    }
 
     SkNf rsqrt0() const { return vrsqrteq_f32(fVec); }
     SkNf rsqrt1() const {
@@ -78,6 +78,10 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return _mm_min_ps(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return _mm_max_ps(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        __m128 mask = _mm_castsi128_ps(cond.fVec);
+        return _mm_or_ps(_mm_and_ps(mask, t.fVec), _mm_andnot_ps(mask, e.fVec));
+    }
 
     SkNf  sqrt() const { return _mm_sqrt_ps (fVec);  }
     SkNf rsqrt0() const { return _mm_rsqrt_ps(fVec); }
@@ -123,6 +127,10 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return _mm_min_pd(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return _mm_max_pd(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        __m128d mask = _mm_castsi128_pd(cond.fVec);
+        return _mm_or_pd(_mm_and_pd(mask, t.fVec), _mm_andnot_pd(mask, e.fVec));
+    }
 
     SkNf  sqrt() const { return _mm_sqrt_pd(fVec);  }
     SkNf rsqrt0() const { return _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(fVec))); }
@@ -208,6 +216,10 @@ public:
 
     static SkNf Min(const SkNf& l, const SkNf& r) { return _mm_min_ps(l.fVec, r.fVec); }
     static SkNf Max(const SkNf& l, const SkNf& r) { return _mm_max_ps(l.fVec, r.fVec); }
+    static SkNf Select(const Nb& cond, const SkNf& t, const SkNf& e) {
+        __m128 mask = _mm_castsi128_ps(cond.fVec);
+        return _mm_or_ps(_mm_and_ps(mask, t.fVec), _mm_andnot_ps(mask, e.fVec));
+    }
 
     SkNf  sqrt() const { return _mm_sqrt_ps (fVec);  }
     SkNf rsqrt0() const { return _mm_rsqrt_ps(fVec); }
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkTextureCompressor.h"
+#include "SkTextureCompression_opts_SSE2.h"
+
+/* SSE2 versions of the A8 -> R11 EAC and A8 -> LATC compressors. Both work on
+ * four horizontally adjacent 4x4 blocks at a time and produce exactly the same
+ * blocks as the portable versions in src/utils/SkTextureCompressor_R11EAC.cpp
+ * and src/utils/SkTextureCompressor_LATC.cpp.
+ */
+
+static inline __m128i set1_64(uint64_t x) {
+    return _mm_set_epi32(static_cast<int>(x >> 32), static_cast<int>(x),
+                         static_cast<int>(x >> 32), static_cast<int>(x));
+}
+
+// Quantizes each byte to a three-bit index. This matches
+// SkTextureCompressor::ConvertToThreeBitIndex, expressed as the seven
+// alpha values at which its result steps up.
+static inline __m128i three_bit_index(const __m128i& x) {
+    static const uint8_t kSteps[7] = { 34, 70, 106, 142, 178, 214, 254 };
+
+    __m128i index = _mm_setzero_si128();
+    for (int i = 0; i < 7; ++i) {
+        // x >= step, as 0xFF or 0x00 in each byte
+        const __m128i step = _mm_set1_epi8(static_cast<char>(kSteps[i]));
+        const __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(x, step), x);
+        index = _mm_sub_epi8(index, ge);
+    }
+    return index;
+}
+
+template<unsigned shift>
+static inline __m128i swap_shift(const __m128i& x, const __m128i& mask) {
+    const __m128i t = _mm_and_si128(_mm_xor_si128(x, _mm_srli_epi64(x, shift)), mask);
+    return _mm_xor_si128(x, _mm_xor_si128(t, _mm_slli_epi64(t, shift)));
+}
+
+static inline __m128i swap_bytes_64(const __m128i& x) {
+    const __m128i y = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(y, _MM_SHUFFLE(0, 1, 2, 3)),
+                               _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// R11 EAC
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Maps the three-bit indices
+// 0 1 2 3 4 5 6 7
+// to
+// 3 2 1 0 4 5 6 7
+static inline __m128i r11eac_indices(const __m128i& x) {
+    const __m128i lessThanFour = _mm_cmplt_epi8(x, _mm_set1_epi8(4));
+    return _mm_xor_si128(x, _mm_and_si128(lessThanFour, _mm_set1_epi8(3)));
+}
+
+// Vector version of interleave6 in SkTextureCompressor_R11EAC.cpp, for little
+// endian CPUs. Each 64-bit lane holds the indices of the top two rows of a
+// block in its high half and those of the bottom two rows in its low half.
+static inline __m128i interleave6(const __m128i& rows) {
+    __m128i x = swap_shift<10>(rows, set1_64(0x3FC0003FC00000ULL));
+
+    const __m128i x1 = _mm_and_si128(_mm_slli_epi64(x, 52), set1_64(0x3FULL << 52));
+    const __m128i x2 = _mm_and_si128(_mm_slli_epi64(x, 20), set1_64(0x3FULL << 28));
+    x = _mm_srli_epi64(_mm_or_si128(x, _mm_or_si128(x1, x2)), 16);
+
+    x = swap_shift<6>(x, set1_64(0xFC0000ULL));
+    x = swap_shift<36>(x, set1_64(0xFC0ULL));
+
+    const __m128i y1 = _mm_and_si128(x, set1_64(0xFFFULL << 36));
+    const __m128i y2 = _mm_slli_epi64(_mm_and_si128(x, set1_64(0xFFFFFFULL)), 12);
+    const __m128i y3 = _mm_and_si128(_mm_srli_epi64(x, 24), set1_64(0xFFFULL));
+    x = _mm_or_si128(y1, _mm_or_si128(y2, y3));
+
+    // Set the header, and store big endian
+    return swap_bytes_64(_mm_or_si128(x, set1_64(0x8490000000000000ULL)));
+}
+
+static void compress_r11eac_blocks(uint64_t* dst, const uint8_t* src, size_t rowBytes) {
+    static const uint64_t kTransparent = 0x0020000000002000ULL;
+    static const uint64_t kOpaque = 0xFFFFFFFFFFFFFFFFULL;
+
+    const __m128i alphaRow1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i alphaRow2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + rowBytes));
+    const __m128i alphaRow3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*rowBytes));
+    const __m128i alphaRow4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3*rowBytes));
+
+    // Find the solid blocks, which the portable code encodes specially.
+    const __m128i solid = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(alphaRow1, alphaRow2),
+                                                      _mm_cmpeq_epi8(alphaRow3, alphaRow4)),
+                                        _mm_cmpeq_epi8(alphaRow1, alphaRow3));
+    const int transparentMask = _mm_movemask_epi8(
+        _mm_and_si128(solid, _mm_cmpeq_epi8(alphaRow1, _mm_setzero_si128())));
+    const int opaqueMask = _mm_movemask_epi8(
+        _mm_and_si128(solid, _mm_cmpeq_epi8(alphaRow1, _mm_set1_epi8(-1))));
+    if (0xFFFF == transparentMask || 0xFFFF == opaqueMask) {
+        const __m128i block = set1_64(0xFFFF == transparentMask ? kTransparent : kOpaque);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), block);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2), block);
+        return;
+    }
+
+    const __m128i indexRow1 = r11eac_indices(three_bit_index(alphaRow1));
+    const __m128i indexRow2 = r11eac_indices(three_bit_index(alphaRow2));
+    const __m128i indexRow3 = r11eac_indices(three_bit_index(alphaRow3));
+    const __m128i indexRow4 = r11eac_indices(three_bit_index(alphaRow4));
+
+    // Indices are at most three bits, so shifting 16-bit lanes doesn't cross bytes.
+    const __m128i indexRow12 = _mm_or_si128(_mm_slli_epi16(indexRow1, 3), indexRow2);
+    const __m128i indexRow34 = _mm_or_si128(_mm_slli_epi16(indexRow3, 3), indexRow4);
+
+    const __m128i blocks01 = interleave6(_mm_unpacklo_epi32(indexRow34, indexRow12));
+    const __m128i blocks23 = interleave6(_mm_unpackhi_epi32(indexRow34, indexRow12));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), blocks01);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2), blocks23);
+
+    for (int i = 0; i < 4; ++i) {
+        if (0xF == ((transparentMask >> 4*i) & 0xF)) {
+            dst[i] = kTransparent;
+        } else if (0xF == ((opaqueMask >> 4*i) & 0xF)) {
+            dst[i] = kOpaque;
+        }
+    }
+}
+
+bool CompressA8toR11EAC_SSE2(uint8_t* dst, const uint8_t* src,
+                             int width, int height, size_t rowBytes) {
+    // Since we're going to operate on 4 blocks at a time, the src width
+    // must be a multiple of 16. However, the height only needs to be a
+    // multiple of 4
+    if (0 == width || 0 == height || (width % 16) != 0 || (height % 4) != 0) {
+        return SkTextureCompressor::CompressBufferToFormat(
+            dst, src,
+            kAlpha_8_SkColorType,
+            width, height, rowBytes,
+            SkTextureCompressor::kR11_EAC_Format, false);
+    }
+
+    const int blocksX = width >> 2;
+    const int blocksY = height >> 2;
+
+    uint64_t* encPtr = reinterpret_cast<uint64_t*>(dst);
+    for (int y = 0; y < blocksY; ++y) {
+        for (int x = 0; x < blocksX; x += 4) {
+            compress_r11eac_blocks(encPtr, src + 4*x, rowBytes);
+            encPtr += 4;
+        }
+        src += 4 * rowBytes;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// LATC
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Since the palette is
+// 255, 0, 219, 182, 146, 109, 73, 36
+// we need to map the three-bit indices
+// 0 1 2 3 4 5 6 7
+// to
+// 1 7 6 5 4 3 2 0
+// which is (8 - x) & 7, with the first and last entries swapped.
+static inline __m128i latc_indices(const __m128i& x) {
+    const __m128i seven = _mm_set1_epi8(7);
+    const __m128i ends = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_setzero_si128()),
+                                      _mm_cmpeq_epi8(x, seven));
+    const __m128i index = _mm_and_si128(_mm_sub_epi8(_mm_set1_epi8(8), x), seven);
+    return _mm_xor_si128(index, _mm_and_si128(ends, _mm_set1_epi8(1)));
+}
+
+// Packs the bottom three bits of each byte into the bottom 12 bits of each
+// 32-bit lane, first byte lowest.
+static inline __m128i pack_latc_row(const __m128i& x) {
+    const __m128i pairs = _mm_or_si128(_mm_and_si128(x, _mm_set1_epi16(0xFF)),
+                                       _mm_slli_epi16(_mm_srli_epi16(x, 8), 3));
+    return _mm_or_si128(_mm_and_si128(pairs, _mm_set1_epi32(0xFFFF)),
+                        _mm_slli_epi32(_mm_srli_epi32(pairs, 16), 6));
+}
+
+static void compress_latc_blocks(uint64_t* dst, const uint8_t* src, size_t rowBytes) {
+    __m128i rows[4];
+    for (int i = 0; i < 4; ++i) {
+        const __m128i alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i*rowBytes));
+        rows[i] = pack_latc_row(latc_indices(three_bit_index(alpha)));
+    }
+
+    // 24 bits of indices for the top and bottom halves of each block
+    const __m128i top = _mm_or_si128(rows[0], _mm_slli_epi32(rows[1], 12));
+    const __m128i bottom = _mm_or_si128(rows[2], _mm_slli_epi32(rows[3], 12));
+
+    // Luminance endpoints are 255 and 0, and the indices follow them.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i header = set1_64(0xFF);
+    const __m128i indices01 = _mm_or_si128(_mm_unpacklo_epi32(top, zero),
+                                           _mm_slli_epi64(_mm_unpacklo_epi32(bottom, zero), 24));
+    const __m128i indices23 = _mm_or_si128(_mm_unpackhi_epi32(top, zero),
+                                           _mm_slli_epi64(_mm_unpackhi_epi32(bottom, zero), 24));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_or_si128(header, _mm_slli_epi64(indices01, 16)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2),
+                     _mm_or_si128(header, _mm_slli_epi64(indices23, 16)));
+}
+
+bool CompressA8toLATC_SSE2(uint8_t* dst, const uint8_t* src,
+                           int width, int height, size_t rowBytes) {
+    if (0 == width || 0 == height || (width % 16) != 0 || (height % 4) != 0) {
+        return SkTextureCompressor::CompressBufferToFormat(
+            dst, src,
+            kAlpha_8_SkColorType,
+            width, height, rowBytes,
+            SkTextureCompressor::kLATC_Format, false);
+    }
+
+    const int blocksX = width >> 2;
+    const int blocksY = height >> 2;
+
+    uint64_t* encPtr = reinterpret_cast<uint64_t*>(dst);
+    for (int y = 0; y < blocksY; ++y) {
+        for (int x = 0; x < blocksX; x += 4) {
+            compress_latc_blocks(encPtr, src + 4*x, rowBytes);
+            encPtr += 4;
+        }
+        src += 4 * rowBytes;
+    }
+    return true;
+}
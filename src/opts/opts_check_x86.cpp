@@ -15,10 +15,14 @@
 #include "SkBlitRow_opts_SSE4.h"
 #include "SkBlurImage_opts_SSE2.h"
 #include "SkBlurImage_opts_SSE4.h"
+#include "SkConfig8888_opts.h"
+#include "SkConfig8888_opts_SSSE3.h"
 #include "SkLazyPtr.h"
 #include "SkMorphology_opts.h"
 #include "SkMorphology_opts_SSE2.h"
 #include "SkRTConf.h"
+#include "SkTextureCompression_opts.h"
+#include "SkTextureCompression_opts_SSE2.h"
 #include "SkUtils.h"
 #include "SkUtils_opts_SSE2.h"
 #include "SkXfermode.h"
@@ -329,6 +333,32 @@ SkMemcpy32Proc SkMemcpy32GetPlatformProc() {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+SkConfig8888RowProc SkConfig8888GetPlatformProc(SkConfig8888ProcType type) {
+#if SK_A32_SHIFT != 24 || SK_G32_SHIFT != 8
+    return NULL;
+#else
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
+        return NULL;
+    }
+    switch (type) {
+        case kSwapRB_SkConfig8888ProcType:
+            return SkSwapRB_SSSE3;
+        case kPremul_SkConfig8888ProcType:
+            return SkPremul_SSSE3;
+        case kSwapRBPremul_SkConfig8888ProcType:
+            return SkSwapRBPremul_SSSE3;
+        case kUnpremul_SkConfig8888ProcType:
+            return SkUnpremul_SSSE3;
+        case kSwapRBUnpremul_SkConfig8888ProcType:
+            return SkSwapRBUnpremul_SSSE3;
+        default:
+            return NULL;
+    }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 SkMorphologyImageFilter::Proc SkMorphologyGetPlatformProc(SkMorphologyProcType type) {
     if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return NULL;
@@ -349,6 +379,37 @@ SkMorphologyImageFilter::Proc SkMorphologyGetPlatformProc(SkMorphologyProcType t
 
 ////////////////////////////////////////////////////////////////////////////////
 
+SkTextureCompressor::CompressionProc
+SkTextureCompressorGetPlatformProc(SkColorType colorType, SkTextureCompressor::Format fmt) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2) || kAlpha_8_SkColorType != colorType) {
+        return NULL;
+    }
+    switch (fmt) {
+        case SkTextureCompressor::kR11_EAC_Format:
+            return CompressA8toR11EAC_SSE2;
+        case SkTextureCompressor::kLATC_Format:
+            return CompressA8toLATC_SSE2;
+        default:
+            return NULL;
+    }
+}
+
+bool SkTextureCompressorGetPlatformDims(SkTextureCompressor::Format fmt, int* dimX, int* dimY) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return false;
+    }
+    switch (fmt) {
+        case SkTextureCompressor::kR11_EAC_Format:
+            *dimX = 16;
+            *dimY = 4;
+            return true;
+        default:
+            return false;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
                                SkBoxBlurProc* boxBlurXY,
                                SkBoxBlurProc* boxBlurYX) {
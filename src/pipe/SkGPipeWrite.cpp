@@ -16,6 +16,7 @@
 #include "SkGPipe.h"
 #include "SkGPipePriv.h"
 #include "SkImageFilter.h"
+#include "SkImage_Base.h"
 #include "SkMaskFilter.h"
 #include "SkWriteBuffer.h"
 #include "SkPaint.h"
@@ -384,6 +385,7 @@ bool SkGPipeCanvas::shuttleBitmap(const SkBitmap& bm, int32_t slot) {
     SkASSERT(shouldFlattenBitmaps(fFlags));
     SkWriteBuffer buffer;
     buffer.setNamedFactoryRecorder(fFactorySet);
+    buffer.setPixelSerializer(fController->getPixelSerializer());
     buffer.writeBitmap(bm);
     this->flattenFactoryNames();
     size_t size = buffer.bytesWritten();
@@ -467,7 +469,9 @@ SkGPipeCanvas::SkGPipeCanvas(SkGPipeController* controller,
     fFlattenableHeap.setBitmapStorage(fBitmapHeap);
 
     fImageHeap = SkNEW(SkImageHeap);
-    if (this->needOpBytes(sizeof(void*))) {
+    // A reader that cannot see our bitmaps cannot see our images either, so those are drawn as
+    // flattened bitmaps instead.
+    if (!shouldFlattenBitmaps(flags) && this->needOpBytes(sizeof(void*))) {
         this->writeOp(kShareImageHeap_DrawOp);
         fWriter.writePtr(static_cast<void*>(fImageHeap));
     }
@@ -857,6 +861,13 @@ bool SkGPipeCanvas::commonDrawImage(const SkImage* image, DrawOps op, unsigned f
 
 void SkGPipeCanvas::onDrawImage(const SkImage* image, SkScalar x, SkScalar y,
                                 const SkPaint* paint) {
+    if (shouldFlattenBitmaps(fFlags)) {
+        SkBitmap bm;
+        if (as_IB(image)->getROPixels(&bm)) {
+            this->drawBitmap(bm, x, y, paint);
+        }
+        return;
+    }
     NOTIFY_SETUP(this);
     if (this->commonDrawImage(image, kDrawImage_DrawOp, 0, sizeof(SkScalar) * 2, paint)) {
         fWriter.writeScalar(x);
@@ -866,6 +877,13 @@ void SkGPipeCanvas::onDrawImage(const SkImage* image, SkScalar x, SkScalar y,
 
 void SkGPipeCanvas::onDrawImageRect(const SkImage* image, const SkRect* src, const SkRect& dst,
                                     const SkPaint* paint) {
+    if (shouldFlattenBitmaps(fFlags)) {
+        SkBitmap bm;
+        if (as_IB(image)->getROPixels(&bm)) {
+            this->drawBitmapRectToRect(bm, src, dst, paint);
+        }
+        return;
+    }
     NOTIFY_SETUP(this);
     unsigned flags = 0;
     size_t opBytesNeeded = sizeof(SkRect);  // dst
@@ -0,0 +1,544 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSharedMemoryPipe.h"
+
+#include "SkAtomics.h"
+#include "SkBitmap.h"
+#include "SkChecksum.h"
+#include "SkData.h"
+#include "SkImage.h"
+#include "SkImageDecoder.h"
+#include "SkMath.h"
+#include "SkMutex.h"
+#include "SkPixelSerializer.h"
+#include "../SkGPipePriv.h"
+
+#if !defined(SK_BUILD_FOR_WIN32)
+    #include <fcntl.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #ifndef MAP_ANONYMOUS
+        #define MAP_ANONYMOUS MAP_ANON
+    #endif
+#endif
+
+// Android's libc has no shm_open, so only desktop POSIX systems get named memory.
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    #define SK_SHARED_PIPE_NAMED_MEMORY
+#endif
+
+#if defined(__linux__)
+    #include <limits.h>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
+
+/*
+ *  The memory starts with a Header, followed by the ring of commands, and then the pixel arena.
+ *
+ *  Positions in the ring count the bytes written since the memory was created, and wrap around
+ *  at 2^32, which the size of the ring (a power of 2) divides. The writer owns fWritten and the
+ *  reader owns fRead; each only ever reads the other's. The writer never lets a command cross
+ *  the end of the ring: if there is no room for the next block before the end, it fills the
+ *  rest with kSkip_DrawOps, which the reader plays back like any other command.
+ *
+ *  Whichever side has to wait sets its fWaiting flag and sleeps on its signal, which the other
+ *  side only bumps (and wakes) when it sees the flag, so neither makes a system call while the
+ *  other is keeping up.
+ */
+struct SkSharedPipeMemory::Header {
+    uint32_t    fMagic;
+    uint32_t    fID;            // identifies the pixel arena in PixelHandles
+    uint32_t    fRingBytes;
+    uint32_t    fPixelBytes;
+    uint32_t    fPad0[12];
+
+    // Written by the writer, on its own cache line.
+    uint32_t    fWritten;
+    uint32_t    fWriterWaiting;
+    uint32_t    fDataSignal;
+    uint32_t    fClosed;
+    uint32_t    fPixelsUsed;
+    uint32_t    fPad1[11];
+
+    // Written by the reader.
+    uint32_t    fRead;
+    uint32_t    fReaderWaiting;
+    uint32_t    fSpaceSignal;
+    uint32_t    fPad2[13];
+};
+
+static const uint32_t kHeaderMagic = SkSetFourByteTag('s', 'k', 'g', 'p');
+static const uint32_t kPixelHandleMagic = SkSetFourByteTag('s', 'k', 'p', 'x');
+
+static const size_t kMinRingBytes = 4096;
+static const size_t kMaxRingBytes = 1 << 30;
+static const size_t kPixelAlignment = 16;
+
+// How many times to look for the other side's progress before going to sleep.
+static const int kSpinCount = 256;
+
+/*
+ *  The bitmaps SkSharedPixelSerializer sends, in place of their pixels.
+ */
+struct PixelHandle {
+    uint32_t    fMagic;
+    uint32_t    fID;
+    uint32_t    fOffset;        // of the pixels, in the arena
+    uint32_t    fRowBytes;
+    int32_t     fWidth;
+    int32_t     fHeight;
+    int32_t     fColorType;
+    int32_t     fAlphaType;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// These are shared between processes, so they cannot use the FUTEX_PRIVATE_FLAG versions.
+static void futex_wait(uint32_t* addr, uint32_t value) {
+#if defined(__linux__)
+    syscall(SYS_futex, addr, FUTEX_WAIT, value, NULL, NULL, 0);
+#elif !defined(SK_BUILD_FOR_WIN32)
+    sched_yield();
+#endif
+}
+
+static void futex_wake(uint32_t* addr) {
+#if defined(__linux__)
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+/*
+ *  Sleeps until the other side signals, or until it has stored something other than value to
+ *  *word, which it does before checking *waiting. Callers check their condition again after.
+ */
+static void wait_for_change(const uint32_t* word, uint32_t value, const uint32_t* closed,
+                            uint32_t* waiting, uint32_t* signal) {
+    for (int i = 0; i < kSpinCount; ++i) {
+        if (sk_atomic_load(word, sk_memory_order_acquire) != value) {
+            return;
+        }
+    }
+    const uint32_t seq = sk_atomic_load(signal, sk_memory_order_acquire);
+    sk_atomic_store(waiting, 1u);
+    // Both this and the other side's store to *word are sequentially consistent, so either it
+    // sees that we are waiting, or we see what it stored.
+    if (sk_atomic_load(word) == value && !(closed && sk_atomic_load(closed))) {
+        futex_wait(signal, seq);
+    }
+    sk_atomic_store(waiting, 0u, sk_memory_order_relaxed);
+}
+
+static void signal_if_waiting(uint32_t* waiting, uint32_t* signal) {
+    if (sk_atomic_load(waiting)) {
+        sk_atomic_fetch_add(signal, 1u);
+        futex_wake(signal);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The SkSharedPipeMemory this process has mapped, for InstallPixelRef().
+SK_DECLARE_STATIC_MUTEX(gMappedMutex);
+static SkSharedPipeMemory* gMappedHead = NULL;
+static int32_t gNextID = 0;
+
+static void unref_memory(void*, void* context) {
+    static_cast<SkSharedPipeMemory*>(context)->unref();
+}
+
+SkSharedPipeMemory::SkSharedPipeMemory(void* base, size_t size, const char name[])
+    : fHeader(static_cast<Header*>(base))
+    , fSize(size)
+    , fName(name) {
+    SkAutoMutexAcquire lock(gMappedMutex);
+    fNext = gMappedHead;
+    gMappedHead = this;
+}
+
+SkSharedPipeMemory::~SkSharedPipeMemory() {
+    {
+        SkAutoMutexAcquire lock(gMappedMutex);
+        SkSharedPipeMemory** prev = &gMappedHead;
+        while (*prev != this) {
+            prev = &(*prev)->fNext;
+        }
+        *prev = fNext;
+    }
+#if !defined(SK_BUILD_FOR_WIN32)
+    munmap(fHeader, fSize);
+#endif
+#if defined(SK_SHARED_PIPE_NAMED_MEMORY)
+    if (!fName.isEmpty()) {
+        shm_unlink(fName.c_str());
+    }
+#endif
+}
+
+bool SkSharedPipeMemory::ComputeSize(size_t* ringBytes, size_t* pixelBytes, size_t* size) {
+    if (*ringBytes > kMaxRingBytes || *pixelBytes > 0x7FFFFFFF) {
+        return false;
+    }
+    *ringBytes = SkNextPow2(SkToInt(SkTMax(kMinRingBytes, *ringBytes)));
+    *pixelBytes = SkAlign4(*pixelBytes);
+    *size = sizeof(Header) + *ringBytes + *pixelBytes;
+    return true;
+}
+
+void SkSharedPipeMemory::init(size_t ringBytes, size_t pixelBytes) {
+    sk_bzero(fHeader, sizeof(Header));
+    fHeader->fMagic = kHeaderMagic;
+    fHeader->fID = SkChecksum::Mix((uint32_t)getpid()) + sk_atomic_inc(&gNextID);
+    fHeader->fRingBytes = SkToU32(ringBytes);
+    fHeader->fPixelBytes = SkToU32(pixelBytes);
+}
+
+SkSharedPipeMemory* SkSharedPipeMemory::Create(size_t ringBytes, size_t pixelBytes) {
+#if defined(SK_BUILD_FOR_WIN32)
+    return NULL;
+#else
+    size_t size;
+    if (!ComputeSize(&ringBytes, &pixelBytes, &size)) {
+        return NULL;
+    }
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == base) {
+        return NULL;
+    }
+    SkSharedPipeMemory* memory = SkNEW_ARGS(SkSharedPipeMemory, (base, size, NULL));
+    memory->init(ringBytes, pixelBytes);
+    return memory;
+#endif
+}
+
+SkSharedPipeMemory* SkSharedPipeMemory::CreateNamed(const char name[], size_t ringBytes,
+                                                    size_t pixelBytes) {
+#if !defined(SK_SHARED_PIPE_NAMED_MEMORY)
+    return NULL;
+#else
+    size_t size;
+    if (!ComputeSize(&ringBytes, &pixelBytes, &size)) {
+        return NULL;
+    }
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    void* base = MAP_FAILED;
+    if (0 == ftruncate(fd, size)) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (MAP_FAILED == base) {
+        shm_unlink(name);
+        return NULL;
+    }
+    SkSharedPipeMemory* memory = SkNEW_ARGS(SkSharedPipeMemory, (base, size, name));
+    memory->init(ringBytes, pixelBytes);
+    return memory;
+#endif
+}
+
+SkSharedPipeMemory* SkSharedPipeMemory::OpenNamed(const char name[]) {
+#if !defined(SK_SHARED_PIPE_NAMED_MEMORY)
+    return NULL;
+#else
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    void* base = MAP_FAILED;
+    struct stat st;
+    if (0 == fstat(fd, &st) && (size_t)st.st_size >= sizeof(Header)) {
+        base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (MAP_FAILED == base) {
+        return NULL;
+    }
+    const Header* header = static_cast<const Header*>(base);
+    size_t ringBytes = header->fRingBytes;
+    size_t pixelBytes = header->fPixelBytes;
+    size_t size;
+    if (kHeaderMagic != header->fMagic || !SkIsPow2(ringBytes) ||
+            !ComputeSize(&ringBytes, &pixelBytes, &size) || size != (size_t)st.st_size) {
+        munmap(base, st.st_size);
+        return NULL;
+    }
+    return SkNEW_ARGS(SkSharedPipeMemory, (base, size, NULL));
+#endif
+}
+
+size_t SkSharedPipeMemory::ringBytes() const {
+    return fHeader->fRingBytes;
+}
+
+size_t SkSharedPipeMemory::pixelBytes() const {
+    return fHeader->fPixelBytes;
+}
+
+uint8_t* SkSharedPipeMemory::ring() const {
+    return reinterpret_cast<uint8_t*>(fHeader + 1);
+}
+
+uint8_t* SkSharedPipeMemory::pixels() const {
+    return this->ring() + fHeader->fRingBytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool is_shareable(const SkImageInfo& info, size_t rowBytes) {
+    return kUnknown_SkColorType != info.colorType() &&
+           kIndex_8_SkColorType != info.colorType() &&
+           info.validRowBytes(rowBytes) &&
+           !info.isEmpty();
+}
+
+bool SkSharedPipeMemory::allocPixels(SkBitmap* bitmap) {
+    const SkImageInfo& info = bitmap->info();
+    const size_t rowBytes = bitmap->rowBytes();
+    if (!is_shareable(info, rowBytes)) {
+        return false;
+    }
+    const uint64_t size = (info.getSafeSize64(rowBytes) + kPixelAlignment - 1) &
+                          ~(uint64_t)(kPixelAlignment - 1);
+    const uint32_t used = fHeader->fPixelsUsed;
+    if (size > fHeader->fPixelBytes - used) {
+        return false;
+    }
+    fHeader->fPixelsUsed = used + SkToU32(size);
+
+    this->ref();    // unref_memory() balances this once the pixels are released.
+    return bitmap->installPixels(info, this->pixels() + used, rowBytes, NULL,
+                                 unref_memory, this);
+}
+
+void SkSharedPipeMemory::resetPixels() {
+    fHeader->fPixelsUsed = 0;
+}
+
+bool SkSharedPipeMemory::containsPixels(const void* addr, size_t size) const {
+    const uint8_t* p = static_cast<const uint8_t*>(addr);
+    return p >= this->pixels() && size <= fHeader->fPixelBytes &&
+           (size_t)(p - this->pixels()) <= fHeader->fPixelBytes - size;
+}
+
+bool SkSharedPipeMemory::InstallPixelRef(const void* src, size_t length, SkBitmap* dst) {
+    PixelHandle handle;
+    if (sizeof(PixelHandle) != length ||
+            (memcpy(&handle, src, sizeof(handle)), kPixelHandleMagic != handle.fMagic)) {
+        return SkImageDecoder::DecodeMemory(src, length, dst);
+    }
+    if (handle.fColorType < 0 || handle.fColorType > kLastEnum_SkColorType ||
+            handle.fAlphaType < 0 || handle.fAlphaType > kLastEnum_SkAlphaType) {
+        return false;
+    }
+    const SkImageInfo info = SkImageInfo::Make(handle.fWidth, handle.fHeight,
+                                               (SkColorType)handle.fColorType,
+                                               (SkAlphaType)handle.fAlphaType);
+    if (!is_shareable(info, handle.fRowBytes)) {
+        return false;
+    }
+
+    SkAutoMutexAcquire lock(gMappedMutex);
+    for (SkSharedPipeMemory* memory = gMappedHead; memory; memory = memory->fNext) {
+        if (memory->fHeader->fID != handle.fID) {
+            continue;
+        }
+        void* addr = memory->pixels() + handle.fOffset;
+        if (handle.fOffset > memory->fHeader->fPixelBytes ||
+                !memory->containsPixels(addr, info.getSafeSize(handle.fRowBytes))) {
+            return false;
+        }
+        memory->ref();
+        return dst->installPixels(info, addr, handle.fRowBytes, NULL, unref_memory, memory);
+    }
+    return false;
+}
+
+/*
+ *  Sends bitmaps whose pixels are in the arena as a PixelHandle.
+ */
+class SkSharedPixelSerializer : public SkPixelSerializer {
+public:
+    SkSharedPixelSerializer(SkSharedPipeMemory* memory) : fMemory(memory) {}
+
+protected:
+    bool onUseEncodedData(const void*, size_t) override { return true; }
+
+    SkData* onEncodePixels(const SkImageInfo& info, const void* pixels, size_t rowBytes) override {
+        if (!is_shareable(info, rowBytes) ||
+                !fMemory->containsPixels(pixels, info.getSafeSize(rowBytes))) {
+            return NULL;
+        }
+        PixelHandle handle;
+        handle.fMagic = kPixelHandleMagic;
+        handle.fID = fMemory->fHeader->fID;
+        handle.fOffset = SkToU32(static_cast<const uint8_t*>(pixels) - fMemory->pixels());
+        handle.fRowBytes = SkToU32(rowBytes);
+        handle.fWidth = info.width();
+        handle.fHeight = info.height();
+        handle.fColorType = info.colorType();
+        handle.fAlphaType = info.alphaType();
+        return SkData::NewWithCopy(&handle, sizeof(handle));
+    }
+
+private:
+    // The controller owns this, and the memory.
+    SkSharedPipeMemory* fMemory;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+void* SkSharedPipeMemory::waitForSpace(size_t minBytes, size_t* actual) {
+    Header* h = fHeader;
+    const uint32_t capacity = h->fRingBytes;
+    if (minBytes > capacity) {
+        return NULL;
+    }
+    uint32_t written = h->fWritten;
+    uint32_t offset = written & (capacity - 1);
+
+    if (capacity - offset < minBytes) {
+        // Skip to the start of the ring.
+        const uint32_t tail = capacity - offset;
+        uint32_t read;
+        while (capacity - (written - (read = sk_atomic_load(&h->fRead, sk_memory_order_acquire)))
+                < tail) {
+            wait_for_change(&h->fRead, read, NULL, &h->fWriterWaiting, &h->fSpaceSignal);
+        }
+        uint32_t* op = reinterpret_cast<uint32_t*>(this->ring() + offset);
+        uint32_t remaining = tail;
+        while (remaining > 0) {
+            const uint32_t skip = SkTMin<uint32_t>(remaining - 4, DRAWOPS_DATA_MASK & ~3);
+            *op = DrawOp_packOpFlagData(kSkip_DrawOp, 0, skip);
+            op += 1 + skip / 4;
+            remaining -= 4 + skip;
+        }
+        this->publish(tail);
+        written += tail;
+        offset = 0;
+    }
+
+    uint32_t read;
+    while (capacity - (written - (read = sk_atomic_load(&h->fRead, sk_memory_order_acquire)))
+            < minBytes) {
+        wait_for_change(&h->fRead, read, NULL, &h->fWriterWaiting, &h->fSpaceSignal);
+    }
+    *actual = SkTMin(capacity - offset, capacity - (written - read));
+    return this->ring() + offset;
+}
+
+void SkSharedPipeMemory::publish(size_t bytes) {
+    Header* h = fHeader;
+    sk_atomic_store(&h->fWritten, h->fWritten + SkToU32(bytes));
+    signal_if_waiting(&h->fReaderWaiting, &h->fDataSignal);
+}
+
+void SkSharedPipeMemory::waitForReader() {
+    Header* h = fHeader;
+    const uint32_t written = h->fWritten;
+    uint32_t read;
+    while ((read = sk_atomic_load(&h->fRead, sk_memory_order_acquire)) != written) {
+        wait_for_change(&h->fRead, read, NULL, &h->fWriterWaiting, &h->fSpaceSignal);
+    }
+}
+
+void SkSharedPipeMemory::close() {
+    Header* h = fHeader;
+    sk_atomic_store(&h->fClosed, 1u);
+    // The reader may be about to sleep without having seen fClosed, so always signal.
+    sk_atomic_fetch_add(&h->fDataSignal, 1u);
+    futex_wake(&h->fDataSignal);
+}
+
+const void* SkSharedPipeMemory::waitForData(size_t* bytes) {
+    Header* h = fHeader;
+    const uint32_t capacity = h->fRingBytes;
+    const uint32_t read = h->fRead;
+    for (;;) {
+        uint32_t written = sk_atomic_load(&h->fWritten, sk_memory_order_acquire);
+        if (written == read && sk_atomic_load(&h->fClosed, sk_memory_order_acquire)) {
+            // Everything is published before the pipe is closed.
+            written = sk_atomic_load(&h->fWritten, sk_memory_order_acquire);
+            if (written == read) {
+                return NULL;
+            }
+        }
+        if (written != read) {
+            const uint32_t offset = read & (capacity - 1);
+            *bytes = SkTMin(written - read, capacity - offset);
+            return this->ring() + offset;
+        }
+        wait_for_change(&h->fWritten, read, &h->fClosed, &h->fReaderWaiting, &h->fDataSignal);
+    }
+}
+
+void SkSharedPipeMemory::consume(size_t bytes) {
+    Header* h = fHeader;
+    sk_atomic_store(&h->fRead, h->fRead + SkToU32(bytes));
+    signal_if_waiting(&h->fWriterWaiting, &h->fSpaceSignal);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSharedMemoryPipeController::SkSharedMemoryPipeController(SkSharedPipeMemory* memory)
+    : fMemory(SkRef(memory))
+    , fSerializer(SkNEW_ARGS(SkSharedPixelSerializer, (memory))) {}
+
+SkSharedMemoryPipeController::~SkSharedMemoryPipeController() {
+    fMemory->close();
+}
+
+void* SkSharedMemoryPipeController::requestBlock(size_t minRequest, size_t* actual) {
+    return fMemory->waitForSpace(minRequest, actual);
+}
+
+void SkSharedMemoryPipeController::notifyWritten(size_t bytes) {
+    fMemory->publish(bytes);
+}
+
+SkPixelSerializer* SkSharedMemoryPipeController::getPixelSerializer() {
+    return fSerializer.get();
+}
+
+void SkSharedMemoryPipeController::waitForReader() {
+    fMemory->waitForReader();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSharedMemoryPipeReader::SkSharedMemoryPipeReader(SkSharedPipeMemory* memory, SkCanvas* target)
+    : fMemory(SkRef(memory))
+    , fCanvas(target) {}
+
+SkGPipeReader::Status SkSharedMemoryPipeReader::playback() {
+    SkGPipeReader reader(fCanvas);
+    reader.setBitmapDecoder(SkSharedPipeMemory::InstallPixelRef);
+    for (;;) {
+        size_t bytes;
+        const void* data = fMemory->waitForData(&bytes);
+        if (NULL == data) {
+            return SkGPipeReader::kEOF_Status;
+        }
+        size_t bytesRead = 0;
+        const SkGPipeReader::Status status = reader.playback(data, bytes, 0, &bytesRead);
+        if (SkGPipeReader::kError_Status == status) {
+            return status;
+        }
+        // Everything in a contiguous run is whole commands, but the next recording may start
+        // after this one's kDone_DrawOp.
+        fMemory->consume(SkGPipeReader::kDone_Status == status ? bytesRead : bytes);
+        if (SkGPipeReader::kDone_Status == status) {
+            return status;
+        }
+    }
+}
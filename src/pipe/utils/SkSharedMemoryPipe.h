@@ -0,0 +1,157 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedMemoryPipe_DEFINED
+#define SkSharedMemoryPipe_DEFINED
+
+#include "SkGPipe.h"
+#include "SkRefCnt.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+
+class SkBitmap;
+class SkCanvas;
+class SkPixelSerializer;
+
+/**
+ *  Memory shared between a process writing an SkGPipe and a process reading it. It holds a ring
+ *  buffer of pipe commands, and an arena for bitmap pixels that both processes can see, so that
+ *  bitmaps allocated there are drawn by the reader without being copied through the pipe.
+ *
+ *  There is one writer and one reader. Either one blocks (on a futex on Linux) when it has to
+ *  wait for the other.
+ */
+class SkSharedPipeMemory : public SkRefCnt {
+public:
+    /**
+     *  Maps anonymous shared memory, for a reader in a child process that is fork()ed after this.
+     *  ringBytes is rounded up to a power of 2, and must be at least as large as the largest
+     *  command, including any bitmaps not allocated in the pixel arena.
+     *  Returns NULL if shared memory is not supported, or could not be mapped.
+     */
+    static SkSharedPipeMemory* Create(size_t ringBytes, size_t pixelBytes);
+
+    /**
+     *  Creates a named POSIX shared memory object (see shm_open), for a reader in an unrelated
+     *  process, which calls OpenNamed() with the same name. The name is unlinked when the
+     *  returned object is destroyed. Returns NULL if the name is already in use, or if the
+     *  platform has no named shared memory (Windows and Android).
+     */
+    static SkSharedPipeMemory* CreateNamed(const char name[], size_t ringBytes, size_t pixelBytes);
+    static SkSharedPipeMemory* OpenNamed(const char name[]);
+
+    virtual ~SkSharedPipeMemory();
+
+    size_t ringBytes() const;
+    size_t pixelBytes() const;
+
+    /**
+     *  Allocates pixels for a bitmap, whose info must already be set, from the arena. Like
+     *  SkBitmap::tryAllocPixels(), returns false if there is not enough room. The pixels must
+     *  not change once the bitmap has been drawn into the pipe, and must stay allocated until
+     *  the reader is done with them; see SkSharedMemoryPipeController::waitForReader().
+     */
+    bool allocPixels(SkBitmap*);
+
+    /**
+     *  Makes all of the arena available again. Only call this once the reader has drawn every
+     *  bitmap using the arena, and the writer will draw none of them again.
+     */
+    void resetPixels();
+
+    /**
+     *  An SkPicture::InstallPixelRefProc for SkGPipeReader::setBitmapDecoder(). It installs
+     *  bitmaps whose pixels are in the arena of any SkSharedPipeMemory mapped by this process,
+     *  and decodes anything else with SkImageDecoder::DecodeMemory().
+     */
+    static bool InstallPixelRef(const void* src, size_t length, SkBitmap* dst);
+
+private:
+    struct Header;
+
+    SkSharedPipeMemory(void* base, size_t size, const char name[]);
+
+    static bool ComputeSize(size_t* ringBytes, size_t* pixelBytes, size_t* size);
+    void init(size_t ringBytes, size_t pixelBytes);
+
+    uint8_t* ring() const;
+    uint8_t* pixels() const;
+
+    bool containsPixels(const void* addr, size_t size) const;
+
+    // Called by the writer.
+    void* waitForSpace(size_t minBytes, size_t* actual);
+    void publish(size_t bytes);
+    void waitForReader();
+    void close();
+
+    // Called by the reader. Returns NULL once the writer has closed the pipe and everything
+    // written has been read.
+    const void* waitForData(size_t* bytes);
+    void consume(size_t bytes);
+
+    Header*     fHeader;
+    size_t      fSize;
+    SkString    fName;      // only set when this created a named object
+
+    SkSharedPipeMemory* fNext;  // in the list of memory mapped by this process
+
+    friend class SkSharedMemoryPipeController;
+    friend class SkSharedMemoryPipeReader;
+    friend class SkSharedPixelSerializer;
+
+    typedef SkRefCnt INHERITED;
+};
+
+/**
+ *  Writes the pipe into SkSharedPipeMemory, for a writer started with
+ *  SkGPipeWriter::kCrossProcess_Flag. Bitmaps whose pixels were allocated with
+ *  SkSharedPipeMemory::allocPixels() are sent as a reference to their pixels.
+ */
+class SkSharedMemoryPipeController : public SkGPipeController {
+public:
+    SkSharedMemoryPipeController(SkSharedPipeMemory*);
+
+    /**
+     *  Closes the pipe, so a reader that is still waiting for commands stops.
+     */
+    virtual ~SkSharedMemoryPipeController();
+
+    void* requestBlock(size_t minRequest, size_t* actual) override;
+    void notifyWritten(size_t bytes) override;
+    SkPixelSerializer* getPixelSerializer() override;
+
+    /**
+     *  Blocks until the reader has played back everything written so far.
+     */
+    void waitForReader();
+
+private:
+    SkAutoTUnref<SkSharedPipeMemory>    fMemory;
+    SkAutoTUnref<SkPixelSerializer>     fSerializer;
+};
+
+/**
+ *  Plays back a pipe from SkSharedPipeMemory.
+ */
+class SkSharedMemoryPipeReader {
+public:
+    SkSharedMemoryPipeReader(SkSharedPipeMemory*, SkCanvas* target);
+
+    /**
+     *  Plays back commands as they arrive, until the writer finishes recording (returning
+     *  kDone_Status), or closes the pipe without finishing (kEOF_Status), or there is an error.
+     *  After kDone_Status, this may be called again for the writer's next recording.
+     */
+    SkGPipeReader::Status playback();
+
+private:
+    SkAutoTUnref<SkSharedPipeMemory>    fMemory;
+    SkCanvas*                           fCanvas;
+};
+
+#endif
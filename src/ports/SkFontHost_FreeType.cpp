@@ -194,6 +194,9 @@ public:
                fFace != NULL;
     }
 
+    // Every FreeType scalercontext generates its images under gFTMutex.
+    bool canGenerateImagesConcurrently() const override { return false; }
+
 protected:
     unsigned generateGlyphCount() override;
     uint16_t generateCharToGlyph(SkUnichar uni) override;
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureUtils.h"
+#include "SkPixelRef.h"
+#include "SkRecordDraw.h"
+#include "SkTaskGroup.h"
+
+// Locking a lazy pixel ref generates its pixels, which stay cached after it is unlocked.
+static void preroll(SkBitmap* bitmap) {
+    bitmap->lockPixels();
+    bitmap->unlockPixels();
+}
+
+int SkPictureUtils::PrerollBitmaps(const SkPicture* pict, const SkRect& clip) {
+    SkRect query;
+    if (NULL == pict || !query.intersect(clip, pict->cullRect())) {
+        return 0;
+    }
+
+    SkTArray<SkBitmap> bitmaps;
+    SkRecordCollectBitmaps(pict, query, &bitmaps);
+
+    SkTArray<SkBitmap> lazy;
+    for (int i = 0; i < bitmaps.count(); ++i) {
+        if (bitmaps[i].pixelRef()->isLazyGenerated()) {
+            lazy.push_back(bitmaps[i]);
+        }
+    }
+
+    SkTaskGroup tg;
+    tg.batch(preroll, lazy.begin(), lazy.count());
+    tg.wait();
+    return lazy.count();
+}
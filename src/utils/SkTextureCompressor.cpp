@@ -14,6 +14,8 @@
 #include "SkBitmapProcShader.h"
 #include "SkData.h"
 #include "SkEndian.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
 
 #include "SkTextureCompression_opts.h"
 
@@ -31,6 +33,85 @@ static bool compress_etc1_565(uint8_t* dst, const uint8_t* src,
 #endif
 }
 
+template <int blockDimX, int blockDimY>
+static bool compress_a8_astc(uint8_t* dst, const uint8_t* src,
+                             int width, int height, size_t rowBytes) {
+    return SkTextureCompressor::CompressA8ToASTC(dst, src, width, height, rowBytes,
+                                                 blockDimX, blockDimY);
+}
+
+// Large images are compressed in horizontal bands of whole blocks, one per task.
+// Each band should be at least this many pixels to be worth a task.
+static const int kMinPixelsPerBand = 256*256;
+
+namespace {
+
+struct CompressionBand {
+    SkTextureCompressor::CompressionProc fProc;
+    uint8_t*                             fDst;
+    const uint8_t*                       fSrc;
+    int                                  fWidth;
+    int                                  fHeight;
+    size_t                               fRowBytes;
+    bool                                 fSuccess;
+};
+
+}  // namespace
+
+static void compress_band(CompressionBand* band) {
+    band->fSuccess = band->fProc(band->fDst, band->fSrc, band->fWidth, band->fHeight,
+                                 band->fRowBytes);
+}
+
+// Splits the image into bands of block rows and compresses them in parallel. All of our
+// formats lay out their blocks row by row, so each band writes a contiguous part of dst.
+// Returns false without touching dst if the image is too small to split.
+static bool compress_in_bands(SkTextureCompressor::CompressionProc proc,
+                              SkTextureCompressor::Format format,
+                              uint8_t* dst, const uint8_t* src,
+                              int width, int height, size_t rowBytes, bool* success) {
+    int dimX, dimY;
+    SkTextureCompressor::GetBlockDimensions(format, &dimX, &dimY, true);
+    if (width <= 0 || height <= 0 || (width % dimX) != 0 || (height % dimY) != 0) {
+        return false;
+    }
+
+    const int blockRows = height / dimY;
+    const int bandCount = SkTMin(blockRows, (width*height) / kMinPixelsPerBand);
+    if (bandCount < 2) {
+        return false;
+    }
+
+    const int blockRowsPerBand = (blockRows + bandCount - 1) / bandCount;
+    const int bandHeight = blockRowsPerBand*dimY;
+    const size_t bandSize = SkTextureCompressor::GetCompressedDataSize(format, width, bandHeight);
+
+    SkAutoSTMalloc<16, CompressionBand> bands(bandCount);
+    int count = 0;
+    for (int y = 0; y < height; y += bandHeight) {
+        CompressionBand& band = bands[count];
+        band.fProc = proc;
+        band.fDst = dst + count*bandSize;
+        band.fSrc = src + y*rowBytes;
+        band.fWidth = width;
+        band.fHeight = SkTMin(bandHeight, height - y);
+        band.fRowBytes = rowBytes;
+        band.fSuccess = false;
+        ++count;
+    }
+    SkASSERT(count <= bandCount);
+
+    SkTaskGroup tg;
+    tg.batch(compress_band, bands.get(), count);
+    tg.wait();
+
+    *success = true;
+    for (int i = 0; i < count; ++i) {
+        *success = *success && bands[i].fSuccess;
+    }
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace SkTextureCompressor {
@@ -137,6 +218,45 @@ bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcCol
                     case kR11_EAC_Format:
                         proc = CompressA8ToR11EAC;
                         break;
+                    case kASTC_4x4_Format:
+                        proc = compress_a8_astc<4, 4>;
+                        break;
+                    case kASTC_5x4_Format:
+                        proc = compress_a8_astc<5, 4>;
+                        break;
+                    case kASTC_5x5_Format:
+                        proc = compress_a8_astc<5, 5>;
+                        break;
+                    case kASTC_6x5_Format:
+                        proc = compress_a8_astc<6, 5>;
+                        break;
+                    case kASTC_6x6_Format:
+                        proc = compress_a8_astc<6, 6>;
+                        break;
+                    case kASTC_8x5_Format:
+                        proc = compress_a8_astc<8, 5>;
+                        break;
+                    case kASTC_8x6_Format:
+                        proc = compress_a8_astc<8, 6>;
+                        break;
+                    case kASTC_8x8_Format:
+                        proc = compress_a8_astc<8, 8>;
+                        break;
+                    case kASTC_10x5_Format:
+                        proc = compress_a8_astc<10, 5>;
+                        break;
+                    case kASTC_10x6_Format:
+                        proc = compress_a8_astc<10, 6>;
+                        break;
+                    case kASTC_10x8_Format:
+                        proc = compress_a8_astc<10, 8>;
+                        break;
+                    case kASTC_10x10_Format:
+                        proc = compress_a8_astc<10, 10>;
+                        break;
+                    case kASTC_12x10_Format:
+                        proc = compress_a8_astc<12, 10>;
+                        break;
                     case kASTC_12x12_Format:
                         proc = CompressA8To12x12ASTC;
                         break;
@@ -166,11 +286,15 @@ bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcCol
         }
     }
 
-    if (proc) {
-        return proc(dst, src, width, height, rowBytes);
+    if (NULL == proc) {
+        return false;
     }
 
-    return false;
+    bool success;
+    if (compress_in_bands(proc, format, dst, src, width, height, rowBytes, &success)) {
+        return success;
+    }
+    return proc(dst, src, width, height, rowBytes);
 }
 
 SkData* CompressBitmapToFormat(const SkPixmap& pixmap, Format format) {
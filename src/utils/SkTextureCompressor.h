@@ -30,19 +30,19 @@ namespace SkTextureCompressor {
                             //    bitmap to insert alphas.
 
         // Multi-purpose formats
-        kASTC_4x4_Format,   // 4x4 blocks, no compression, decompresses RGBA
-        kASTC_5x4_Format,   // 5x4 blocks, no compression, decompresses RGBA
-        kASTC_5x5_Format,   // 5x5 blocks, no compression, decompresses RGBA
-        kASTC_6x5_Format,   // 6x5 blocks, no compression, decompresses RGBA
-        kASTC_6x6_Format,   // 6x6 blocks, no compression, decompresses RGBA
-        kASTC_8x5_Format,   // 8x5 blocks, no compression, decompresses RGBA
-        kASTC_8x6_Format,   // 8x6 blocks, no compression, decompresses RGBA
-        kASTC_8x8_Format,   // 8x8 blocks, no compression, decompresses RGBA
-        kASTC_10x5_Format,  // 10x5 blocks, no compression, decompresses RGBA
-        kASTC_10x6_Format,  // 10x6 blocks, no compression, decompresses RGBA
-        kASTC_10x8_Format,  // 10x8 blocks, no compression, decompresses RGBA
-        kASTC_10x10_Format, // 10x10 blocks, no compression, decompresses RGBA
-        kASTC_12x10_Format, // 12x10 blocks, no compression, decompresses RGBA
+        kASTC_4x4_Format,   // 4x4 blocks, compresses A8, decompresses RGBA
+        kASTC_5x4_Format,   // 5x4 blocks, compresses A8, decompresses RGBA
+        kASTC_5x5_Format,   // 5x5 blocks, compresses A8, decompresses RGBA
+        kASTC_6x5_Format,   // 6x5 blocks, compresses A8, decompresses RGBA
+        kASTC_6x6_Format,   // 6x6 blocks, compresses A8, decompresses RGBA
+        kASTC_8x5_Format,   // 8x5 blocks, compresses A8, decompresses RGBA
+        kASTC_8x6_Format,   // 8x6 blocks, compresses A8, decompresses RGBA
+        kASTC_8x8_Format,   // 8x8 blocks, compresses A8, decompresses RGBA
+        kASTC_10x5_Format,  // 10x5 blocks, compresses A8, decompresses RGBA
+        kASTC_10x6_Format,  // 10x6 blocks, compresses A8, decompresses RGBA
+        kASTC_10x8_Format,  // 10x8 blocks, compresses A8, decompresses RGBA
+        kASTC_10x10_Format, // 10x10 blocks, compresses A8, decompresses RGBA
+        kASTC_12x10_Format, // 12x10 blocks, compresses A8, decompresses RGBA
         kASTC_12x12_Format, // 12x12 blocks, compresses A8, decompresses RGBA
 
         kLast_Format = kASTC_12x12_Format
@@ -63,6 +63,7 @@ namespace SkTextureCompressor {
     // Compresses the given src data into dst. The src data is assumed to be
     // large enough to hold width*height pixels. The dst data is expected to
     // be large enough to hold the compressed data according to the format.
+    // Large images are split into bands of blocks that are compressed in parallel.
     bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcColorType,
                                 int width, int height, size_t rowBytes, Format format,
                                 bool opt = true /* Use optimization if available */);
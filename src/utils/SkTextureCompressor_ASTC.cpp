@@ -261,6 +261,166 @@ inline void CompressA8ASTCBlockVertical(uint8_t* dst, const uint8_t* src) {
     compress_a8_astc_block<GetAlphaTranspose>(&dst, src, 12);
 }
 
+// The 12x12 encoder above works from a precomputed table. For the other block
+// sizes we build the same information at runtime: pick a weight grid that fits in
+// the block, and record for each texel the grid points that contribute to it
+// using the weight infill procedure from section C.2.18 of the spec. Everything
+// else (luminance endpoints of 0 and 255, three bit weights) matches the 12x12
+// encoder.
+class ASTCA8Encoder {
+public:
+    ASTCA8Encoder(int blockDimX, int blockDimY)
+        : fBlockDimX(blockDimX)
+        , fBlockDimY(blockDimY)
+        , fWeightDimX(0)
+        , fWeightDimY(0)
+        , fBlockMode(0) {
+        SkASSERT(blockDimX > 1 && blockDimX <= 12);
+        SkASSERT(blockDimY > 1 && blockDimY <= 12);
+
+        // Choose the largest weight grid whose three bit weights leave room for
+        // two 8-bit endpoints: 128 - 11 (block mode) - 2 (partitions) - 4 (CEM) - 16 = 95
+        // bits, i.e. at most 31 weights. Break ties by matching the block's aspect ratio.
+        for (int h = 2; h <= blockDimY; ++h) {
+            for (int w = 2; w <= blockDimX; ++w) {
+                const int area = w*h;
+                if (area*3 > 95 || BlockMode(w, h) < 0) {
+                    continue;
+                }
+                const int bestArea = fWeightDimX*fWeightDimY;
+                if (area > bestArea ||
+                    (area == bestArea && SkAbs32(w*blockDimY - h*blockDimX) <
+                                         SkAbs32(fWeightDimX*blockDimY - fWeightDimY*blockDimX))) {
+                    fWeightDimX = w;
+                    fWeightDimY = h;
+                }
+            }
+        }
+        SkASSERT(fWeightDimX > 0 && fWeightDimY > 0);
+        fBlockMode = BlockMode(fWeightDimX, fWeightDimY);
+
+        // Same as ASTCDecompressionData::infillWeight, but recording where each
+        // contribution comes from instead of applying it.
+        const int Ds = (1024 + blockDimX/2) / (blockDimX - 1);
+        const int Dt = (1024 + blockDimY/2) / (blockDimY - 1);
+        for (int t = 0; t < blockDimY; ++t) {
+            for (int s = 0; s < blockDimX; ++s) {
+                const int gs = (Ds*s*(fWeightDimX - 1) + 32) >> 6;
+                const int gt = (Dt*t*(fWeightDimY - 1) + 32) >> 6;
+                const int fs = gs & 0xF;
+                const int ft = gt & 0xF;
+                const int idx = (gs >> 4) + (gt >> 4)*fWeightDimX;
+
+                const int w11 = (fs*ft + 8) >> 4;
+                Contributions& texel = fTexels[t*blockDimX + s];
+                texel.fWeight[0] = 16 - fs - ft + w11;
+                texel.fWeight[1] = fs - w11;
+                texel.fWeight[2] = ft - w11;
+                texel.fWeight[3] = w11;
+                texel.fIndex[0] = idx;
+                texel.fIndex[1] = idx + 1;
+                texel.fIndex[2] = idx + fWeightDimX;
+                texel.fIndex[3] = idx + fWeightDimX + 1;
+            }
+        }
+    }
+
+    void compressBlock(uint8_t** dst, const uint8_t* src, size_t rowBytes) const {
+        const int numWeights = fWeightDimX*fWeightDimY;
+        int weightTot[31];
+        int alphaTot[31];
+        sk_bzero(weightTot, sizeof(weightTot));
+        sk_bzero(alphaTot, sizeof(alphaTot));
+
+        const uint8_t firstAlpha = *src;
+        bool constant = true;
+        for (int t = 0; t < fBlockDimY; ++t) {
+            const uint8_t* row = src + t*rowBytes;
+            for (int s = 0; s < fBlockDimX; ++s) {
+                const int alpha = row[s];
+                constant = constant && (alpha == firstAlpha);
+
+                const Contributions& texel = fTexels[t*fBlockDimX + s];
+                for (int i = 0; i < 4; ++i) {
+                    const int weight = texel.fWeight[i];
+                    if (weight > 0) {
+                        weightTot[texel.fIndex[i]] += weight;
+                        alphaTot[texel.fIndex[i]] += weight * alpha;
+                    }
+                }
+            }
+        }
+
+        // Endpoints v0 = 0 and v1 = 255, unless the block is solid.
+        uint64_t top = fBlockMode | (0xFFULL << 25);
+        uint64_t bottom = 0;
+        if (constant && (0 == firstAlpha || 0xFF == firstAlpha)) {
+            if (0xFF == firstAlpha) {
+                // v0 = 255, v1 = 0 with every weight zero.
+                top = fBlockMode | (0xFFULL << 17);
+            }
+            send_packing(dst, SkEndian_SwapLE64(top), 0);
+            return;
+        }
+
+        // The weights are stored from the most significant bit of the block
+        // downwards, with the bits of each weight reversed.
+        for (int idx = 0; idx < numWeights; ++idx) {
+            const int index = weightTot[idx] > 0 ? (alphaTot[idx] / weightTot[idx]) >> 5 : 0;
+            for (int bit = 0; bit < 3; ++bit) {
+                if (0 == (index & (1 << bit))) {
+                    continue;
+                }
+                const int pos = 127 - (idx*3 + bit);
+                if (pos >= 64) {
+                    bottom |= 1ULL << (pos - 64);
+                } else {
+                    top |= 1ULL << pos;
+                }
+            }
+        }
+
+        send_packing(dst, SkEndian_SwapLE64(top), SkEndian_SwapLE64(bottom));
+    }
+
+private:
+    // Returns the block mode bits for a single plane, low precision weight grid of
+    // the given dimensions with weights in the range 0-7, or -1 if the grid size
+    // can't be encoded. See Table C.2.8 of the spec.
+    static int BlockMode(int w, int h) {
+        // R0 = 1, R1 = 1, R2 = 1
+        static const int kRange0to7 = 0x13;
+        if (w >= 4 && w <= 7 && h >= 2 && h <= 5) {
+            return kRange0to7 | ((w - 4) << 7) | ((h - 2) << 5);
+        }
+        if (w >= 8 && w <= 11 && h >= 2 && h <= 5) {
+            return kRange0to7 | (1 << 2) | ((w - 8) << 7) | ((h - 2) << 5);
+        }
+        if (w >= 2 && w <= 5 && h >= 8 && h <= 11) {
+            return kRange0to7 | (1 << 3) | ((h - 8) << 7) | ((w - 2) << 5);
+        }
+        if (w >= 2 && w <= 5 && h >= 6 && h <= 7) {
+            return kRange0to7 | (3 << 2) | ((h - 6) << 7) | ((w - 2) << 5);
+        }
+        if (w >= 2 && w <= 3 && h >= 2 && h <= 5) {
+            return kRange0to7 | (3 << 2) | (1 << 8) | ((w - 2) << 7) | ((h - 2) << 5);
+        }
+        return -1;
+    }
+
+    struct Contributions {
+        uint8_t fIndex[4];
+        uint8_t fWeight[4];
+    };
+
+    const int       fBlockDimX;
+    const int       fBlockDimY;
+    int             fWeightDimX;
+    int             fWeightDimY;
+    uint64_t        fBlockMode;
+    Contributions   fTexels[144];
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // ASTC Decoder
@@ -2054,6 +2214,27 @@ bool CompressA8To12x12ASTC(uint8_t* dst, const uint8_t* src,
     return true;
 }
 
+bool CompressA8ToASTC(uint8_t* dst, const uint8_t* src, int width, int height, size_t rowBytes,
+                      int blockDimX, int blockDimY) {
+    if (12 == blockDimX && 12 == blockDimY) {
+        return CompressA8To12x12ASTC(dst, src, width, height, rowBytes);
+    }
+
+    if (width < 0 || ((width % blockDimX) != 0) || height < 0 || ((height % blockDimY) != 0)) {
+        return false;
+    }
+
+    const ASTCA8Encoder encoder(blockDimX, blockDimY);
+    uint8_t** dstPtr = &dst;
+    for (int y = 0; y < height; y += blockDimY) {
+        for (int x = 0; x < width; x += blockDimX) {
+            encoder.compressBlock(dstPtr, src + y*rowBytes + x, rowBytes);
+        }
+    }
+
+    return true;
+}
+
 SkBlitter* CreateASTCBlitter(int width, int height, void* outputBuffer,
                              SkTBlitterAllocator* allocator) {
     if ((width % 12) != 0 || (height % 12) != 0) {
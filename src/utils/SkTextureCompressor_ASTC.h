@@ -17,6 +17,10 @@ namespace SkTextureCompressor {
     bool CompressA8To12x12ASTC(uint8_t* dst, const uint8_t* src,
                                int width, int height, size_t rowBytes);
 
+    // Compresses A8 data into ASTC blocks of any of the supported dimensions.
+    bool CompressA8ToASTC(uint8_t* dst, const uint8_t* src, int width, int height,
+                          size_t rowBytes, int blockDimX, int blockDimY);
+
     SkBlitter* CreateASTCBlitter(int width, int height, void* outputBuffer,
                                  SkTBlitterAllocator *allocator);
 
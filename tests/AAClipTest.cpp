@@ -6,7 +6,9 @@
  */
 
 #include "SkAAClip.h"
+#include "SkBlitter.h"
 #include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkMask.h"
 #include "SkPath.h"
 #include "SkRandom.h"
@@ -434,6 +436,130 @@ static void test_crbug_422693(skiatest::Reporter* reporter) {
     rc.op(path, rc.getBounds().size(), SkRegion::kIntersect_Op, true);
 }
 
+static U8CPU clip_alpha(const SkMask& mask, int x, int y) {
+    return mask.fBounds.contains(x, y) ? *mask.getAddr8(x, y) : 0;
+}
+
+static void make_rand_rrect_clip(SkAAClip* clip, SkRandom& rand) {
+    SkRect r = SkRect::MakeXYWH(rand.nextRangeF(0, 30), rand.nextRangeF(0, 30),
+                                rand.nextRangeF(10, 60), rand.nextRangeF(10, 60));
+    SkPath path;
+    path.addRoundRect(r, rand.nextRangeF(0, 10), rand.nextRangeF(0, 10));
+    clip->setPath(path, NULL, true);
+}
+
+// Every op between two AA clips must match the per-pixel alpha math, including the rows where
+// one or both clips are uniform and take the shortcut in operateY.
+static void test_aa_ops(skiatest::Reporter* reporter) {
+    static const SkRegion::Op gOps[] = {
+        SkRegion::kIntersect_Op, SkRegion::kDifference_Op, SkRegion::kUnion_Op,
+        SkRegion::kXOR_Op, SkRegion::kReverseDifference_Op,
+    };
+
+    SkRandom rand;
+    for (int i = 0; i < 100; ++i) {
+        SkAAClip clipA, clipB;
+        make_rand_rrect_clip(&clipA, rand);
+        make_rand_rrect_clip(&clipB, rand);
+
+        SkMask maskA, maskB;
+        clipA.copyToMask(&maskA);
+        clipB.copyToMask(&maskB);
+
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gOps); ++j) {
+            SkAAClip result;
+            result.op(clipA, clipB, gOps[j]);
+            SkMask mask;
+            result.copyToMask(&mask);
+
+            for (int y = 0; y < 100; ++y) {
+                for (int x = 0; x < 100; ++x) {
+                    unsigned a = clip_alpha(maskA, x, y);
+                    unsigned b = clip_alpha(maskB, x, y);
+                    unsigned expected;
+                    switch (gOps[j]) {
+                        case SkRegion::kIntersect_Op:
+                            expected = SkMulDiv255Round(a, b);
+                            break;
+                        case SkRegion::kDifference_Op:
+                            expected = SkMulDiv255Round(a, 0xFF - b);
+                            break;
+                        case SkRegion::kUnion_Op:
+                            expected = a + b - SkMulDiv255Round(a, b);
+                            break;
+                        case SkRegion::kXOR_Op:
+                            expected = a + b - 2 * SkMulDiv255Round(a, b);
+                            break;
+                        default:
+                            expected = SkMulDiv255Round(b, 0xFF - a);
+                            break;
+                    }
+                    REPORTER_ASSERT(reporter, clip_alpha(mask, x, y) == expected);
+                }
+            }
+            SkMask::FreeImage(mask.fImage);
+        }
+        SkMask::FreeImage(maskA.fImage);
+        SkMask::FreeImage(maskB.fImage);
+    }
+}
+
+// Records A8 masks (and opaque spans) into a 100x100 coverage buffer.
+class CoverageBlitter : public SkBlitter {
+public:
+    CoverageBlitter() { sk_bzero(fCoverage, sizeof(fCoverage)); }
+
+    void blitH(int x, int y, int width) override {
+        memset(&fCoverage[y][x], 0xFF, width);
+    }
+
+    void blitMask(const SkMask& mask, const SkIRect& clip) override {
+        SkASSERT(SkMask::kA8_Format == mask.fFormat);
+        for (int y = clip.fTop; y < clip.fBottom; ++y) {
+            memcpy(&fCoverage[y][clip.fLeft], mask.getAddr8(clip.fLeft, y), clip.width());
+        }
+    }
+
+    uint8_t fCoverage[100][100];
+};
+
+// SkAAClipBlitter::blitMask blits solid clip spans directly and merges the rest; both must
+// scale the mask exactly like SkMulDiv255Round. 3D masks are merged into A8 everywhere.
+static void test_blitmask(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    for (int i = 0; i < 20; ++i) {
+        SkAAClip clip;
+        make_rand_rrect_clip(&clip, rand);
+        SkMask clipMask;
+        clip.copyToMask(&clipMask);
+
+        SkMask mask;
+        mask.fFormat = (i & 1) ? SkMask::k3D_Format : SkMask::kA8_Format;
+        mask.fBounds.set(0, 0, 100, 100);
+        mask.fRowBytes = 100;
+        mask.fImage = SkMask::AllocImage(mask.computeTotalImageSize());
+        for (size_t j = 0; j < mask.computeTotalImageSize(); ++j) {
+            mask.fImage[j] = rand.nextU() & 0xFF;
+        }
+
+        CoverageBlitter coverage;
+        SkAAClipBlitter blitter;
+        blitter.init(&coverage, &clip);
+        SkIRect r = clip.getBounds();
+        blitter.blitMask(mask, r);
+
+        for (int y = r.fTop; y < r.fBottom; ++y) {
+            for (int x = r.fLeft; x < r.fRight; ++x) {
+                unsigned expected = SkMulDiv255Round(mask.fImage[y * mask.fRowBytes + x],
+                                                     clip_alpha(clipMask, x, y));
+                REPORTER_ASSERT(reporter, coverage.fCoverage[y][x] == expected);
+            }
+        }
+        SkMask::FreeImage(mask.fImage);
+        SkMask::FreeImage(clipMask.fImage);
+    }
+}
+
 DEF_TEST(AAClip, reporter) {
     test_empty(reporter);
     test_path_bounds(reporter);
@@ -444,4 +570,6 @@ DEF_TEST(AAClip, reporter) {
     test_nearly_integral(reporter);
     test_really_a_rect(reporter);
     test_crbug_422693(reporter);
+    test_aa_ops(reporter);
+    test_blitmask(reporter);
 }
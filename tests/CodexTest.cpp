@@ -8,7 +8,10 @@
 #include "Resources.h"
 #include "SkBitmap.h"
 #include "SkCodec.h"
+#include "SkData.h"
+#include "SkIncrementalCodec.h"
 #include "SkMD5.h"
+#include "SkRWBuffer.h"
 #include "Test.h"
 
 static SkStreamAsset* resource(const char path[]) {
@@ -219,3 +222,112 @@ DEF_TEST(Codec_Empty, r) {
     test_empty(r, "empty_images/zero-width.wbmp");
     test_empty(r, "empty_images/zero-height.wbmp");
 }
+
+// Feed the image to SkIncrementalCodec a few bytes at a time, and check that it ends up with
+// the same pixels as SkCodec, within tolerance.
+static void test_incremental(skiatest::Reporter* r, const char path[], int tolerance) {
+    SkAutoTDelete<SkStream> stream(resource(path));
+    if (!stream) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+    SkAutoTUnref<SkData> data(SkData::NewFromStream(stream, stream->getLength()));
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data));
+    if (!codec) {
+        ERRORF(r, "Unable to decode '%s'", path);
+        return;
+    }
+    SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType);
+    if (kOpaque_SkAlphaType != info.alphaType()) {
+        info = info.makeAlphaType(kPremul_SkAlphaType);
+    }
+    SkBitmap expected;
+    expected.allocPixels(info);
+    REPORTER_ASSERT(r, SkImageGenerator::kSuccess ==
+            codec->getPixels(info, expected.getPixels(), expected.rowBytes(), NULL, NULL, NULL));
+
+    const size_t kChunkSize = 97;
+    SkRWBuffer buffer;
+    SkAutoTDelete<SkIncrementalCodec> incremental;
+    SkIncrementalCodec::Result result = SkIncrementalCodec::kIncomplete_Result;
+    int rowsDecoded = 0;
+    for (size_t offset = 0; offset < data->size(); offset += kChunkSize) {
+        buffer.append(data->bytes() + offset, SkTMin(kChunkSize, data->size() - offset));
+        SkAutoTUnref<SkROBuffer> snapshot(buffer.newRBufferSnapshot());
+        if (!incremental) {
+            incremental.reset(SkIncrementalCodec::NewFromBuffer(snapshot));
+            if (!incremental) {
+                continue;
+            }
+        }
+        REPORTER_ASSERT(r, SkIncrementalCodec::kIncomplete_Result == result);
+        result = incremental->update(snapshot);
+        REPORTER_ASSERT(r, SkIncrementalCodec::kError_Result != result);
+        REPORTER_ASSERT(r, incremental->rowsDecoded() >= rowsDecoded);
+        rowsDecoded = incremental->rowsDecoded();
+    }
+    REPORTER_ASSERT(r, SkIncrementalCodec::kComplete_Result == result);
+    if (!incremental || !incremental->hasInfo()) {
+        ERRORF(r, "Unable to decode '%s' incrementally", path);
+        return;
+    }
+
+    const SkBitmap& bm = incremental->bitmap();
+    REPORTER_ASSERT(r, bm.info().dimensions() == info.dimensions());
+    REPORTER_ASSERT(r, incremental->rowsDecoded() == bm.height());
+    SkAutoLockPixels lockExpected(expected);
+    SkAutoLockPixels lock(bm);
+    int maxDiff = 0;
+    for (int y = 0; y < bm.height(); ++y) {
+        for (int x = 0; x < bm.width(); ++x) {
+            const SkPMColor c0 = *bm.getAddr32(x, y);
+            const SkPMColor c1 = *expected.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDiff = SkTMax(maxDiff, SkAbs32(((c0 >> shift) & 0xFF) -
+                                                  ((c1 >> shift) & 0xFF)));
+            }
+        }
+    }
+    if (maxDiff > tolerance) {
+        ERRORF(r, "'%s' decoded incrementally differs by %d", path, maxDiff);
+    }
+}
+
+DEF_TEST(Codec_incremental, r) {
+    // GIF
+    test_incremental(r, "box.gif", 0);
+    test_incremental(r, "color_wheel.gif", 0);
+    test_incremental(r, "randPixels.gif", 0);
+
+    // JPG (grayscale.jpg is progressive)
+    test_incremental(r, "CMYK.jpg", 1);
+    test_incremental(r, "color_wheel.jpg", 1);
+    test_incremental(r, "grayscale.jpg", 1);
+    test_incremental(r, "mandrill_512_q075.jpg", 1);
+
+    // PNG
+    test_incremental(r, "arrow.png", 0);
+    test_incremental(r, "half-transparent-white-pixel.png", 0);
+    test_incremental(r, "mandrill_128.png", 0);
+    test_incremental(r, "plane_interlaced.png", 0);
+    test_incremental(r, "yellow_rose.png", 0);
+
+    // Not an image we can decode.
+    SkRWBuffer buffer;
+    buffer.append("hello world", 11);
+    SkAutoTUnref<SkROBuffer> snapshot(buffer.newRBufferSnapshot());
+    REPORTER_ASSERT(r, NULL == SkIncrementalCodec::NewFromBuffer(snapshot));
+
+    // A 1x1 GIF whose LZW code size, 9, is more than GIF allows.
+    static const uint8_t kBadCodeSize[] = {
+        'G', 'I', 'F', '8', '9', 'a', 1, 0, 1, 0, 0x80, 0, 0,
+        0, 0, 0, 0xFF, 0xFF, 0xFF,
+        0x2C, 0, 0, 0, 0, 1, 0, 1, 0, 0,
+        9, 2, 0x00, 0x01, 0, 0x3B,
+    };
+    SkRWBuffer gifBuffer;
+    gifBuffer.append(kBadCodeSize, sizeof(kBadCodeSize));
+    SkAutoTUnref<SkROBuffer> gifSnapshot(gifBuffer.newRBufferSnapshot());
+    SkAutoTDelete<SkIncrementalCodec> gif(SkIncrementalCodec::NewFromBuffer(gifSnapshot));
+    REPORTER_ASSERT(r, gif && SkIncrementalCodec::kError_Result == gif->update(gifSnapshot));
+}
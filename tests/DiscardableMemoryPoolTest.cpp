@@ -33,3 +33,45 @@ DEF_TEST(DiscardableMemoryPool, reporter) {
     REPORTER_ASSERT(reporter, !dm2->lock());
     REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
 }
+
+DEF_TEST(DiscardableMemoryPool_Recycle, reporter) {
+    SkAutoTUnref<SkDiscardableMemoryPool> pool(
+        SkDiscardableMemoryPool::Create(100000, NULL));
+    SkDiscardableMemoryPool::Stats stats;
+
+    // Large blocks are rounded up to a size class.
+    SkAutoTDelete<SkDiscardableMemory> dm1(pool->create(20000));
+    REPORTER_ASSERT(reporter, 20480 == pool->getRAMUsed());
+    dm1->unlock();
+
+    // Going over budget purges dm1, whose slab is kept for reuse.
+    SkAutoTDelete<SkDiscardableMemory> dm2(pool->create(90000));
+    REPORTER_ASSERT(reporter, 98304 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, !dm1->lock());
+    pool->getStats(&stats);
+    REPORTER_ASSERT(reporter, 1 == stats.fPurges);
+    REPORTER_ASSERT(reporter, 1 == stats.fMisses);
+    REPORTER_ASSERT(reporter, 20480 == stats.fBytesRecycled);
+
+    // Another block of the same size class reuses that slab.
+    SkAutoTDelete<SkDiscardableMemory> dm3(pool->create(19000));
+    pool->getStats(&stats);
+    REPORTER_ASSERT(reporter, 1 == stats.fRecycles);
+    REPORTER_ASSERT(reporter, 0 == stats.fBytesRecycled);
+    REPORTER_ASSERT(reporter, 98304 + 20480 == stats.fBytesUsed);
+
+    // dm2's slab is too big to keep within a quarter of the budget, so it is freed.
+    dm2->unlock();
+    dm3->unlock();
+    REPORTER_ASSERT(reporter, 20480 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, dm3->lock());
+    dm3->unlock();
+    pool->getStats(&stats);
+    REPORTER_ASSERT(reporter, 2 == stats.fPurges);
+    REPORTER_ASSERT(reporter, 1 == stats.fHits);
+    REPORTER_ASSERT(reporter, 0 == stats.fBytesRecycled);
+
+    pool->resetStats();
+    pool->getStats(&stats);
+    REPORTER_ASSERT(reporter, 0 == stats.fHits && 0 == stats.fMisses && 0 == stats.fPurges);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkDistanceFieldGen.h"
+#include "SkGlyphCache.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "Test.h"
+
+static void check_same_field(skiatest::Reporter* reporter, const unsigned char* image,
+                             int width, int height, size_t rowBytes) {
+    size_t size = SkComputeDistanceFieldSize(width, height);
+    SkAutoTMalloc<unsigned char> simd(size);
+    SkAutoTMalloc<unsigned char> scalar(size);
+    REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(simd.get(), image,
+                                                                 width, height, rowBytes));
+    REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8ImageNoSIMD(scalar.get(), image,
+                                                                       width, height, rowBytes));
+    REPORTER_ASSERT(reporter, 0 == memcmp(simd.get(), scalar.get(), size));
+}
+
+// The SIMD passes must produce exactly the field the scalar ones do, for glyphs of every size
+// and for paths whose widths leave the vector loops with leftover texels.
+DEF_TEST(DistanceFieldGen_SIMD, reporter) {
+    static const SkScalar kTextSizes[] = { 12, 24, 40, 72 };
+    static const char kText[] = "Skia@&gWQ%";
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kTextSizes); ++i) {
+        paint.setTextSize(kTextSizes[i]);
+        SkAutoGlyphCache autoCache(paint, NULL, NULL);
+        SkGlyphCache* cache = autoCache.getCache();
+        for (const char* c = kText; *c; ++c) {
+            const SkGlyph& glyph = cache->getUnicharMetrics(*c);
+            const void* image = cache->findImage(glyph);
+            if (NULL == image || SkMask::kA8_Format != glyph.fMaskFormat) {
+                continue;
+            }
+            check_same_field(reporter, (const unsigned char*)image, glyph.fWidth, glyph.fHeight,
+                             glyph.rowBytes());
+        }
+    }
+
+    for (int size = 5; size < 40; size += 3) {
+        SkBitmap mask;
+        mask.allocPixels(SkImageInfo::MakeA8(size, size + 2));
+        mask.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas canvas(mask);
+        SkPath path;
+        path.moveTo(0.5f, 1.25f);
+        path.lineTo(size - 1.5f, size * 0.5f);
+        path.lineTo(size * 0.3f, size + 1.0f);
+        path.addCircle(size * 0.5f, size * 0.5f, size * 0.2f);
+        canvas.drawPath(path, paint);
+        SkAutoLockPixels lock(mask);
+        check_same_field(reporter, (const unsigned char*)mask.getPixels(), mask.width(),
+                         mask.height(), mask.rowBytes());
+    }
+}
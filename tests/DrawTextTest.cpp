@@ -8,6 +8,7 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkColor.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkPoint.h"
 #include "SkRect.h"
@@ -106,3 +107,65 @@ DEF_TEST(DrawText, reporter) {
         }
     }
 }
+
+// Long runs of glyph IDs have their images prefetched before the blit loop; make sure they
+// come out the same as glyphs that were scaled one at a time.
+DEF_TEST(DrawTextPrefetch, reporter) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLACK);
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(24));
+
+    const char text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+    const size_t len = sizeof(text) - 1;
+    SkTDArray<uint16_t> glyphs;
+    glyphs.setCount(paint.textToGlyphs(text, len, NULL));
+    paint.textToGlyphs(text, len, glyphs.begin());
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    SkTDArray<SkPoint> pos;
+    pos.setCount(glyphs.count());
+    for (int i = 0; i < glyphs.count(); ++i) {
+        pos[i].set(SkIntToScalar(4 + 24 * (i % 16)), SkIntToScalar(28 + 32 * (i / 16)));
+    }
+
+    SkIRect rect = SkIRect::MakeWH(400, 32 * (glyphs.count() / 16 + 1));
+    SkBitmap oneAtATimeBitmap;
+    create(&oneAtATimeBitmap, rect);
+    SkCanvas oneAtATimeCanvas(oneAtATimeBitmap);
+    SkBitmap prefetchedBitmap;
+    create(&prefetchedBitmap, rect);
+    SkCanvas prefetchedCanvas(prefetchedBitmap);
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&oneAtATimeCanvas);
+    for (int i = 0; i < glyphs.count(); ++i) {
+        oneAtATimeCanvas.drawPosText(&glyphs[i], sizeof(uint16_t), &pos[i], paint);
+    }
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&prefetchedCanvas);
+    prefetchedCanvas.drawPosText(glyphs.begin(), glyphs.count() * sizeof(uint16_t),
+                                 pos.begin(), paint);
+
+    REPORTER_ASSERT(reporter, compare(oneAtATimeBitmap, rect, prefetchedBitmap, rect));
+
+    // Only the glyphs inside the clip are prefetched; the ones it cuts through still draw the same.
+    SkRect clip = SkRect::MakeXYWH(SkIntToScalar(50), SkIntToScalar(10),
+                                   SkIntToScalar(200), SkIntToScalar(40));
+    oneAtATimeCanvas.clipRect(clip);
+    prefetchedCanvas.clipRect(clip);
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&oneAtATimeCanvas);
+    for (int i = 0; i < glyphs.count(); ++i) {
+        oneAtATimeCanvas.drawPosText(&glyphs[i], sizeof(uint16_t), &pos[i], paint);
+    }
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&prefetchedCanvas);
+    prefetchedCanvas.drawPosText(glyphs.begin(), glyphs.count() * sizeof(uint16_t),
+                                 pos.begin(), paint);
+
+    REPORTER_ASSERT(reporter, compare(oneAtATimeBitmap, rect, prefetchedBitmap, rect));
+}
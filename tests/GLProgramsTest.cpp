@@ -21,8 +21,11 @@
 #include "GrResourceProvider.h"
 #include "GrTest.h"
 #include "GrXferProcessor.h"
+#include "SkCanvas.h"
 #include "SkChecksum.h"
+#include "SkData.h"
 #include "SkRandom.h"
+#include "SkSurface.h"
 #include "Test.h"
 #include "effects/GrConfigConversionEffect.h"
 #include "effects/GrPorterDuffXferProcessor.h"
@@ -322,4 +325,90 @@ DEF_GPUTEST(GLPrograms, reporter, factory) {
     }
 }
 
+namespace {
+// Remembers everything stored in it, like a cache that persists across processes would.
+class TestPersistentCache : public GrContextOptions::PersistentCache {
+public:
+    TestPersistentCache() : fLoads(0) {}
+
+    ~TestPersistentCache() {
+        fKeys.unrefAll();
+        fData.unrefAll();
+    }
+
+    SkData* load(const SkData& key) override {
+        ++fLoads;
+        for (int i = 0; i < fKeys.count(); ++i) {
+            if (fKeys[i]->equals(&key)) {
+                return SkRef(fData[i]);
+            }
+        }
+        return NULL;
+    }
+
+    void store(const SkData& key, const SkData& data) override {
+        for (int i = 0; i < fKeys.count(); ++i) {
+            if (fKeys[i]->equals(&key)) {
+                fData[i]->unref();
+                fData[i] = SkData::NewWithCopy(data.data(), data.size());
+                return;
+            }
+        }
+        *fKeys.append() = SkData::NewWithCopy(key.data(), key.size());
+        *fData.append() = SkData::NewWithCopy(data.data(), data.size());
+    }
+
+    SkTDArray<SkData*> fKeys;
+    SkTDArray<SkData*> fData;
+    int fLoads;
+};
+}
+
+static void draw_something(GrContext* context) {
+    SkImageInfo info = SkImageInfo::MakeN32Premul(64, 64);
+    SkAutoTUnref<SkSurface> surface(SkSurface::NewRenderTarget(context, SkSurface::kNo_Budgeted,
+                                                               info, 0));
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    surface->getCanvas()->drawCircle(32, 32, 20, paint);
+    context->flush();
+}
+
+DEF_GPUTEST(GLProgramsPersistentCache, reporter, factory) {
+    for (int type = 0; type < GrContextFactory::kGLContextTypeCnt; ++type) {
+        GrContextFactory::GLContextType glType = static_cast<GrContextFactory::GLContextType>(type);
+        TestPersistentCache cache;
+        GrContextOptions opts;
+        opts.fSuppressPrints = true;
+        opts.fPersistentCache = &cache;
+
+        {
+            GrContextFactory cacheFactory(opts);
+            GrContext* context = cacheFactory.get(glType);
+            if (!context) {
+                continue;
+            }
+            draw_something(context);
+            // Only programs the driver can hand back as binaries are worth storing.
+            GrGLGpu* gpu = static_cast<GrGLGpu*>(context->getGpu());
+            REPORTER_ASSERT(reporter, gpu->glCaps().programBinarySupport() ==
+                                      (cache.fKeys.count() > 0));
+        }
+        if (0 == cache.fKeys.count()) {
+            continue;
+        }
+
+        // A fresh context can link everything the first one stored ahead of time.
+        GrContextFactory cacheFactory(opts);
+        GrContext* context = cacheFactory.get(glType);
+        int warmed = context->warmUpProgramCache(cache.fKeys.begin(), cache.fKeys.count());
+        REPORTER_ASSERT(reporter, warmed == cache.fKeys.count());
+
+        // Programs built after warming up don't go back to the persistent cache.
+        int loads = cache.fLoads;
+        draw_something(context);
+        REPORTER_ASSERT(reporter, loads == cache.fLoads);
+    }
+}
+
 #endif
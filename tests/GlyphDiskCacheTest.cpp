@@ -0,0 +1,170 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphCache.h"
+#include "SkGlyphDiskCache.h"
+#include "SkOSFile.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkTaskGroup.h"
+#include "Test.h"
+
+#include <stdio.h>
+
+// Glyphs written by one store should come back from the next one to map the file, and a
+// small byte limit should keep the file small.
+DEF_TEST(GlyphDiskCache, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "glyph_disk_cache_test");
+    remove(path.c_str());
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(24));
+
+    SkAutoGlyphCache autoCache(paint, NULL, NULL);
+    SkGlyphCache* cache = autoCache.getCache();
+    const SkDescriptor* desc = &cache->getDescriptor();
+    SkTypeface* typeface = cache->getScalerContext()->getTypeface();
+
+    uint16_t glyphIDs[16];
+    const int count = SkTMin<int>(SK_ARRAY_COUNT(glyphIDs), typeface->countGlyphs());
+    for (int i = 0; i < count; ++i) {
+        glyphIDs[i] = i;
+    }
+
+    {
+        SkGlyphDiskCache store(path.c_str(), 1 << 20);
+        SkGlyphDiskCache::Strike* strike = store.findStrike(desc, typeface);
+        if (NULL == strike) {
+            // The default typeface doesn't have a 'head' table to fingerprint it with.
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            const SkGlyph& glyph = cache->getGlyphIDMetrics(glyphIDs[i]);
+            SkGlyph probe;
+            probe.initWithGlyphID(glyphIDs[i]);
+            REPORTER_ASSERT(reporter, !store.findMetrics(strike, &probe));
+            store.addMetrics(strike, glyph);
+            if (cache->findImage(glyph)) {
+                store.addImage(strike, glyph);
+            }
+            if (cache->findPath(glyph)) {
+                store.addPath(strike, glyph);
+            }
+        }
+        REPORTER_ASSERT(reporter, store.flush());
+    }
+
+    SkGlyphDiskCache store(path.c_str(), 1 << 20);
+    SkGlyphDiskCache::Stats stats;
+    store.getStats(&stats);
+    REPORTER_ASSERT(reporter, stats.fGlyphsOnDisk > 0);
+    SkGlyphDiskCache::Strike* strike = store.findStrike(desc, typeface);
+    REPORTER_ASSERT(reporter, strike);
+    for (int i = 0; i < count; ++i) {
+        const SkGlyph& glyph = cache->getGlyphIDMetrics(glyphIDs[i]);
+        SkGlyph loaded;
+        loaded.initWithGlyphID(glyphIDs[i]);
+        REPORTER_ASSERT(reporter, store.findMetrics(strike, &loaded));
+        REPORTER_ASSERT(reporter, loaded.fAdvanceX == glyph.fAdvanceX &&
+                                  loaded.fAdvanceY == glyph.fAdvanceY &&
+                                  loaded.fWidth == glyph.fWidth &&
+                                  loaded.fHeight == glyph.fHeight &&
+                                  loaded.fTop == glyph.fTop &&
+                                  loaded.fLeft == glyph.fLeft &&
+                                  loaded.fMaskFormat == glyph.fMaskFormat);
+        if (glyph.fImage) {
+            const size_t size = glyph.computeImageSize();
+            SkAutoTMalloc<uint8_t> image(size);
+            loaded.fImage = image.get();
+            REPORTER_ASSERT(reporter, store.findImage(strike, loaded));
+            REPORTER_ASSERT(reporter, 0 == memcmp(image.get(), glyph.fImage, size));
+        }
+        if (glyph.fPath) {
+            SkPath loadedPath;
+            REPORTER_ASSERT(reporter, store.findPath(strike, loaded, &loadedPath));
+            REPORTER_ASSERT(reporter, loadedPath == *glyph.fPath);
+        }
+    }
+
+    // Stores flushing the same file at once must each write their own temporary file, so the
+    // file that ends up in place is always a complete one.
+    {
+        struct FlushTask {
+            const char*            fPath;
+            const SkDescriptor*    fDesc;
+            SkTypeface*            fTypeface;
+            SkGlyphCache*          fCache;
+            const uint16_t*        fGlyphIDs;
+            int                    fCount;
+            bool                   fFlushed;
+
+            static void Run(FlushTask* task) {
+                SkGlyphDiskCache store(task->fPath, 1 << 20);
+                SkGlyphDiskCache::Strike* strike = store.findStrike(task->fDesc,
+                                                                    task->fTypeface);
+                for (int i = 0; strike && i < task->fCount; ++i) {
+                    SkGlyph glyph;
+                    glyph.initWithGlyphID(task->fGlyphIDs[i]);
+                    if (store.findMetrics(strike, &glyph)) {
+                        store.addMetrics(strike, glyph);
+                    }
+                }
+                task->fFlushed = store.flush();
+            }
+        };
+        FlushTask tasks[8];
+        for (int i = 0; i < (int)SK_ARRAY_COUNT(tasks); ++i) {
+            FlushTask task = { path.c_str(), desc, typeface, cache, glyphIDs, count, false };
+            tasks[i] = task;
+        }
+        SkTaskGroup tg;
+        tg.batch(FlushTask::Run, tasks, SK_ARRAY_COUNT(tasks));
+        tg.wait();
+        for (int i = 0; i < (int)SK_ARRAY_COUNT(tasks); ++i) {
+            REPORTER_ASSERT(reporter, tasks[i].fFlushed);
+        }
+
+        SkGlyphDiskCache reread(path.c_str(), 1 << 20);
+        reread.getStats(&stats);
+        REPORTER_ASSERT(reporter, stats.fGlyphsOnDisk > 0);
+        SkGlyphDiskCache::Strike* rereadStrike = reread.findStrike(desc, typeface);
+        for (int i = 0; rereadStrike && i < count; ++i) {
+            SkGlyph loaded;
+            loaded.initWithGlyphID(glyphIDs[i]);
+            REPORTER_ASSERT(reporter, reread.findMetrics(rereadStrike, &loaded));
+            REPORTER_ASSERT(reporter,
+                            loaded.fAdvanceX == cache->getGlyphIDMetrics(glyphIDs[i]).fAdvanceX);
+        }
+
+        // None of them left a temporary file behind.
+        SkString tmpPrefix = SkOSPath::Basename(path.c_str());
+        tmpPrefix.append(".");
+        SkOSFile::Iter iter(tmpDir.c_str(), ".tmp");
+        SkString name;
+        while (iter.next(&name)) {
+            REPORTER_ASSERT(reporter, !name.startsWith(tmpPrefix.c_str()));
+        }
+    }
+
+    // Compacting to a tiny limit keeps only what fits.
+    const size_t kSmallLimit = 1024;
+    {
+        SkGlyphDiskCache small(path.c_str(), kSmallLimit);
+        REPORTER_ASSERT(reporter, small.flush());
+    }
+    {
+        SkGlyphDiskCache small(path.c_str(), kSmallLimit);
+        small.getStats(&stats);
+        REPORTER_ASSERT(reporter, stats.fBytesOnDisk <= kSmallLimit);
+    }
+    remove(path.c_str());
+}
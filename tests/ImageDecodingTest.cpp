@@ -753,3 +753,108 @@ DEF_TEST(ImageDecoding_JpegOverwrite, r) {
     REPORTER_ASSERT(r, !allocator->ready());  // Decoder used correct memory
     REPORTER_ASSERT(r, sentinal == pixels[pixelCount]);
 }
+
+#if !defined(SK_BUILD_FOR_MAC) && !defined(SK_BUILD_FOR_IOS) && !defined(SK_BUILD_FOR_WIN)
+// Every preset, serial or in parallel bands, should give back the pixels it was given.
+DEF_TEST(ImageDecoding_PNGEncoderOptions, r) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(1024, 768, true);
+    SkCanvas canvas(bitmap);
+    const SkPoint pts[] = { { 0, 0 }, { 1024, 768 } };
+    const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    SkPaint paint;
+    paint.setShader(SkGradientShader::CreateLinear(pts, colors, NULL, SK_ARRAY_COUNT(colors),
+                                                   SkShader::kClamp_TileMode))->unref();
+    canvas.drawPaint(paint);
+    paint.setShader(NULL);
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorWHITE);
+    canvas.drawCircle(512, 384, 300, paint);
+
+    for (int preset = SkPNGEncoderOptions::kFastest_Preset;
+         preset <= SkPNGEncoderOptions::kSmallest_Preset; ++preset) {
+        for (int parallel = 0; parallel < 2; ++parallel) {
+            SkPNGEncoderOptions options((SkPNGEncoderOptions::Preset)preset);
+            options.fParallel = SkToBool(parallel);
+            SkAutoTDelete<SkImageEncoder> encoder(CreatePNGImageEncoder(options));
+            SkAutoTUnref<SkData> data(encoder->encodeData(bitmap, SkImageEncoder::kDefaultQuality));
+            REPORTER_ASSERT(r, data);
+            if (!data) {
+                continue;
+            }
+            SkBitmap decoded;
+            REPORTER_ASSERT(r, SkImageDecoder::DecodeMemory(data->data(), data->size(), &decoded,
+                                                            kN32_SkColorType,
+                                                            SkImageDecoder::kDecodePixels_Mode));
+            if (decoded.width() != bitmap.width() || decoded.height() != bitmap.height()) {
+                ERRORF(r, "preset %d parallel %d decoded to the wrong size", preset, parallel);
+                continue;
+            }
+            SkAutoLockPixels alp0(bitmap), alp1(decoded);
+            bool same = true;
+            for (int y = 0; y < bitmap.height() && same; ++y) {
+                same = 0 == memcmp(bitmap.getAddr(0, y), decoded.getAddr(0, y),
+                                   bitmap.width() * sizeof(SkPMColor));
+            }
+            REPORTER_ASSERT(r, same);
+        }
+    }
+}
+#endif
+
+// Only the libpng and libjpeg encoders write rows; the CG and WIC ones don't.
+#if defined(SK_BUILD_FOR_ANDROID) || defined(SK_BUILD_FOR_UNIX)
+// Encoding a band of rows at a time should give the same bytes as encoding the whole bitmap.
+DEF_TEST(ImageEncoder_rows, r) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(300, 200);
+    SkCanvas canvas(bitmap);
+    canvas.clear(0x80FF8000);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorBLUE);
+    canvas.drawCircle(150, 100, 80, paint);
+
+    const SkImageEncoder::Type types[] = { SkImageEncoder::kPNG_Type, SkImageEncoder::kJPEG_Type };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(types); ++i) {
+        SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(types[i]));
+        if (!encoder) {
+            continue;
+        }
+        SkAutoTUnref<SkData> expected(encoder->encodeData(bitmap, 90));
+        SkDynamicMemoryWStream stream;
+        SkAutoTDelete<SkImageEncoder::RowWriter> writer(
+                encoder->beginRows(&stream, bitmap.info(), 90));
+        REPORTER_ASSERT(r, writer);
+        if (!writer) {
+            continue;
+        }
+        SkAutoLockPixels alp(bitmap);
+        const int kBandHeight = 64;
+        for (int y = 0; y < bitmap.height(); y += kBandHeight) {
+            const int rows = SkTMin(kBandHeight, bitmap.height() - y);
+            REPORTER_ASSERT(r, writer->writeRows(bitmap.getAddr(0, y), bitmap.rowBytes(), rows));
+        }
+        REPORTER_ASSERT(r, writer->finish());
+        // No more rows fit.
+        REPORTER_ASSERT(r, !writer->writeRows(bitmap.getPixels(), bitmap.rowBytes(), 1));
+
+        SkAutoTUnref<SkData> actual(stream.copyToData());
+        REPORTER_ASSERT(r, expected && actual->equals(expected));
+    }
+
+    // A writer that didn't get all of its rows fails to finish.
+    SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+    if (encoder) {
+        SkDynamicMemoryWStream stream;
+        SkAutoTDelete<SkImageEncoder::RowWriter> writer(
+                encoder->beginRows(&stream, bitmap.info(), 90));
+        REPORTER_ASSERT(r, writer);
+        if (writer) {
+            SkAutoLockPixels alp(bitmap);
+            REPORTER_ASSERT(r, writer->writeRows(bitmap.getPixels(), bitmap.rowBytes(), 10));
+            REPORTER_ASSERT(r, !writer->finish());
+        }
+    }
+}
+#endif  // SK_BUILD_FOR_ANDROID || SK_BUILD_FOR_UNIX
@@ -6,8 +6,11 @@
  */
 
 #include "SkCachedData.h"
+#include "SkCanvas.h"
 #include "SkMaskCache.h"
+#include "SkPath.h"
 #include "SkResourceCache.h"
+#include "SkStrokeRec.h"
 #include "Test.h"
 
 enum LockedState {
@@ -104,3 +107,90 @@ DEF_TEST(RectsMaskCache, reporter) {
     check_data(reporter, data, 1, kNotInCache, kLocked);
     data->unref();
 }
+
+DEF_TEST(PathMaskCache, reporter) {
+    SkResourceCache cache(1024);
+
+    SkPath path;
+    path.addCircle(50, 50, 40);
+    SkMatrix matrix;
+    matrix.setScale(2, 2);
+    matrix.postTranslate(0.25f, 0.5f);
+    SkStrokeRec stroke(SkStrokeRec::kFill_InitStyle);
+    SkMask mask;
+
+    SkCachedData* data = SkMaskCache::FindAndRef(path, matrix, stroke, &mask, &cache);
+    REPORTER_ASSERT(reporter, NULL == data);
+
+    size_t size = 256;
+    data = cache.newCachedData(size);
+    memset(data->writable_data(), 0xff, size);
+    mask.fBounds.setXYWH(0, 0, 16, 16);
+    mask.fRowBytes = 16;
+    mask.fFormat = SkMask::kA8_Format;
+    SkMaskCache::Add(path, matrix, stroke, mask, data, &cache);
+    check_data(reporter, data, 2, kInCache, kLocked);
+
+    data->unref();
+    check_data(reporter, data, 1, kInCache, kUnlocked);
+
+    // A different subpixel offset, stroke, or path is a different mask.
+    SkMatrix otherMatrix(matrix);
+    otherMatrix.setTranslateX(0.5f);
+    REPORTER_ASSERT(reporter, NULL == SkMaskCache::FindAndRef(path, otherMatrix, stroke,
+                                                              &mask, &cache));
+    SkStrokeRec hairline(SkStrokeRec::kHairline_InitStyle);
+    REPORTER_ASSERT(reporter, NULL == SkMaskCache::FindAndRef(path, matrix, hairline,
+                                                              &mask, &cache));
+    SkPath otherPath(path);
+    otherPath.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, NULL == SkMaskCache::FindAndRef(otherPath, matrix, stroke,
+                                                              &mask, &cache));
+
+    sk_bzero(&mask, sizeof(mask));
+    data = SkMaskCache::FindAndRef(path, matrix, stroke, &mask, &cache);
+    REPORTER_ASSERT(reporter, data);
+    REPORTER_ASSERT(reporter, data->size() == size);
+    REPORTER_ASSERT(reporter, mask.fBounds.right() == 16 && mask.fBounds.bottom() == 16);
+    REPORTER_ASSERT(reporter, data->data() == (const void*)mask.fImage);
+    check_data(reporter, data, 2, kInCache, kLocked);
+
+    cache.purgeAll();
+    check_data(reporter, data, 1, kNotInCache, kLocked);
+    data->unref();
+}
+
+static void make_star(SkPath* path, SkScalar cx, SkScalar cy, SkScalar radius) {
+    path->moveTo(cx + radius, cy);
+    for (int i = 1; i < 40; ++i) {
+        SkScalar r = (i & 1) ? radius / 2 : radius;
+        SkScalar angle = i * SK_ScalarPI / 20;
+        path->lineTo(cx + r * SkScalarCos(angle), cy + r * SkScalarSin(angle));
+    }
+    path->close();
+}
+
+// Drawing a complex anti-aliased path caches its mask, unless the mask would be too big.
+DEF_TEST(PathMaskCache_Draw, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(600, 600);
+    SkCanvas canvas(bitmap);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    const SkStrokeRec stroke(paint);
+    SkMask mask;
+
+    SkPath small;
+    make_star(&small, 50, 50, 40);
+    canvas.drawPath(small, paint);
+    SkCachedData* data = SkMaskCache::FindAndRef(small, SkMatrix::I(), stroke, &mask);
+    REPORTER_ASSERT(reporter, data);
+    if (data) {
+        data->unref();
+    }
+
+    SkPath big;
+    make_star(&big, 300, 300, 280);
+    canvas.drawPath(big, paint);
+    REPORTER_ASSERT(reporter, NULL == SkMaskCache::FindAndRef(big, SkMatrix::I(), stroke, &mask));
+}
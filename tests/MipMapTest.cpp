@@ -53,3 +53,73 @@ DEF_TEST(MipMap, reporter) {
         }
     }
 }
+
+static uint32_t naive_average(const SkBitmap& bm, int x, int y, int shift) {
+    unsigned sum = 0;
+    sum += (*bm.getAddr32(x,     y)     >> shift) & 0xFF;
+    sum += (*bm.getAddr32(x + 1, y)     >> shift) & 0xFF;
+    sum += (*bm.getAddr32(x,     y + 1) >> shift) & 0xFF;
+    sum += (*bm.getAddr32(x + 1, y + 1) >> shift) & 0xFF;
+    return (sum >> 2) << shift;
+}
+
+// The first level must be the exact (truncated) 2x2 box average of the source, whichever
+// path (vectorized or not) produced each pixel.
+DEF_TEST(MipMap_Values, reporter) {
+    SkRandom rand;
+    for (int i = 0; i < 50; ++i) {
+        SkBitmap bm;
+        bm.allocN32Pixels(2 + rand.nextU() % 100, 2 + rand.nextU() % 100);
+        for (int y = 0; y < bm.height(); ++y) {
+            for (int x = 0; x < bm.width(); ++x) {
+                *bm.getAddr32(x, y) = rand.nextU();
+            }
+        }
+
+        SkAutoTUnref<SkMipMap> mm(SkMipMap::Build(bm, NULL));
+        SkMipMap::Level level;
+        REPORTER_ASSERT(reporter, mm->extractLevel(SK_ScalarHalf, &level));
+        REPORTER_ASSERT(reporter, level.fWidth == (uint32_t)bm.width() / 2);
+        REPORTER_ASSERT(reporter, level.fHeight == (uint32_t)bm.height() / 2);
+
+        for (uint32_t y = 0; y < level.fHeight; ++y) {
+            const uint32_t* row = (const uint32_t*)((const char*)level.fPixels +
+                                                    y * level.fRowBytes);
+            for (uint32_t x = 0; x < level.fWidth; ++x) {
+                uint32_t expected = naive_average(bm, 2*x, 2*y,  0) |
+                                    naive_average(bm, 2*x, 2*y,  8) |
+                                    naive_average(bm, 2*x, 2*y, 16) |
+                                    naive_average(bm, 2*x, 2*y, 24);
+                REPORTER_ASSERT(reporter, row[x] == expected);
+            }
+        }
+    }
+}
+
+DEF_TEST(MipMap_PartialBuild, reporter) {
+    SkBitmap bm;
+    bm.allocN32Pixels(256, 256);
+    bm.eraseColor(SK_ColorWHITE);
+
+    SkAutoTUnref<SkMipMap> full(SkMipMap::Build(bm, NULL));
+    REPORTER_ASSERT(reporter, full->countLevels() == SkMipMap::ComputeLevelCount(256, 256));
+    REPORTER_ASSERT(reporter, 8 == full->countLevels());
+
+    SkAutoTUnref<SkMipMap> partial(SkMipMap::Build(bm, NULL, 2));
+    REPORTER_ASSERT(reporter, 2 == partial->countLevels());
+    REPORTER_ASSERT(reporter, partial->size() < full->size());
+    REPORTER_ASSERT(reporter, partial->hasLevels(2));
+    REPORTER_ASSERT(reporter, !partial->hasLevels(3));
+    REPORTER_ASSERT(reporter, full->hasLevels(100));
+
+    REPORTER_ASSERT(reporter, 0 == SkMipMap::ComputeLevel(SK_Scalar1));
+    REPORTER_ASSERT(reporter, 1 == SkMipMap::ComputeLevel(SK_ScalarHalf));
+    REPORTER_ASSERT(reporter, 2 == SkMipMap::ComputeLevel(SK_Scalar1 / 4));
+
+    // Asking for a deeper level than was built clamps to the deepest one we have.
+    SkMipMap::Level level;
+    REPORTER_ASSERT(reporter, partial->extractLevel(SK_Scalar1 / 16, &level));
+    REPORTER_ASSERT(reporter, 64 == level.fWidth);
+
+    REPORTER_ASSERT(reporter, NULL == SkMipMap::Build(bm, NULL, 0));
+}
@@ -369,3 +369,45 @@ DEF_TEST(Paint_nothingToDraw, r) {
     REPORTER_ASSERT(r, !paint.nothingToDraw());
 }
 
+
+// The measurements served from SkTextMeasureCache (no bounds asked for) should match the ones
+// measured glyph by glyph (bounds asked for), the first time and the second.
+DEF_TEST(Paint_measureTextCache, r) {
+    static const char* gTexts[] = { "Hamburgefons", "Ave", "To", "x", "Wavy Tavern" };
+    const size_t count = SK_ARRAY_COUNT(gTexts);
+    size_t lengths[count];
+    for (size_t i = 0; i < count; ++i) {
+        lengths[i] = strlen(gTexts[i]);
+    }
+
+    SkPaint paint;
+    for (int devKern = 0; devKern < 2; ++devKern) {
+        for (int size = 0; size < 2; ++size) {
+            paint.setDevKernText(SkToBool(devKern));
+            // The big size makes SkCanonicalizePaint measure at another size and scale.
+            paint.setTextSize(size ? SkIntToScalar(400) : SkIntToScalar(17));
+            for (int pass = 0; pass < 2; ++pass) {
+                SkScalar batched[count];
+                paint.measureTexts(count, (const void* const*)gTexts, lengths, batched);
+                for (size_t i = 0; i < count; ++i) {
+                    SkRect bounds;
+                    const SkScalar expected = paint.measureText(gTexts[i], lengths[i], &bounds);
+                    ASSERT(expected == paint.measureText(gTexts[i], lengths[i]));
+                    ASSERT(expected == batched[i]);
+
+                    SkScalar widths[32], expectedWidths[32];
+                    SkRect rects[32];
+                    const int n = paint.getTextWidths(gTexts[i], lengths[i], widths);
+                    ASSERT(n == paint.getTextWidths(gTexts[i], lengths[i], expectedWidths, rects));
+                    ASSERT(0 == memcmp(widths, expectedWidths, n * sizeof(SkScalar)));
+
+                    SkScalar measured;
+                    ASSERT(lengths[i] == paint.breakText(gTexts[i], lengths[i],
+                                                         expected + 1, &measured));
+                    ASSERT(SkScalarNearlyEqual(measured, expected));
+                    ASSERT(0 == paint.breakText(gTexts[i], lengths[i], widths[0] / 2, &measured));
+                }
+            }
+        }
+    }
+}
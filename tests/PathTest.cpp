@@ -6,6 +6,7 @@
  */
 
 #include "SkCanvas.h"
+#include "SkFloatBits.h"
 #include "SkPaint.h"
 #include "SkParse.h"
 #include "SkParsePath.h"
@@ -2157,6 +2158,133 @@ static void test_flattening(skiatest::Reporter* reporter) {
     }
 }
 
+static void test_compact_flattening(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    SkPath p;
+    p.setFillType(SkPath::kEvenOdd_FillType);
+    for (int i = 0; i < 8; ++i) {
+        p.moveTo(rand.nextRangeF(-1000, 1000), rand.nextRangeF(-1000, 1000));
+        for (int j = 0; j < 20; ++j) {
+            p.lineTo(rand.nextRangeF(-1000, 1000), rand.nextRangeF(-1000, 1000));
+        }
+        p.quadTo(1.5f, 2.25f, -3, 4);
+        p.conicTo(10, 10, 20, 0, 0.7071f);
+        p.cubicTo(1e-20f, -1e5f, 0.1f, 0.2f, 1, 2);
+        p.close();
+    }
+
+    // Lossless: the path reads back exactly, and is smaller than with writeToMemory().
+    size_t size = p.writeCompactToMemory(NULL);
+    REPORTER_ASSERT(reporter, SkAlign4(size) == size);
+    REPORTER_ASSERT(reporter, size < p.writeToMemory(NULL));
+    SkAutoMalloc storage(size);
+    REPORTER_ASSERT(reporter, size == p.writeCompactToMemory(storage.get()));
+
+    SkPath exact;
+    REPORTER_ASSERT(reporter, size == exact.readFromMemory(storage.get(), size));
+    REPORTER_ASSERT(reporter, exact == p);
+    REPORTER_ASSERT(reporter, exact.getBounds() == p.getBounds());
+    REPORTER_ASSERT(reporter, exact.getSegmentMasks() == p.getSegmentMasks());
+
+    // Every truncation is rejected.
+    for (size_t length = 0; length < size; ++length) {
+        SkPath tooShort;
+        REPORTER_ASSERT(reporter, 0 == tooShort.readFromMemory(storage.get(), length));
+        REPORTER_ASSERT(reporter, tooShort.isEmpty());
+    }
+
+    // With a tolerance, every point moves by no more than it.
+    const SkScalar kTolerance = 0.01f;
+    size_t gridSize = p.writeCompactToMemory(NULL, kTolerance);
+    REPORTER_ASSERT(reporter, gridSize < size);
+    SkAutoMalloc gridStorage(gridSize);
+    p.writeCompactToMemory(gridStorage.get(), kTolerance);
+    SkPath grid;
+    REPORTER_ASSERT(reporter, gridSize == grid.readFromMemory(gridStorage.get(), gridSize));
+    REPORTER_ASSERT(reporter, grid.countVerbs() == p.countVerbs());
+    REPORTER_ASSERT(reporter, grid.countPoints() == p.countPoints());
+    REPORTER_ASSERT(reporter, grid.getFillType() == p.getFillType());
+    for (int i = 0; i < p.countPoints(); ++i) {
+        SkPoint a = p.getPoint(i);
+        SkPoint b = grid.getPoint(i);
+        REPORTER_ASSERT(reporter, SkScalarAbs(a.fX - b.fX) <= kTolerance);
+        REPORTER_ASSERT(reporter, SkScalarAbs(a.fY - b.fY) <= kTolerance);
+    }
+
+    // Points on a coarse grid take a few bits each, and are still exact.
+    SkPath ints;
+    ints.moveTo(0, 0);
+    for (int i = 1; i < 100; ++i) {
+        ints.lineTo(SkIntToScalar(i), SkIntToScalar(i % 7) + 0.25f);
+    }
+    size = ints.writeCompactToMemory(NULL);
+    REPORTER_ASSERT(reporter, 4 * size < ints.writeToMemory(NULL));
+    SkAutoMalloc intStorage(size);
+    ints.writeCompactToMemory(intStorage.get());
+    SkPath intsBack;
+    REPORTER_ASSERT(reporter, size == intsBack.readFromMemory(intStorage.get(), size));
+    REPORTER_ASSERT(reporter, intsBack == ints);
+
+    // -0 is not on the grid, since it would read back as 0.
+    SkPath negativeZero;
+    negativeZero.moveTo(1, 2);
+    negativeZero.lineTo(-0.0f, 1);
+    size = negativeZero.writeCompactToMemory(NULL);
+    SkAutoMalloc negativeZeroStorage(size);
+    negativeZero.writeCompactToMemory(negativeZeroStorage.get());
+    SkPath negativeZeroBack;
+    REPORTER_ASSERT(reporter, size == negativeZeroBack.readFromMemory(negativeZeroStorage.get(),
+                                                                      size));
+    REPORTER_ASSERT(reporter, SkFloat2Bits(negativeZeroBack.getPoint(1).fX) ==
+                              SkFloat2Bits(-0.0f));
+
+    // Points that cannot be rounded to the grid are written exactly.
+    SkPath nonFinite;
+    nonFinite.moveTo(0, 0);
+    nonFinite.lineTo(SK_ScalarInfinity, 1.5f);
+    nonFinite.lineTo(SK_ScalarNaN, -SK_ScalarInfinity);
+    gridSize = nonFinite.writeCompactToMemory(NULL, kTolerance);
+    SkAutoMalloc nonFiniteStorage(gridSize);
+    nonFinite.writeCompactToMemory(nonFiniteStorage.get(), kTolerance);
+    SkPath readBack;
+    REPORTER_ASSERT(reporter, gridSize == readBack.readFromMemory(nonFiniteStorage.get(),
+                                                                  gridSize));
+    REPORTER_ASSERT(reporter, readBack.countPoints() == 3);
+    SkPoint pts[3];
+    readBack.getPoints(pts, 3);
+    REPORTER_ASSERT(reporter, pts[1].fX == SK_ScalarInfinity && pts[1].fY == 1.5f);
+    REPORTER_ASSERT(reporter, SkScalarIsNaN(pts[2].fX) && pts[2].fY == -SK_ScalarInfinity);
+    REPORTER_ASSERT(reporter, !readBack.isFinite());
+
+    // The oval flag and convexity survive.
+    SkPath oval;
+    oval.addOval(SkRect::MakeXYWH(0.5f, 1, 10, 20));
+    REPORTER_ASSERT(reporter, oval.isConvex());
+    size = oval.writeCompactToMemory(NULL);
+    SkAutoMalloc ovalStorage(size);
+    oval.writeCompactToMemory(ovalStorage.get());
+    SkPath ovalBack;
+    REPORTER_ASSERT(reporter, size == ovalBack.readFromMemory(ovalStorage.get(), size));
+    REPORTER_ASSERT(reporter, ovalBack == oval);
+    REPORTER_ASSERT(reporter, ovalBack.isOval(NULL));
+    REPORTER_ASSERT(reporter, ovalBack.getConvexityOrUnknown() == SkPath::kConvex_Convexity);
+
+    // A verb that does not match the points is rejected. The first verb run follows the 4 byte
+    // header, the flags and three one byte counts.
+    SkPath line;
+    line.moveTo(1, 2);
+    line.lineTo(3, 4);
+    size = line.writeCompactToMemory(NULL);
+    SkAutoMalloc lineStorage(size);
+    line.writeCompactToMemory(lineStorage.get());
+    uint8_t* firstRun = (uint8_t*)lineStorage.get() + 8;
+    REPORTER_ASSERT(reporter, *firstRun == ((1 << 3) | SkPath::kLine_Verb));
+    *firstRun = (1 << 3) | SkPath::kCubic_Verb;
+    SkPath badVerb;
+    REPORTER_ASSERT(reporter, 0 == badVerb.readFromMemory(lineStorage.get(), size));
+    REPORTER_ASSERT(reporter, badVerb.isEmpty());
+}
+
 static void test_transform(skiatest::Reporter* reporter) {
     SkPath p;
 
@@ -3741,6 +3869,7 @@ DEF_TEST(Paths, reporter) {
     test_close(reporter);
     test_segment_masks(reporter);
     test_flattening(reporter);
+    test_compact_flattening(reporter);
     test_transform(reporter);
     test_bounds(reporter);
     test_iter(reporter);
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkAtomics.h"
 #include "SkBBoxHierarchy.h"
 #include "SkBlurImageFilter.h"
 #include "SkCanvas.h"
@@ -14,6 +15,7 @@
 #include "SkData.h"
 #include "SkImageGenerator.h"
 #include "SkError.h"
+#include "SkImage.h"
 #include "SkImageEncoder.h"
 #include "SkImageGenerator.h"
 #include "SkLayerInfo.h"
@@ -29,6 +31,7 @@
 #include "SkRecord.h"
 #include "SkShader.h"
 #include "SkStream.h"
+#include "SkUtils.h"
 #include "sk_tool_utils.h"
 
 #if SK_SUPPORT_GPU
@@ -1313,3 +1316,227 @@ DEF_TEST(MiniRecorderLeftHanging, r) {
     REPORTER_ASSERT(r, rec.drawRect(SkRect::MakeWH(20,30), paint));
     // Don't call rec.detachPicture().  Test succeeds by not asserting or leaking the shader.
 }
+
+// Counts how many times its pixels are generated.
+class CountingImageGenerator : public SkImageGenerator {
+public:
+    CountingImageGenerator(int32_t* count)
+        : INHERITED(SkImageInfo::MakeN32Premul(20, 20)), fCount(count) {}
+
+protected:
+    Result onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes, const Options&,
+                       SkPMColor ctable[], int* ctableCount) override {
+        if (info.colorType() != kN32_SkColorType) {
+            return kInvalidConversion;
+        }
+        for (int y = 0; y < info.height(); ++y) {
+            sk_memset32((uint32_t*)((char*)pixels + y * rowBytes), SK_ColorBLUE, info.width());
+        }
+        sk_atomic_inc(fCount);
+        return kSuccess;
+    }
+
+private:
+    int32_t* fCount;
+
+    typedef SkImageGenerator INHERITED;
+};
+
+DEF_TEST(Picture_PrerollBitmaps, r) {
+    int32_t count = 0;
+    SkPictureRecorder recorder;
+
+    // A nested picture with a lazy image at (60, 60) in the outer picture's coordinates.
+    SkAutoTUnref<SkImage> nestedImage(
+            SkImage::NewFromGenerator(SkNEW_ARGS(CountingImageGenerator, (&count))));
+    recorder.beginRecording(20, 20)->drawImage(nestedImage, 0, 0);
+    SkAutoTUnref<SkPicture> nested(recorder.endRecording());
+
+    // A lazy bitmap shader filling a rect at (0, 60).
+    SkBitmap shaderBitmap;
+    REPORTER_ASSERT(r, SkInstallDiscardablePixelRef(SkNEW_ARGS(CountingImageGenerator, (&count)),
+                                                    &shaderBitmap));
+    SkPaint paint;
+    paint.setShader(SkShader::CreateBitmapShader(shaderBitmap, SkShader::kClamp_TileMode,
+                                                 SkShader::kClamp_TileMode))->unref();
+
+    SkCanvas* canvas = recorder.beginRecording(100, 100);
+    SkAutoTUnref<SkImage> images[2];
+    for (int i = 0; i < 2; ++i) {
+        images[i].reset(SkImage::NewFromGenerator(SkNEW_ARGS(CountingImageGenerator, (&count))));
+        canvas->drawImage(images[i], SkIntToScalar(60 * i), 0);
+    }
+    canvas->drawRect(SkRect::MakeXYWH(0, 60, 20, 20), paint);
+    canvas->translate(60, 60);
+    canvas->drawPicture(nested);
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+    REPORTER_ASSERT(r, 0 == count);
+
+    // Only the first image is inside this clip.
+    const SkRect clip = SkRect::MakeWH(30, 30);
+    REPORTER_ASSERT(r, 1 == SkPictureUtils::PrerollBitmaps(picture, clip));
+    REPORTER_ASSERT(r, 1 == count);
+
+    // Drawing with that clip finds it decoded.
+    SkBitmap bm;
+    bm.allocN32Pixels(100, 100);
+    SkCanvas dst(bm);
+    dst.clipRect(clip);
+    dst.drawPicture(picture);
+    REPORTER_ASSERT(r, 1 == count);
+    REPORTER_ASSERT(r, SK_ColorBLUE == bm.getColor(10, 10));
+
+    // This clip touches everything, but doesn't have to decode the first image again.
+    REPORTER_ASSERT(r, 4 == SkPictureUtils::PrerollBitmaps(picture, SkRect::MakeWH(100, 100)));
+    REPORTER_ASSERT(r, 4 == count);
+}
+
+class RectCountingCanvas : public SkCanvas {
+public:
+    RectCountingCanvas(const SkBitmap& bitmap) : INHERITED(bitmap), fRectCount(0) {}
+
+    void onDrawRect(const SkRect& rect, const SkPaint& paint) override {
+        ++fRectCount;
+        this->INHERITED::onDrawRect(rect, paint);
+    }
+
+    int fRectCount;
+
+private:
+    typedef SkCanvas INHERITED;
+};
+
+static int draw_clipped(const SkPicture* picture, const SkRect& clip, SkBitmap* bm) {
+    bm->allocN32Pixels(200, 200);
+    bm->eraseColor(SK_ColorWHITE);
+    RectCountingCanvas canvas(*bm);
+    canvas.scale(SK_ScalarHalf, SK_ScalarHalf);
+    canvas.clipRect(clip);
+    canvas.drawPicture(picture);
+    return canvas.fRectCount;
+}
+
+// A deserialized picture with an op index only reads the ops inside the clip.
+DEF_TEST(Picture_OpIndex, r) {
+    static const int kCells = 32;
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(400, 400);
+    SkPaint paint;
+    for (int y = 0; y < kCells; ++y) {
+        canvas->save();
+        canvas->translate(0, SkIntToScalar(12 * y));
+        if (y == kCells / 2) {
+            canvas->clipRect(SkRect::MakeWH(200, 12));
+        }
+        for (int x = 0; x < kCells; ++x) {
+            paint.setColor(SkColorSetARGB(0xFF, (x * 8) & 0xFF, (y * 8) & 0xFF, 0x80));
+            canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(12 * x), 0, 10, 10), paint);
+        }
+        canvas->restore();
+    }
+    // Enough dashed paths to make the picture unsuitable for GPU rasterization.
+    SkPaint dashPaint;
+    dashPaint.setStyle(SkPaint::kStroke_Style);
+    const SkScalar intervals[] = { 4, 4 };
+    dashPaint.setPathEffect(SkDashPathEffect::Create(intervals, 2, 0))->unref();
+    for (int i = 0; i < 6; ++i) {
+        SkPath path;
+        path.moveTo(0, SkIntToScalar(i));
+        path.lineTo(10, SkIntToScalar(i));
+        canvas->drawPath(path, dashPaint);
+    }
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+    REPORTER_ASSERT(r, !picture->suitableForGpuRasterization(NULL));
+
+    SkDynamicMemoryWStream wStream;
+    picture->serializeWithOpIndex(&wStream);
+    SkAutoTDelete<SkStream> rStream(wStream.detachAsStream());
+
+    // Plain serialization doesn't pay for an index, so loading it records everything.
+    SkDynamicMemoryWStream plainStream;
+    picture->serialize(&plainStream);
+    SkAutoTDelete<SkStream> plainRStream(plainStream.detachAsStream());
+    SkAutoTUnref<SkPicture> plain(SkPicture::CreateIndexedFromStream(plainRStream));
+    REPORTER_ASSERT(r, plain && plain->asSkBigPicture());
+
+    // Plain loading still records everything up front.
+    SkAutoTUnref<SkPicture> recorded(SkPicture::CreateFromStream(rStream));
+    REPORTER_ASSERT(r, recorded && recorded->asSkBigPicture());
+    REPORTER_ASSERT(r, recorded && !recorded->suitableForGpuRasterization(NULL));
+
+    rStream->rewind();
+    SkAutoTUnref<SkPicture> loaded(SkPicture::CreateIndexedFromStream(rStream));
+    REPORTER_ASSERT(r, loaded.get() != NULL);
+    if (!loaded) {
+        return;
+    }
+    REPORTER_ASSERT(r, NULL == loaded->asSkBigPicture());
+    REPORTER_ASSERT(r, loaded->cullRect() == picture->cullRect());
+    REPORTER_ASSERT(r, !loaded->suitableForGpuRasterization(NULL));
+
+    SkBitmap expected, actual;
+    const SkRect all = SkRect::MakeWH(400, 400);
+    draw_clipped(picture, all, &expected);
+    REPORTER_ASSERT(r, kCells * kCells == draw_clipped(loaded, all, &actual));
+    REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(), expected.getSize()));
+
+    // Only a few blocks of rects touch this clip, which straddles the clipped row.
+    const SkRect clip = SkRect::MakeXYWH(150, 180, 60, 30);
+    draw_clipped(picture, clip, &expected);
+    const int rects = draw_clipped(loaded, clip, &actual);
+    REPORTER_ASSERT(r, rects > 0 && rects < kCells * 4);
+    REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(), expected.getSize()));
+
+    // Serializing it again keeps everything.
+    SkDynamicMemoryWStream wStream2;
+    loaded->serializeWithOpIndex(&wStream2);
+    SkAutoTDelete<SkStream> rStream2(wStream2.detachAsStream());
+    SkAutoTUnref<SkPicture> reloaded(SkPicture::CreateIndexedFromStream(rStream2));
+    REPORTER_ASSERT(r, reloaded.get() != NULL);
+    if (reloaded) {
+        REPORTER_ASSERT(r, kCells * kCells == draw_clipped(reloaded, all, &actual));
+        draw_clipped(picture, all, &expected);
+        REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                       expected.getSize()));
+    }
+}
+
+// An op index whose blocks do not line up with the ops is rejected.
+DEF_TEST(Picture_OpIndexMismatch, r) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(100, 100);
+    SkPaint paint;
+    for (int i = 0; i < 16; ++i) {
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(6 * i), 0, 5, 5), paint);
+    }
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkDynamicMemoryWStream wStream;
+    picture->serializeWithOpIndex(&wStream);
+    SkAutoTUnref<SkData> data(wStream.copyToData());
+
+    // The index is its tag, its block count, then the blocks' bounds, starts and stops.
+    const uint32_t tag = SkSetFourByteTag('i', 'n', 'd', 'x');
+    const char* bytes = (const char*)data->data();
+    size_t offset = 0;
+    while (offset + sizeof(tag) <= data->size() && memcmp(bytes + offset, &tag, sizeof(tag))) {
+        offset++;
+    }
+    REPORTER_ASSERT(r, offset + sizeof(tag) <= data->size());
+    if (offset + sizeof(tag) > data->size()) {
+        return;
+    }
+    const size_t firstStart = offset + 2 * sizeof(uint32_t) + sizeof(SkRect);
+
+    SkMemoryStream good(data);
+    SkAutoTUnref<SkPicture> loaded(SkPicture::CreateIndexedFromStream(&good));
+    REPORTER_ASSERT(r, loaded && NULL == loaded->asSkBigPicture());
+
+    // Starting the first block in the middle of its first op.
+    SkAutoTUnref<SkData> bad(SkData::NewWithCopy(data->data(), data->size()));
+    uint32_t* start = (uint32_t*)((char*)bad->writable_data() + firstStart);
+    *start += 4;
+    SkMemoryStream badStream(bad);
+    REPORTER_ASSERT(r, NULL == SkPicture::CreateIndexedFromStream(&badStream));
+}
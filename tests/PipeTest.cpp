@@ -54,3 +54,95 @@ DEF_TEST(Pipe, reporter) {
 
     testDrawingAfterEndRecording(&canvas);
 }
+
+#if !defined(SK_BUILD_FOR_WIN32)
+
+#include "SkPixelSerializer.h"
+#include "SkSharedMemoryPipe.h"
+#include "SkThreadUtils.h"
+
+static void draw_shared_memory_commands(SkCanvas* canvas, const SkBitmap& shared,
+                                        const SkBitmap& copied) {
+    SkPaint paint;
+    for (int i = 0; i < 2000; ++i) {
+        paint.setColor(SkColorSetARGB(0xFF, (i * 7) & 0xFF, (i * 13) & 0xFF, (i * 29) & 0xFF));
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(i % 60), SkIntToScalar(i % 50),
+                                          SkIntToScalar(4), SkIntToScalar(8)), paint);
+        if (0 == i % 100) {
+            canvas->drawBitmap(shared, SkIntToScalar(i % 40), SkIntToScalar(i % 30));
+            canvas->drawBitmap(copied, SkIntToScalar(i % 30), SkIntToScalar(i % 40));
+        }
+    }
+}
+
+static void play_shared_memory_pipe(void* data) {
+    SkSharedMemoryPipeReader* reader = static_cast<SkSharedMemoryPipeReader*>(data);
+    while (SkGPipeReader::kDone_Status == reader->playback()) {}
+}
+
+DEF_TEST(Pipe_SharedMemory, reporter) {
+    // Small enough that the commands wrap around the ring several times.
+    SkAutoTUnref<SkSharedPipeMemory> memory(SkSharedPipeMemory::Create(32 * 1024, 64 * 1024));
+    REPORTER_ASSERT(reporter, memory.get());
+    if (!memory) {
+        return;
+    }
+
+    SkBitmap shared;
+    shared.setInfo(SkImageInfo::MakeN32Premul(16, 16));
+    REPORTER_ASSERT(reporter, memory->allocPixels(&shared));
+    shared.eraseColor(SK_ColorGREEN);
+    SkBitmap copied;
+    copied.allocN32Pixels(16, 16);
+    copied.eraseColor(SK_ColorBLUE);
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(64, 64);
+    expected.eraseColor(SK_ColorWHITE);
+    actual.allocN32Pixels(64, 64);
+    actual.eraseColor(SK_ColorWHITE);
+    SkCanvas expectedCanvas(expected);
+    draw_shared_memory_commands(&expectedCanvas, shared, copied);
+
+    SkCanvas actualCanvas(actual);
+    SkSharedMemoryPipeReader reader(memory, &actualCanvas);
+    SkThread thread(play_shared_memory_pipe, &reader);
+    REPORTER_ASSERT(reporter, thread.start());
+    {
+        SkSharedMemoryPipeController controller(memory);
+        // Draw two recordings through the same pipe.
+        for (int i = 0; i < 2; ++i) {
+            SkGPipeWriter writer;
+            SkCanvas* pipeCanvas = writer.startRecording(&controller,
+                                                         SkGPipeWriter::kCrossProcess_Flag);
+            draw_shared_memory_commands(pipeCanvas, shared, copied);
+            writer.endRecording();
+        }
+        controller.waitForReader();
+
+        // Bitmaps in the shared memory are sent by reference.
+        SkAutoDataUnref handle(controller.getPixelSerializer()->encodePixels(
+                shared.info(), shared.getPixels(), shared.rowBytes()));
+        REPORTER_ASSERT(reporter, handle.get());
+        if (handle) {
+            SkBitmap installed;
+            REPORTER_ASSERT(reporter, SkSharedPipeMemory::InstallPixelRef(handle->data(),
+                                                                          handle->size(),
+                                                                          &installed));
+            REPORTER_ASSERT(reporter, installed.getPixels() == shared.getPixels());
+        }
+        REPORTER_ASSERT(reporter, NULL == controller.getPixelSerializer()->encodePixels(
+                copied.info(), copied.getPixels(), copied.rowBytes()));
+    }
+    // Destroying the controller closes the pipe, which stops the reader.
+    thread.join();
+
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+
+    // Tiny rings are rounded up to the minimum size.
+    SkAutoTUnref<SkSharedPipeMemory> tiny(SkSharedPipeMemory::Create(0, 0));
+    REPORTER_ASSERT(reporter, tiny && tiny->ringBytes() >= 4096 && 0 == tiny->pixelBytes());
+}
+
+#endif
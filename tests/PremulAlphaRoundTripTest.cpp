@@ -8,6 +8,7 @@
 #include "SkBitmapDevice.h"
 #include "SkCanvas.h"
 #include "SkConfig8888.h"
+#include "SkUnPreMultiply.h"
 #include "Test.h"
 #include "sk_tool_utils.h"
 
@@ -131,3 +132,82 @@ DEF_GPUTEST(PremulAlphaRoundTrip, reporter, factory) {
         }
     }
 }
+
+static uint32_t swap_rb(uint32_t c) {
+    uint8_t* byte = reinterpret_cast<uint8_t*>(&c);
+    SkTSwap(byte[0], byte[2]);
+    return c;
+}
+
+// SkPixelInfo::CopyPixels() premuls and unpremuls with SIMD where it can; check that every
+// alpha and component value gives exactly what the portable math does. The odd width leaves
+// a few pixels at the end of each row for the portable code.
+DEF_TEST(PremulAlpha_CopyPixels, reporter) {
+    const int kWidth = 253;
+    const int kHeight = 260;
+    SkAutoTMalloc<uint32_t> unpremul(kWidth * kHeight);
+    SkAutoTMalloc<uint32_t> premul(kWidth * kHeight);
+    SkAutoTMalloc<uint32_t> dst(kWidth * kHeight);
+
+    // Every (alpha, component) pair appears as R, G and B somewhere, and premul pixels are
+    // valid, their components no larger than their alpha.
+    for (int i = 0; i < kWidth * kHeight; ++i) {
+        const int a = (i >> 8) & 0xFF;
+        const int c[3] = { i & 0xFF, (i * 7 + 3) & 0xFF, 0xFF - (i & 0xFF) };
+        uint8_t* u = reinterpret_cast<uint8_t*>(&unpremul[i]);
+        uint8_t* p = reinterpret_cast<uint8_t*>(&premul[i]);
+        for (int j = 0; j < 3; ++j) {
+            u[j] = c[j];
+            p[j] = SkMulDiv255Round(c[j], a);
+        }
+        u[3] = p[3] = a;
+    }
+
+    const SkColorType colorTypes[] = { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType };
+    for (size_t srcIdx = 0; srcIdx < SK_ARRAY_COUNT(colorTypes); ++srcIdx) {
+        for (size_t dstIdx = 0; dstIdx < SK_ARRAY_COUNT(colorTypes); ++dstIdx) {
+            const bool swap = srcIdx != dstIdx;
+            const SkImageInfo srcInfo = SkImageInfo::Make(kWidth, kHeight, colorTypes[srcIdx],
+                                                          kUnpremul_SkAlphaType);
+            const SkImageInfo dstInfo = SkImageInfo::Make(kWidth, kHeight, colorTypes[dstIdx],
+                                                          kPremul_SkAlphaType);
+
+            // Premul.
+            REPORTER_ASSERT(reporter, SkPixelInfo::CopyPixels(dstInfo, dst, kWidth * 4,
+                                                              srcInfo, unpremul, kWidth * 4));
+            int mismatches = 0;
+            for (int i = 0; i < kWidth * kHeight; ++i) {
+                mismatches += dst[i] != (swap ? swap_rb(premul[i]) : premul[i]);
+            }
+            REPORTER_ASSERT(reporter, 0 == mismatches);
+
+            // Unpremul.
+            REPORTER_ASSERT(reporter, SkPixelInfo::CopyPixels(srcInfo, dst, kWidth * 4,
+                                                              dstInfo, premul, kWidth * 4));
+            mismatches = 0;
+            for (int i = 0; i < kWidth * kHeight; ++i) {
+                uint32_t expected = premul[i];
+                uint8_t* e = reinterpret_cast<uint8_t*>(&expected);
+                const SkUnPreMultiply::Scale scale = SkUnPreMultiply::GetScale(e[3]);
+                for (int j = 0; j < 3; ++j) {
+                    e[j] = SkUnPreMultiply::ApplyScale(scale, e[j]);
+                }
+                mismatches += dst[i] != (swap ? swap_rb(expected) : expected);
+            }
+            REPORTER_ASSERT(reporter, 0 == mismatches);
+
+            // Just swapping, in place.
+            if (swap) {
+                memcpy(dst, premul, kWidth * kHeight * 4);
+                REPORTER_ASSERT(reporter, SkPixelInfo::CopyPixels(
+                        dstInfo, dst, kWidth * 4, dstInfo.makeColorType(colorTypes[srcIdx]),
+                        dst, kWidth * 4));
+                mismatches = 0;
+                for (int i = 0; i < kWidth * kHeight; ++i) {
+                    mismatches += dst[i] != swap_rb(premul[i]);
+                }
+                REPORTER_ASSERT(reporter, 0 == mismatches);
+            }
+        }
+    }
+}
@@ -230,6 +230,39 @@ static bool test_rects(const SkIRect rect[], int count) {
     return true;
 }
 
+// Many overlapping rects make bands with lots of intervals, which exercises the bulk builder's
+// interval merging and the binary search in contains()/intersects().
+static void test_many_rects(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    for (int i = 0; i < 20; i++) {
+        const int N = 200;
+        SkIRect rect[N];
+        for (int j = 0; j < N; j++) {
+            int x = rand.nextU() % 1000;
+            int y = rand.nextU() % 100;
+            rect[j].setXYWH(x, y, 1 + rand.nextU() % 8, 1 + rand.nextU() % 50);
+        }
+        REPORTER_ASSERT(reporter, test_rects(rect, N));
+
+        SkRegion rgn;
+        rgn.setRects(rect, N);
+        for (int k = 0; k < 1000; k++) {
+            int x = rand.nextU() % 1010;
+            int y = rand.nextU() % 160;
+            bool expected = false;
+            for (int j = 0; j < N; j++) {
+                expected |= rect[j].contains(x, y);
+            }
+            REPORTER_ASSERT(reporter, rgn.contains(x, y) == expected);
+
+            SkIRect r = SkIRect::MakeXYWH(x, y, 1 + rand.nextU() % 4, 1 + rand.nextU() % 4);
+            REPORTER_ASSERT(reporter, rgn.contains(r) == slow_contains(rgn, r));
+            SkRegion tmp;
+            REPORTER_ASSERT(reporter, rgn.intersects(r) == tmp.op(rgn, r, SkRegion::kIntersect_Op));
+        }
+    }
+}
+
 DEF_TEST(Region, reporter) {
     const SkIRect r2[] = {
         { 0, 0, 1, 1 },
@@ -261,4 +294,5 @@ DEF_TEST(Region, reporter) {
     test_proc(reporter, intersects_proc);
     test_empties(reporter);
     test_fromchrome(reporter);
+    test_many_rects(reporter);
 }
@@ -543,3 +543,68 @@ DEF_TEST(Serialization, reporter) {
 
     TestPictureTypefaceSerialization(reporter);
 }
+
+static SkFlattenable* create_late_flattenable(SkReadBuffer&) {
+    return NULL;
+}
+
+DEF_TEST(Serialization_FlattenableNames, reporter) {
+    uint8_t table[256];
+    for (int i = 0; i < 256; ++i) {
+        table[i] = (i * 41) % 256;
+    }
+    SkAutoTUnref<SkColorFilter> tableFilter(SkTableColorFilter::Create(table));
+    SkAutoTUnref<SkColorFilter> modeFilter(
+            SkColorFilter::CreateModeFilter(SK_ColorRED, SkXfermode::kSrcOver_Mode));
+    SkAutoTUnref<SkXfermode> xfermode(SkXfermode::Create(SkXfermode::kMultiply_Mode));
+
+    // Names and factories map to each other.
+    const SkFlattenable* flattenables[] = { tableFilter, modeFilter, xfermode };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(flattenables); ++i) {
+        SkFlattenable::Factory factory = flattenables[i]->getFactory();
+        const char* name = SkFlattenable::FactoryToName(factory);
+        REPORTER_ASSERT(reporter, name);
+        if (name) {
+            REPORTER_ASSERT(reporter, SkFlattenable::NameToFactory(name) == factory);
+            SkFlattenable::Type type;
+            REPORTER_ASSERT(reporter, SkFlattenable::NameToType(name, &type));
+        }
+    }
+    SkFlattenable::Type type;
+    REPORTER_ASSERT(reporter, NULL == SkFlattenable::NameToFactory("NoSuchFlattenable"));
+    REPORTER_ASSERT(reporter, !SkFlattenable::NameToType("NoSuchFlattenable", &type));
+
+    // Flattenables registered after the first lookups are still found. Register() is safe to
+    // call while other tests look entries up, and this entry's name and factory are used by
+    // nothing else, so leaving it registered doesn't affect them.
+    static const char kLateName[] = "Serialization_LateFlattenable";
+    if (NULL == SkFlattenable::NameToFactory(kLateName)) {
+        SkFlattenable::Register(kLateName, create_late_flattenable,
+                                SkFlattenable::kSkColorFilter_Type);
+    }
+    REPORTER_ASSERT(reporter, SkFlattenable::NameToFactory(kLateName) == create_late_flattenable);
+    REPORTER_ASSERT(reporter, SkFlattenable::NameToType(kLateName, &type) &&
+                              SkFlattenable::kSkColorFilter_Type == type);
+    REPORTER_ASSERT(reporter, !strcmp(kLateName,
+                                      SkFlattenable::FactoryToName(create_late_flattenable)));
+
+    // A validating buffer resolves each name once, then reuses it.
+    SkWriteBuffer writer(SkWriteBuffer::kValidation_Flag);
+    const SkColorFilter* filters[] = { tableFilter, modeFilter, tableFilter, tableFilter };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(filters); ++i) {
+        writer.writeFlattenable(filters[i]);
+    }
+    writer.writeFlattenable(xfermode);
+    size_t size = writer.bytesWritten();
+    SkAutoTMalloc<unsigned char> data(size);
+    writer.writeToMemory(static_cast<void*>(data.get()));
+
+    SkValidatingReadBuffer reader(static_cast<void*>(data.get()), size);
+    for (size_t i = 0; i < SK_ARRAY_COUNT(filters); ++i) {
+        SkAutoTUnref<SkFlattenable> obj(reader.readFlattenable(SkFlattenable::kSkColorFilter_Type));
+        REPORTER_ASSERT(reporter, obj && obj->getFactory() == filters[i]->getFactory());
+    }
+    // A name that resolved to another type doesn't match.
+    SkAutoTUnref<SkFlattenable> obj(reader.readFlattenable(SkFlattenable::kSkColorFilter_Type));
+    REPORTER_ASSERT(reporter, NULL == obj.get());
+}
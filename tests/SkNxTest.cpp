@@ -72,6 +72,9 @@ static void test_Nf(skiatest::Reporter* r) {
     REPORTER_ASSERT(r, (a <= fours).anyTrue());
     REPORTER_ASSERT(r, !(a > fours).allTrue());
     REPORTER_ASSERT(r, !(a >= fours).allTrue());
+
+    assert_eq(SkNf<N,T>::Select(a < fours, a, fours), 3, 4, 4, 4);
+    assert_eq(SkNf<N,T>::Select(a >= fours, a*b, SkNf<N,T>(0)), 0, 16, 25, 36);
 }
 
 DEF_TEST(SkNf, r) {
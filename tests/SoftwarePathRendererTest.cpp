@@ -0,0 +1,146 @@
+/*
+ * Copyright 2015 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPath.h"
+
+#if SK_SUPPORT_GPU
+#include "GrContext.h"
+#include "GrContextFactory.h"
+#include "GrSoftwarePathRenderer.h"
+#include "GrTest.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+// A small self-intersecting star, which has to go through a software mask.
+static SkPath make_star(SkScalar cx, SkScalar cy, SkScalar r) {
+    const int kPoints = 7;
+    SkPath path;
+    for (int i = 0; i < kPoints; ++i) {
+        SkScalar angle = 2 * SK_ScalarPI * ((3 * i) % kPoints) / kPoints;
+        SkPoint pt = SkPoint::Make(cx + r * SkScalarCos(angle), cy + r * SkScalarSin(angle));
+        if (0 == i) {
+            path.moveTo(pt);
+        } else {
+            path.lineTo(pt);
+        }
+    }
+    path.close();
+    return path;
+}
+
+static void test_small_masks(skiatest::Reporter* reporter, GrContext* context) {
+    GrSurfaceDesc desc;
+    desc.fFlags = kRenderTarget_GrSurfaceFlag;
+    desc.fWidth = 512;
+    desc.fHeight = 512;
+    desc.fConfig = kSkia8888_GrPixelConfig;
+    desc.fOrigin = kTopLeft_GrSurfaceOrigin;
+    SkAutoTUnref<GrTexture> texture(context->textureProvider()->refScratchTexture(desc,
+        GrTextureProvider::kExact_ScratchTexMatch));
+    if (NULL == texture) {
+        return;
+    }
+    GrTestTarget tt;
+    context->getTestTarget(&tt);
+    GrRenderTarget* rt = texture->asRenderTarget();
+    GrDrawTarget* dt = tt.target();
+
+    GrSoftwarePathRenderer swpr(context);
+    GrStrokeInfo fill(SkStrokeRec::kFill_InitStyle);
+    GrStrokeInfo stroke(SkStrokeRec::kHairline_InitStyle);
+    stroke.setStrokeStyle(SkIntToScalar(2));
+
+    // Warm up: create the atlas and any shared buffers.
+    GrPipelineBuilder pipelineBuilder;
+    pipelineBuilder.setRenderTarget(rt);
+    swpr.drawPath(dt, &pipelineBuilder, SK_ColorBLACK, SkMatrix::I(),
+                  make_star(SkIntToScalar(20), SkIntToScalar(20), SkIntToScalar(10)), fill, true);
+    context->flush();
+
+    int countBefore;
+    context->getResourceCacheUsage(&countBefore, NULL);
+    int32_t masksBefore = GrSoftwarePathRenderer::AtlasMaskCount();
+
+    // Many small masks in different colors, under different matrices, and more than fit in the
+    // atlas at once. They should all share the atlas rather than each getting its own texture.
+    SkRandom rand;
+    for (int i = 0; i < 400; ++i) {
+        SkMatrix viewMatrix;
+        viewMatrix.setRotate(rand.nextRangeF(0, 360));
+        viewMatrix.postTranslate(rand.nextRangeF(32, 480), rand.nextRangeF(32, 480));
+        SkPath path = make_star(0, 0, rand.nextRangeF(4, 30));
+        GrPipelineBuilder pipelineBuilder;
+        pipelineBuilder.setRenderTarget(rt);
+        swpr.drawPath(dt, &pipelineBuilder, rand.nextU() | 0xFF000000, viewMatrix, path,
+                      (i & 1) ? fill : stroke, SkToBool(i & 2));
+    }
+    context->flush();
+
+    int countAfter;
+    context->getResourceCacheUsage(&countAfter, NULL);
+    REPORTER_ASSERT(reporter, countAfter - countBefore <= 2);
+    REPORTER_ASSERT(reporter, masksBefore + 400 == GrSoftwarePathRenderer::AtlasMaskCount());
+
+    // A mask bigger than the atlas allows gets a texture of its own.
+    swpr.drawPath(dt, &pipelineBuilder, SK_ColorBLACK, SkMatrix::I(),
+                  make_star(SkIntToScalar(256), SkIntToScalar(256), SkIntToScalar(200)), fill,
+                  true);
+    context->flush();
+    REPORTER_ASSERT(reporter, masksBefore + 400 == GrSoftwarePathRenderer::AtlasMaskCount());
+}
+
+// A renderer that isn't the context's own can outlive the context being abandoned, and then has to
+// let go of its destroyed atlas texture safely.
+static void test_abandon(skiatest::Reporter* reporter, GrContextFactory::GLContextType type) {
+    GrContextFactory factory;
+    GrContext* context = factory.get(type);
+    if (NULL == context) {
+        return;
+    }
+    GrSurfaceDesc desc;
+    desc.fFlags = kRenderTarget_GrSurfaceFlag;
+    desc.fWidth = 64;
+    desc.fHeight = 64;
+    desc.fConfig = kSkia8888_GrPixelConfig;
+    SkAutoTUnref<GrTexture> texture(context->textureProvider()->refScratchTexture(desc,
+        GrTextureProvider::kExact_ScratchTexMatch));
+    if (NULL == texture) {
+        return;
+    }
+
+    GrSoftwarePathRenderer swpr(context);
+    {
+        GrTestTarget tt;
+        context->getTestTarget(&tt);
+        GrPipelineBuilder pipelineBuilder;
+        pipelineBuilder.setRenderTarget(texture->asRenderTarget());
+        GrStrokeInfo fill(SkStrokeRec::kFill_InitStyle);
+        int32_t masksBefore = GrSoftwarePathRenderer::AtlasMaskCount();
+        swpr.drawPath(tt.target(), &pipelineBuilder, SK_ColorBLACK, SkMatrix::I(),
+                      make_star(SkIntToScalar(20), SkIntToScalar(20), SkIntToScalar(10)), fill,
+                      true);
+        context->flush();
+        REPORTER_ASSERT(reporter, masksBefore + 1 == GrSoftwarePathRenderer::AtlasMaskCount());
+    }
+    factory.abandonContexts();
+}
+
+DEF_GPUTEST(SoftwarePathRendererAtlas, reporter, factory) {
+    static const GrContextFactory::GLContextType kTypes[] = {
+        GrContextFactory::kNull_GLContextType,
+        GrContextFactory::kDebug_GLContextType,
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kTypes); ++i) {
+        GrContext* context = factory->get(kTypes[i]);
+        if (NULL == context) {
+            continue;
+        }
+        test_small_masks(reporter, context);
+        test_abandon(reporter, kTypes[i]);
+    }
+}
+#endif
@@ -11,6 +11,7 @@
 #include "SkOSFile.h"
 #include "SkRandom.h"
 #include "SkStream.h"
+#include "SkStreamPriv.h"
 #include "Test.h"
 
 #ifndef SK_BUILD_FOR_WIN
@@ -193,6 +194,114 @@ DEF_TEST(Stream, reporter) {
     TestNullData();
 }
 
+// Reads stream in chunks of random sizes, and checks them against data.
+static void test_buffered_reads(skiatest::Reporter* reporter, SkStream* stream,
+                                const uint8_t* data, size_t length) {
+    SkRandom rand;
+    SkAutoTMalloc<uint8_t> storage(length);
+    size_t pos = 0;
+    while (pos < length) {
+        // Mostly small reads, and the occasional one larger than the buffer.
+        size_t size = rand.nextBool() ? rand.nextULessThan(100) : rand.nextULessThan(100000);
+        size = SkTMin(size, length - pos);
+        if (rand.nextULessThan(4) == 0) {
+            REPORTER_ASSERT(reporter, stream->skip(size) == size);
+        } else {
+            REPORTER_ASSERT(reporter, stream->read(storage.get(), size) == size);
+            REPORTER_ASSERT(reporter, !memcmp(storage.get(), data + pos, size));
+        }
+        pos += size;
+    }
+    REPORTER_ASSERT(reporter, 0 == stream->read(storage.get(), 1));
+    REPORTER_ASSERT(reporter, stream->isAtEnd());
+}
+
+DEF_TEST(Stream_BufferedFILE, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "buffered_stream_test");
+
+    const size_t kLength = 3 * SkBufferedFILEStream::kBufferSize + 123;
+    SkAutoTMalloc<uint8_t> data(kLength);
+    SkRandom rand;
+    for (size_t i = 0; i < kLength; ++i) {
+        data[i] = rand.nextU() & 0xFF;
+    }
+    {
+        SkFILEWStream writer(path.c_str());
+        if (!writer.isValid()) {
+            ERRORF(reporter, "Failed to create tmp file %s\n", path.c_str());
+            return;
+        }
+        writer.write(data.get(), kLength);
+    }
+
+    // NewFromFile() maps a regular file.
+    {
+        SkAutoTDelete<SkStreamAsset> stream(SkStream::NewFromFile(path.c_str()));
+        REPORTER_ASSERT(reporter, stream.get() && stream->getMemoryBase());
+        REPORTER_ASSERT(reporter, stream->getLength() == kLength);
+    }
+
+    // A seekable file.
+    {
+        SkBufferedFILEStream stream(sk_fopen(path.c_str(), kRead_SkFILE_Flag), path.c_str());
+        REPORTER_ASSERT(reporter, stream.getLength() == kLength);
+        test_buffered_reads(reporter, &stream, data.get(), kLength);
+
+        REPORTER_ASSERT(reporter, stream.rewind());
+        REPORTER_ASSERT(reporter, stream.getPosition() == 0);
+        test_buffered_reads(reporter, &stream, data.get(), kLength);
+
+        // Seek back and forth, past the buffer.
+        const size_t positions[] = { 5, kLength - 10, 70000, 69999, kLength, 0 };
+        for (size_t i = 0; i < SK_ARRAY_COUNT(positions); ++i) {
+            uint8_t byte;
+            REPORTER_ASSERT(reporter, stream.seek(positions[i]));
+            REPORTER_ASSERT(reporter, stream.getPosition() == positions[i]);
+            if (positions[i] < kLength) {
+                REPORTER_ASSERT(reporter, stream.read(&byte, 1) == 1);
+                REPORTER_ASSERT(reporter, byte == data[positions[i]]);
+            }
+        }
+        REPORTER_ASSERT(reporter, stream.move(100));
+        REPORTER_ASSERT(reporter, stream.move(-50));
+        REPORTER_ASSERT(reporter, stream.getPosition() == 51);
+
+        SkAutoTDelete<SkStreamAsset> fork(stream.fork());
+        REPORTER_ASSERT(reporter, fork.get() && fork->getPosition() == 51);
+        test_buffered_reads(reporter, fork.get(), data.get() + 51, kLength - 51);
+        SkAutoTDelete<SkStreamAsset> duplicate(stream.duplicate());
+        REPORTER_ASSERT(reporter, duplicate.get() && duplicate->getPosition() == 0);
+        test_buffered_reads(reporter, duplicate.get(), data.get(), kLength);
+    }
+
+#ifndef SK_BUILD_FOR_WIN
+    // A pipe, with less in it than the pipe holds, so this can write it all up front.
+    int fds[2];
+    if (pipe(fds) == 0) {
+        const size_t kPipeLength = 3000;
+        REPORTER_ASSERT(reporter, write(fds[1], data.get(), kPipeLength) == kPipeLength);
+        close(fds[1]);
+
+        SkBufferedFILEStream stream((SkFILE*)fdopen(fds[0], "rb"), NULL);
+        REPORTER_ASSERT(reporter, stream.getLength() == 0);
+        REPORTER_ASSERT(reporter, NULL == stream.duplicate());
+
+        // The start is still buffered, so the stream can rewind.
+        uint8_t header[16];
+        REPORTER_ASSERT(reporter, stream.read(header, sizeof(header)) == sizeof(header));
+        REPORTER_ASSERT(reporter, !memcmp(header, data.get(), sizeof(header)));
+        REPORTER_ASSERT(reporter, stream.rewind());
+        test_buffered_reads(reporter, &stream, data.get(), kPipeLength);
+        REPORTER_ASSERT(reporter, stream.seek(1000));
+        REPORTER_ASSERT(reporter, stream.read(header, 1) == 1 && header[0] == data[1000]);
+    }
+#endif
+}
+
 /**
  *  Tests peeking and then reading the same amount. The two should provide the
  *  same results.
@@ -274,5 +274,28 @@ DEF_GPUTEST(TessellatingPathRendererTests, reporter, factory) {
     test_path(dt, rt, create_path_13());
     test_path(dt, rt, create_path_14());
     test_path(dt, rt, create_path_15());
+
+    // Drawing the same non-volatile path again should reuse the cached triangles rather than
+    // tessellating it again or allocating another vertex buffer.
+    SkPath path = create_path_14();
+    test_path(dt, rt, path);
+    context->flush();
+    int countBefore;
+    context->getResourceCacheUsage(&countBefore, NULL);
+    int32_t tessellationsBefore = GrTessellatingPathRenderer::TessellationCount();
+    test_path(dt, rt, path);
+    context->flush();
+    int countAfter;
+    context->getResourceCacheUsage(&countAfter, NULL);
+    REPORTER_ASSERT(reporter, countBefore == countAfter);
+    REPORTER_ASSERT(reporter,
+                    tessellationsBefore == GrTessellatingPathRenderer::TessellationCount());
+
+    // A volatile path is never cached, so each draw tessellates it.
+    path.setIsVolatile(true);
+    test_path(dt, rt, path);
+    context->flush();
+    REPORTER_ASSERT(reporter,
+                    tessellationsBefore + 1 == GrTessellatingPathRenderer::TessellationCount());
 }
 #endif
@@ -30,6 +30,19 @@ static bool compresses_a8(SkTextureCompressor::Format fmt) {
     switch (fmt) {
         case SkTextureCompressor::kLATC_Format:
         case SkTextureCompressor::kR11_EAC_Format:
+        case SkTextureCompressor::kASTC_4x4_Format:
+        case SkTextureCompressor::kASTC_5x4_Format:
+        case SkTextureCompressor::kASTC_5x5_Format:
+        case SkTextureCompressor::kASTC_6x5_Format:
+        case SkTextureCompressor::kASTC_6x6_Format:
+        case SkTextureCompressor::kASTC_8x5_Format:
+        case SkTextureCompressor::kASTC_8x6_Format:
+        case SkTextureCompressor::kASTC_8x8_Format:
+        case SkTextureCompressor::kASTC_10x5_Format:
+        case SkTextureCompressor::kASTC_10x6_Format:
+        case SkTextureCompressor::kASTC_10x8_Format:
+        case SkTextureCompressor::kASTC_10x10_Format:
+        case SkTextureCompressor::kASTC_12x10_Format:
         case SkTextureCompressor::kASTC_12x12_Format:
             return true;
 
@@ -72,15 +85,8 @@ DEF_TEST(CompressAlphaFailDimensions, reporter) {
  * compressed textures can (currently) only be created from A8 bitmaps.
  */
 DEF_TEST(CompressAlphaFailColorType, reporter) {
-    static const int kWidth = 12;
-    static const int kHeight = 12;
-
-    // ASTC is at most 12x12, and any dimension divisible by 12 is also divisible
-    // by 4, which is the dimensions of R11_EAC and LATC. In the future, we might
-    // support additional variants of ASTC, such as 5x6 and 8x8, in which case this would
-    // need to be updated.
-    REPORTER_ASSERT(reporter, kWidth % 12 == 0);
-    REPORTER_ASSERT(reporter, kHeight % 12 == 0);
+    static const int kWidth = 120;
+    static const int kHeight = 120;
 
     SkAutoPixmapStorage pixmap;
     pixmap.alloc(SkImageInfo::MakeN32Premul(kWidth, kHeight));
@@ -91,6 +97,14 @@ DEF_TEST(CompressAlphaFailColorType, reporter) {
         if (!compresses_a8(fmt)) {
             continue;
         }
+
+        // 120 is divisible by every block dimension we support, so only the color type can
+        // make these fail.
+        int dimX, dimY;
+        SkTextureCompressor::GetBlockDimensions(fmt, &dimX, &dimY, true);
+        REPORTER_ASSERT(reporter, kWidth % dimX == 0);
+        REPORTER_ASSERT(reporter, kHeight % dimY == 0);
+
         SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(pixmap, fmt));
         REPORTER_ASSERT(reporter, NULL == data);
     }
@@ -273,3 +287,114 @@ DEF_TEST(CompressLATC, reporter) {
         }
     }
 }
+
+// Fills the pixmap with a gradient, with the left and top 'solidSize' pixels set to
+// transparent and opaque respectively.
+static void fill_test_alpha(const SkPixmap& pixmap, int solidSize) {
+    const int range = pixmap.width() + pixmap.height();
+    uint8_t* pixels = reinterpret_cast<uint8_t*>(pixmap.writable_addr());
+    for (int y = 0; y < pixmap.height(); ++y) {
+        for (int x = 0; x < pixmap.width(); ++x) {
+            if (x < solidSize) {
+                pixels[x] = 0;
+            } else if (y < solidSize) {
+                pixels[x] = 0xFF;
+            } else {
+                pixels[x] = static_cast<uint8_t>((x + y) * 255 / range);
+            }
+        }
+        pixels += pixmap.rowBytes();
+    }
+}
+
+/**
+ * Make sure that the SIMD encoders produce the same blocks as the portable ones, and
+ * that compressing a large image in parallel bands matches compressing it in one piece.
+ */
+DEF_TEST(CompressA8Bands, reporter) {
+    static const int kWidth = 512;  // Large enough to be split into bands.
+    static const int kHeight = 512;
+    static const int kStripY = 256;
+    static const int kStripHeight = 16;
+
+    SkAutoPixmapStorage pixmap;
+    pixmap.alloc(SkImageInfo::MakeA8(kWidth, kHeight));
+    fill_test_alpha(pixmap, 64);
+    const uint8_t* pixels = reinterpret_cast<const uint8_t*>(pixmap.addr());
+
+    const SkTextureCompressor::Format kFormats[] = {
+        SkTextureCompressor::kLATC_Format,
+        SkTextureCompressor::kR11_EAC_Format,
+        SkTextureCompressor::kASTC_8x8_Format,
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kFormats); ++i) {
+        const SkTextureCompressor::Format fmt = kFormats[i];
+        const int size = SkTextureCompressor::GetCompressedDataSize(fmt, kWidth, kHeight);
+        const int stripSize =
+            SkTextureCompressor::GetCompressedDataSize(fmt, kWidth, kStripHeight);
+        REPORTER_ASSERT(reporter, size > 0 && stripSize > 0);
+
+        SkAutoMalloc opt(size), portable(size), strip(stripSize);
+        REPORTER_ASSERT(reporter, SkTextureCompressor::CompressBufferToFormat(
+            (uint8_t*)opt.get(), pixels, kAlpha_8_SkColorType, kWidth, kHeight,
+            pixmap.rowBytes(), fmt, true));
+        REPORTER_ASSERT(reporter, SkTextureCompressor::CompressBufferToFormat(
+            (uint8_t*)portable.get(), pixels, kAlpha_8_SkColorType, kWidth, kHeight,
+            pixmap.rowBytes(), fmt, false));
+        REPORTER_ASSERT(reporter, 0 == memcmp(opt.get(), portable.get(), size));
+
+        REPORTER_ASSERT(reporter, SkTextureCompressor::CompressBufferToFormat(
+            (uint8_t*)strip.get(), pixels + kStripY*pixmap.rowBytes(), kAlpha_8_SkColorType,
+            kWidth, kStripHeight, pixmap.rowBytes(), fmt, false));
+        const size_t stripOffset = (kStripY / kStripHeight) * stripSize;
+        REPORTER_ASSERT(reporter,
+                        0 == memcmp((const uint8_t*)portable.get() + stripOffset, strip.get(),
+                                    stripSize));
+    }
+}
+
+/**
+ * Make sure that every ASTC block size round trips A8 data to within the precision
+ * of its three bit weights, and that solid blocks are exact.
+ */
+DEF_TEST(CompressASTC, reporter) {
+    static const int kSolidSize = 120;  // Divisible by every ASTC block dimension.
+    static const int kWidth = 2*kSolidSize;
+    static const int kHeight = 2*kSolidSize;
+
+    SkAutoPixmapStorage pixmap;
+    pixmap.alloc(SkImageInfo::MakeA8(kWidth, kHeight));
+    fill_test_alpha(pixmap, kSolidSize);
+    const uint8_t* pixels = reinterpret_cast<const uint8_t*>(pixmap.addr());
+
+    SkAutoTMalloc<SkColor> decompressed(kWidth*kHeight);
+    for (int i = SkTextureCompressor::kASTC_4x4_Format; i <= SkTextureCompressor::kLast_Format;
+         ++i) {
+        const SkTextureCompressor::Format fmt = static_cast<SkTextureCompressor::Format>(i);
+        SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(pixmap, fmt));
+        REPORTER_ASSERT(reporter, data);
+        if (NULL == data) {
+            continue;
+        }
+
+        REPORTER_ASSERT(reporter, SkTextureCompressor::DecompressBufferFromFormat(
+            reinterpret_cast<uint8_t*>(decompressed.get()), kWidth*sizeof(SkColor),
+            data->bytes(), kWidth, kHeight, fmt));
+
+        int maxError = 0;
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                // ASTC blocks start at the bottom left, so the image comes back upside down.
+                const SkColor color = decompressed[(kHeight - 1 - y)*kWidth + x];
+                const int expected = pixels[y*pixmap.rowBytes() + x];
+                const int error = SkAbs32(static_cast<int>(SkColorGetR(color)) - expected);
+                maxError = SkTMax(maxError, error);
+                if (x < kSolidSize || y < kSolidSize) {
+                    REPORTER_ASSERT(reporter, 0 == error);
+                }
+            }
+        }
+        // Three bit weights are 36 apart, and the encoder truncates.
+        REPORTER_ASSERT(reporter, maxError < 37);
+    }
+}